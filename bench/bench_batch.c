@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_batch.c
+ * @brief Coalescing of the published MQTT packets (LOC_NETW_TX_BUF_SZ)
+ *
+ * Usage: bench_batch [messages] [messages per burst]
+ *
+ * The PUBLISH packets (QoS 0, JSON payload) are written through the network layer of the
+ * client to the local broker, in TCP and in TLS, as LOCC_processPendingMesssage does when it
+ * drains the message queue:
+ *  - off : one write per packet (no netw_batchStart, i.e. LOC_NETW_TX_BUF_SZ = 0),
+ *  - on  : each burst between netw_batchStart() and netw_batchFlush().
+ * send() is wrapped (-Wl,--wrap) to count the calls of the client; the broker counts the
+ * bytes received on the connection (TLS records included).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "config/liveobjects_dev_params.h"
+#include "liveobjects_iotsoftbox_api.h"
+#include "iotsoftbox-core/netw_wrapper.h"
+#include "MQTTPacket.h"
+
+#include "bench_util.h"
+
+static volatile uint32_t _bench_cnt_send;
+
+static BenchBroker_t _bench_broker;
+
+ssize_t __real_send(int sock, const void* buf, size_t len, int flags);
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+ssize_t __wrap_send(int sock, const void* buf, size_t len, int flags) {
+	if (!bench_brokerSelf()) {
+		__atomic_add_fetch(&_bench_cnt_send, 1, __ATOMIC_RELAXED);
+	}
+	return __real_send(sock, buf, len, flags);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Write msg_nb PUBLISH packets, by bursts of burst_nb packets (batched or not),
+ * and wait until the broker has received all of them */
+static int bench_run(uint8_t tls, uint8_t batch, uint32_t msg_nb, uint32_t burst_nb) {
+	LiveObjectsNetConnectParams_t cp = { LOC_SERV_IP_ADDRESS, LOC_SERV_PORT, 5000 };
+	LiveObjectsSecurityParams_t sp;
+	MQTTString topic = MQTTString_initializer;
+	Network net;
+	unsigned char pkt[256];
+	char payload[128];
+	uint32_t n_send;
+	uint64_t t0, t1;
+	uint32_t i;
+	int ret = 0;
+
+	_bench_broker.port = LOC_SERV_PORT;
+	_bench_broker.tls = tls;
+	if (bench_brokerStart(&_bench_broker)) {
+		return -1;
+	}
+	memset(&net, 0, sizeof(net));
+	memset(&sp, 0, sizeof(sp));
+	if ((netw_init(&net, NULL)) || ((tls) && (netw_setSecurity(&net, &sp))) || (netw_connect(&net, &cp))) {
+		fprintf(stderr, "ERROR: connection to the local broker\n");
+		bench_brokerStop(&_bench_broker);
+		return -1;
+	}
+	topic.cstring = "dev/data";
+
+	/* Only the published packets: not the TLS handshake */
+	_bench_broker.wire_bytes = 0;
+	n_send = _bench_cnt_send;
+	t0 = bench_nowNs();
+	for (i = 0; (i < msg_nb) && (ret == 0); i++) {
+		int len = snprintf(payload, sizeof(payload),
+				"{\"s\":\"urn:lo:nsid:bench:1\",\"m\":\"bench_v1\",\"v\":{\"temp\":21.5,\"cnt\":%u}}", i);
+		if ((batch) && ((i % burst_nb) == 0)) {
+			netw_batchStart(&net);
+		}
+		len = MQTTSerialize_publish(pkt, sizeof(pkt), 0, 0, 0, 0, topic, (unsigned char*) payload, len);
+		if ((len <= 0) || (net.mqttwrite(&net, pkt, len, 1000) != len)) {
+			ret = -1;
+		}
+		if ((batch) && (((i + 1) % burst_nb == 0) || (i + 1 == msg_nb)) && (netw_batchFlush(&net))) {
+			ret = -1;
+		}
+	}
+	while ((ret == 0) && (_bench_broker.cnt_publish < msg_nb)) {
+		if ((bench_nowNs() - t0) > 60000000000ULL) {
+			fprintf(stderr, "ERROR: %u/%u messages received\n", _bench_broker.cnt_publish, msg_nb);
+			ret = -1;
+		}
+		usleep(50);
+	}
+	t1 = bench_nowNs();
+	n_send = _bench_cnt_send - n_send;
+	if (ret == 0) {
+		printf("%-4s %-4s %9.0f msg/s  send=%-6u (%.3f/msg)  wire=%-8llu bytes (%.1f/msg)\n",
+				(tls) ? "tls" : "tcp", (batch) ? "on" : "off", (double) msg_nb * 1e9 / (double) (t1 - t0),
+				n_send, (double) n_send / msg_nb, (unsigned long long) _bench_broker.wire_bytes,
+				(double) _bench_broker.wire_bytes / msg_nb);
+	}
+	else {
+		fprintf(stderr, "ERROR: write failed\n");
+	}
+
+	netw_disconnect(&net, 0);
+	netw_tls_destroy(&net);
+	bench_brokerStop(&_bench_broker);
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int main(int argc, char* argv[]) {
+	uint32_t msg_nb = (uint32_t) bench_arg(argc, argv, 1, 20000);
+	uint32_t burst_nb = (uint32_t) bench_arg(argc, argv, 2, 32);
+	uint8_t tls;
+
+	LiveObjectsClient_SetDbgLevel(LOTRACE_LEVEL_NONE);
+
+	if (burst_nb == 0) {
+		burst_nb = 1;
+	}
+	printf("messages=%u burst=%u LOC_NETW_TX_BUF_SZ=%u\n", msg_nb, burst_nb, (unsigned) LOC_NETW_TX_BUF_SZ);
+	for (tls = 0; tls <= 1; tls++) {
+		if ((bench_run(tls, 0, msg_nb, burst_nb)) || (bench_run(tls, 1, msg_nb, burst_nb))) {
+			return 1;
+		}
+	}
+	return 0;
+}
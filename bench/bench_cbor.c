@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_cbor.c
+ * @brief JSON vs. CBOR encoding (LOD_ENCODING_JSON / LOD_ENCODING_CBOR)
+ *
+ * Usage: bench_cbor [iterations]
+ *
+ * Prints the size of the payload, and the time (ns and CPU cycles) per message:
+ *  - encoding of a data message (LO_msg_encode_data) of 6 elements (int32, int16[3], float,
+ *    double[2], bool, string) with stream id, model and tags, as published by the client thread,
+ *  - decoding of a parameter update request (LO_msg_decode_params_req) of 3 parameters
+ *    (uint32, double, string).
+ * The cycles are read with the time-stamp counter (x86 only, otherwise 0).
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "liveobjects-client/LiveObjectsClient_Core.h"
+#include "iotsoftbox-core/loc_msg.h"
+#include "iotsoftbox-core/loc_cbor.h"
+
+#include "bench_util.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES()  __rdtsc()
+#else
+#define BENCH_CYCLES()  0
+#endif
+
+#define BENCH_CBOR_BUF_SZ     512
+
+static int32_t _bench_i32 = -123456;
+static int16_t _bench_i16[3] = { 12, -300, 32000 };
+static float _bench_f = 21.5f;
+static double _bench_d[2] = { 45.1234567891, -1.000001 };
+static uint8_t _bench_b = 1;
+static char _bench_str[] = "running";
+
+static const LiveObjectsD_Data_t _bench_data[] = {
+	{ LOD_TYPE_INT32, "cnt", &_bench_i32, 1, LOD_PREC_SHORTEST },
+	{ LOD_TYPE_INT16, "acc", _bench_i16, 3, LOD_PREC_SHORTEST },
+	{ LOD_TYPE_FLOAT, "temp", &_bench_f, 1, LOD_PREC_SHORTEST },
+	{ LOD_TYPE_DOUBLE, "pos", _bench_d, 2, LOD_PREC_SHORTEST },
+	{ LOD_TYPE_BOOL, "on", &_bench_b, 1, LOD_PREC_SHORTEST },
+	{ LOD_TYPE_STRING_C, "state", _bench_str, 1, LOD_PREC_SHORTEST },
+};
+
+static uint32_t _bench_period;
+static double _bench_ratio;
+static char _bench_name[16];
+
+static const LiveObjectsD_Param_t _bench_params[] = {
+	{ 1, { LOD_TYPE_UINT32, "period", &_bench_period, 1, LOD_PREC_SHORTEST } },
+	{ 2, { LOD_TYPE_DOUBLE, "ratio", &_bench_ratio, 1, LOD_PREC_SHORTEST } },
+	{ 3, { LOD_TYPE_STRING_C, "name", _bench_name, 1, LOD_PREC_SHORTEST } },
+};
+
+static const char _bench_req_json[] =
+		"{\"cfg\":{\"period\":{\"t\":\"u32\",\"v\":60000},\"ratio\":{\"t\":\"double\",\"v\":0.125},"
+		"\"name\":{\"t\":\"str\",\"v\":\"sensor-12\"}},\"cid\":12345}";
+
+static uint8_t _bench_req_cbor[BENCH_CBOR_BUF_SZ];
+static uint32_t _bench_req_cbor_len;
+
+/* --------------------------------------------------------------------------------- */
+/* Parameter callback: accept the value (copied by the client in the user variable) */
+static int bench_paramCb(const LiveObjectsD_Param_t* param_ptr, const void* value, int len) {
+	if (param_ptr->parm_data.data_type == LOD_TYPE_STRING_C) {
+		if (len >= (int) sizeof(_bench_name)) {
+			return -1;
+		}
+		memcpy(_bench_name, value, len);
+		_bench_name[len] = 0;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Same request as _bench_req_json, in CBOR */
+static int bench_reqCbor(void) {
+	LOCborWriter_t cw;
+	static const char* const names[3] = { "period", "ratio", "name" };
+	static const char* const types[3] = { "u32", "double", "str" };
+	int i;
+
+	LO_cbor_init(&cw, _bench_req_cbor, sizeof(_bench_req_cbor));
+	LO_cbor_put_map(&cw, 2);
+	LO_cbor_put_str(&cw, "cfg");
+	LO_cbor_put_map(&cw, 3);
+	for (i = 0; i < 3; i++) {
+		LO_cbor_put_str(&cw, names[i]);
+		LO_cbor_put_map(&cw, 2);
+		LO_cbor_put_str(&cw, "t");
+		LO_cbor_put_str(&cw, types[i]);
+		LO_cbor_put_str(&cw, "v");
+		if (i == 0) {
+			LO_cbor_put_uint(&cw, 60000);
+		}
+		else if (i == 1) {
+			LO_cbor_put_double(&cw, 0.125);
+		}
+		else {
+			LO_cbor_put_str(&cw, "sensor-12");
+		}
+	}
+	LO_cbor_put_str(&cw, "cid");
+	LO_cbor_put_int(&cw, 12345);
+	if (cw.err) {
+		return -1;
+	}
+	_bench_req_cbor_len = cw.buf_len;
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Encode n data messages. Return the payload length, or -1 */
+static int bench_encode(const LOMSetOfData_t* set, long n, double* ns, double* cycles) {
+	uint32_t len = 0;
+	uint64_t t0, c0;
+	long i;
+
+	if (LO_msg_encode_data(0, set, &len) == NULL) { /* warm-up */
+		return -1;
+	}
+	t0 = bench_nowNs();
+	c0 = BENCH_CYCLES();
+	for (i = 0; i < n; i++) {
+		if (LO_msg_encode_data(0, set, &len) == NULL) {
+			return -1;
+		}
+	}
+	*cycles = (double) (BENCH_CYCLES() - c0) / n;
+	*ns = (double) (bench_nowNs() - t0) / n;
+	return (int) len;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Decode n parameter update requests. Return 0 if all the parameters are updated */
+static int bench_decode(const LOMSetOfParams_t* set, const char* req, uint32_t len, long n, double* ns,
+		double* cycles) {
+	LOMSetofUpdatedParams_t upd;
+	uint64_t t0, c0;
+	long i;
+
+	t0 = bench_nowNs();
+	c0 = BENCH_CYCLES();
+	for (i = 0; i < n; i++) {
+		memset(&upd, 0, sizeof(upd));
+		if (LO_msg_decode_params_req(req, len, set, &upd)) {
+			return -1;
+		}
+	}
+	*cycles = (double) (BENCH_CYCLES() - c0) / n;
+	*ns = (double) (bench_nowNs() - t0) / n;
+	if ((upd.cid != 12345) || (upd.nb_of_params != 3) || (_bench_period != 60000) || (_bench_ratio != 0.125)
+			|| (strcmp(_bench_name, "sensor-12"))) {
+		return -1;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int main(int argc, char* argv[]) {
+	static LOMSetOfData_t set;
+	LOMSetOfParams_t params;
+	long n = bench_arg(argc, argv, 1, 200000);
+	uint8_t enc;
+
+	LiveObjectsClient_SetDbgLevel(LOTRACE_LEVEL_NONE);
+
+	if (n <= 0) {
+		n = 1;
+	}
+	memset(&set, 0, sizeof(set));
+	set.data_set.data_ptr = _bench_data;
+	set.data_set.data_nb = sizeof(_bench_data) / sizeof(_bench_data[0]);
+	strcpy(set.stream_id, "urn:lo:nsid:bench:cbor");
+	strcpy(set.model, "bench_v1");
+	strcpy(set.tags, "[\"bench\",\"cbor\"]");
+
+	memset(&params, 0, sizeof(params));
+	params.param_set.param_ptr = _bench_params;
+	params.param_set.param_nb = sizeof(_bench_params) / sizeof(_bench_params[0]);
+	params.param_callback = bench_paramCb;
+	if (bench_reqCbor()) {
+		printf("ERROR: CBOR request\n");
+		return 1;
+	}
+
+	printf("iterations=%ld\n", n);
+	printf("%-6s %-6s | %6s %10s %10s\n", "", "", "bytes", "ns/msg", "cycles/msg");
+	for (enc = LOD_ENCODING_JSON; enc <= LOD_ENCODING_CBOR; enc++) {
+		double ns, cycles;
+		int len;
+
+		/* As attached by the client: compiled plan, used by the JSON encoding only */
+		set.data_set.encoding = enc;
+		LO_msg_plan_compile(&set.data_set);
+		LO_msg_plan_envelope(&set);
+		len = bench_encode(&set, n, &ns, &cycles);
+		LO_msg_plan_release(&set.data_set);
+		if (len < 0) {
+			printf("ERROR: encoding failed\n");
+			return 1;
+		}
+		printf("%-6s %-6s | %6d %10.0f %10.0f\n", "encode", (enc == LOD_ENCODING_JSON) ? "json" : "cbor", len, ns,
+				cycles);
+	}
+	for (enc = LOD_ENCODING_JSON; enc <= LOD_ENCODING_CBOR; enc++) {
+		const char* req = (enc == LOD_ENCODING_JSON) ? _bench_req_json : (const char*) _bench_req_cbor;
+		uint32_t len = (enc == LOD_ENCODING_JSON) ? (uint32_t) strlen(_bench_req_json) : _bench_req_cbor_len;
+		double ns, cycles;
+
+		_bench_period = 0;
+		_bench_ratio = 0;
+		_bench_name[0] = 0;
+		if (bench_decode(&params, req, len, n, &ns, &cycles)) {
+			printf("ERROR: decoding failed\n");
+			return 1;
+		}
+		printf("%-6s %-6s | %6u %10.0f %10.0f\n", "decode", (enc == LOD_ENCODING_JSON) ? "json" : "cbor", len, ns,
+				cycles);
+	}
+	return 0;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_json.c
+ * @brief JSON encoding of one data array: strlen-based builder vs. LOJsonWriter_t
+ *
+ * Usage: bench_json [min_elements_per_run]
+ *
+ * For messages of 1, 64 and 1024 elements, prints the time to encode one
+ * message with the former builder (strlen() on the whole buffer before each
+ * append) and with the cursor-based writer of loc_json_api.c.
+ * data_dim is an int8_t, so a message holds arrays of at most 64 elements
+ * (1024 elements = 16 arrays of 64).
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "liveobjects-client/LiveObjectsClient_Core.h"
+#include "iotsoftbox-core/loc_json_api.h"
+
+#include "bench_util.h"
+
+#define BENCH_JSON_BUF_SZ     (32 * 1024)
+#define BENCH_JSON_DIM_MAX    1024
+#define BENCH_JSON_ARRAY_DIM  64
+#define BENCH_JSON_ITEM_MAX   (BENCH_JSON_DIM_MAX / BENCH_JSON_ARRAY_DIM)
+
+typedef struct {
+	LiveObjectsD_Data_t items[BENCH_JSON_ITEM_MAX];
+	int                 item_nb;
+	long                elt_nb;
+} BenchMsg_t;
+
+static char _bench_buf[BENCH_JSON_BUF_SZ];
+
+/* --------------------------------------------------------------------------------- */
+/* Former builder (before LOJsonWriter_t), limited to the types measured here       */
+
+static int legacy_json_begin(char *pbuf, uint32_t sz) {
+	return (snprintf(pbuf, sz, "{") == 1) ? 0 : -1;
+}
+
+static int legacy_json_end(char *pbuf, uint32_t sz) {
+	char* pcur = pbuf + strlen(pbuf);
+	if (*(pcur - 1) == ',') {
+		pcur--;
+	}
+	return (snprintf(pcur, sz, "}") == 1) ? 0 : -1;
+}
+
+static int legacy_json_add_item(const LiveObjectsD_Data_t* data_ptr, char *pbuf, uint32_t sz) {
+	int rc;
+	short i;
+	short dim;
+	char* data_value_ptr;
+	int len = sz - strlen(pbuf);
+	char* pcur = pbuf + strlen(pbuf);
+
+	rc = snprintf(pcur, len, "\"%s\":", data_ptr->data_name);
+	if (rc < 0) {
+		return -1;
+	}
+	len = sz - strlen(pbuf);
+	pcur = pbuf + strlen(pbuf);
+	if (len < 4) {
+		return -1;
+	}
+	dim = data_ptr->data_dim;
+	if (dim > 1) {
+		*pcur++ = '[';
+		len--;
+	}
+	data_value_ptr = (char*) data_ptr->data_value;
+	for (i = 0; i < dim; i++) {
+		switch (data_ptr->data_type) {
+		case LOD_TYPE_INT32:
+			rc = snprintf(pcur, len, "%" PRIi32 ",", *((int32_t*) data_value_ptr));
+			if (dim > 1) data_value_ptr += sizeof(int32_t);
+			break;
+		case LOD_TYPE_DOUBLE:
+			rc = snprintf(pcur, len, "%lf,", *((double*) data_value_ptr));
+			if (dim > 1) data_value_ptr += sizeof(double);
+			break;
+		default:
+			return -1;
+		}
+		if (dim > 1) {
+			len = sz - strlen(pbuf);
+			pcur = pbuf + strlen(pbuf);
+			if (len < 2) {
+				return -1;
+			}
+		}
+	}
+	if (dim > 1) {
+		pcur--;
+		if ((*pcur != ',') || (len < 2)) {
+			return -1;
+		}
+		*pcur++ = ']';
+		*pcur++ = ',';
+		*pcur = 0;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int bench_legacy(const BenchMsg_t* msg) {
+	int i;
+	_bench_buf[0] = 0;
+	if (legacy_json_begin(_bench_buf, sizeof(_bench_buf))) {
+		return -1;
+	}
+	for (i = 0; i < msg->item_nb; i++) {
+		if (legacy_json_add_item(&msg->items[i], _bench_buf, sizeof(_bench_buf))) {
+			return -1;
+		}
+	}
+	if (legacy_json_end(_bench_buf, sizeof(_bench_buf))) {
+		return -1;
+	}
+	return (int) strlen(_bench_buf);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int bench_writer(const BenchMsg_t* msg) {
+	LOJsonWriter_t jw;
+	int i;
+	LO_json_init(&jw, _bench_buf, sizeof(_bench_buf));
+	if (LO_json_begin(&jw)) {
+		return -1;
+	}
+	for (i = 0; i < msg->item_nb; i++) {
+		if (LO_json_add_item(&msg->items[i], &jw)) {
+			return -1;
+		}
+	}
+	if (LO_json_end(&jw)) {
+		return -1;
+	}
+	return (int) jw.buf_len;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Mean time (ns) to encode one message, over at least min_elements encoded elements */
+static double bench_run(int (*encode)(const BenchMsg_t*), const BenchMsg_t* msg, long min_elements,
+		int* msg_len) {
+	long n = min_elements / msg->elt_nb + 100;
+	long i;
+	uint64_t t0;
+
+	*msg_len = encode(msg); /* warm-up */
+	t0 = bench_nowNs();
+	for (i = 0; i < n; i++) {
+		if (encode(msg) < 0) {
+			*msg_len = -1;
+			break;
+		}
+	}
+	return (double) (bench_nowNs() - t0) / n;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int main(int argc, char* argv[]) {
+	static int32_t ivalues[BENCH_JSON_DIM_MAX];
+	static double dvalues[BENCH_JSON_DIM_MAX];
+	static const long dims[] = { 1, BENCH_JSON_ARRAY_DIM, BENCH_JSON_DIM_MAX };
+	static const char* names[BENCH_JSON_ITEM_MAX] = { "s0", "s1", "s2", "s3", "s4", "s5", "s6", "s7", "s8", "s9",
+			"s10", "s11", "s12", "s13", "s14", "s15" };
+	long min_elements = bench_arg(argc, argv, 1, 1000000);
+	unsigned int d;
+	int i, k;
+
+	LiveObjectsClient_SetDbgLevel(LOTRACE_LEVEL_NONE);
+
+	for (i = 0; i < BENCH_JSON_DIM_MAX; i++) {
+		ivalues[i] = (i * 7919) - 4000000;
+		dvalues[i] = (i * 0.37) + 1477389652.125;
+	}
+
+	printf("%-6s %5s | %12s %8s | %12s %8s | %7s\n", "type", "dim", "legacy ns", "bytes", "writer ns", "bytes",
+			"speedup");
+	for (d = 0; d < sizeof(dims) / sizeof(dims[0]); d++) {
+		for (i = 0; i < 2; i++) {
+			BenchMsg_t msg;
+			int legacy_len, writer_len;
+			double legacy_ns, writer_ns;
+
+			memset(&msg, 0, sizeof(msg));
+			msg.elt_nb = dims[d];
+			for (k = 0; (k * BENCH_JSON_ARRAY_DIM) < dims[d]; k++) {
+				LiveObjectsD_Data_t* item = &msg.items[k];
+				item->data_type = (i == 0) ? LOD_TYPE_INT32 : LOD_TYPE_DOUBLE;
+				item->data_name = names[k];
+				item->data_value = (i == 0) ? (void*) &ivalues[k * BENCH_JSON_ARRAY_DIM] :
+						(void*) &dvalues[k * BENCH_JSON_ARRAY_DIM];
+				item->data_dim = (int8_t) ((dims[d] < BENCH_JSON_ARRAY_DIM) ? dims[d] : BENCH_JSON_ARRAY_DIM);
+			}
+			msg.item_nb = k;
+
+			legacy_ns = bench_run(bench_legacy, &msg, min_elements, &legacy_len);
+			writer_ns = bench_run(bench_writer, &msg, min_elements, &writer_len);
+			printf("%-6s %5ld | %12.0f %8d | %12.0f %8d | %6.1fx\n", (i == 0) ? "int32" : "double", dims[d],
+					legacy_ns, legacy_len, writer_ns, writer_len, legacy_ns / writer_ns);
+			if ((legacy_len < 0) || (writer_len < 0)) {
+				printf("ERROR: encoding failed\n");
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_ktls.c
+ * @brief Throughput and CPU of the TLS record layer: mbedtls vs. kernel (LOC_NETW_KTLS)
+ *
+ * Usage: bench_ktls [megabytes] [payload size]
+ *
+ * QoS 0 PUBLISH packets are written through the network layer of the client to the local
+ * broker, as in bench_batch:
+ *  - tcp   : no TLS (reference),
+ *  - tls   : records encrypted by mbedtls (the "tls" ULP is refused, as by a kernel without kTLS),
+ *  - ktls  : records encrypted by the kernel, when it supports kTLS (TLS 1.2 AES-GCM).
+ * setsockopt() is wrapped (-Wl,--wrap) to refuse the ULP in the tls case. The CPU time is the
+ * one of the writing thread (user and system: the kernel encrypts in send()).
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include "config/liveobjects_dev_params.h"
+#include "liveobjects_iotsoftbox_api.h"
+#include "iotsoftbox-core/netw_wrapper.h"
+#include "MQTTPacket.h"
+
+#include "bench_util.h"
+
+#ifndef TCP_ULP
+#define TCP_ULP  31
+#endif
+
+#define BENCH_KTLS_PAYLOAD_MAX   (32 * 1024)
+
+static volatile uint8_t _bench_ulp_off;
+
+static BenchBroker_t _bench_broker;
+
+int __real_setsockopt(int sock, int level, int name, const void* val, socklen_t len);
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int __wrap_setsockopt(int sock, int level, int name, const void* val, socklen_t len) {
+	if ((_bench_ulp_off) && (level == IPPROTO_TCP) && (name == TCP_ULP)) {
+		errno = ENOENT;
+		return -1;
+	}
+	return __real_setsockopt(sock, level, name, val, len);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* CPU time of the calling thread, in nanoseconds */
+static uint64_t bench_threadCpuNs(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Write msg_nb PUBLISH packets of payload_sz bytes, and wait until the broker has received all of them */
+static int bench_run(const char* mode, uint32_t msg_nb, uint32_t payload_sz) {
+	static unsigned char pkt[BENCH_KTLS_PAYLOAD_MAX + 64];
+	static unsigned char payload[BENCH_KTLS_PAYLOAD_MAX];
+	LiveObjectsNetConnectParams_t cp = { LOC_SERV_IP_ADDRESS, LOC_SERV_PORT, 5000 };
+	LiveObjectsSecurityParams_t sp;
+	LiveObjectsD_TlsStats_t stats;
+	MQTTString topic = MQTTString_initializer;
+	uint8_t tls = (strcmp(mode, "tcp") != 0);
+	Network net;
+	uint64_t t0, t1, c0, c1;
+	uint32_t i;
+	int len;
+	int ret = 0;
+
+	_bench_ulp_off = (strcmp(mode, "tls") == 0);
+	_bench_broker.port = LOC_SERV_PORT;
+	_bench_broker.tls = tls;
+	if (bench_brokerStart(&_bench_broker)) {
+		return -1;
+	}
+	memset(&net, 0, sizeof(net));
+	memset(&sp, 0, sizeof(sp));
+	if ((netw_init(&net, NULL)) || ((tls) && (netw_setSecurity(&net, &sp))) || (netw_connect(&net, &cp))) {
+		fprintf(stderr, "ERROR: connection to the local broker\n");
+		bench_brokerStop(&_bench_broker);
+		return -1;
+	}
+	memset(&stats, 0, sizeof(stats));
+	netw_tls_getStats(&net, &stats);
+	if ((!strcmp(mode, "ktls")) && (stats.tls_ktls == 0)) {
+		printf("%-4s not available (kernel without the \"tls\" ULP, or LOC_NETW_KTLS=0)\n", mode);
+		netw_disconnect(&net, 0);
+		netw_tls_destroy(&net);
+		bench_brokerStop(&_bench_broker);
+		return 0;
+	}
+
+	topic.cstring = "dev/data";
+	memset(payload, 'x', payload_sz);
+	len = MQTTSerialize_publish(pkt, sizeof(pkt), 0, 0, 0, 0, topic, payload, (int) payload_sz);
+	t0 = bench_nowNs();
+	c0 = bench_threadCpuNs();
+	for (i = 0; (i < msg_nb) && (ret == 0); i++) {
+		if ((len <= 0) || (net.mqttwrite(&net, pkt, len, 5000) != len)) {
+			fprintf(stderr, "ERROR: write failed\n");
+			ret = -1;
+		}
+	}
+	c1 = bench_threadCpuNs();
+	while ((ret == 0) && (_bench_broker.cnt_publish < msg_nb)) {
+		if ((bench_nowNs() - t0) > 120000000000ULL) {
+			fprintf(stderr, "ERROR: %u/%u messages received\n", _bench_broker.cnt_publish, msg_nb);
+			ret = -1;
+		}
+		usleep(50);
+	}
+	t1 = bench_nowNs();
+	if (ret == 0) {
+		double mb = (double) msg_nb * len / 1e6;
+		printf("%-4s %9.1f MB/s  client CPU %7.2f ms/MB  (%.0f%% of the elapsed time)\n", mode,
+				mb * 1e9 / (double) (t1 - t0), (double) (c1 - c0) / 1e6 / mb,
+				100.0 * (double) (c1 - c0) / (double) (t1 - t0));
+	}
+
+	netw_disconnect(&net, 0);
+	netw_tls_destroy(&net);
+	bench_brokerStop(&_bench_broker);
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int main(int argc, char* argv[]) {
+	static const char* const modes[] = { "tcp", "tls", "ktls" };
+	long mbytes = bench_arg(argc, argv, 1, 256);
+	long payload_sz = bench_arg(argc, argv, 2, 8192);
+	uint32_t msg_nb;
+	unsigned int i;
+
+	LiveObjectsClient_SetDbgLevel(LOTRACE_LEVEL_NONE);
+
+	if ((payload_sz <= 0) || (payload_sz > BENCH_KTLS_PAYLOAD_MAX)) {
+		payload_sz = 8192;
+	}
+	if (mbytes <= 0) {
+		mbytes = 1;
+	}
+	msg_nb = (uint32_t) ((mbytes * 1000000L + payload_sz - 1) / payload_sz);
+	printf("size=%ld MB payload=%ld bytes messages=%u LOC_NETW_KTLS=%u\n", mbytes, payload_sz, msg_nb,
+			(unsigned) LOC_NETW_KTLS);
+	for (i = 0; i < sizeof(modes) / sizeof(modes[0]); i++) {
+		if (bench_run(modes[i], msg_nb, (uint32_t) payload_sz)) {
+			return 1;
+		}
+	}
+	return 0;
+}
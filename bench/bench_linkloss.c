@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_linkloss.c
+ * @brief Detection of a lost connection, and latency of the PUBACK (socket options of netw_sock.c)
+ *
+ * Usage: bench_linkloss <network namespace of the broker> [interface of the broker] [timeout in s]
+ *
+ * Started by linkloss.sh (root): the client runs in the network namespace of the process,
+ * the broker listens on LOC_SERV_IP_ADDRESS in the other namespace, the two namespaces being
+ * joined by a veth pair. Faults are injected on the interface of the broker:
+ *  - nodelay : QoS 1 PUBLISH just after a QoS 0 one, time to receive the PUBACK,
+ *  - close   : the broker closes the connection (FIN), time until the client is disconnected,
+ *  - dead    : the interface of the broker is set down (all the packets are dropped),
+ *              on an idle connection, time until the client is disconnected,
+ *  - deadpub : same, with a QoS 0 PUBLISH sent one second after the link is down.
+ */
+
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+
+#include "config/liveobjects_dev_params.h"
+#include "liveobjects_iotsoftbox_api.h"
+
+#include "bench_util.h"
+
+#define BENCH_LINKLOSS_NODELAY_NB   200
+
+static BenchBroker_t _bench_broker;
+
+static int _bench_ns_self = -1;
+static int _bench_ns_broker = -1;
+static int _bench_if_sock = -1;
+static const char* _bench_if_name;
+
+static volatile uint32_t _bench_acks;
+
+/* --------------------------------------------------------------------------------- */
+/* Start the broker: listening socket created in the network namespace of the broker */
+static int bench_brokerStartNs(void) {
+	int ret;
+	if (setns(_bench_ns_broker, CLONE_NEWNET)) {
+		perror("setns");
+		return -1;
+	}
+	ret = bench_brokerStart(&_bench_broker);
+	if (setns(_bench_ns_self, CLONE_NEWNET)) {
+		perror("setns");
+		return -1;
+	}
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Set the interface of the broker up or down */
+static int bench_linkSet(int up) {
+	struct ifreq ifr;
+	memset(&ifr, 0, sizeof(ifr));
+	strncpy(ifr.ifr_name, _bench_if_name, IFNAMSIZ - 1);
+	if (ioctl(_bench_if_sock, SIOCGIFFLAGS, &ifr)) {
+		perror("SIOCGIFFLAGS");
+		return -1;
+	}
+	if (up) {
+		ifr.ifr_flags |= IFF_UP;
+	}
+	else {
+		ifr.ifr_flags &= ~IFF_UP;
+	}
+	if (ioctl(_bench_if_sock, SIOCSIFFLAGS, &ifr)) {
+		perror("SIOCSIFFLAGS");
+		return -1;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Wait until the client is connected (state 1) or disconnected (state 0).
+ * Return the time in ns, or 0 after timeout_s */
+static uint64_t bench_waitState(int state, uint32_t timeout_s) {
+	uint64_t t0 = bench_nowNs();
+	while (bench_clientConnected() != state) {
+		if ((bench_nowNs() - t0) > (uint64_t) timeout_s * 1000000000ULL) {
+			return 0;
+		}
+		usleep(1000);
+	}
+	return bench_nowNs() - t0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void bench_pubAck(void* ctx, int result) {
+	(void) ctx;
+	if (result == 0) {
+		__atomic_add_fetch(&_bench_acks, 1, __ATOMIC_RELAXED);
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* QoS 1 PUBLISH after a QoS 0 one: with the Nagle algorithm, the second one waits for the
+ * (delayed) ACK of the first one */
+static int bench_nodelay(void) {
+	uint64_t sum = 0, max = 0;
+	uint32_t i;
+
+	for (i = 0; i < BENCH_LINKLOSS_NODELAY_NB; i++) {
+		uint32_t acks = _bench_acks;
+		uint64_t t0, dt;
+		if (LiveObjectsClient_Publish("dev/data", "{\"v\":0}")) {
+			return -1;
+		}
+		usleep(300);
+		t0 = bench_nowNs();
+		if (LiveObjectsClient_PublishQos1("dev/data", "{\"v\":1}", bench_pubAck, NULL)) {
+			return -1;
+		}
+		while (_bench_acks == acks) {
+			if ((bench_nowNs() - t0) > 2000000000ULL) {
+				fprintf(stderr, "ERROR: no PUBACK\n");
+				return -1;
+			}
+			usleep(20);
+		}
+		dt = bench_nowNs() - t0;
+		sum += dt;
+		if (dt > max) {
+			max = dt;
+		}
+		usleep(5000);
+	}
+	printf("%-8s PUBACK after %u QoS 0/QoS 1 pairs: avg %.3f ms  max %.3f ms\n", "nodelay",
+			BENCH_LINKLOSS_NODELAY_NB, (double) sum / i / 1e6, (double) max / 1e6);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Inject the fault, wait until the client is disconnected, then restore the link and the broker */
+static int bench_fault(const char* name, uint32_t timeout_s) {
+	uint64_t t0, dt;
+	int ret = 0;
+
+	sleep(1);
+	if (!strcmp(name, "close")) {
+		bench_brokerStop(&_bench_broker);
+	}
+	else if (bench_linkSet(0)) {
+		return -1;
+	}
+	t0 = bench_nowNs();
+	if (!strcmp(name, "deadpub")) {
+		sleep(1);
+		LiveObjectsClient_Publish("dev/data", "{\"v\":1}");
+	}
+	while ((bench_clientConnected()) && ((bench_nowNs() - t0) < (uint64_t) timeout_s * 1000000000ULL)) {
+		usleep(1000);
+	}
+	dt = bench_nowNs() - t0;
+	if (bench_clientConnected()) {
+		printf("%-8s not detected in %u s\n", name, timeout_s);
+	}
+	else {
+		printf("%-8s connection lost detected after %.2f s\n", name, (double) dt / 1e9);
+	}
+
+	/* Back to a connected client, with a new broker (the connection of the lost one is stale) */
+	if (strcmp(name, "close")) {
+		bench_linkSet(1);
+		bench_brokerStop(&_bench_broker);
+	}
+	if ((bench_brokerStartNs()) || (bench_waitState(1, 60) == 0)) {
+		fprintf(stderr, "ERROR: client not connected again\n");
+		ret = -1;
+	}
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int main(int argc, char* argv[]) {
+	static const char* const faults[] = { "close", "dead", "deadpub" };
+	char path[128];
+	uint32_t timeout_s = (uint32_t) bench_arg(argc, argv, 3, 90);
+	unsigned int i;
+
+	LiveObjectsClient_SetDbgLevel(LOTRACE_LEVEL_NONE);
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <network namespace of the broker> [interface] [timeout s]"
+				" (see linkloss.sh)\n", argv[0]);
+		return 1;
+	}
+	_bench_if_name = (argc > 2) ? argv[2] : "lob1";
+	snprintf(path, sizeof(path), "/run/netns/%s", argv[1]);
+	_bench_ns_self = open("/proc/self/ns/net", O_RDONLY);
+	_bench_ns_broker = open(path, O_RDONLY);
+	if ((_bench_ns_self < 0) || (_bench_ns_broker < 0)) {
+		perror(path);
+		return 1;
+	}
+	/* Socket to set the interface of the broker up/down, in its namespace */
+	if (setns(_bench_ns_broker, CLONE_NEWNET) == 0) {
+		_bench_if_sock = socket(AF_INET, SOCK_DGRAM, 0);
+		if (setns(_bench_ns_self, CLONE_NEWNET)) {
+			perror("setns");
+			return 1;
+		}
+	}
+	if ((_bench_if_sock < 0) || (bench_linkSet(1))) {
+		fprintf(stderr, "ERROR: interface %s in %s\n", _bench_if_name, argv[1]);
+		return 1;
+	}
+
+	printf("broker=%s:%u TCP_NODELAY=%u KEEPIDLE=%us KEEPINTVL=%us KEEPCNT=%u USER_TIMEOUT=%ums\n",
+			LOC_SERV_IP_ADDRESS, (unsigned) LOC_SERV_PORT, (unsigned) LOC_NETW_TCP_NODELAY,
+			(unsigned) LOC_NETW_TCP_KEEPIDLE_S, (unsigned) LOC_NETW_TCP_KEEPINTVL_S, (unsigned) LOC_NETW_TCP_KEEPCNT,
+			(unsigned) LOC_NETW_TCP_USER_TIMEOUT_MS);
+
+	_bench_broker.port = LOC_SERV_PORT;
+	_bench_broker.ip = LOC_SERV_IP_ADDRESS;
+	if (bench_brokerStartNs()) {
+		return 1;
+	}
+	if ((LiveObjectsClient_Init(NULL, 1, 2)) || (LiveObjectsClient_SetDevId("bench"))
+			|| (bench_clientStart(5000)) || (bench_nodelay())) {
+		bench_brokerStop(&_bench_broker);
+		return 1;
+	}
+	for (i = 0; i < sizeof(faults) / sizeof(faults[0]); i++) {
+		if (bench_fault(faults[i], timeout_s)) {
+			break;
+		}
+	}
+	LiveObjectsClient_Stop();
+	bench_brokerStop(&_bench_broker);
+	return (i == sizeof(faults) / sizeof(faults[0])) ? 0 : 1;
+}
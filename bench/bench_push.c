@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_push.c
+ * @brief Throughput of 1, 2 and 4 producer threads, each one pushing its own data stream
+ *
+ * Usage: bench_push [messages_per_thread]
+ *
+ * encode: LO_msg_encode_data() of each thread into message blocks of the pool (no network),
+ *         BENCH_PUSH_ENCODE_X times more messages.
+ * push:   LiveObjectsClient_PushData() to the client thread, connected to a local broker.
+ *         The rate is measured until the broker has received all the messages.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "config/liveobjects_dev_params.h"
+#include "liveobjects_iotsoftbox_api.h"
+#include "iotsoftbox-core/loc_msg.h"
+#include "iotsoftbox-core/loc_mpool.h"
+
+#include "bench_util.h"
+
+#define BENCH_PUSH_THREAD_MAX  4
+#define BENCH_PUSH_ENCODE_X    20
+
+/* Data message encoded by a user thread (MTYPE_PUB_DATA of loc_core.c) */
+#define BENCH_PUSH_FROM_USER   0x22
+
+typedef struct {
+	pthread_t            thread;
+	int                  handle;      /* Data handle (push) */
+	long                 msg_nb;
+	long                 msg_ok;
+	int32_t              counter;
+	double               temperature;
+	float                humidity;
+	LiveObjectsD_Data_t  data[3];
+	LOMSetOfData_t       set;         /* encode */
+} BenchProducer_t;
+
+static BenchProducer_t _bench_producers[BENCH_PUSH_THREAD_MAX];
+static BenchBroker_t   _bench_broker;
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void bench_producerInit(BenchProducer_t* p, int idx) {
+	LiveObjectsD_Data_t data[3] = {
+		{ LOD_TYPE_INT32, "counter", &p->counter, 1, LOD_PREC_SHORTEST },
+		{ LOD_TYPE_DOUBLE, "temperature", &p->temperature, 1, LOD_PREC_SHORTEST },
+		{ LOD_TYPE_FLOAT, "humidity", &p->humidity, 1, LOD_PREC_SHORTEST },
+	};
+	memset(p, 0, sizeof(BenchProducer_t));
+	memcpy(p->data, data, sizeof(data));
+	p->temperature = 21.5 + idx;
+	p->humidity = 48.25f;
+	p->set.data_set.data_ptr = p->data;
+	p->set.data_set.data_nb = 3;
+	snprintf(p->set.stream_id, sizeof(p->set.stream_id), "urn:lo:nsid:bench:%d", idx);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void* bench_encodeThread(void* arg) {
+	BenchProducer_t* p = (BenchProducer_t*) arg;
+	long i;
+	for (i = 0; i < p->msg_nb; i++) {
+		uint32_t len;
+		const char* msg;
+		p->counter = (int32_t) i;
+		msg = LO_msg_encode_data(BENCH_PUSH_FROM_USER, &p->set, &len);
+		if (msg) {
+			p->msg_ok++;
+			LO_mpool_free(msg);
+		}
+	}
+	return NULL;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void* bench_pushThread(void* arg) {
+	BenchProducer_t* p = (BenchProducer_t*) arg;
+	long i;
+	for (i = 0; i < p->msg_nb; i++) {
+		p->counter = (int32_t) i;
+		if (LiveObjectsClient_PushData(p->handle) == 0) {
+			p->msg_ok++;
+		}
+	}
+	return NULL;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Run nb producers, return the total number of messages accepted */
+static long bench_runProducers(void* (*func)(void*), int nb) {
+	long total = 0;
+	int i;
+	for (i = 0; i < nb; i++) {
+		_bench_producers[i].msg_ok = 0;
+		pthread_create(&_bench_producers[i].thread, NULL, func, &_bench_producers[i]);
+	}
+	for (i = 0; i < nb; i++) {
+		pthread_join(_bench_producers[i].thread, NULL);
+		total += _bench_producers[i].msg_ok;
+	}
+	return total;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int main(int argc, char* argv[]) {
+	long msg_nb = bench_arg(argc, argv, 1, 20000);
+	int nb;
+	int i;
+
+	LiveObjectsClient_SetDbgLevel(LOTRACE_LEVEL_NONE);
+
+	_bench_broker.port = LOC_SERV_PORT;
+	if (bench_brokerStart(&_bench_broker)) {
+		return 1;
+	}
+	if ((LiveObjectsClient_Init(NULL, 1, 2)) || (LiveObjectsClient_SetDevId("bench"))
+			|| (LiveObjectsClient_SetQueueParams(4096, LOD_MQ_BLOCK, 10000))) {
+		fprintf(stderr, "ERROR: client init\n");
+		return 1;
+	}
+	for (i = 0; i < BENCH_PUSH_THREAD_MAX; i++) {
+		BenchProducer_t* p = &_bench_producers[i];
+		bench_producerInit(p, i);
+		p->handle = LiveObjectsClient_AttachData(0, p->set.stream_id, NULL, NULL, NULL,
+				p->data, 3);
+		if (p->handle < 0) {
+			fprintf(stderr, "ERROR: attach data %d\n", i);
+			return 1;
+		}
+	}
+	if (bench_clientStart(5000)) {
+		return 1;
+	}
+
+	printf("%-7s %7s | %10s %12s\n", "mode", "threads", "messages", "msg/s");
+	for (nb = 1; nb <= BENCH_PUSH_THREAD_MAX; nb *= 2) {
+		uint64_t t0;
+		long ok;
+		for (i = 0; i < nb; i++) {
+			_bench_producers[i].msg_nb = msg_nb * BENCH_PUSH_ENCODE_X;
+		}
+		t0 = bench_nowNs();
+		ok = bench_runProducers(bench_encodeThread, nb);
+		double s = (double) (bench_nowNs() - t0) / 1e9;
+		printf("%-7s %7d | %10ld %12.0f\n", "encode", nb, ok, ok / s);
+	}
+	for (nb = 1; nb <= BENCH_PUSH_THREAD_MAX; nb *= 2) {
+		uint32_t expected = _bench_broker.cnt_publish;
+		uint64_t t0;
+		long ok;
+		double s;
+		for (i = 0; i < nb; i++) {
+			_bench_producers[i].msg_nb = msg_nb;
+		}
+		t0 = bench_nowNs();
+		ok = bench_runProducers(bench_pushThread, nb);
+		expected += (uint32_t) ok;
+		while (((int32_t) (_bench_broker.cnt_publish - expected)) < 0) {
+			if ((bench_nowNs() - t0) > 60000000000ULL) {
+				fprintf(stderr, "ERROR: %u messages not received by the broker\n",
+						expected - _bench_broker.cnt_publish);
+				return 1;
+			}
+			usleep(100);
+		}
+		s = (double) (bench_nowNs() - t0) / 1e9;
+		printf("%-7s %7d | %10ld %12.0f\n", "push", nb, ok, ok / s);
+	}
+
+	LiveObjectsClient_Stop();
+	bench_brokerStop(&_bench_broker);
+	return 0;
+}
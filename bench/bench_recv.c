@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_recv.c
+ * @brief System calls of the client per inbound command
+ *
+ * Usage: bench_recv [commands]
+ *
+ * The local broker publishes the commands on "dev/cmd" (one TCP send per command)
+ * as soon as the client subscribes. recv() and poll() are wrapped (-Wl,--wrap) to
+ * count the calls done by the client, from the SUBSCRIBE of "dev/cmd" until all the commands
+ * are processed (SUBACK included).
+ */
+
+#include <poll.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/socket.h>
+
+#include "config/liveobjects_dev_params.h"
+#include "liveobjects_iotsoftbox_api.h"
+
+#include "bench_util.h"
+
+static volatile uint32_t _bench_cnt_recv;
+static volatile uint32_t _bench_cnt_poll;
+static volatile uint32_t _bench_cnt_cmd;
+
+/* Counters when the broker starts to publish the commands */
+static volatile uint32_t _bench_recv0;
+static volatile uint32_t _bench_poll0;
+static volatile uint64_t _bench_t0;
+
+static BenchBroker_t _bench_broker;
+
+ssize_t __real_recv(int sock, void* buf, size_t len, int flags);
+int __real_poll(struct pollfd* fds, nfds_t nfds, int timeout);
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+ssize_t __wrap_recv(int sock, void* buf, size_t len, int flags) {
+	if (!bench_brokerSelf()) {
+		__atomic_add_fetch(&_bench_cnt_recv, 1, __ATOMIC_RELAXED);
+	}
+	return __real_recv(sock, buf, len, flags);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int __wrap_poll(struct pollfd* fds, nfds_t nfds, int timeout) {
+	if (!bench_brokerSelf()) {
+		__atomic_add_fetch(&_bench_cnt_poll, 1, __ATOMIC_RELAXED);
+	}
+	return __real_poll(fds, nfds, timeout);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Broker thread, before the SUBACK of "dev/cmd" and the commands */
+static void bench_onCommands(void) {
+	_bench_recv0 = _bench_cnt_recv;
+	_bench_poll0 = _bench_cnt_poll;
+	_bench_t0 = bench_nowNs();
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int bench_command(LiveObjectsD_CommandRequestBlock_t* pCmdReqBlk) {
+	(void) pCmdReqBlk;
+	__atomic_add_fetch(&_bench_cnt_cmd, 1, __ATOMIC_RELAXED);
+	return 0;
+}
+
+static const LiveObjectsD_Command_t _bench_cmds[] = {
+	{ 1, "bench", 0 }
+};
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int main(int argc, char* argv[]) {
+	uint32_t cmd_nb = (uint32_t) bench_arg(argc, argv, 1, 1000);
+	uint32_t n_recv, n_poll;
+	uint64_t t0;
+
+	LiveObjectsClient_SetDbgLevel(LOTRACE_LEVEL_NONE);
+
+	_bench_broker.port = LOC_SERV_PORT;
+	_bench_broker.cmd_nb = cmd_nb;
+	_bench_broker.on_cmd = bench_onCommands;
+	if (bench_brokerStart(&_bench_broker)) {
+		return 1;
+	}
+	if ((LiveObjectsClient_Init(NULL, 1, 2)) || (LiveObjectsClient_SetDevId("bench"))
+			|| (LiveObjectsClient_AttachCommands(_bench_cmds, 1, bench_command) < 0)
+			|| (LiveObjectsClient_ControlCommands(1))) {
+		fprintf(stderr, "ERROR: client init\n");
+		return 1;
+	}
+	t0 = bench_nowNs();
+	if (bench_clientStart(5000)) {
+		return 1;
+	}
+	while (_bench_cnt_cmd < cmd_nb) {
+		if ((bench_nowNs() - t0) > 60000000000ULL) {
+			fprintf(stderr, "ERROR: %u/%u commands received\n", _bench_cnt_cmd, cmd_nb);
+			return 1;
+		}
+		usleep(100);
+	}
+	n_recv = _bench_cnt_recv - _bench_recv0;
+	n_poll = _bench_cnt_poll - _bench_poll0;
+	printf("commands=%u in %.1f ms: recv=%u poll=%u -> recv/cmd=%.3f poll/cmd=%.3f\n", cmd_nb,
+			(double) (bench_nowNs() - _bench_t0) / 1e6, n_recv, n_poll,
+			(double) n_recv / cmd_nb, (double) n_poll / cmd_nb);
+
+	LiveObjectsClient_Stop();
+	bench_brokerStop(&_bench_broker);
+	return 0;
+}
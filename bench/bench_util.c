@@ -0,0 +1,556 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_util.c
+ * @brief Helpers shared by the benchmarks
+ */
+
+#include "bench_util.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include "liveobjects-client/LiveObjectsClient_Core.h"
+
+#include "mbedtls/certs.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/net.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/x509_crt.h"
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static uint64_t bench_clockNs(clockid_t id) {
+	struct timespec ts;
+	clock_gettime(id, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+uint64_t bench_nowNs(void) {
+	return bench_clockNs(CLOCK_MONOTONIC);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+uint64_t bench_cpuNs(void) {
+	return bench_clockNs(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+long bench_arg(int argc, char* argv[], int idx, long def) {
+	if ((idx < argc) && argv[idx] && argv[idx][0]) {
+		return strtol(argv[idx], NULL, 0);
+	}
+	return def;
+}
+
+/* ================================================================================= */
+/* Local MQTT broker                                                                 */
+
+/* Set in the threads of the broker */
+static __thread int _bench_broker_self = 0;
+
+#define BENCH_CONN_BUF_SZ      (16 * 1024)
+
+/* TLS configuration of the broker (server side) */
+typedef struct {
+	mbedtls_ssl_config       conf;
+	mbedtls_x509_crt         crt;
+	mbedtls_pk_context       pkey;
+	mbedtls_entropy_context  entropy;
+	mbedtls_ctr_drbg_context ctr_drbg;
+	pthread_mutex_t          rng_mutex;   /* The generator is shared by the connection threads */
+} BenchTls_t;
+
+typedef struct {
+	BenchBroker_t*      broker;
+	int                 sock;
+	uint8_t             tls;
+	mbedtls_ssl_context ssl;
+	uint32_t            roff;                    /* Read position in rbuf */
+	uint32_t            rlen;                    /* Number of bytes in rbuf */
+	uint8_t             rbuf[BENCH_CONN_BUF_SZ]; /* Bytes received, not processed yet */
+} BenchConn_t;
+
+#define BENCH_MQTT_CONNECT     1
+#define BENCH_MQTT_PUBLISH     3
+#define BENCH_MQTT_SUBSCRIBE   8
+#define BENCH_MQTT_PINGREQ     12
+#define BENCH_MQTT_DISCONNECT  14
+
+#define BENCH_RX_BUF_SZ        (64 * 1024)
+
+/* --------------------------------------------------------------------------------- */
+/* Wait (100 ms at most) and receive bytes from the socket.
+ * Return the number of bytes, 0 if none, -1 on error or when the broker stops */
+static int bench_connRecv(BenchConn_t* c, uint8_t* buf, size_t len) {
+	struct pollfd pfd;
+	ssize_t rc;
+
+	pfd.fd = c->sock;
+	pfd.events = POLLIN;
+	rc = poll(&pfd, 1, 100);
+	if (c->broker->stop) {
+		return -1;
+	}
+	if (rc <= 0) {
+		return ((rc < 0) && (errno != EINTR)) ? -1 : 0;
+	}
+	rc = recv(c->sock, buf, len, 0);
+	if (rc <= 0) {
+		return -1;
+	}
+	__atomic_add_fetch(&c->broker->wire_bytes, (uint64_t) rc, __ATOMIC_RELAXED);
+	return (int) rc;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* mbedtls receive callback */
+static int bench_connBioRecv(void* ctx, unsigned char* buf, size_t len) {
+	int rc = bench_connRecv((BenchConn_t*) ctx, buf, len);
+	if (rc < 0) {
+		return MBEDTLS_ERR_NET_RECV_FAILED;
+	}
+	return (rc) ? rc : MBEDTLS_ERR_SSL_WANT_READ;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* mbedtls send callback */
+static int bench_connBioSend(void* ctx, const unsigned char* buf, size_t len) {
+	ssize_t rc = send(((BenchConn_t*) ctx)->sock, buf, len, MSG_NOSIGNAL);
+	return (rc < 0) ? MBEDTLS_ERR_NET_SEND_FAILED : (int) rc;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Read exactly len bytes. Return 0 if successful, -1 on error or when the broker stops */
+static int bench_connRead(BenchConn_t* c, uint8_t* buf, uint32_t len) {
+	while (len) {
+		int rc;
+		if (c->roff < c->rlen) {
+			uint32_t n = c->rlen - c->roff;
+			if (n > len) {
+				n = len;
+			}
+			memcpy(buf, c->rbuf + c->roff, n);
+			c->roff += n;
+			buf += n;
+			len -= n;
+			continue;
+		}
+		if (c->tls) {
+			rc = mbedtls_ssl_read(&c->ssl, c->rbuf, sizeof(c->rbuf));
+			if (rc == MBEDTLS_ERR_SSL_WANT_READ) {
+				continue;
+			}
+		}
+		else {
+			rc = bench_connRecv(c, c->rbuf, sizeof(c->rbuf));
+			if (rc == 0) {
+				continue;
+			}
+		}
+		if (rc <= 0) {
+			return -1;
+		}
+		c->roff = 0;
+		c->rlen = (uint32_t) rc;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int bench_connWrite(BenchConn_t* c, const uint8_t* buf, uint32_t len) {
+	while (len) {
+		int rc;
+		if (c->tls) {
+			rc = mbedtls_ssl_write(&c->ssl, buf, len);
+		}
+		else {
+			rc = (int) send(c->sock, buf, len, MSG_NOSIGNAL);
+		}
+		if (rc <= 0) {
+			return -1;
+		}
+		buf += rc;
+		len -= (uint32_t) rc;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Read one MQTT packet: fixed header in *p_hdr, variable header and payload in buf */
+static int bench_connReadPacket(BenchConn_t* c, uint8_t* p_hdr, uint8_t* buf, uint32_t* p_len) {
+	uint32_t len = 0;
+	uint32_t mult = 1;
+	uint8_t b;
+	int n = 0;
+
+	if (bench_connRead(c, p_hdr, 1)) {
+		return -1;
+	}
+	do {
+		if ((++n > 4) || (bench_connRead(c, &b, 1))) {
+			return -1;
+		}
+		len += (b & 0x7F) * mult;
+		mult *= 128;
+	} while (b & 0x80);
+	if ((len > BENCH_RX_BUF_SZ) || (bench_connRead(c, buf, len))) {
+		return -1;
+	}
+	__atomic_add_fetch(&c->broker->rx_bytes, (uint64_t) (1 + n + len), __ATOMIC_RELAXED);
+	*p_len = len;
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Publish the commands {"req":"bench","arg":{},"cid":<n>} on "dev/cmd", one TCP send per command */
+static int bench_connCommands(BenchConn_t* c) {
+	static const char topic[] = "dev/cmd";
+	uint8_t pkt[128];
+	uint32_t i;
+
+	for (i = 0; i < c->broker->cmd_nb; i++) {
+		int len = snprintf((char*) pkt + 4 + sizeof(topic) - 1, sizeof(pkt) - 4 - sizeof(topic) + 1,
+				"{\"req\":\"bench\",\"arg\":{},\"cid\":%u}", i + 1);
+		len += 2 + sizeof(topic) - 1;
+		pkt[0] = 0x30;
+		pkt[1] = (uint8_t) len;
+		pkt[2] = 0;
+		pkt[3] = sizeof(topic) - 1;
+		memcpy(pkt + 4, topic, sizeof(topic) - 1);
+		if (bench_connWrite(c, pkt, (uint32_t) (2 + len))) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int bench_connProcess(BenchConn_t* c, uint8_t hdr, const uint8_t* buf, uint32_t len) {
+	uint8_t rsp[8];
+	int is_cmd;
+
+	switch (hdr >> 4) {
+	case BENCH_MQTT_CONNECT:
+		__atomic_add_fetch(&c->broker->cnt_connect, 1, __ATOMIC_RELAXED);
+		rsp[0] = 0x20;
+		rsp[1] = 2;
+		rsp[2] = 0;
+		rsp[3] = 0;
+		return bench_connWrite(c, rsp, 4);
+
+	case BENCH_MQTT_SUBSCRIBE:
+		/* One topic per SUBSCRIBE (LiveObjects client), granted with QoS 1 */
+		is_cmd = ((len >= 11) && (buf[3] == 7) && (memcmp(buf + 4, "dev/cmd", 7) == 0));
+		if ((is_cmd) && (c->broker->on_cmd)) {
+			c->broker->on_cmd();
+		}
+		rsp[0] = 0x90;
+		rsp[1] = 3;
+		rsp[2] = buf[0];
+		rsp[3] = buf[1];
+		rsp[4] = 1;
+		if (bench_connWrite(c, rsp, 5)) {
+			return -1;
+		}
+		if (is_cmd) {
+			return bench_connCommands(c);
+		}
+		return 0;
+
+	case BENCH_MQTT_PINGREQ:
+		rsp[0] = 0xD0;
+		rsp[1] = 0;
+		return bench_connWrite(c, rsp, 2);
+
+	case BENCH_MQTT_PUBLISH:
+		__atomic_add_fetch(&c->broker->cnt_publish, 1, __ATOMIC_RELAXED);
+		if (hdr & 0x06) {
+			uint32_t topic_len = ((uint32_t) buf[0] << 8) | buf[1];
+			if (len < topic_len + 4) {
+				return -1;
+			}
+			rsp[0] = 0x40;
+			rsp[1] = 2;
+			rsp[2] = buf[2 + topic_len];
+			rsp[3] = buf[3 + topic_len];
+			return bench_connWrite(c, rsp, 4);
+		}
+		return 0;
+
+	case BENCH_MQTT_DISCONNECT:
+		return -1;
+
+	default:
+		/* PUBACK from the client, ... */
+		return 0;
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void* bench_connThread(void* arg) {
+	BenchConn_t* c = (BenchConn_t*) arg;
+	uint8_t* buf = (uint8_t*) malloc(BENCH_RX_BUF_SZ);
+	uint8_t hdr;
+	uint32_t len;
+
+	_bench_broker_self = 1;
+	if ((buf) && (c->tls)) {
+		int ret;
+		mbedtls_ssl_init(&c->ssl);
+		ret = mbedtls_ssl_setup(&c->ssl, &((BenchTls_t*) c->broker->tls_conf)->conf);
+		if (ret == 0) {
+			mbedtls_ssl_set_bio(&c->ssl, c, bench_connBioSend, bench_connBioRecv, NULL);
+			while (((ret = mbedtls_ssl_handshake(&c->ssl)) == MBEDTLS_ERR_SSL_WANT_READ) && (!c->broker->stop)) {
+			}
+		}
+		if (ret) {
+			fprintf(stderr, "ERROR: TLS handshake of the broker -0x%x\n", -ret);
+			free(buf);
+			buf = NULL;
+		}
+	}
+	while ((buf) && (bench_connReadPacket(c, &hdr, buf, &len) == 0)) {
+		if (bench_connProcess(c, hdr, buf, len)) {
+			break;
+		}
+	}
+	free(buf);
+	if (c->tls) {
+		mbedtls_ssl_free(&c->ssl);
+	}
+	close(c->sock);
+	free(c);
+	return NULL;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void* bench_brokerThread(void* arg) {
+	BenchBroker_t* b = (BenchBroker_t*) arg;
+
+	_bench_broker_self = 1;
+	while (!b->stop) {
+		struct pollfd pfd;
+		BenchConn_t* c;
+		pthread_t th;
+		int sock;
+
+		pfd.fd = b->lsock;
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, 100) <= 0) {
+			continue;
+		}
+		sock = accept(b->lsock, NULL, NULL);
+		if (sock < 0) {
+			continue;
+		}
+		c = (BenchConn_t*) malloc(sizeof(BenchConn_t));
+		if (c == NULL) {
+			close(sock);
+			continue;
+		}
+		c->broker = b;
+		c->sock = sock;
+		c->tls = b->tls;
+		c->roff = 0;
+		c->rlen = 0;
+		if (pthread_create(&th, NULL, bench_connThread, c)) {
+			close(sock);
+			free(c);
+			continue;
+		}
+		pthread_detach(th);
+	}
+	return NULL;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Random generator of the TLS connections */
+static int bench_tlsRandom(void* ctx, unsigned char* buf, size_t len) {
+	BenchTls_t* t = (BenchTls_t*) ctx;
+	int ret;
+	pthread_mutex_lock(&t->rng_mutex);
+	ret = mbedtls_ctr_drbg_random(&t->ctr_drbg, buf, len);
+	pthread_mutex_unlock(&t->rng_mutex);
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void bench_tlsFree(BenchTls_t* t) {
+	mbedtls_ssl_config_free(&t->conf);
+	mbedtls_x509_crt_free(&t->crt);
+	mbedtls_pk_free(&t->pkey);
+	mbedtls_ctr_drbg_free(&t->ctr_drbg);
+	mbedtls_entropy_free(&t->entropy);
+	pthread_mutex_destroy(&t->rng_mutex);
+	free(t);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Server configuration, with the test certificate of mbedtls (RSA) */
+static BenchTls_t* bench_tlsCreate(void) {
+	BenchTls_t* t = (BenchTls_t*) malloc(sizeof(BenchTls_t));
+	int ret;
+
+	if (t == NULL) {
+		return NULL;
+	}
+	mbedtls_ssl_config_init(&t->conf);
+	mbedtls_x509_crt_init(&t->crt);
+	mbedtls_pk_init(&t->pkey);
+	mbedtls_entropy_init(&t->entropy);
+	mbedtls_ctr_drbg_init(&t->ctr_drbg);
+	pthread_mutex_init(&t->rng_mutex, NULL);
+
+	if (((ret = mbedtls_ctr_drbg_seed(&t->ctr_drbg, mbedtls_entropy_func, &t->entropy,
+			(const unsigned char*) "bench", 5)) != 0)
+			|| ((ret = mbedtls_x509_crt_parse(&t->crt, (const unsigned char*) mbedtls_test_srv_crt,
+					mbedtls_test_srv_crt_len)) != 0)
+			|| ((ret = mbedtls_pk_parse_key(&t->pkey, (const unsigned char*) mbedtls_test_srv_key,
+					mbedtls_test_srv_key_len, NULL, 0)) != 0)
+			|| ((ret = mbedtls_ssl_config_defaults(&t->conf, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_STREAM,
+					MBEDTLS_SSL_PRESET_DEFAULT)) != 0)
+			|| ((ret = mbedtls_ssl_conf_own_cert(&t->conf, &t->crt, &t->pkey)) != 0)) {
+		fprintf(stderr, "ERROR: TLS configuration of the broker -0x%x\n", -ret);
+		bench_tlsFree(t);
+		return NULL;
+	}
+	mbedtls_ssl_conf_rng(&t->conf, bench_tlsRandom, t);
+	return t;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int bench_brokerSelf(void) {
+	return _bench_broker_self;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void bench_brokerFree(BenchBroker_t* b) {
+	if (b->tls_conf) {
+		bench_tlsFree((BenchTls_t*) b->tls_conf);
+		b->tls_conf = NULL;
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int bench_brokerStart(BenchBroker_t* b) {
+	struct sockaddr_in addr;
+	pthread_t th;
+	int on = 1;
+
+	b->stop = 0;
+	b->cnt_connect = 0;
+	b->cnt_publish = 0;
+	b->rx_bytes = 0;
+	b->wire_bytes = 0;
+	b->tls_conf = NULL;
+	if ((b->tls) && ((b->tls_conf = bench_tlsCreate()) == NULL)) {
+		return -1;
+	}
+	b->lsock = socket(AF_INET, SOCK_STREAM, 0);
+	if (b->lsock < 0) {
+		perror("socket");
+		bench_brokerFree(b);
+		return -1;
+	}
+	setsockopt(b->lsock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(b->port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if ((b->ip) && (inet_pton(AF_INET, b->ip, &addr.sin_addr) != 1)) {
+		fprintf(stderr, "ERROR: bad address %s\n", b->ip);
+		close(b->lsock);
+		bench_brokerFree(b);
+		return -1;
+	}
+	if ((bind(b->lsock, (struct sockaddr*) &addr, sizeof(addr))) || (listen(b->lsock, 16))) {
+		perror("bind/listen");
+		close(b->lsock);
+		bench_brokerFree(b);
+		return -1;
+	}
+	if (pthread_create(&th, NULL, bench_brokerThread, b)) {
+		close(b->lsock);
+		bench_brokerFree(b);
+		return -1;
+	}
+	b->thread = (uintptr_t) th;
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void bench_brokerStop(BenchBroker_t* b) {
+	b->stop = 1;
+	pthread_join((pthread_t) b->thread, NULL);
+	close(b->lsock);
+	/* Let the connection threads see the stop before the TLS configuration is freed */
+	usleep(200 * 1000);
+	bench_brokerFree(b);
+}
+
+/* ================================================================================= */
+/* LiveObjects client                                                                */
+
+static volatile int _bench_client_state = CSTATE_DOWN;
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void bench_clientState(LiveObjectsD_State_t state) {
+	_bench_client_state = state;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int bench_clientConnected(void) {
+	return (_bench_client_state == CSTATE_CONNECTED) ? 1 : 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int bench_clientStart(uint32_t timeout_ms) {
+	uint64_t deadline = bench_nowNs() + (uint64_t) timeout_ms * 1000000ULL;
+
+	if (LiveObjectsClient_ThreadStart(bench_clientState)) {
+		return -1;
+	}
+	while (_bench_client_state != CSTATE_CONNECTED) {
+		if (bench_nowNs() > deadline) {
+			fprintf(stderr, "ERROR: not connected to the local broker after %u ms\n", timeout_ms);
+			return -1;
+		}
+		usleep(1000);
+	}
+	return 0;
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  bench_util.h
+ * @brief Helpers shared by the benchmarks
+ */
+
+#ifndef __bench_util_H_
+#define __bench_util_H_
+
+#include <stdint.h>
+
+#include "liveobjects-client/LiveObjectsClient_Defs.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Local MQTT broker, just enough for the LiveObjects client:
+ * CONNACK, SUBACK, PINGRESP, PUBACK (QoS 1), commands on "dev/cmd", and counters of
+ * what it received.
+ * One thread per client connection. With tls, the connections are TLS (mbedtls test certificate,
+ * not verified by the clients of the benchmarks).
+ */
+typedef struct {
+	uint16_t          port;         /*!< TCP port */
+	const char*       ip;           /*!< IPv4 address to listen on (NULL: 127.0.0.1) */
+	uint32_t          cmd_nb;       /*!< Number of commands published on "dev/cmd" after its SUBSCRIBE */
+	uint8_t           tls;          /*!< 1 = TLS connections */
+	void            (*on_cmd)(void);/*!< Called (if set) when "dev/cmd" is subscribed, before the SUBACK */
+	int               lsock;
+	volatile int      stop;
+	volatile uint32_t cnt_connect;  /*!< Number of MQTT CONNECT received */
+	volatile uint32_t cnt_publish;  /*!< Number of MQTT PUBLISH received */
+	volatile uint64_t rx_bytes;     /*!< Number of bytes received (MQTT packets) */
+	volatile uint64_t wire_bytes;   /*!< Number of bytes received on the TCP connections (with the TLS records) */
+	void*             tls_conf;
+	uintptr_t         thread;
+} BenchBroker_t;
+
+/** Monotonic clock, in nanoseconds */
+uint64_t bench_nowNs(void);
+
+/** CPU time consumed by the process (all threads), in nanoseconds */
+uint64_t bench_cpuNs(void);
+
+/** Return 1 if the calling thread is a thread of the broker, 0 otherwise */
+int bench_brokerSelf(void);
+
+/** Start the broker b->port, b->ip, b->cmd_nb and b->tls (other fields are reset). Return 0 if successful */
+int bench_brokerStart(BenchBroker_t* b);
+
+/** Stop the broker: close the listening socket and all the client connections */
+void bench_brokerStop(BenchBroker_t* b);
+
+/** Start the LiveObjects client thread (default instance), and wait until it is connected.
+ *  Return 0 if connected within timeout_ms */
+int bench_clientStart(uint32_t timeout_ms);
+
+/** Return 1 if the LiveObjects client (started by bench_clientStart) is connected, 0 otherwise */
+int bench_clientConnected(void);
+
+/** Integer argument argv[idx] if present, otherwise def */
+long bench_arg(int argc, char* argv[], int idx, long def);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __bench_util_H_ */
@@ -0,0 +1,24 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  liveobjects_dev_config.h
+ *
+ * @brief User parameters of the benchmarks, overwriting the default LiveObjects parameters
+ *        defined in header file : LiveObjectsClient_Config.h
+ *
+ */
+
+#ifndef __liveobjects_dev_config_H_
+#define __liveobjects_dev_config_H_
+
+#define LOC_MQTT_DEF_COMMAND_TIMEOUT           10000
+
+#endif /* __liveobjects_dev_config_H_ */
@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  liveobjects_dev_params.h
+ * @brief Parameters of the benchmarks: the client talks to the local broker of bench_util.c
+ */
+
+#ifndef __liveobjects_dev_params_H_
+#define __liveobjects_dev_params_H_
+
+/* Plain MQTT (the TLS benchmarks are built with SECURITY_ENABLED=1) */
+#ifndef SECURITY_ENABLED
+#define SECURITY_ENABLED                     0
+#endif
+
+/* Local broker started by the benchmark itself */
+#ifndef LOC_SERV_IP_ADDRESS
+#define LOC_SERV_IP_ADDRESS                  "127.0.0.1"
+#endif
+#ifndef LOC_SERV_PORT
+#define LOC_SERV_PORT                        18830
+#endif
+
+/* 0 -> standard output, 1 -> syslog output /var/log/syslog */
+#define SYSLOG 0
+
+#endif /*__liveobjects_dev_params_H_*/
@@ -0,0 +1,30 @@
+#!/bin/sh
+# Link-loss scenarios of bench_linkloss (see README.md). Run as root:
+#   bench/linkloss.sh [path of bench_linkloss] [timeout in s]
+# The client runs in the network namespace lobench-c (10.77.0.1), the broker in
+# lobench-b (10.77.0.2, LOC_SERV_IP_ADDRESS of bench_linkloss), joined by a veth
+# pair lob0/lob1. The namespaces (and the veth pair) are removed at exit.
+set -e
+BIN=${1:-build/bin/bench_linkloss}
+NS_C=lobench-c
+NS_B=lobench-b
+
+cleanup() {
+	ip netns del $NS_C 2>/dev/null || true
+	ip netns del $NS_B 2>/dev/null || true
+}
+trap cleanup EXIT INT TERM
+
+cleanup
+ip netns add $NS_C
+ip netns add $NS_B
+ip link add lob0 netns $NS_C type veth peer name lob1 netns $NS_B
+ip -n $NS_C addr add 10.77.0.1/24 dev lob0
+ip -n $NS_B addr add 10.77.0.2/24 dev lob1
+for ns in $NS_C $NS_B; do
+	ip -n $ns link set lo up
+done
+ip -n $NS_C link set lob0 up
+ip -n $NS_B link set lob1 up
+
+ip netns exec $NS_C "$BIN" $NS_B lob1 ${2:-90}
@@ -24,6 +24,12 @@
 #define CLIENT_PKEY           NULL
 #define CLIENT_PKEY_PASSWORD  0
 
+/* DER data in memory (no PEM decoding at startup): SERVER_CERT, CLIENT_CERT or CLIENT_PKEY
+ * is then the address of the binary data, with its length defined below */
+/*#define SERVER_CERT_DER_LEN   sizeof(server_cert_der)*/
+/*#define CLIENT_CERT_DER_LEN   sizeof(client_cert_der)*/
+/*#define CLIENT_PKEY_DER_LEN   sizeof(client_pkey_der)*/
+
 #define SERVER_CERTIFICATE_COMMON_NAME     "liveobjects.orange-business.com"
 
 #ifndef SERVER_CERT
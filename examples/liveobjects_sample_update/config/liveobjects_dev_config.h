@@ -28,21 +28,45 @@
 //#define LOC_FEATURE_LO_DATA                  0
 //#define LOC_FEATURE_LO_COMMANDS              0
 //#define LOC_FEATURE_LO_RESOURCES             0
+//#define LOC_FEATURE_CBOR                     0
 
 
 
 //#define LOC_MQTT_API_KEEPALIVEINTERVAL_SEC   30
+//#define LOC_SERV_ATTEMPT_DELAY_MS            250
+//#define LOC_DNS_CACHE_NB                     4
+//#define LOC_DNS_CACHE_TTL_S                  300
+//#define LOC_RUN_WAIT_MAX_MS                  1000
+//#define LOC_RUN_RETRY_MS                     1000
+//#define LOC_RUN_RETRY_MAX_MS                 60000
+//#define LOC_GATEWAY_WORKER_MAX               16
 #define LOC_MQTT_DEF_COMMAND_TIMEOUT           10000
 //#define LOC_MQTT_DEF_SND_SZ                  (1024*2)
 //#define LOC_MQTT_DEF_RCV_SZ                  (1024*2)
+//#define LOC_NETW_RX_BUF_SZ                   1024
+//#define LOC_NETW_TX_BUF_SZ                   2048
+//#define LOC_NETW_TCP_NODELAY                 1
+//#define LOC_NETW_TCP_KEEPIDLE_S              10
+//#define LOC_NETW_TCP_USER_TIMEOUT_MS         20000
+//#define LOC_TLS_SESSION_RESUME               1
+//#define LOC_NETW_KTLS                        0
 
 //#define LOC_MQTT_DEF_TOPIC_NAME_SZ           40
 //#define LOC_MQTT_DEF_DEV_ID_SZ               20
 //#define LOC_MQTT_DEF_NAME_SPACE_SZ           20
+//#define LOC_MQTT_INFLIGHT_MAX                8
 
 //#define LOC_MQTT_DEF_PENDING_MSG_MAX         5
+//#define LOM_MQUEUE_POLICY                    0
+//#define LOM_MQUEUE_TIMEOUT_MS                100
+//#define LOM_MSG_POOL_NB                      8
+//#define LOC_STORE_SEGMENT_SZ                 (1024*64)
+//#define LOC_STORE_MAX_SZ                     (1024*1024)
+//#define LOC_STORE_REPLAY_RATE                20
+//#define LOC_STORE_REPLAY_BURST               5
 //#define LOC_MAX_OF_COMMAND_ARGS              5
 //#define LOC_MAX_OF_DATA_SET                  5
+//#define LOC_STATUS_RESYNC_MS                 0
 
 //#define LOM_JSON_BUF_SZ                      1024
 //#define LOM_JSON_BUF_USER_SZ                 200
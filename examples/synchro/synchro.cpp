@@ -29,7 +29,7 @@
 
 #include "config/liveobjects_dev_params.h"
 #include "liveobjects_iotsoftbox_api.h"
-#include "../../mqtt_live_objects/LiveObjects-iotSoftbox-mqtt-core/liveobjects-client/LiveObjectsClient_Defs.h"
+#include "liveobjects_iotsoftbox_data.hpp"
 
 /* Default LiveObjects device settings : name space and device identifier*/
 #define LOC_CLIENT_DEV_NAME_SPACE            "Langevin-Wallon"
@@ -86,9 +86,9 @@ char appv_status_message[150] = "READY";
 
 /// Set of status
 LiveObjectsD_Data_t appv_set_status[] = {
-        {LOD_TYPE_STRING_C, "sample_version", (void *) APPV_VERSION, 1},
-        {LOD_TYPE_INT32,    "sample_counter", &appv_status_counter,  1},
-        {LOD_TYPE_STRING_C, "sample_message", appv_status_message,   1}
+        {LOD_TYPE_STRING_C, "sample_version", (void *) APPV_VERSION, 1, LOD_PREC_SHORTEST},
+        {LOD_TYPE_INT32,    "sample_counter", &appv_status_counter,  1, LOD_PREC_SHORTEST},
+        {LOD_TYPE_STRING_C, "sample_message", appv_status_message,   1, LOD_PREC_SHORTEST}
 };
 #define SET_STATUS_NB (sizeof(appv_set_status) / sizeof(LiveObjectsD_Data_t))
 
@@ -101,25 +101,19 @@ int appv_hdl_status = -1;
 
 uint8_t appv_measures_enabled = 1;
 
-// contains a counter incremented after each data sent
-uint32_t appvCounter = 0;
+struct Measures {
+    uint32_t counter;   // contains a counter incremented after each data sent
+    double tsAvant;
+    double tsApres;
+} appv_measures = {0, 0, 0};
 
+/// Set of Collected data (published on a data stream), types deduced from the fields
+constexpr auto appv_measures_schema = LiveObjects::schema(
+        LiveObjects::field<&Measures::counter>("counter"),
+        LiveObjects::field<&Measures::tsAvant>("Timestamp Avant"),
+        LiveObjects::field<&Measures::tsApres>("Timestamp Apres"));
 
-double appvTSApres = 0;
-double appvTSAvant = 0;
-
-
-/// Set of Collected data (published on a data stream)
-LiveObjectsD_Data_t appv_set_measures[] = {
-        {LOD_TYPE_UINT8,  "counter",         &appvCounter, 1},
-        {LOD_TYPE_DOUBLE, "Timestamp Avant", &appvTSAvant, 1},
-        {LOD_TYPE_DOUBLE, "Timestamp Apres", &appvTSApres, 1}
-};
-
-#define SET_MEASURES_NB (sizeof(appv_set_measures) / sizeof(LiveObjectsD_Data_t))
-
-
-int appv_hdl_data = -1;
+LiveObjects::DataSet appv_set_measures(appv_measures_schema, appv_measures);
 
 // ----------------------------------------------------------
 // CONFIGURATION data
@@ -141,10 +135,10 @@ struct conf_s {
 
 /// Set of configuration parameters
 LiveObjectsD_Param_t appv_set_param[] = {
-        {PARM_IDX_NAME,      {LOD_TYPE_STRING_C, "name",      appv_conf.name,             1}},
-        {PARM_IDX_TIMEOUT,   {LOD_TYPE_UINT32,   "timeout",   (void *) &appv_cfg_timeout, 1}},
-        {PARM_IDX_THRESHOLD, {LOD_TYPE_INT32,    "threshold", &appv_conf.threshold,       1}},
-        {PARM_IDX_GAIN,      {LOD_TYPE_FLOAT,    "gain",      &appv_conf.gain,            1}}
+        {PARM_IDX_NAME,      {LOD_TYPE_STRING_C, "name",      appv_conf.name,             1, LOD_PREC_SHORTEST}},
+        {PARM_IDX_TIMEOUT,   {LOD_TYPE_UINT32,   "timeout",   (void *) &appv_cfg_timeout, 1, LOD_PREC_SHORTEST}},
+        {PARM_IDX_THRESHOLD, {LOD_TYPE_INT32,    "threshold", &appv_conf.threshold,       1, LOD_PREC_SHORTEST}},
+        {PARM_IDX_GAIN,      {LOD_TYPE_FLOAT,    "gain",      &appv_conf.gain,            1, LOD_PREC_SHORTEST}}
 };
 #define SET_PARAM_NB (sizeof(appv_set_param) / sizeof(LiveObjectsD_Param_t))
 
@@ -561,13 +555,13 @@ void appli_sched(void) {
     if (appv_log_level > 2) {
         /*printf("thread_appli: %"PRIu32" - %s PUBLISH - volt=%2.2f temp=%d\r\n", loop_cnt,appv_measures_enabled ? "DATA" : "NO", appv_measures_volt, appvTimestamp);*/
         std::cout << "thread_appli: " << loop_cnt << " - " << (appv_measures_enabled ? "DATA" : "NO")
-                  << " PUBLISH - temp=" << appvTimestamp << std::endl;
+                  << " PUBLISH - ts=" << appv_measures.tsApres << std::endl;
     }
 
     if (appv_measures_enabled) {
         std::cout << "LiveObjectsClient_PushData..." << std::endl;
-        LiveObjectsClient_PushData(appv_hdl_data);
-        appvCounter++;
+        appv_set_measures.push();
+        appv_measures.counter++;
     }
 }
 
@@ -616,10 +610,9 @@ bool mqtt_start(void *ctx) {
 
     // Attach one set of collected data to the LiveObjects Client instance
     // --------------------------------------------------------------------
-    appv_hdl_data = LiveObjectsClient_AttachData(STREAM_PREFIX, "MesureLatence", "mV1", "\"Test\"", NULL,
-                                                 appv_set_measures, SET_MEASURES_NB);
-    if (appv_hdl_data <
-        0) { ;//     std::cout << " !!! ERROR (" << appv_hdl_data << ") to attach a collected data stream !" << std::endl;
+    ret = appv_set_measures.attach(STREAM_PREFIX, "MesureLatence", "mV1", "\"Test\"", NULL);
+    if (ret <
+        0) { ;//     std::cout << " !!! ERROR (" << ret << ") to attach a collected data stream !" << std::endl;
     }
     else { ;//      std::cout << "mqtt_start: LiveObjectsClient_AttachData -> OK " << std::endl;
     }
@@ -694,18 +687,18 @@ int main() {
         auto TimestampAvant = std::chrono::duration<double>(
                 pointMesure1.time_since_epoch());    // défini la durée du traitement
 
-        appvTSAvant = TimestampAvant.count();
+        appv_measures.tsAvant = TimestampAvant.count();
         auto toutDeSuite = std::chrono::system_clock::now();
         auto convertion = std::chrono::duration<double>(toutDeSuite.time_since_epoch());
 
-        appvTSApres = convertion.count();
-        appvTSAvant = TimestampAvant.count();
+        appv_measures.tsApres = convertion.count();
+        appv_measures.tsAvant = TimestampAvant.count();
 
         appli_sched();
         LiveObjectsClient_Cycle(1);
 
-        std::cout << "Timestamp Avant : " << std::fixed << appvTSAvant << std::endl;
-        std::cout << "Timestamp Apres: " << std::fixed << appvTSApres << std::endl;
+        std::cout << "Timestamp Avant : " << std::fixed << appv_measures.tsAvant << std::endl;
+        std::cout << "Timestamp Apres: " << std::fixed << appv_measures.tsApres << std::endl;
         std::this_thread::sleep_for(std::chrono::milliseconds(5000));
         std::cout << "Fin programme : " << std::endl;
     }
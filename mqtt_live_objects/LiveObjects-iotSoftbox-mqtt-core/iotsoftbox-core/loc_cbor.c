@@ -0,0 +1,653 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+/**
+ * @file  loc_cbor.c
+ * @brief Basic CBOR functions
+ */
+
+#include "liveobjects-client/LiveObjectsClient_Config.h"
+
+#include "loc_cbor.h"
+
+#ifndef TRACE_GROUP
+#define TRACE_GROUP "CBOR"
+#endif
+#include "liveobjects-sys/loc_trace.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include "liveobjects-sys/LiveObjectsClient_Platform.h"
+#include "platform_default.h"
+
+#if LOC_FEATURE_CBOR
+
+/* Maximum nesting level of the skipped items */
+#define LO_CBOR_SKIP_DEPTH  8
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_cbor_init(LOCborWriter_t* cw, uint8_t* buf, uint32_t sz) {
+	cw->buf_ptr = buf;
+	cw->buf_sz = sz;
+	cw->buf_len = 0;
+	cw->err = 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LO_cbor_put(LOCborWriter_t* cw, const void* p, uint32_t len) {
+	if ((cw->err) || (cw->buf_len + len > cw->buf_sz)) {
+		cw->err = -1;
+		return -1;
+	}
+	memcpy(cw->buf_ptr + cw->buf_len, p, len);
+	cw->buf_len += len;
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Initial byte and argument of an item, in the shortest form */
+static int LO_cbor_put_head(LOCborWriter_t* cw, uint8_t major, uint64_t arg) {
+	uint8_t h[9];
+	uint32_t n;
+	major <<= 5;
+	if (arg < 24) {
+		h[0] = major | (uint8_t) arg;
+		n = 1;
+	}
+	else if (arg <= 0xFF) {
+		h[0] = major | 24;
+		h[1] = (uint8_t) arg;
+		n = 2;
+	}
+	else if (arg <= 0xFFFF) {
+		h[0] = major | 25;
+		h[1] = (uint8_t) (arg >> 8);
+		h[2] = (uint8_t) arg;
+		n = 3;
+	}
+	else if (arg <= 0xFFFFFFFF) {
+		h[0] = major | 26;
+		h[1] = (uint8_t) (arg >> 24);
+		h[2] = (uint8_t) (arg >> 16);
+		h[3] = (uint8_t) (arg >> 8);
+		h[4] = (uint8_t) arg;
+		n = 5;
+	}
+	else {
+		int i;
+		h[0] = major | 27;
+		for (i = 0; i < 8; i++) {
+			h[1 + i] = (uint8_t) (arg >> (56 - 8 * i));
+		}
+		n = 9;
+	}
+	return LO_cbor_put(cw, h, n);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_cbor_put_uint(LOCborWriter_t* cw, uint64_t value) {
+	return LO_cbor_put_head(cw, LO_CBOR_UINT, value);
+}
+
+int LO_cbor_put_int(LOCborWriter_t* cw, int64_t value) {
+	if (value < 0) {
+		return LO_cbor_put_head(cw, LO_CBOR_NINT, (uint64_t) (-1 - value));
+	}
+	return LO_cbor_put_head(cw, LO_CBOR_UINT, (uint64_t) value);
+}
+
+int LO_cbor_put_text(LOCborWriter_t* cw, const char* p, uint32_t len) {
+	if (LO_cbor_put_head(cw, LO_CBOR_TEXT, len)) {
+		return -1;
+	}
+	return LO_cbor_put(cw, p, len);
+}
+
+int LO_cbor_put_str(LOCborWriter_t* cw, const char* p) {
+	return LO_cbor_put_text(cw, p, (p) ? (uint32_t) strlen(p) : 0);
+}
+
+int LO_cbor_put_array(LOCborWriter_t* cw, uint32_t nb) {
+	return LO_cbor_put_head(cw, LO_CBOR_ARRAY, nb);
+}
+
+int LO_cbor_put_map(LOCborWriter_t* cw, uint32_t nb) {
+	return LO_cbor_put_head(cw, LO_CBOR_MAP, nb);
+}
+
+int LO_cbor_put_bool(LOCborWriter_t* cw, int value) {
+	uint8_t b = (value) ? 0xF5 : 0xF4;
+	return LO_cbor_put(cw, &b, 1);
+}
+
+int LO_cbor_put_null(LOCborWriter_t* cw) {
+	uint8_t b = 0xF6;
+	return LO_cbor_put(cw, &b, 1);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Half precision form of a single precision value, if it is exact. Return 0 if not. */
+static int LO_cbor_half(float value, uint16_t* half) {
+	uint32_t bits;
+	uint32_t mant;
+	int32_t exp;
+	uint16_t sign;
+
+	memcpy(&bits, &value, sizeof(bits));
+	sign = (uint16_t) ((bits >> 16) & 0x8000);
+	exp = (int32_t) ((bits >> 23) & 0xFF);
+	mant = bits & 0x7FFFFF;
+
+	if (exp == 0xFF) {
+		/* Infinity, or NaN (canonical form) */
+		*half = (mant) ? 0x7E00 : (sign | 0x7C00);
+		return 1;
+	}
+	if ((exp == 0) && (mant == 0)) {
+		*half = sign;
+		return 1;
+	}
+	if (exp == 0) {
+		/* Single precision subnormal: too small */
+		return 0;
+	}
+	exp -= 127;
+	if ((exp >= -14) && (exp <= 15)) {
+		if (mant & 0x1FFF) {
+			return 0;
+		}
+		*half = sign | (uint16_t) ((exp + 15) << 10) | (uint16_t) (mant >> 13);
+		return 1;
+	}
+	if ((exp >= -24) && (exp < -14)) {
+		/* Half precision subnormal */
+		uint32_t shift = (uint32_t) (-1 - exp);  /* 13 + (-14 - exp) */
+		mant |= 0x800000;
+		if (mant & ((1u << shift) - 1)) {
+			return 0;
+		}
+		*half = sign | (uint16_t) (mant >> shift);
+		return 1;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_cbor_put_float(LOCborWriter_t* cw, float value) {
+	uint8_t h[5];
+	uint16_t half;
+	uint32_t bits;
+	if (LO_cbor_half(value, &half)) {
+		h[0] = 0xF9;
+		h[1] = (uint8_t) (half >> 8);
+		h[2] = (uint8_t) half;
+		return LO_cbor_put(cw, h, 3);
+	}
+	memcpy(&bits, &value, sizeof(bits));
+	h[0] = 0xFA;
+	h[1] = (uint8_t) (bits >> 24);
+	h[2] = (uint8_t) (bits >> 16);
+	h[3] = (uint8_t) (bits >> 8);
+	h[4] = (uint8_t) bits;
+	return LO_cbor_put(cw, h, 5);
+}
+
+int LO_cbor_put_double(LOCborWriter_t* cw, double value) {
+	uint8_t h[9];
+	uint64_t bits;
+	int i;
+	/* (float) of a finite double out of the float range is undefined */
+	if ((isnan(value)) || (isinf(value))
+			|| ((value >= -FLT_MAX) && (value <= FLT_MAX) && ((double) (float) value == value))) {
+		return LO_cbor_put_float(cw, (float) value);
+	}
+	memcpy(&bits, &value, sizeof(bits));
+	h[0] = 0xFB;
+	for (i = 0; i < 8; i++) {
+		h[1 + i] = (uint8_t) (bits >> (56 - 8 * i));
+	}
+	return LO_cbor_put(cw, h, 9);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* One value of a data element */
+static int LO_cbor_put_one(LOCborWriter_t* cw, LiveObjectsD_Type_t type, const void* v) {
+	switch (type) {
+	case LOD_TYPE_INT32:
+		return LO_cbor_put_int(cw, *((const int32_t*) v));
+	case LOD_TYPE_INT16:
+		return LO_cbor_put_int(cw, *((const int16_t*) v));
+	case LOD_TYPE_INT8:
+		return LO_cbor_put_int(cw, *((const int8_t*) v));
+	case LOD_TYPE_UINT32:
+		return LO_cbor_put_uint(cw, *((const uint32_t*) v));
+	case LOD_TYPE_UINT16:
+		return LO_cbor_put_uint(cw, *((const uint16_t*) v));
+	case LOD_TYPE_UINT8:
+		return LO_cbor_put_uint(cw, *((const uint8_t*) v));
+	case LOD_TYPE_STRING_C:
+		return LO_cbor_put_str(cw, (const char*) v);
+	case LOD_TYPE_BOOL:
+		return LO_cbor_put_bool(cw, *((const uint8_t*) v));
+	case LOD_TYPE_FLOAT:
+		return LO_cbor_put_float(cw, *((const float*) v));
+	case LOD_TYPE_DOUBLE:
+		return LO_cbor_put_double(cw, *((const double*) v));
+	default:
+		LOTRACE_ERR("Unknown data type %d", type);
+		cw->err = -1;
+		return -1;
+	}
+}
+
+static uint32_t LO_cbor_stride(LiveObjectsD_Type_t type) {
+	switch (type) {
+	case LOD_TYPE_INT32:
+	case LOD_TYPE_UINT32:
+		return sizeof(int32_t);
+	case LOD_TYPE_INT16:
+	case LOD_TYPE_UINT16:
+		return sizeof(int16_t);
+	case LOD_TYPE_FLOAT:
+		return sizeof(float);
+	case LOD_TYPE_DOUBLE:
+		return sizeof(double);
+	default:
+		return sizeof(uint8_t);
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Value (or array of values) of a data element. A string is one value, whatever data_dim. */
+int LO_cbor_put_value(LOCborWriter_t* cw, const LiveObjectsD_Data_t* data_ptr) {
+	const uint8_t* v = (const uint8_t*) data_ptr->data_value;
+	uint32_t stride;
+	int i;
+
+	if ((data_ptr->data_dim <= 1) || (data_ptr->data_type == LOD_TYPE_STRING_C)) {
+		return LO_cbor_put_one(cw, data_ptr->data_type, v);
+	}
+	if (LO_cbor_put_array(cw, (uint32_t) data_ptr->data_dim)) {
+		return -1;
+	}
+	stride = LO_cbor_stride(data_ptr->data_type);
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_cbor_put_one(cw, data_ptr->data_type, v)) {
+			return -1;
+		}
+		v += stride;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_cbor_put_item(LOCborWriter_t* cw, const LiveObjectsD_Data_t* data_ptr) {
+	if (LO_cbor_put_str(cw, data_ptr->data_name)) {
+		return -1;
+	}
+	return LO_cbor_put_value(cw, data_ptr);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Array of the text strings of a list in JSON format: "a","b" */
+int LO_cbor_put_tags(LOCborWriter_t* cw, const char* tags) {
+	const char* p;
+	const char* q;
+	uint32_t nb = 0;
+
+	for (p = tags; (p) && (*p); p++) {
+		if (*p == '"') {
+			nb++;
+		}
+	}
+	if (LO_cbor_put_array(cw, nb / 2)) {
+		return -1;
+	}
+	for (p = tags; (p) && (*p); p++) {
+		if (*p != '"') {
+			continue;
+		}
+		q = strchr(p + 1, '"');
+		if (q == NULL) {
+			break;
+		}
+		if (LO_cbor_put_text(cw, p + 1, (uint32_t) (q - p - 1))) {
+			return -1;
+		}
+		p = q;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_cbor_reader_init(LOCborReader_t* cr, const uint8_t* buf, uint32_t len) {
+	cr->buf_ptr = buf;
+	cr->buf_len = len;
+	cr->pos = 0;
+	cr->err = 0;
+}
+
+int LO_cbor_peek(const LOCborReader_t* cr) {
+	if ((cr->err) || (cr->pos >= cr->buf_len)) {
+		return -1;
+	}
+	return cr->buf_ptr[cr->pos] >> 5;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Initial byte and argument of the next item. Return the major type, or -1. */
+static int LO_cbor_get_head(LOCborReader_t* cr, uint8_t* info, uint64_t* arg) {
+	uint8_t ib;
+	uint32_t n;
+	uint32_t i;
+
+	if ((cr->err) || (cr->pos >= cr->buf_len)) {
+		cr->err = -1;
+		return -1;
+	}
+	ib = cr->buf_ptr[cr->pos++];
+	*info = ib & 0x1F;
+	if (*info < 24) {
+		*arg = *info;
+		return ib >> 5;
+	}
+	if (*info == 31) {
+		/* Indefinite length, or break */
+		*arg = 0;
+		return ib >> 5;
+	}
+	if (*info > 27) {
+		cr->err = -1;
+		return -1;
+	}
+	n = 1u << (*info - 24);
+	if (cr->pos + n > cr->buf_len) {
+		cr->err = -1;
+		return -1;
+	}
+	*arg = 0;
+	for (i = 0; i < n; i++) {
+		*arg = (*arg << 8) | cr->buf_ptr[cr->pos++];
+	}
+	return ib >> 5;
+}
+
+/* Definite-length item of the expected major type */
+static int LO_cbor_get_expected(LOCborReader_t* cr, int major, uint64_t* arg) {
+	uint8_t info;
+	if ((LO_cbor_get_head(cr, &info, arg) != major) || (info == 31)) {
+		cr->err = -1;
+		return -1;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_cbor_get_map(LOCborReader_t* cr, uint32_t* nb) {
+	uint64_t arg;
+	if ((LO_cbor_get_expected(cr, LO_CBOR_MAP, &arg)) || (arg > 0xFFFF)) {
+		cr->err = -1;
+		return -1;
+	}
+	*nb = (uint32_t) arg;
+	return 0;
+}
+
+int LO_cbor_get_array(LOCborReader_t* cr, uint32_t* nb) {
+	uint64_t arg;
+	if ((LO_cbor_get_expected(cr, LO_CBOR_ARRAY, &arg)) || (arg > 0xFFFF)) {
+		cr->err = -1;
+		return -1;
+	}
+	*nb = (uint32_t) arg;
+	return 0;
+}
+
+int LO_cbor_get_text(LOCborReader_t* cr, const char** p, uint32_t* len) {
+	uint64_t arg;
+	if ((LO_cbor_get_expected(cr, LO_CBOR_TEXT, &arg)) || (arg > cr->buf_len - cr->pos)) {
+		cr->err = -1;
+		return -1;
+	}
+	*p = (const char*) (cr->buf_ptr + cr->pos);
+	*len = (uint32_t) arg;
+	cr->pos += (uint32_t) arg;
+	return 0;
+}
+
+int LO_cbor_get_int(LOCborReader_t* cr, int64_t* value) {
+	uint8_t info;
+	uint64_t arg;
+	int major = LO_cbor_get_head(cr, &info, &arg);
+	if ((major == LO_CBOR_UINT) && (info != 31) && (arg <= INT64_MAX)) {
+		*value = (int64_t) arg;
+		return 0;
+	}
+	if ((major == LO_CBOR_NINT) && (info != 31) && (arg <= INT64_MAX)) {
+		*value = -1 - (int64_t) arg;
+		return 0;
+	}
+	cr->err = -1;
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static double LO_cbor_half_to_double(uint16_t half) {
+	int exp = (half >> 10) & 0x1F;
+	double mant = (double) (half & 0x3FF);
+	double value;
+	if (exp == 0) {
+		value = ldexp(mant, -24);
+	}
+	else if (exp != 31) {
+		value = ldexp(mant + 1024, exp - 25);
+	}
+	else {
+		value = (mant == 0) ? INFINITY : NAN;
+	}
+	return (half & 0x8000) ? -value : value;
+}
+
+int LO_cbor_get_double(LOCborReader_t* cr, double* value) {
+	uint8_t info;
+	uint64_t arg;
+	int major = LO_cbor_peek(cr);
+
+	if ((major == LO_CBOR_UINT) || (major == LO_CBOR_NINT)) {
+		int64_t i;
+		if (LO_cbor_get_int(cr, &i)) {
+			return -1;
+		}
+		*value = (double) i;
+		return 0;
+	}
+	if (LO_cbor_get_head(cr, &info, &arg) == LO_CBOR_SIMPLE) {
+		if (info == 25) {
+			*value = LO_cbor_half_to_double((uint16_t) arg);
+			return 0;
+		}
+		if (info == 26) {
+			uint32_t bits = (uint32_t) arg;
+			float f;
+			memcpy(&f, &bits, sizeof(f));
+			*value = f;
+			return 0;
+		}
+		if (info == 27) {
+			memcpy(value, &arg, sizeof(*value));
+			return 0;
+		}
+	}
+	cr->err = -1;
+	return -1;
+}
+
+int LO_cbor_get_bool(LOCborReader_t* cr, uint8_t* value) {
+	uint8_t info;
+	uint64_t arg;
+	if ((LO_cbor_get_head(cr, &info, &arg) == LO_CBOR_SIMPLE) && ((info == 20) || (info == 21))) {
+		*value = (info == 21) ? 1 : 0;
+		return 0;
+	}
+	cr->err = -1;
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LO_cbor_skip_depth(LOCborReader_t* cr, int depth) {
+	uint8_t info;
+	uint64_t arg;
+	uint64_t i;
+	int major;
+
+	if (depth > LO_CBOR_SKIP_DEPTH) {
+		cr->err = -1;
+		return -1;
+	}
+	major = LO_cbor_get_head(cr, &info, &arg);
+	if (major < 0) {
+		return -1;
+	}
+	if (info == 31) {
+		if ((major < LO_CBOR_BYTES) || (major > LO_CBOR_MAP)) {
+			/* Break (0xFF) out of an indefinite-length item, or invalid */
+			cr->err = -1;
+			return -1;
+		}
+		/* Indefinite length: items up to the break */
+		while ((cr->pos < cr->buf_len) && (cr->buf_ptr[cr->pos] != 0xFF)) {
+			if (LO_cbor_skip_depth(cr, depth + 1)) {
+				return -1;
+			}
+		}
+		if (cr->pos >= cr->buf_len) {
+			cr->err = -1;
+			return -1;
+		}
+		cr->pos++;
+		return 0;
+	}
+	switch (major) {
+	case LO_CBOR_BYTES:
+	case LO_CBOR_TEXT:
+		if (arg > cr->buf_len - cr->pos) {
+			cr->err = -1;
+			return -1;
+		}
+		cr->pos += (uint32_t) arg;
+		return 0;
+	case LO_CBOR_MAP:
+		if (arg > (cr->buf_len - cr->pos) / 2) {
+			cr->err = -1;
+			return -1;
+		}
+		arg *= 2;
+		/* fall through */
+	case LO_CBOR_ARRAY:
+		if (arg > cr->buf_len - cr->pos) {
+			cr->err = -1;
+			return -1;
+		}
+		for (i = 0; i < arg; i++) {
+			if (LO_cbor_skip_depth(cr, depth + 1)) {
+				return -1;
+			}
+		}
+		return 0;
+	case LO_CBOR_TAG:
+		return LO_cbor_skip_depth(cr, depth + 1);
+	default:
+		return 0;
+	}
+}
+
+int LO_cbor_skip(LOCborReader_t* cr) {
+	return LO_cbor_skip_depth(cr, 0);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_cbor_get_typed(LOCborReader_t* cr, LiveObjectsD_Type_t type, void* value, uint32_t* len) {
+	int64_t i = 0;
+	double d;
+
+	switch (type) {
+	case LOD_TYPE_STRING_C:
+		return LO_cbor_get_text(cr, (const char**) value, len);
+	case LOD_TYPE_BOOL:
+		return LO_cbor_get_bool(cr, (uint8_t*) value);
+	case LOD_TYPE_FLOAT:
+		if ((LO_cbor_get_double(cr, &d)) || ((isfinite(d)) && ((d < -FLT_MAX) || (d > FLT_MAX)))) {
+			return -1;
+		}
+		*((float*) value) = (float) d;
+		return 0;
+	case LOD_TYPE_DOUBLE:
+		return LO_cbor_get_double(cr, (double*) value);
+	default:
+		break;
+	}
+
+	if (LO_cbor_get_int(cr, &i)) {
+		return -1;
+	}
+	switch (type) {
+	case LOD_TYPE_INT32:
+		if ((i < INT32_MIN) || (i > INT32_MAX)) {
+			break;
+		}
+		*((int32_t*) value) = (int32_t) i;
+		return 0;
+	case LOD_TYPE_INT16:
+		if ((i < INT16_MIN) || (i > INT16_MAX)) {
+			break;
+		}
+		*((int16_t*) value) = (int16_t) i;
+		return 0;
+	case LOD_TYPE_INT8:
+		if ((i < INT8_MIN) || (i > INT8_MAX)) {
+			break;
+		}
+		*((int8_t*) value) = (int8_t) i;
+		return 0;
+	case LOD_TYPE_UINT32:
+		if ((i < 0) || (i > UINT32_MAX)) {
+			break;
+		}
+		*((uint32_t*) value) = (uint32_t) i;
+		return 0;
+	case LOD_TYPE_UINT16:
+		if ((i < 0) || (i > UINT16_MAX)) {
+			break;
+		}
+		*((uint16_t*) value) = (uint16_t) i;
+		return 0;
+	case LOD_TYPE_UINT8:
+		if ((i < 0) || (i > UINT8_MAX)) {
+			break;
+		}
+		*((uint8_t*) value) = (uint8_t) i;
+		return 0;
+	default:
+		break;
+	}
+	LOTRACE_WARN("Value %lld out of range for type %d", (long long) i, type);
+	cr->err = -1;
+	return -1;
+}
+#endif /* LOC_FEATURE_CBOR */
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file   loc_cbor.h
+ * @brief  CBOR (RFC 8949) interface: binary encoding of the messages
+ *
+ * Only the definite-length items are written: integers, text strings, arrays, maps,
+ * booleans, null and floating-point values (in the shortest of the half, single and
+ * double precision formats that keeps the value).
+ * The reader also skips the other items (byte strings, tags, indefinite lengths).
+ */
+
+#ifndef __loc_cbor_H_
+#define __loc_cbor_H_
+
+#include <stdint.h>
+
+#include "liveobjects-client/LiveObjectsClient_Defs.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/** Major types */
+#define LO_CBOR_UINT     0
+#define LO_CBOR_NINT     1
+#define LO_CBOR_BYTES    2
+#define LO_CBOR_TEXT     3
+#define LO_CBOR_ARRAY    4
+#define LO_CBOR_MAP      5
+#define LO_CBOR_TAG      6
+#define LO_CBOR_SIMPLE   7
+
+/**
+ * CBOR writer context, same principle as the JSON writer (LOJsonWriter_t).
+ */
+typedef struct {
+	uint8_t* buf_ptr;  /*!< Output buffer */
+	uint32_t buf_sz;   /*!< Size of the output buffer */
+	uint32_t buf_len;  /*!< Current length of the encoded data */
+	int      err;      /*!< Sticky error: set when an item does not fit in the buffer */
+} LOCborWriter_t;
+
+/**
+ * CBOR reader context.
+ */
+typedef struct {
+	const uint8_t* buf_ptr;  /*!< Encoded data */
+	uint32_t buf_len;        /*!< Length of the encoded data */
+	uint32_t pos;            /*!< Read position */
+	int      err;            /*!< Sticky error: malformed or truncated data, or unexpected item */
+} LOCborReader_t;
+
+void LO_cbor_init(LOCborWriter_t* cw, uint8_t* buf, uint32_t sz);
+
+int LO_cbor_put_uint(LOCborWriter_t* cw, uint64_t value);
+
+int LO_cbor_put_int(LOCborWriter_t* cw, int64_t value);
+
+int LO_cbor_put_text(LOCborWriter_t* cw, const char* p, uint32_t len);
+
+int LO_cbor_put_str(LOCborWriter_t* cw, const char* p);
+
+int LO_cbor_put_array(LOCborWriter_t* cw, uint32_t nb);
+
+int LO_cbor_put_map(LOCborWriter_t* cw, uint32_t nb);
+
+int LO_cbor_put_bool(LOCborWriter_t* cw, int value);
+
+int LO_cbor_put_null(LOCborWriter_t* cw);
+
+int LO_cbor_put_float(LOCborWriter_t* cw, float value);
+
+int LO_cbor_put_double(LOCborWriter_t* cw, double value);
+
+/* Value (or array of values) of a data element */
+int LO_cbor_put_value(LOCborWriter_t* cw, const LiveObjectsD_Data_t* data_ptr);
+
+/* Name and value of a data element, in a map */
+int LO_cbor_put_item(LOCborWriter_t* cw, const LiveObjectsD_Data_t* data_ptr);
+
+/* Array of the text strings of a list in JSON format: "a","b" */
+int LO_cbor_put_tags(LOCborWriter_t* cw, const char* tags);
+
+
+void LO_cbor_reader_init(LOCborReader_t* cr, const uint8_t* buf, uint32_t len);
+
+/* Major type of the next item, or -1 at the end of the data */
+int LO_cbor_peek(const LOCborReader_t* cr);
+
+int LO_cbor_get_map(LOCborReader_t* cr, uint32_t* nb);
+
+int LO_cbor_get_array(LOCborReader_t* cr, uint32_t* nb);
+
+/* Text string, not null-terminated (pointer in the encoded data) */
+int LO_cbor_get_text(LOCborReader_t* cr, const char** p, uint32_t* len);
+
+int LO_cbor_get_int(LOCborReader_t* cr, int64_t* value);
+
+/* Integer or floating-point value */
+int LO_cbor_get_double(LOCborReader_t* cr, double* value);
+
+int LO_cbor_get_bool(LOCborReader_t* cr, uint8_t* value);
+
+/* Skip the next item (with its content) */
+int LO_cbor_skip(LOCborReader_t* cr);
+
+/* Read the next item in a value of the given type: 'value' is the address of one value
+ * of this type, or of a char pointer (LOD_TYPE_STRING_C) set to the text in the encoded data,
+ * with its length in *len. */
+int LO_cbor_get_typed(LOCborReader_t* cr, LiveObjectsD_Type_t type, void* value, uint32_t* len);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __loc_cbor_H_ */
@@ -27,13 +27,18 @@
 #include "liveobjects-client/LiveObjectsClient_Config.h"
 
 #include "liveobjects-client/LiveObjectsClient_Core.h"
+#include "liveobjects-client/LiveObjectsClient_Instance.h"
 #include "liveobjects-client/LiveObjectsClient_Security.h"
 #include "liveobjects-client/LiveObjectsClient_Toolbox.h"
 
 #include "netw_wrapper.h"
 
+#include "loc_core.h"
 #include "loc_json_api.h"
 #include "loc_msg.h"
+#include "loc_mpool.h"
+#include "loc_mqueue.h"
+#include "loc_store.h"
 #include "loc_wget.h"
 
 #include "loc_sys.h"
@@ -106,50 +111,190 @@ typedef struct {
 	messageHandler callback;
 } LOMTopicSub_t;
 
+#if LOM_MQUEUE
+/* Message published with QoS 1, in the slot (packet_id % LOC_MQTT_INFLIGHT_MAX) */
+typedef struct {
+	const char* p_msg;
+	uint16_t packet_id;
+} LOCCInflight_t;
+
+#if (LOC_MQTT_INFLIGHT_MAX < 1)
+#error "LOC_MQTT_INFLIGHT_MAX must be at least 1"
+#endif
+#define LOCC_INFLIGHT_SLOT(packet_id)   ((packet_id) % LOC_MQTT_INFLIGHT_MAX)
+#endif /* LOM_MQUEUE */
+
+/* Store of the data messages published while disconnected (replayed from a message of the pool) */
+#if LOM_MQUEUE && (LOM_JSON_BUF_USER_SZ > 0) && LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
+#define LOCC_STORE 1
+#else
+#define LOCC_STORE 0
+#endif
+
+#if LOCC_STORE
+#if (LOC_STORE_REPLAY_RATE < 1) || (LOC_STORE_REPLAY_BURST < 1)
+#error "LOC_STORE_REPLAY_RATE and LOC_STORE_REPLAY_BURST must be at least 1"
+#endif
+#define LOCC_STORE_INTERVAL_US   (1000000ULL / LOC_STORE_REPLAY_RATE)
+#define LOCC_STORE_BURST_US      ((LOC_STORE_REPLAY_BURST - 1) * LOCC_STORE_INTERVAL_US)
+#endif
+
+/* Batches of data samples (encoded in a message of the pool) */
+#if LOM_MQUEUE && (LOM_JSON_BUF_USER_SZ > 0) && LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
+#define LOCC_BATCH 1
+#else
+#define LOCC_BATCH 0
+#endif
+
+#if LOCC_BATCH
+/* Message of a batch being filled */
+typedef struct {
+	char* p_msg;             /* Message of the pool, or NULL */
+	LOJsonWriter_t jw;
+	uint32_t nb;             /* Number of samples */
+	uint64_t first_us;       /* Time of the first sample */
+} LOCCBatchMsg_t;
+
+/* Samples of a data set gathered in one message (see LiveObjectsInstance_SetDataBatch) */
+typedef struct {
+	uint32_t size;           /* Max number of samples in a message, 0 if the data set is not batched */
+	uint32_t linger_ms;      /* Max time the first sample waits */
+	uint32_t sample_max;     /* Size of the largest sample encoded */
+	LOCCBatchMsg_t cur;      /* Protected by mutex */
+	LiveObjectsD_BatchStats_t stats;
+	LOSysMutex_t* mutex;     /* Created by LiveObjectsInstance_Init */
+} LOCCBatch_t;
+#endif
+
 /* --------------------------------------------------------------------------------- */
-/* Local variables
- * ---------------
+/* LiveObjects Client instance
+ * ---------------------------
  */
 
-static char _LOClient_dev_id[LOC_MQTT_DEF_DEV_ID_SZ] = "";
-static char _LOClient_dev_name_space[LOC_MQTT_DEF_NAME_SPACE_SZ] = "";
+struct LiveObjectsClient {
+	char dev_id[LOC_MQTT_DEF_DEV_ID_SZ];
+	char dev_name_space[LOC_MQTT_DEF_NAME_SPACE_SZ];
 
-static unsigned long long apikey_p1 = 0;
-static unsigned long long apikey_p2 = 0;
+	unsigned long long apikey_p1;
+	unsigned long long apikey_p2;
 
-static Network _LOClient_MQTTClient_network;
+	Network MQTTClient_network;
 
-static volatile int8_t  _LOClient_state_run = 0;
-static volatile uint8_t _LOClient_state_connected = 0;
+	volatile int8_t  state_run;
+	volatile uint8_t state_connected;
 
-static int8_t _LOClient_cfg_first;
+	int8_t cfg_first;
 
-static MQTTClient _LOClient_mqtt_ctx;
+	MQTTClient mqtt_ctx;
 
-static unsigned char _LOClient_mqtt_buffer_snd[LOC_MQTT_DEF_SND_SZ + 10];
-static unsigned char _LOClient_mqtt_buffer_rcv[LOC_MQTT_DEF_RCV_SZ + 10];
+	unsigned char mqtt_buffer_snd[LOC_MQTT_DEF_SND_SZ + 10];
+	unsigned char mqtt_buffer_rcv[LOC_MQTT_DEF_RCV_SZ + 10];
 
 #if LOM_MQUEUE
-static struct {
-	int iwrite;
-	int iread;
-	const char* msg[LOC_MQTT_DEF_PENDING_MSG_MAX];
-} _LOClient_queue;
+	LOMQueue_t queue;
+	uint32_t   queue_capacity;
+	uint8_t    queue_policy;
+	uint32_t   queue_timeout_ms;
+
+	LOCCInflight_t inflight[LOC_MQTT_INFLIGHT_MAX];  /* QoS 1 messages waiting for their PUBACK, indexed by packet id */
+	volatile uint32_t inflight_nb;
+	const char* inflight_next;                        /* Got from the queue, waiting for a free slot */
+	volatile uint32_t inflight_high_water;
+	volatile uint32_t inflight_acked;
+	volatile uint32_t inflight_retransmitted;
+	volatile uint32_t inflight_dropped;
 #endif /* LOM_MQUEUE */
 
+#if LOCC_STORE
+	LOStore_t* store;                             /* Data messages published while disconnected, or NULL */
+	uint64_t   store_next_us;                     /* Replay: theoretical time of the next stored message */
+#endif
+#if LOCC_BATCH
+	LOCCBatch_t batch[LOC_MAX_OF_DATA_SET];
+#endif
+
+#if SECURITY_ENABLED
+	LiveObjectsSecurityParams_t params_security;
+#endif
+	LiveObjectsNetConnectParams_t params_connect;
+
+	LOMTopicSub_t TopicSub[3];
+
+#if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
+	LOMSetOfStatus_t          Set_Status[LOC_MAX_OF_STATUS_SET];
+#endif
+#if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
+	LOMSetOfData_t            Set_Data[LOC_MAX_OF_DATA_SET];
+#endif
+#if LOC_FEATURE_LO_PARAMS
+	LOMSetOfParams_t          Set_Params;
+	LOMSetofUpdatedParams_t   Set_UpdatedParams;
+#endif
+#if LOC_FEATURE_LO_COMMANDS
+	LOMSetofCommands_t        Set_Cmd;
+#endif
+#if LOC_FEATURE_LO_RESOURCES
+	LOMSetOfResources_t       Set_Rsc;
+	LOMSetOfUpdatedResource_t Set_UpdatedRsc;
+	LOWget_t                  wget;
+#endif
+
+	LOSysEvent_t* event;                          /* Events waited by the client thread */
+	uintptr_t thread_id;                          /* Thread running LiveObjectsInstance_Run() */
+	LiveObjectsD_CallbackState_t thread_callback; /* Given to LiveObjectsInstance_ThreadStart() */
+
+	LOSysEventGroup_t* group;                     /* Gateway worker running this instance */
+	Timer retry_timer;                            /* Next connection attempt */
+	uint32_t retry_base_ms;                       /* Backoff: delay before the second attempt */
+	uint32_t retry_max_ms;                        /* Backoff: max delay */
+	uint32_t retry_attempt;                       /* Number of attempts since the disconnection */
+	uint32_t retry_seed;                          /* Jitter: state of the pseudo-random generator */
+	uint64_t retry_down_us;                       /* Time of the disconnection, 0 if connected (or never) */
+	uint64_t retry_up_us;                         /* Time of the last connection */
+	volatile uint8_t retry_now;                   /* Network back (LiveObjectsInstance_NetworkChanged) */
+	LiveObjectsD_ReconnectStats_t retry_stats;
+	uint32_t stat_published;                      /* Number of MQTT messages published */
+	uint32_t stat_received;                       /* Number of MQTT messages received */
+
+	uint8_t ready;                                /* Default values are set */
+	uint8_t allocated;                            /* Created by LiveObjectsInstance_Create() */
+};
+
+/* --------------------------------------------------------------------------------- */
+/* Local variables
+ * ---------------
+ */
+
 #if SECURITY_ENABLED
 
-static LiveObjectsSecurityParams_t _LOClient_params_security = {
-		{ 0, SERVER_CERT },
-		{ 0, CLIENT_CERT },
-		{ 0, CLIENT_PKEY },
+/* PEM strings, or DER data when the length is defined (see liveobjects_dev_security.h) */
+#ifdef SERVER_CERT_DER_LEN
+#define LOCC_SERVER_CERT   { 2, (const char*) SERVER_CERT, SERVER_CERT_DER_LEN }
+#else
+#define LOCC_SERVER_CERT   { 0, SERVER_CERT, 0 }
+#endif
+#ifdef CLIENT_CERT_DER_LEN
+#define LOCC_CLIENT_CERT   { 2, (const char*) CLIENT_CERT, CLIENT_CERT_DER_LEN }
+#else
+#define LOCC_CLIENT_CERT   { 0, CLIENT_CERT, 0 }
+#endif
+#ifdef CLIENT_PKEY_DER_LEN
+#define LOCC_CLIENT_PKEY   { 2, (const char*) CLIENT_PKEY, CLIENT_PKEY_DER_LEN }
+#else
+#define LOCC_CLIENT_PKEY   { 0, CLIENT_PKEY, 0 }
+#endif
+
+static const LiveObjectsSecurityParams_t _LOClient_def_params_security = {
+		LOCC_SERVER_CERT,
+		LOCC_CLIENT_CERT,
+		LOCC_CLIENT_PKEY,
 		SERVER_CERTIFICATE_COMMON_NAME,
 		VERIFY_MODE
 };
 
 #endif
 
-static LiveObjectsNetConnectParams_t _LOClient_params_connect = {
+static const LiveObjectsNetConnectParams_t _LOClient_def_params_connect = {
 		LOC_SERV_IP_ADDRESS,
 		LOC_SERV_PORT,
 		LOC_SERV_TIMEOUT
@@ -180,31 +325,18 @@ static void LOCC_ntfDevRscUpd(MessageData* msg);
 #define TOPIC_COMMAND  1
 #define TOPIC_RSC_UPD  2
 
-LOMTopicSub_t _LOClient_TopicSub[3] = {
+static const LOMTopicSub_t _LOClient_def_TopicSub[3] = {
 		{ 0, "dev/cfg/upd", LOCC_NTFDEVCFGUDP },
 		{ 0, "dev/cmd", LOCC_NTFDEVCMD },
 		{ 0, "dev/rsc/upd", LOCC_NTFDEVRSCUDP }
 };
 
-#if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
-static LOMSetOfStatus_t          _LOClient_Set_Status[LOC_MAX_OF_STATUS_SET];
-#endif
-#if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
-static LOMSetOfData_t             _LOClient_Set_Data[LOC_MAX_OF_DATA_SET];
-#endif
-#if LOC_FEATURE_LO_PARAMS
-static LOMSetOfParams_t           _LOClient_Set_Params;
-static LOMSetofUpdatedParams_t    _LOClient_Set_UpdatedParams;
-#endif
-#if LOC_FEATURE_LO_COMMANDS
-static LOMSetofCommands_t         _LOClient_Set_Cmd;
-#endif
-#if LOC_FEATURE_LO_RESOURCES
-static LOMSetOfResources_t        _LOClient_Set_Rsc;
-static LOMSetOfUpdatedResource_t  _LOClient_Set_UpdatedRsc;
-#endif
+/* Instance used by the LiveObjectsClient_xxx() functions */
+static LiveObjectsClient_t _LOClient_default;
 
-static int LOCC_MqttPublish(enum QoS qos, const char* topic_name, const char* payload_data);
+static int LOCC_MqttPublish(LiveObjectsClient_t* loc, enum QoS qos, const char* topic_name, const char* payload_data);
+static int LOCC_MqttPublishLen(LiveObjectsClient_t* loc, enum QoS qos, const char* topic_name, const char* payload_data,
+		uint32_t payload_len);
 
 #if LOC_MQTT_DUMP_MSG
 
@@ -215,9 +347,9 @@ static uint16_t _LOClient_dump_mqtt_publish = 0;
  * -----------------
  */
 
-static int apikeyconv(char * apikey, int size) {
+static int apikeyconv(LiveObjectsClient_t* loc, char * apikey, int size) {
 	if (size == APIKEY_LENGTH) {
-		snprintf(apikey, size, "%016llx%016llx", apikey_p1, apikey_p2);
+		snprintf(apikey, size, "%016llx%016llx", loc->apikey_p1, loc->apikey_p2);
 		return 0;
 	}
 	return -1;
@@ -305,88 +437,130 @@ void LOCC_mqtt_dump_msg(const unsigned char* p_buf) {
 #endif /* LOC_MQTT_DUMP_MSG */
 
 /* ================================================================================= */
-/* Messages Queue
+/* Instance
  */
+/* --------------------------------------------------------------------------------- */
+/* Set the default values of a new instance */
+static void LOCC_instanceInit(LiveObjectsClient_t* loc) {
+	memset(loc, 0, sizeof(LiveObjectsClient_t));
+#if LOM_MQUEUE
+	loc->queue_capacity = LOC_MQTT_DEF_PENDING_MSG_MAX;
+	loc->queue_policy = LOM_MQUEUE_POLICY;
+	loc->queue_timeout_ms = LOM_MQUEUE_TIMEOUT_MS;
+#endif
+#if SECURITY_ENABLED
+	loc->params_security = _LOClient_def_params_security;
+#endif
+	loc->params_connect = _LOClient_def_params_connect;
+	memcpy(loc->TopicSub, _LOClient_def_TopicSub, sizeof(loc->TopicSub));
+#if LOC_FEATURE_LO_RESOURCES
+	loc->wget.sock_hdl = SOCKETHANDLE_NULL;
+#endif
+	loc->MQTTClient_network.my_socket = SOCKETHANDLE_NULL;
+	loc->retry_base_ms = LOC_RUN_RETRY_MS;
+	loc->retry_max_ms = LOC_RUN_RETRY_MAX_MS;
+	loc->ready = 1;
+}
+
 /* --------------------------------------------------------------------------------- */
 /*  */
-static int LOCC_mqInit(void) {
+static LiveObjectsClient_t* LOCC_default(void) {
+	if (!_LOClient_default.ready) {
+		LOCC_instanceInit(&_LOClient_default);
+	}
+	return &_LOClient_default;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Is it the thread running this instance ? */
+static uint8_t LOCC_threadIsClient(LiveObjectsClient_t* loc) {
+	return ((loc->thread_id) && (loc->thread_id == LO_sys_threadSelf())) ? 1 : 0;
+}
+
+/* ================================================================================= */
+/* Messages Queue
+ */
 #if LOM_MQUEUE
-	memset(&_LOClient_queue, 0, sizeof(_LOClient_queue));
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void LOCC_mqRelease(const char* p_msg) {
+	const LOMsgHeader_t* hdr = LOM_MSG_HDR(p_msg);
+	LOTRACE_DBG1("release msg %p x%x", p_msg, *p_msg);
+	if ((hdr->qos) && (hdr->ack_callback)) {
+		/* QoS 1: not acknowledged */
+		hdr->ack_callback(hdr->ack_ctx, -1);
+	}
+	LO_mpool_free(p_msg);
+}
 #endif /* LOM_MQUEUE */
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LOCC_mqInit(LiveObjectsClient_t* loc) {
+#if LOM_MQUEUE
+	return LO_mq_init(&loc->queue, loc->queue_capacity, (LiveObjectsD_MqPolicy_t) loc->queue_policy,
+			loc->queue_timeout_ms, LOCC_mqRelease);
+#else
 	return 0;
+#endif /* LOM_MQUEUE */
 }
 
 #if LOM_MQUEUE
 /* --------------------------------------------------------------------------------- */
 /*  */
-static int LOCC_mqPut(const char* p_msg) {
-	int ret = -1;
-	/* lock */
-	if (MQ_MUTEX_LOCK()) {
-		LOTRACE_WARN("Error to lock mutex");
-		return ret;
-	}
-	if (_LOClient_queue.msg[_LOClient_queue.iwrite] == NULL) {
-		_LOClient_queue.msg[_LOClient_queue.iwrite] = p_msg;
-		if (++_LOClient_queue.iwrite == LOC_MQTT_DEF_PENDING_MSG_MAX)
-			_LOClient_queue.iwrite = 0;
-		ret = 0;
-	}
-	else {
-		/*TODO: queue overflow -> release the oldest message ? */
-		;
+static int LOCC_mqPut(LiveObjectsClient_t* loc, const char* p_msg) {
+	if (LO_mq_put(&loc->queue, p_msg)) {
+		return -1;
 	}
-	/* unlock */
-	MQ_MUTEX_UNLOCK();
-	return ret;
+	/* Wake up the LiveObjects Client thread */
+	LO_sys_eventSignal(loc->event);
+	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-static const char* LOCC_mqGet() {
-	const char* p_msg = NULL;
-	/* lock */
-	if (MQ_MUTEX_LOCK()) {
-		LOTRACE_WARN("Error to lock mutex");
-		return p_msg;
-	}
-	if (_LOClient_queue.iread != _LOClient_queue.iwrite) {
-		p_msg = _LOClient_queue.msg[_LOClient_queue.iread];
-		_LOClient_queue.msg[_LOClient_queue.iread] = NULL;
-		if (++_LOClient_queue.iread == LOC_MQTT_DEF_PENDING_MSG_MAX) {
-			_LOClient_queue.iread = 0;
-		}
-
-	}
-	/* unlock */
-	MQ_MUTEX_UNLOCK();
-	return p_msg;
+static const char* LOCC_mqGet(LiveObjectsClient_t* loc) {
+	return LO_mq_get(&loc->queue);
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-static void LOCC_mqPurge(void) {
-	if (MQ_MUTEX_LOCK()) {
-		LOTRACE_ERR("Error to lock mutex");
-		return;
-	}
-	while (_LOClient_queue.iread != _LOClient_queue.iwrite) {
-		const char* p_msg = _LOClient_queue.msg[_LOClient_queue.iread];
-		if (p_msg) {
-			LOTRACE_DBG1("MEM_FREE msg[%d]=%p x%x", _LOClient_queue.iread, p_msg, *p_msg);
-			MEM_FREE(p_msg);
-		}
-		else {
-			LOTRACE_ERR("msg[%d]=NULL !!", _LOClient_queue.iread);
+/* Release the pending messages, except those published with QoS 1 (put again in the queue)
+ * and the data messages saved in the store */
+static void LOCC_mqPurge(LiveObjectsClient_t* loc) {
+	LiveObjectsD_MqStats_t stats;
+	const char* p_msg;
+	uint32_t nb;
+
+	LO_mq_getStats(&loc->queue, &stats);
+	for (nb = stats.mq_depth; (nb > 0) && ((p_msg = LOCC_mqGet(loc)) != NULL); nb--) {
+		if (LOM_MSG_HDR(p_msg)->qos == 0) {
+#if LOCC_STORE
+			if ((loc->store) && (*p_msg == MTYPE_PUB_DATA)) {
+				LO_store_append(loc->store, MTYPE_PUB_DATA, LOM_MSG_PAYLOAD(p_msg), LOM_MSG_HDR(p_msg)->payload_len);
+			}
+#endif
+			LOCC_mqRelease(p_msg);
 		}
-		_LOClient_queue.msg[_LOClient_queue.iread] = NULL;
-		if (++_LOClient_queue.iread == LOC_MQTT_DEF_PENDING_MSG_MAX) {
-			_LOClient_queue.iread = 0;
+		else if (LO_mq_put(&loc->queue, p_msg)) {
+			LOCC_mqRelease(p_msg);
 		}
 	}
-	_LOClient_queue.iread = _LOClient_queue.iwrite = 0;
-	memset(_LOClient_queue.msg, 0, sizeof(_LOClient_queue.msg));
-	MQ_MUTEX_UNLOCK();
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Queue a message to be published with QoS 1 */
+static int LOCC_mqPutQos1(LiveObjectsClient_t* loc, char* p_msg, LiveObjectsD_CallbackPubAck_t callback,
+		void* msg_ctx) {
+	LOMsgHeader_t* hdr = LOM_MSG_HDR(p_msg);
+	hdr->qos = QOS1;
+	hdr->ack_callback = callback;
+	hdr->ack_ctx = msg_ctx;
+	if (LOCC_mqPut(loc, p_msg) == 0) {
+		return 0;
+	}
+	LOTRACE_ERR("ERROR to put in queue - release %p x%x", p_msg, *p_msg);
+	LO_mpool_free(p_msg);
+	return -1;
 }
 #endif /* LOM_MQUEUE */
 
@@ -397,14 +571,16 @@ static void LOCC_mqPurge(void) {
 /*  */
 #if LOC_FEATURE_LO_PARAMS
 static void LOCC_ntfDevCfgUpd(MessageData* msg) {
+	LiveObjectsClient_t* loc = (LiveObjectsClient_t*) msg->context;
 	int ret;
+	loc->stat_received++;
 	LOTRACE_INF("topicName='%s' '%.*s'", (msg->topicName->cstring) ? msg->topicName->cstring : "" , msg->topicName->lenstring.len,
 			msg->topicName->lenstring.data);
 	LOTRACE_INF("msg: id=%d qos=%d '%.*s'", msg->message->id, msg->message->qos, msg->message->payloadlen,
 			(const char*) msg->message->payload);
 
-	ret = LO_msg_decode_params_req((const char*) msg->message->payload, msg->message->payloadlen, &_LOClient_Set_Params,
-			&_LOClient_Set_UpdatedParams);
+	ret = LO_msg_decode_params_req((const char*) msg->message->payload, msg->message->payloadlen, &loc->Set_Params,
+			&loc->Set_UpdatedParams);
 	if (ret) {
 		LOTRACE_ERR("failed, rc= %d", ret);
 	}
@@ -415,16 +591,18 @@ static void LOCC_ntfDevCfgUpd(MessageData* msg) {
 /*  */
 #if LOC_FEATURE_LO_RESOURCES
 static void LOCC_ntfDevRscUpd(MessageData* msg) {
+	LiveObjectsClient_t* loc = (LiveObjectsClient_t*) msg->context;
 	LiveObjectsD_ResourceRespCode_t rsc_result;
 	const char* pMsg;
 	int32_t cid = 0;
+	loc->stat_received++;
 	LOTRACE_INF("topicName='%s' '%.*s'", msg->topicName->cstring, msg->topicName->lenstring.len,
 			msg->topicName->lenstring.data);
 	LOTRACE_INF("msg: id=%d qos=%d '%.*s'", msg->message->id, msg->message->qos, msg->message->payloadlen,
 			(const char*) msg->message->payload);
 
-	rsc_result = LO_msg_decode_rsc_req((const char*) msg->message->payload, msg->message->payloadlen, &_LOClient_Set_Rsc,
-			&_LOClient_Set_UpdatedRsc, &cid);
+	rsc_result = LO_msg_decode_rsc_req((const char*) msg->message->payload, msg->message->payloadlen, &loc->Set_Rsc,
+			&loc->Set_UpdatedRsc, &cid);
 	if (cid == 0) {
 		LOTRACE_ERR("failed, NO CID !!  ret=%d", rsc_result);
 		return;
@@ -433,7 +611,7 @@ static void LOCC_ntfDevRscUpd(MessageData* msg) {
 	pMsg = LO_msg_encode_rsc_result(cid, rsc_result);
 	if (pMsg) {
 		LOTRACE_DBG1("Publish rsc response, cid=%"PRIi32" with ret=%d ...", cid, rsc_result);
-		LOCC_MqttPublish(QOS0, "dev/rsc/upd/res", pMsg);
+		LOCC_MqttPublish(loc, QOS0, "dev/rsc/upd/res", pMsg);
 	}
 	else {
 		LOTRACE_PRINTF("ERROR to build rsc response, cid=%"PRIi32" with ret=%d", cid, rsc_result);
@@ -445,14 +623,16 @@ static void LOCC_ntfDevRscUpd(MessageData* msg) {
 /*  */
 #if LOC_FEATURE_LO_COMMANDS
 static void LOCC_ntfDevCmd(MessageData* msg) {
+	LiveObjectsClient_t* loc = (LiveObjectsClient_t*) msg->context;
 	int ret;
 	int32_t cid = 0;
+	loc->stat_received++;
 	LOTRACE_INF("topicName='%s' '%.*s'", msg->topicName->cstring, msg->topicName->lenstring.len,
 			msg->topicName->lenstring.data);
 	LOTRACE_INF("msg: id=%d qos=%d '%.*s'", msg->message->id, msg->message->qos, msg->message->payloadlen,
 			(const char*) msg->message->payload);
 
-	ret = LO_msg_decode_cmd_req((const char*) msg->message->payload, msg->message->payloadlen, &_LOClient_Set_Cmd,
+	ret = LO_msg_decode_cmd_req((const char*) msg->message->payload, msg->message->payloadlen, &loc->Set_Cmd,
 			&cid);
 	if (ret < 0) {
 		LOTRACE_ERR("failed, rc= %d, cid=%"PRIi32, ret, cid);
@@ -464,7 +644,7 @@ static void LOCC_ntfDevCmd(MessageData* msg) {
 		LOTRACE_INF("Send command response cid=%"PRIi32" ret= %d", cid, ret);
 		pMsg = LO_msg_encode_cmd_result(cid, ret);
 		if (pMsg) {
-			LOCC_MqttPublish(QOS0, "dev/cmd/res", pMsg);
+			LOCC_MqttPublish(loc, QOS0, "dev/cmd/res", pMsg);
 		}
 	}
 	else {
@@ -478,24 +658,24 @@ static void LOCC_ntfDevCmd(MessageData* msg) {
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if SECURITY_ENABLED
-static int LOCC_EnableTLS(void) {
+static int LOCC_EnableTLS(LiveObjectsClient_t* loc) {
 	int rc;
-	rc = netw_setSecurity(&_LOClient_MQTTClient_network, &_LOClient_params_security);
+	rc = netw_setSecurity(&loc->MQTTClient_network, &loc->params_security);
 	return rc;
 }
 #endif
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-static int LOCC_MqttConnect() {
+static int LOCC_MqttConnect(LiveObjectsClient_t* loc) {
 	int ret;
 	char mqtt_client_id[14+LOC_MQTT_DEF_NAME_SPACE_SZ+LOC_MQTT_DEF_DEV_ID_SZ+2];
 
 	MQTTPacket_connectData connectData = MQTTPacket_connectData_initializer;
 
 
-	ret = snprintf(mqtt_client_id, sizeof(mqtt_client_id), "urn:lo:nsid:%s:%s", _LOClient_dev_name_space,
-			_LOClient_dev_id);
+	ret = snprintf(mqtt_client_id, sizeof(mqtt_client_id), "urn:lo:nsid:%s:%s", loc->dev_name_space,
+			loc->dev_id);
 	mqtt_client_id[sizeof(mqtt_client_id)-1] = 0;
 
 	LOTRACE_DBG1("MQTT Connecting (%s) ...", mqtt_client_id);
@@ -504,7 +684,7 @@ static int LOCC_MqttConnect() {
 	connectData.clientID.cstring = mqtt_client_id;
 	connectData.username.cstring = LOC_MQTT_USER_NAME;
 	char password[APIKEY_LENGTH];
-	ret = apikeyconv(password, APIKEY_LENGTH);
+	ret = apikeyconv(loc, password, APIKEY_LENGTH);
 	if (ret == 0) {
 		connectData.password.cstring = password;
 	} else {
@@ -520,21 +700,28 @@ static int LOCC_MqttConnect() {
 
 	connectData.keepAliveInterval = LOC_MQTT_API_KEEPALIVEINTERVAL_SEC;
 
-	ret = MQTTConnect(&_LOClient_mqtt_ctx, &connectData);
+	ret = MQTTConnect(&loc->mqtt_ctx, &connectData);
 	if (ret) {
 		LOTRACE_ERR("MQTTConnect failed, rc= %d", ret);
 		LOTRACE_ERR("You might need to check your APIKEY\n");
-		netw_disconnect(&_LOClient_MQTTClient_network, 1);
+		netw_disconnect(&loc->MQTTClient_network, 1);
 		return -1;
 	}
 	LOTRACE_INF("MQTT Connected : OK %d", ret);
-	_LOClient_state_connected = 1;
+	loc->state_connected = 1;
 	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-static int LOCC_MqttPublish(enum QoS qos, const char* topic_name, const char* payload_data) {
+static int LOCC_MqttPublish(LiveObjectsClient_t* loc, enum QoS qos, const char* topic_name, const char* payload_data) {
+	return LOCC_MqttPublishLen(loc, qos, topic_name, payload_data, strlen(payload_data));
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Binary payload (i.e. CBOR), not null-terminated */
+static int LOCC_MqttPublishLen(LiveObjectsClient_t* loc, enum QoS qos, const char* topic_name, const char* payload_data,
+		uint32_t payload_len) {
 	int rc;
 	MQTTMessage mqtt_msg;
 
@@ -543,44 +730,228 @@ static int LOCC_MqttPublish(enum QoS qos, const char* topic_name, const char* pa
 	mqtt_msg.dup = 0;
 	mqtt_msg.id = 0;
 	mqtt_msg.payload = (void*) payload_data;
-	mqtt_msg.payloadlen = strlen(payload_data);
+	mqtt_msg.payloadlen = payload_len;
 
 	LOTRACE_DBG1("MQTTPublish len=%d ....", mqtt_msg.payloadlen);
-	rc = MQTTPublish(&_LOClient_mqtt_ctx, topic_name, &mqtt_msg);
+	rc = MQTTPublish(&loc->mqtt_ctx, topic_name, &mqtt_msg);
 	if (rc) {
 		LOTRACE_ERR("MQTTPublish failed, rc=%d", rc);
 	}
+	else {
+		loc->stat_published++;
+	}
 
 #if (LOC_MQTT_DUMP_MSG & 0x01)
 	if (_LOClient_dump_mqtt_publish & 0x04) {
-		mqtt_dump_msg(_LOClient_mqtt_buffer_snd);
+		mqtt_dump_msg(loc->mqtt_buffer_snd);
+	}
+#endif
+
+	return rc;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Topic of a queued message */
+#if LOM_MQUEUE
+static const char* LOCC_msgTopic(const char* p_msg, uint16_t* p_len) {
+	const char* topic;
+	switch (*p_msg) {
+	case MTYPE_PUB_DATA:
+		topic = "dev/data";
+		break;
+	case MTYPE_PUB_CMD_RSP:
+		topic = "dev/cmd/res";
+		break;
+	case MTYPE_PUB_STATUS:
+		topic = "dev/info";
+		break;
+	case MTYPE_PUB_PARAM:
+		topic = "dev/cfg";
+		break;
+	case MTYPE_PUB_RSC:
+		topic = "dev/rsc";
+		break;
+	case MTYPE_PUB_USR_MSG:
+		/* Stored in the message, not terminated by a NUL character */
+		*p_len = LOM_MSG_HDR(p_msg)->topic_len;
+		return (*p_len) ? LOM_MSG_TOPIC(p_msg) : NULL;
+	default:
+		return NULL;
+	}
+	*p_len = (uint16_t) strlen(topic);
+	return topic;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Publish a queued message, the MQTT header, the topic and the packet id (QoS 1)
+ * are written in its headroom. */
+static int LOCC_MqttPublishMsg(LiveObjectsClient_t* loc, const char* p_msg, uint16_t packet_id, uint8_t dup) {
+	int rc;
+	MQTTMessage mqtt_msg;
+	char* payload = (char*) LOM_MSG_PAYLOAD(p_msg);
+	uint16_t tlen = 0;
+	const char* topic_name = LOCC_msgTopic(p_msg, &tlen);
+
+	if (topic_name == NULL) {
+		LOTRACE_ERR("ERROR -  UNKNOW msg %p x%x", p_msg, *p_msg);
+		return -1;
+	}
+
+	mqtt_msg.qos = (enum QoS) LOM_MSG_HDR(p_msg)->qos;
+	mqtt_msg.retained = 0;
+	mqtt_msg.dup = dup;
+	mqtt_msg.id = packet_id;
+	mqtt_msg.payload = payload;
+	mqtt_msg.payloadlen = LOM_MSG_HDR(p_msg)->payload_len;
+
+	LOTRACE_DBG1("MQTTPublishInPlace t=%.*s len=%d id=%u dup=%u ....", tlen, topic_name, mqtt_msg.payloadlen,
+			packet_id, dup);
+	rc = MQTTPublishInPlace(&loc->mqtt_ctx, topic_name, tlen, &mqtt_msg, payload - p_msg - sizeof(LOMsgHeader_t));
+	if ((rc == BUFFER_OVERFLOW) && (mqtt_msg.qos == QOS0) && (*p_msg != MTYPE_PUB_USR_MSG)) {
+		/* Topic is too long to be stored in the headroom */
+		return LOCC_MqttPublishLen(loc, QOS0, topic_name, payload, mqtt_msg.payloadlen);
+	}
+	if (rc) {
+		LOTRACE_ERR("MQTTPublishInPlace failed, rc=%d", rc);
+	}
+	else {
+		loc->stat_published++;
+	}
+
+#if (LOC_MQTT_DUMP_MSG & 0x01)
+	if ((_LOClient_dump_mqtt_publish & 0x04) && (rc == 0)) {
+		int rem_len = 2 + tlen + ((mqtt_msg.qos) ? 2 : 0) + mqtt_msg.payloadlen;
+		mqtt_dump_msg((const unsigned char*) payload - (MQTTPacket_len(rem_len) - mqtt_msg.payloadlen));
 	}
 #endif
 
 	return rc;
 }
 
+/* ================================================================================= */
+/* QoS 1 messages waiting for their PUBACK (in-flight window)
+ */
+/* --------------------------------------------------------------------------------- */
+/* Release a QoS 1 message and give the result to the user */
+static void LOCC_inflightComplete(const char* p_msg, int result) {
+	const LOMsgHeader_t* hdr = LOM_MSG_HDR(p_msg);
+	if (hdr->ack_callback) {
+		hdr->ack_callback(hdr->ack_ctx, result);
+	}
+	LO_mpool_free(p_msg);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Publish a QoS 1 message with a new packet id, it is kept until its PUBACK
+ * (the window must not be full) */
+static void LOCC_inflightPublish(LiveObjectsClient_t* loc, const char* p_msg) {
+	LOCCInflight_t* slot;
+	uint16_t packet_id;
+
+	/* The next packet id with a free slot */
+	do {
+		packet_id = MQTTNextPacketId(&loc->mqtt_ctx);
+		slot = &loc->inflight[LOCC_INFLIGHT_SLOT(packet_id)];
+	} while (slot->p_msg);
+
+	slot->p_msg = p_msg;
+	slot->packet_id = packet_id;
+	LO_ATOMIC_STORE(&loc->inflight_nb, loc->inflight_nb + 1);
+	if (loc->inflight_nb > loc->inflight_high_water) {
+		LO_ATOMIC_STORE(&loc->inflight_high_water, loc->inflight_nb);
+	}
+
+	if (LOCC_MqttPublishMsg(loc, p_msg, packet_id, 0)) {
+		LOTRACE_WARN("msg %p id=%u kept, to be sent again after the reconnection", p_msg, packet_id);
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* PUBACK received, called by the MQTT cycle */
+static void LOCC_inflightAck(void* context, unsigned short packet_id) {
+	LiveObjectsClient_t* loc = (LiveObjectsClient_t*) context;
+	LOCCInflight_t* slot = &loc->inflight[LOCC_INFLIGHT_SLOT(packet_id)];
+	const char* p_msg = slot->p_msg;
+
+	if ((p_msg == NULL) || (slot->packet_id != packet_id)) {
+		LOTRACE_WARN("PUBACK id=%u: no message", packet_id);
+		return;
+	}
+	LOTRACE_DBG1("PUBACK id=%u msg %p", packet_id, p_msg);
+	slot->p_msg = NULL;
+	LO_ATOMIC_STORE(&loc->inflight_nb, loc->inflight_nb - 1);
+	LO_ATOMIC_ADD(&loc->inflight_acked, 1);
+	LOCC_inflightComplete(p_msg, 0);
+
+	if (loc->inflight_next) {
+		/* The window was full: publish the next messages */
+		LO_sys_eventSignal(loc->event);
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* After a reconnection: send again the messages not acknowledged, the oldest first */
+static void LOCC_inflightResend(LiveObjectsClient_t* loc) {
+	uint32_t start = LOCC_INFLIGHT_SLOT(loc->mqtt_ctx.next_packetid + 1);
+	uint32_t i;
+
+	netw_batchStart(&loc->MQTTClient_network);
+	for (i = 0; (i < LOC_MQTT_INFLIGHT_MAX) && (loc->inflight_nb); i++) {
+		LOCCInflight_t* slot = &loc->inflight[(start + i) % LOC_MQTT_INFLIGHT_MAX];
+		if (slot->p_msg) {
+			LOTRACE_INF("Publish again msg %p id=%u", slot->p_msg, slot->packet_id);
+			LO_ATOMIC_ADD(&loc->inflight_retransmitted, 1);
+			if (LOCC_MqttPublishMsg(loc, slot->p_msg, slot->packet_id, 1)) {
+				break;
+			}
+		}
+	}
+	if (netw_batchFlush(&loc->MQTTClient_network)) {
+		LOTRACE_ERR("Failed to send again the in-flight messages");
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Release all the messages not acknowledged (instance destroyed) */
+static void LOCC_inflightPurge(LiveObjectsClient_t* loc) {
+	uint32_t i;
+	for (i = 0; i < LOC_MQTT_INFLIGHT_MAX; i++) {
+		if (loc->inflight[i].p_msg) {
+			LOCC_inflightComplete(loc->inflight[i].p_msg, -1);
+			loc->inflight[i].p_msg = NULL;
+			LO_ATOMIC_ADD(&loc->inflight_dropped, 1);
+		}
+	}
+	LO_ATOMIC_STORE(&loc->inflight_nb, 0);
+	if (loc->inflight_next) {
+		LOCC_inflightComplete(loc->inflight_next, -1);
+		loc->inflight_next = NULL;
+		LO_ATOMIC_ADD(&loc->inflight_dropped, 1);
+	}
+}
+#endif /* LOM_MQUEUE */
+
 /* --------------------------------------------------------------------------------- */
 /*  */
-static int LOCC_SubscibeTopic(int i) {
+static int LOCC_SubscibeTopic(LiveObjectsClient_t* loc, int i) {
 	int rc;
 	if ((i >= 0) && (i < 3)) {
-		if (_LOClient_TopicSub[i].subscribed) {
-			LOTRACE_WARN("Subscribe[%d] %s already done", i, _LOClient_TopicSub[i].topicName);
+		if (loc->TopicSub[i].subscribed) {
+			LOTRACE_WARN("Subscribe[%d] %s already done", i, loc->TopicSub[i].topicName);
 			return 0;
 		}
-		if (_LOClient_TopicSub[i].callback == NULL) {
-			LOTRACE_WARN("Subscribe[%d] %s  - NO CALLBACK FUNCTION !!", i, _LOClient_TopicSub[i].topicName);
+		if (loc->TopicSub[i].callback == NULL) {
+			LOTRACE_WARN("Subscribe[%d] %s  - NO CALLBACK FUNCTION !!", i, loc->TopicSub[i].topicName);
 			return 0;
 		}
-		LOTRACE_NOTICE("Subscribe[%d] '%s' , granted_qos=%d .... ", i, _LOClient_TopicSub[i].topicName, QOS0);
-		rc = MQTTSubscribe(&_LOClient_mqtt_ctx, _LOClient_TopicSub[i].topicName, QOS0, _LOClient_TopicSub[i].callback);
+		LOTRACE_NOTICE("Subscribe[%d] '%s' , granted_qos=%d .... ", i, loc->TopicSub[i].topicName, QOS0);
+		rc = MQTTSubscribe(&loc->mqtt_ctx, loc->TopicSub[i].topicName, QOS0, loc->TopicSub[i].callback);
 		if ((rc < 0) || (rc == 0x80)) {
-			LOTRACE_ERR("Subscribe[%d] %s failed, rc=%d", i, _LOClient_TopicSub[i].topicName, rc);
+			LOTRACE_ERR("Subscribe[%d] %s failed, rc=%d", i, loc->TopicSub[i].topicName, rc);
 		}
 		else {
-			LOTRACE_NOTICE("Subscribe[%d] %s, qos=%d (granted_qos=%d)", i, _LOClient_TopicSub[i].topicName, rc, QOS0);
-			_LOClient_TopicSub[i].subscribed = 1;
+			LOTRACE_NOTICE("Subscribe[%d] %s, qos=%d (granted_qos=%d)", i, loc->TopicSub[i].topicName, rc, QOS0);
+			loc->TopicSub[i].subscribed = 1;
 		}
 	}
 	else {
@@ -591,21 +962,21 @@ static int LOCC_SubscibeTopic(int i) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-static int LOCC_UnsubscibeTopic(int i) {
+static int LOCC_UnsubscibeTopic(LiveObjectsClient_t* loc, int i) {
 	int rc;
 	if ((i >= 0) && (i < 3)) {
-		if (!_LOClient_TopicSub[i].subscribed) {
-			LOTRACE_WARN("Unsubscribe[%d] %s already done", i, _LOClient_TopicSub[i].topicName);
+		if (!loc->TopicSub[i].subscribed) {
+			LOTRACE_WARN("Unsubscribe[%d] %s already done", i, loc->TopicSub[i].topicName);
 			return 0;
 		}
-		LOTRACE_NOTICE("Unsubscribe[%d] %s .... ", i, _LOClient_TopicSub[i].topicName);
-		rc = MQTTUnsubscribe(&_LOClient_mqtt_ctx, _LOClient_TopicSub[i].topicName);
+		LOTRACE_NOTICE("Unsubscribe[%d] %s .... ", i, loc->TopicSub[i].topicName);
+		rc = MQTTUnsubscribe(&loc->mqtt_ctx, loc->TopicSub[i].topicName);
 		if (rc == 0) {
-			LOTRACE_NOTICE("Unsubscribe[%d] %s", i, _LOClient_TopicSub[i].topicName);
-			_LOClient_TopicSub[i].subscribed = 0;
+			LOTRACE_NOTICE("Unsubscribe[%d] %s", i, loc->TopicSub[i].topicName);
+			loc->TopicSub[i].subscribed = 0;
 		}
 		else {
-			LOTRACE_ERR("Unsubscribe[%d] %s failed, rc=%d", i, _LOClient_TopicSub[i].topicName, rc);
+			LOTRACE_ERR("Unsubscribe[%d] %s failed, rc=%d", i, loc->TopicSub[i].topicName, rc);
 		}
 	}
 	else {
@@ -615,13 +986,58 @@ static int LOCC_UnsubscibeTopic(int i) {
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
+/* Encode a status message: all the elements, or in delta mode only the elements changed
+ * since the last message (and all of them after resync_ms, or if force is set).
+ * Return 1 when there is nothing to publish (no change), 0 if the message is encoded, -1 on error. */
 #if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
-static int LOCC_processStatus(uint8_t force) {
+static int LOCC_statusEncode(LOMSetOfStatus_t* p_statusSet, uint8_t from, uint8_t force, const char** p_msg,
+		uint32_t* p_len) {
+	LOMShadow_t* shadow = &p_statusSet->shadow;
+	uint64_t now;
+	int nb;
+
+	LO_sys_mutexLock(p_statusSet->mutex);
+	if (shadow->values == NULL) {
+		LO_sys_mutexUnlock(p_statusSet->mutex);
+		*p_msg = LO_msg_encode_status(from, &p_statusSet->data_set, NULL, p_len);
+		return (*p_msg) ? 0 : -1;
+	}
+	now = LO_sys_timeUs();
+	nb = LO_msg_shadow_diff(shadow, &p_statusSet->data_set,
+			(force) || (now - shadow->full_us >= (uint64_t) shadow->resync_ms * 1000));
+	if (nb == 0) {
+		LO_sys_mutexUnlock(p_statusSet->mutex);
+		LOTRACE_DBG1("No change");
+		return 1;
+	}
+	*p_msg = LO_msg_encode_status(from, &p_statusSet->data_set,
+			(nb < p_statusSet->data_set.data_nb) ? shadow->mask : NULL, p_len);
+	if (*p_msg) {
+		if (nb == p_statusSet->data_set.data_nb) {
+			shadow->full_us = now;
+		}
+		LO_msg_shadow_commit(shadow);
+	}
+	LO_sys_mutexUnlock(p_statusSet->mutex);
+	LOTRACE_DBG1("%d/%d elements", nb, p_statusSet->data_set.data_nb);
+	return (*p_msg) ? 0 : -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* The last encoded message is not published: the next one has all the elements */
+static void LOCC_statusLost(LOMSetOfStatus_t* p_statusSet) {
+	LO_sys_mutexLock(p_statusSet->mutex);
+	p_statusSet->shadow.valid = 0;
+	LO_sys_mutexUnlock(p_statusSet->mutex);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LOCC_processStatus(LiveObjectsClient_t* loc, uint8_t force) {
 	int rc = 0;
 	int status_hdl;
 	for (status_hdl = 0; status_hdl < LOC_MAX_OF_STATUS_SET; status_hdl++) {
-		LOMSetOfStatus_t* p_satusSet = &_LOClient_Set_Status[status_hdl];
+		LOMSetOfStatus_t* p_satusSet = &loc->Set_Status[status_hdl];
 		if ((p_satusSet->data_set.data_ptr) && (p_satusSet->data_set.data_nb)
 				&& ((force)
 #if LOM_PUSH_FLAG
@@ -629,6 +1045,8 @@ static int LOCC_processStatus(uint8_t force) {
 #endif
 						)) {
 			const char* pMsg;
+			uint32_t len;
+			int ret;
 #if LOM_PUSH_FLAG
 			LOTRACE_INF("force=%d  push=%d => PUBLISH STATUS ...", force,
 					p_satusSet->pushtoLOServer);
@@ -636,14 +1054,17 @@ static int LOCC_processStatus(uint8_t force) {
 #else
 			LOTRACE_INF("force=%d  => PUBLISH STATUS ...", force);
 #endif
-			pMsg = LO_msg_encode_status(0, &p_satusSet->data_set);
-			if (pMsg) {
-				rc = LOCC_MqttPublish(QOS0, "dev/info", pMsg);
-				if (rc == 0) {
+			ret = LOCC_statusEncode(p_satusSet, 0, force, &pMsg, &len);
+			if (ret == 0) {
+				rc = LOCC_MqttPublishLen(loc, QOS0, "dev/info", pMsg, len);
+				if (rc) {
+					LOCC_statusLost(p_satusSet);
+				}
+			}
+			if ((ret == 1) || ((ret == 0) && (rc == 0))) {
 #if LOM_PUSH_FLAG
-					p_satusSet->pushtoLOServer = 0;
+				p_satusSet->pushtoLOServer = 0;
 #endif
-				}
 			}
 		}
 	}
@@ -655,19 +1076,19 @@ static int LOCC_processStatus(uint8_t force) {
 /*  */
 #if LOC_FEATURE_LO_RESOURCES
 
-static int LOCC_processResources(uint8_t force) {
+static int LOCC_processResources(LiveObjectsClient_t* loc, uint8_t force) {
 	int rc = 0;
-	if ((_LOClient_Set_Rsc.rsc_ptr) &&
-			((force) || (_LOClient_Set_Rsc.pushtoLOServer))) {
+	if ((loc->Set_Rsc.rsc_ptr) &&
+			((force) || (loc->Set_Rsc.pushtoLOServer))) {
 		const char* pMsg;
 		LOTRACE_INF("force=%d  push=%d => PUBLISH RESOURCES ...", force,
-				_LOClient_Set_Rsc.pushtoLOServer);
-		_LOClient_Set_Rsc.pushtoLOServer = 1;
-		pMsg = LO_msg_encode_resources(0, &_LOClient_Set_Rsc);
+				loc->Set_Rsc.pushtoLOServer);
+		loc->Set_Rsc.pushtoLOServer = 1;
+		pMsg = LO_msg_encode_resources(0, &loc->Set_Rsc);
 		if (pMsg) {
-			rc = LOCC_MqttPublish(QOS0, "dev/rsc", pMsg);
+			rc = LOCC_MqttPublish(loc, QOS0, "dev/rsc", pMsg);
 			if (rc == 0) {
-				_LOClient_Set_Rsc.pushtoLOServer = 0;
+				loc->Set_Rsc.pushtoLOServer = 0;
 			}
 		}
 	}
@@ -678,33 +1099,33 @@ static int LOCC_processResources(uint8_t force) {
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_RESOURCES
-static int LOCC_processGetRsc(void) {
+static int LOCC_processGetRsc(LiveObjectsClient_t* loc) {
 	int rc = 0;
-	if ((_LOClient_Set_UpdatedRsc.ursc_cid) && (_LOClient_Set_UpdatedRsc.ursc_obj_ptr)) {
-		if (_LOClient_Set_Rsc.rsc_cb_data) {
-			if (_LOClient_Set_UpdatedRsc.ursc_connected) {
-				rc = _LOClient_Set_Rsc.rsc_cb_data(_LOClient_Set_UpdatedRsc.ursc_obj_ptr,
-						_LOClient_Set_UpdatedRsc.ursc_offset);
+	if ((loc->Set_UpdatedRsc.ursc_cid) && (loc->Set_UpdatedRsc.ursc_obj_ptr)) {
+		if (loc->Set_Rsc.rsc_cb_data) {
+			if (loc->Set_UpdatedRsc.ursc_connected) {
+				rc = loc->Set_Rsc.rsc_cb_data(loc->Set_UpdatedRsc.ursc_obj_ptr,
+						loc->Set_UpdatedRsc.ursc_offset);
 				if (rc < 0) {
 					LOTRACE_INF("ERROR returned by User callback function");
 					rc = -1;
 				}
 				else if (rc == 0) {
 					LOTRACE_INF("0 byte => ERROR !! offset=%"PRIu32"/%"PRIu32,
-							_LOClient_Set_UpdatedRsc.ursc_offset, _LOClient_Set_UpdatedRsc.ursc_size);
+							loc->Set_UpdatedRsc.ursc_offset, loc->Set_UpdatedRsc.ursc_size);
 					rc = -50;
 				}
 
-				if (_LOClient_Set_UpdatedRsc.ursc_offset == _LOClient_Set_UpdatedRsc.ursc_size) {
+				if (loc->Set_UpdatedRsc.ursc_offset == loc->Set_UpdatedRsc.ursc_size) {
 					int i;
 					unsigned char output[16];
 					memset(output, 0, 16);
 #if LOC_FEATURE_MBEDTLS
-					mbedtls_md5_finish(&_LOClient_Set_UpdatedRsc.md5_ctx, output);
+					mbedtls_md5_finish(&loc->Set_UpdatedRsc.md5_ctx, output);
 #endif /* LOC_FEATURE_MBEDTLS */
 					/* TODO: Check md5 value with the value given by the LO server */
 					for (i = 0; i < sizeof(output); i++) {
-						if (output[i] != _LOClient_Set_UpdatedRsc.ursc_md5[i]) {
+						if (output[i] != loc->Set_UpdatedRsc.ursc_md5[i]) {
 							LOTRACE_INF(
 									"Computed MD5  %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x",
 									output[0], output[1], output[2], output[3], output[4], output[5], output[6],
@@ -712,16 +1133,16 @@ static int LOCC_processGetRsc(void) {
 									output[14], output[15]);
 							LOTRACE_INF(
 									"LO Server MD5  %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x",
-									_LOClient_Set_UpdatedRsc.ursc_md5[0], _LOClient_Set_UpdatedRsc.ursc_md5[1],
-									_LOClient_Set_UpdatedRsc.ursc_md5[2], _LOClient_Set_UpdatedRsc.ursc_md5[3],
-									_LOClient_Set_UpdatedRsc.ursc_md5[4], _LOClient_Set_UpdatedRsc.ursc_md5[5],
-									_LOClient_Set_UpdatedRsc.ursc_md5[6], _LOClient_Set_UpdatedRsc.ursc_md5[7],
-									_LOClient_Set_UpdatedRsc.ursc_md5[8], _LOClient_Set_UpdatedRsc.ursc_md5[9],
-									_LOClient_Set_UpdatedRsc.ursc_md5[10], _LOClient_Set_UpdatedRsc.ursc_md5[11],
-									_LOClient_Set_UpdatedRsc.ursc_md5[12], _LOClient_Set_UpdatedRsc.ursc_md5[13],
-									_LOClient_Set_UpdatedRsc.ursc_md5[14], _LOClient_Set_UpdatedRsc.ursc_md5[15]);
+									loc->Set_UpdatedRsc.ursc_md5[0], loc->Set_UpdatedRsc.ursc_md5[1],
+									loc->Set_UpdatedRsc.ursc_md5[2], loc->Set_UpdatedRsc.ursc_md5[3],
+									loc->Set_UpdatedRsc.ursc_md5[4], loc->Set_UpdatedRsc.ursc_md5[5],
+									loc->Set_UpdatedRsc.ursc_md5[6], loc->Set_UpdatedRsc.ursc_md5[7],
+									loc->Set_UpdatedRsc.ursc_md5[8], loc->Set_UpdatedRsc.ursc_md5[9],
+									loc->Set_UpdatedRsc.ursc_md5[10], loc->Set_UpdatedRsc.ursc_md5[11],
+									loc->Set_UpdatedRsc.ursc_md5[12], loc->Set_UpdatedRsc.ursc_md5[13],
+									loc->Set_UpdatedRsc.ursc_md5[14], loc->Set_UpdatedRsc.ursc_md5[15]);
 							LOTRACE_ERR("MD5 ERROR - [%d] x%x != x%x", i, output[i],
-									_LOClient_Set_UpdatedRsc.ursc_md5[i]);
+									loc->Set_UpdatedRsc.ursc_md5[i]);
 							break;
 						}
 					}
@@ -729,10 +1150,10 @@ static int LOCC_processGetRsc(void) {
 					LOTRACE_WARN("MD5 WARNING: Not implemented => Force OK");
 					i = sizeof(output);
 #endif
-					if (_LOClient_Set_Rsc.rsc_cb_ntfy) {
-						_LOClient_Set_Rsc.rsc_cb_ntfy((i == sizeof(output)) ? 1 : 2,
-								_LOClient_Set_UpdatedRsc.ursc_obj_ptr, _LOClient_Set_UpdatedRsc.ursc_vers_old,
-								_LOClient_Set_UpdatedRsc.ursc_vers_new, _LOClient_Set_UpdatedRsc.ursc_size);
+					if (loc->Set_Rsc.rsc_cb_ntfy) {
+						loc->Set_Rsc.rsc_cb_ntfy((i == sizeof(output)) ? 1 : 2,
+								loc->Set_UpdatedRsc.ursc_obj_ptr, loc->Set_UpdatedRsc.ursc_vers_old,
+								loc->Set_UpdatedRsc.ursc_vers_new, loc->Set_UpdatedRsc.ursc_size);
 					}
 					rc = -1;
 				}
@@ -740,22 +1161,22 @@ static int LOCC_processGetRsc(void) {
 			else {
 				LOTRACE_INF(
 						"PROCESS PENDING RESOURCE %s - cid=%"PRIi32" retry=%d offset=%"PRIu32" => connect to %s ...",
-						_LOClient_Set_UpdatedRsc.ursc_obj_ptr->rsc_name, _LOClient_Set_UpdatedRsc.ursc_cid,
-						_LOClient_Set_UpdatedRsc.ursc_retry, _LOClient_Set_UpdatedRsc.ursc_offset,
-						_LOClient_Set_UpdatedRsc.ursc_uri);
-				rc = LO_wget_start(_LOClient_Set_UpdatedRsc.ursc_uri, _LOClient_Set_UpdatedRsc.ursc_size,
-						_LOClient_Set_UpdatedRsc.ursc_offset);
+						loc->Set_UpdatedRsc.ursc_obj_ptr->rsc_name, loc->Set_UpdatedRsc.ursc_cid,
+						loc->Set_UpdatedRsc.ursc_retry, loc->Set_UpdatedRsc.ursc_offset,
+						loc->Set_UpdatedRsc.ursc_uri);
+				rc = LO_wget_start(&loc->wget, loc->Set_UpdatedRsc.ursc_uri, loc->Set_UpdatedRsc.ursc_size,
+						loc->Set_UpdatedRsc.ursc_offset);
 				if (rc == 0) {
 					LOTRACE_NOTICE("PROCESS RESOURCE %s - cid=%"PRIi32"  uri='%s'",
-							_LOClient_Set_UpdatedRsc.ursc_obj_ptr->rsc_name, _LOClient_Set_UpdatedRsc.ursc_cid,
-							_LOClient_Set_UpdatedRsc.ursc_uri);
-					_LOClient_Set_UpdatedRsc.ursc_connected = 1;
-					if (_LOClient_Set_UpdatedRsc.ursc_offset == 0) {
+							loc->Set_UpdatedRsc.ursc_obj_ptr->rsc_name, loc->Set_UpdatedRsc.ursc_cid,
+							loc->Set_UpdatedRsc.ursc_uri);
+					loc->Set_UpdatedRsc.ursc_connected = 1;
+					if (loc->Set_UpdatedRsc.ursc_offset == 0) {
 #if LOC_FEATURE_MBEDTLS
-						mbedtls_md5_init(&_LOClient_Set_UpdatedRsc.md5_ctx);
-						mbedtls_md5_starts(&_LOClient_Set_UpdatedRsc.md5_ctx);
+						mbedtls_md5_init(&loc->Set_UpdatedRsc.md5_ctx);
+						mbedtls_md5_starts(&loc->Set_UpdatedRsc.md5_ctx);
 #else
-						memset(&_LOClient_Set_UpdatedRsc.md5_ctx,0,sizeof(_LOClient_Set_UpdatedRsc.md5_ctx));
+						memset(&loc->Set_UpdatedRsc.md5_ctx,0,sizeof(loc->Set_UpdatedRsc.md5_ctx));
 #endif
 					}
 				}
@@ -764,32 +1185,32 @@ static int LOCC_processGetRsc(void) {
 		else {
 			LOTRACE_NOTICE(
 					"PROCESS PENDING RESOURCE cid=%"PRIi32" - %s => NO USER Callback => ABORT !!",
-					_LOClient_Set_UpdatedRsc.ursc_cid, _LOClient_Set_UpdatedRsc.ursc_obj_ptr->rsc_name);
+					loc->Set_UpdatedRsc.ursc_cid, loc->Set_UpdatedRsc.ursc_obj_ptr->rsc_name);
 		}
 
 		if (rc < 0) {
-			if (_LOClient_Set_UpdatedRsc.ursc_connected) {
+			if (loc->Set_UpdatedRsc.ursc_connected) {
 				LOTRACE_DBG1("close TCP connection used for HTTP GET");
-				LO_wget_close();
-				if ((rc == -50) && (_LOClient_Set_UpdatedRsc.ursc_retry < 4)) {
-					_LOClient_Set_UpdatedRsc.ursc_retry++;
-					_LOClient_Set_UpdatedRsc.ursc_connected = 0;
+				LO_wget_close(&loc->wget);
+				if ((rc == -50) && (loc->Set_UpdatedRsc.ursc_retry < 4)) {
+					loc->Set_UpdatedRsc.ursc_retry++;
+					loc->Set_UpdatedRsc.ursc_connected = 0;
 					LOTRACE_NOTICE("retry=%u => partial content from %"PRIu32,
-							_LOClient_Set_UpdatedRsc.ursc_retry, _LOClient_Set_UpdatedRsc.ursc_offset);
+							loc->Set_UpdatedRsc.ursc_retry, loc->Set_UpdatedRsc.ursc_offset);
 					return 0;
 				}
 #if LOC_FEATURE_MBEDTLS
 				LOTRACE_DBG1("Free MD5 Context");
-				mbedtls_md5_free(&_LOClient_Set_UpdatedRsc.md5_ctx);
+				mbedtls_md5_free(&loc->Set_UpdatedRsc.md5_ctx);
 #endif
 			}
 
-			_LOClient_Set_UpdatedRsc.ursc_cid = 0;
-			_LOClient_Set_UpdatedRsc.ursc_obj_ptr = NULL;
-			_LOClient_Set_UpdatedRsc.ursc_connected = 0;
-			_LOClient_Set_UpdatedRsc.ursc_retry = 0;
+			loc->Set_UpdatedRsc.ursc_cid = 0;
+			loc->Set_UpdatedRsc.ursc_obj_ptr = NULL;
+			loc->Set_UpdatedRsc.ursc_connected = 0;
+			loc->Set_UpdatedRsc.ursc_retry = 0;
 
-			_LOClient_Set_Rsc.pushtoLOServer = 1;
+			loc->Set_Rsc.pushtoLOServer = 1;
 		}
 	}
 
@@ -800,67 +1221,67 @@ static int LOCC_processGetRsc(void) {
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_PARAMS
-static int LOCC_processConfig(void) {
+static int LOCC_processConfig(LiveObjectsClient_t* loc) {
 	int rc = 0;
 
-	if (_LOClient_Set_Params.param_set.param_ptr) {
+	if (loc->Set_Params.param_set.param_ptr) {
 		const char* pMsg;
 
-		if (_LOClient_Set_UpdatedParams.cid) {
-			if ((_LOClient_Set_UpdatedParams.nb_of_params) && (_LOClient_Set_UpdatedParams.tab_of_param_ptr[0])) {
+		if (loc->Set_UpdatedParams.cid) {
+			if ((loc->Set_UpdatedParams.nb_of_params) && (loc->Set_UpdatedParams.tab_of_param_ptr[0])) {
 				LOTRACE_INF("cid=%"PRIi32" => PUBLISH CFG_UPDATE response...",
-						_LOClient_Set_UpdatedParams.cid);
-				pMsg = LO_msg_encode_params_update(&_LOClient_Set_UpdatedParams);
+						loc->Set_UpdatedParams.cid);
+				pMsg = LO_msg_encode_params_update(&loc->Set_UpdatedParams);
 				if (pMsg) {
-					rc = LOCC_MqttPublish(QOS0, "dev/cfg", pMsg);
+					rc = LOCC_MqttPublish(loc, QOS0, "dev/cfg", pMsg);
 					if (rc == 0) {
-						_LOClient_Set_UpdatedParams.cid = 0;
+						loc->Set_UpdatedParams.cid = 0;
 					}
 				}
 				else {
-					_LOClient_Set_UpdatedParams.cid = 0;
+					loc->Set_UpdatedParams.cid = 0;
 				}
 			}
 			else {
 				LOTRACE_INF("EMPTY => PUBLISH all CFG parameters with cid=%"PRIi32" ...",
-						_LOClient_Set_UpdatedParams.cid);
-				pMsg = LO_msg_encode_params_all(0, &_LOClient_Set_Params.param_set, _LOClient_Set_UpdatedParams.cid);
+						loc->Set_UpdatedParams.cid);
+				pMsg = LO_msg_encode_params_all(0, &loc->Set_Params.param_set, loc->Set_UpdatedParams.cid);
 				if (pMsg) {
-					rc = LOCC_MqttPublish(QOS0, "dev/cfg", pMsg);
+					rc = LOCC_MqttPublish(loc, QOS0, "dev/cfg", pMsg);
 					if (rc == 0) {
-						_LOClient_Set_UpdatedParams.cid = 0;
+						loc->Set_UpdatedParams.cid = 0;
 					}
 				}
 				else {
-					_LOClient_Set_UpdatedParams.cid = 0;
+					loc->Set_UpdatedParams.cid = 0;
 				}
 			}
 		}
 
-		if ((_LOClient_cfg_first)
+		if ((loc->cfg_first)
 #if LOM_PUSH_FLAG
-				|| (_LOClient_Set_Params.pushtoLOServer)
+				|| (loc->Set_Params.pushtoLOServer)
 #endif
 				) {
 #if LOM_PUSH_FLAG
-			LOTRACE_INF("first=%d  push=%d => PUBLISH CFG parameters ...", _LOClient_cfg_first,
-					_LOClient_Set_Params.pushtoLOServer);
+			LOTRACE_INF("first=%d  push=%d => PUBLISH CFG parameters ...", loc->cfg_first,
+					loc->Set_Params.pushtoLOServer);
 #endif
-			pMsg = LO_msg_encode_params_all(0, &_LOClient_Set_Params.param_set, 0);
+			pMsg = LO_msg_encode_params_all(0, &loc->Set_Params.param_set, 0);
 			if (pMsg) {
-				rc = LOCC_MqttPublish(QOS0, "dev/cfg", pMsg);
+				rc = LOCC_MqttPublish(loc, QOS0, "dev/cfg", pMsg);
 				if (rc == 0) {
 #if LOM_PUSH_FLAG
-					_LOClient_Set_Params.pushtoLOServer = 0;
+					loc->Set_Params.pushtoLOServer = 0;
 #endif
-					if (_LOClient_cfg_first) {
+					if (loc->cfg_first) {
 #if 1
-						rc = LOCC_SubscibeTopic(TOPIC_CFG_UPD);
+						rc = LOCC_SubscibeTopic(loc, TOPIC_CFG_UPD);
 						if (rc == 0) {
-							_LOClient_cfg_first = 0;
+							loc->cfg_first = 0;
 						}
 #else
-						_LOClient_cfg_first = 0;
+						loc->cfg_first = 0;
 #endif
 					}
 				}
@@ -874,22 +1295,23 @@ static int LOCC_processConfig(void) {
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOM_PUSH_ASYNC &&  LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
-static int LOCC_processData(uint8_t force)
+static int LOCC_processData(LiveObjectsClient_t* loc, uint8_t force)
 {
 	int rc = 0;
 	int data_hdl;
 	for (data_hdl=0; data_hdl < LOC_MAX_OF_DATA_SET; data_hdl++) {
-		LOMSetOfData_t* p_dataSet = &_LOClient_Set_Data[data_hdl];
+		LOMSetOfData_t* p_dataSet = &loc->Set_Data[data_hdl];
 		if ((p_dataSet->data_set.data_ptr) && ((force) || p_dataSet->pushtoLOServer)) {
 			const char* pMsg;
+			uint32_t len;
 			p_dataSet->pushtoLOServer = 1;
 			LOTRACE_INF("LOCC_processData: force=%d  pushtoLom=%d => PUBLISH DATA ...", force , p_dataSet->pushtoLOServer);
 			/* TODO: set timestamp only tif the board has the good date/time  !
-			 * tbx_GetDateTimeStr(_LOClient_Set_Data.timestamp, sizeof(_LOClient_Set_Data.timestamp));
+			 * tbx_GetDateTimeStr(loc->Set_Data.timestamp, sizeof(loc->Set_Data.timestamp));
 			 */
-			pMsg = LO_msg_encode_data(0, p_dataSet);
+			pMsg = LO_msg_encode_data(0, p_dataSet, &len);
 			if (pMsg) {
-				rc = LOCC_MqttPublish(QOS0, "dev/data", pMsg);
+				rc = LOCC_MqttPublishLen(loc, QOS0, "dev/data", pMsg, len);
 				if (rc == 0) {
 					p_dataSet->pushtoLOServer = 0;
 				}
@@ -903,158 +1325,589 @@ static int LOCC_processData(uint8_t force)
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOM_MQUEUE
-static void LOCC_processPendingMesssage() {
+static void LOCC_processPendingMesssage(LiveObjectsClient_t* loc) {
 	const char* p_msg;
-	while ((p_msg = LOCC_mqGet()) != NULL) {
-		if (*p_msg == MTYPE_PUB_DATA) {
-			LOTRACE_DBG1("Publish DATA  %p...", p_msg);
-			LOCC_MqttPublish(QOS0, "dev/data", p_msg + 1);
-		}
-		else if (*p_msg == MTYPE_PUB_CMD_RSP) {
-			LOTRACE_INF("Publish Command Response %p...", p_msg);
-			LOCC_MqttPublish(QOS0, "dev/cmd/res", p_msg + 1);
-		}
-		else if (*p_msg == MTYPE_PUB_STATUS) {
-			LOTRACE_INF("Publish STATUS  %p...", p_msg);
-			LOCC_MqttPublish(QOS0, "dev/info", p_msg + 1);
-		}
-		else if (*p_msg == MTYPE_PUB_PARAM) {
-			LOTRACE_INF("Publish PARAMS  %p...", p_msg);
-			LOCC_MqttPublish(QOS0, "dev/cfg", p_msg + 1);
-		}
-		else if (*p_msg == MTYPE_PUB_RSC) {
-			LOTRACE_INF("Publish RESOURCES  %p...", p_msg);
-			LOCC_MqttPublish(QOS0, "dev/rsc", p_msg + 1);
-		}
-		else if (*p_msg == MTYPE_PUB_USR_MSG) {
-			const char* pc = p_msg + 1;
-			short tlen;
-			memcpy((char*) &tlen, pc, 2);
-			if (tlen > 0) {
-				pc += 2;
-				LOTRACE_INF("Publish t=%s msg='%s' ...", pc, pc + tlen + 1);
-				LOCC_MqttPublish(QOS0, pc, pc + tlen + 1);
-			}
+	/* A burst of messages is sent in one write */
+	netw_batchStart(&loc->MQTTClient_network);
+	while (1) {
+		p_msg = loc->inflight_next;
+		if (p_msg) {
+			loc->inflight_next = NULL;
 		}
-		else {
-			LOTRACE_ERR("ERROR -  UNKNOW msg %p x%x", p_msg, *p_msg);
+		else if ((p_msg = LOCC_mqGet(loc)) == NULL) {
+			break;
+		}
+		if (LOM_MSG_HDR(p_msg)->qos) {
+			if (loc->inflight_nb >= LOC_MQTT_INFLIGHT_MAX) {
+				/* Window full: wait for a PUBACK, the next messages keep their order */
+				LOTRACE_DBG1("In-flight window full, msg %p waits", p_msg);
+				loc->inflight_next = p_msg;
+				break;
+			}
+			LOTRACE_DBG1("Publish QoS 1 msg %p x%x...", p_msg, *p_msg);
+			LOCC_inflightPublish(loc, p_msg);
+			continue;
 		}
-		LOTRACE_DBG1("MEM_FREE msg %p x%x", p_msg, *p_msg);
-		MEM_FREE(p_msg);
+		LOTRACE_DBG1("Publish msg %p x%x...", p_msg, *p_msg);
+		LOCC_MqttPublishMsg(loc, p_msg, 0, 0);
+		LOTRACE_DBG1("release msg %p x%x", p_msg, *p_msg);
+		LO_mpool_free(p_msg);
+	}
+	if (netw_batchFlush(&loc->MQTTClient_network)) {
+		LOTRACE_ERR("Failed to send the pending messages");
 	}
 }
 #endif
+
+#if LOCC_STORE
 /* --------------------------------------------------------------------------------- */
-/*  */
-static int LOCC_setStreamId(uint8_t stream_prefix, LOMSetOfData_t* p_dataSet, const char* stream_id) {
-	if (stream_prefix == 1) {
-		int len = snprintf(p_dataSet->stream_id, sizeof(p_dataSet->stream_id) - 1, "urn:lo:nsid:%s:%s!%s",
-				_LOClient_dev_name_space, _LOClient_dev_id, stream_id);
-		if (len > 0) {
-			p_dataSet->stream_id[len] = 0;
-		}
-	}
-	else if (stream_prefix == 2) {
-		int len = snprintf(p_dataSet->stream_id, sizeof(p_dataSet->stream_id) - 1, "%s:%s!%s", _LOClient_dev_name_space,
-				_LOClient_dev_id, stream_id);
-		if (len > 0)
-			p_dataSet->stream_id[len] = 0;
-	}
-	else {
-		size_t len = strlen(stream_id);
-		memset(p_dataSet->stream_id, 0, sizeof(p_dataSet->stream_id));
-		memcpy(p_dataSet->stream_id, stream_id,
-				len < sizeof(p_dataSet->stream_id) ? len : sizeof(p_dataSet->stream_id));
-		p_dataSet->stream_id[sizeof(p_dataSet->stream_id) - 1] = 0;
-	}
-	return 0;
+/* Data messages are saved in the store when disconnected, or while older messages are
+ * not yet replayed (to keep the order) */
+static uint8_t LOCC_storeUsed(LiveObjectsClient_t* loc) {
+	return (loc->store) && ((!loc->state_connected) || (LO_store_backlog(loc->store)));
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-static void LOCC_controlFeature(uint8_t* enable_ptr, int topic_num) {
-	int ret;
-	if (*enable_ptr == 0x01) {
-		LOTRACE_INF("LOCC_controlFeature: ENABLE topic_num=%d", topic_num);
-		ret = LOCC_SubscibeTopic(topic_num);
-		if (ret == 0) {
-			LOTRACE_NOTICE("LOCC_controlFeature: OK to enable topic_num=%d", topic_num);
-			*enable_ptr = 0x11;
-		}
-	}
-	else if (*enable_ptr == 0x10) {
-		LOTRACE_NOTICE("LOCC_controlFeature: DISABLE topic_num=%d", topic_num);
-		ret = LOCC_UnsubscibeTopic(topic_num);
-		if (ret == 0) {
-			*enable_ptr = 0x00;
-		}
+/* Save a data message (of the pool, released) in the store */
+static int LOCC_storeAppend(LiveObjectsClient_t* loc, const char* p_msg) {
+	int ret = LO_store_append(loc->store, MTYPE_PUB_DATA, LOM_MSG_PAYLOAD(p_msg), LOM_MSG_HDR(p_msg)->payload_len);
+	LO_mpool_free(p_msg);
+	if (ret == 0) {
+		LO_sys_eventSignal(loc->event);
 	}
+	return ret;
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-static void LOCC_connectInit(uint8_t mode) {
-	_LOClient_cfg_first = 1;
-	if (mode == 0) {
-		_LOClient_TopicSub[TOPIC_CFG_UPD].subscribed = 0;
-		_LOClient_TopicSub[TOPIC_COMMAND].subscribed = 0;
-		_LOClient_TopicSub[TOPIC_RSC_UPD].subscribed = 0;
-
-#if LOC_FEATURE_LO_PARAMS
-		memset(&_LOClient_Set_UpdatedParams, 0, sizeof(_LOClient_Set_UpdatedParams));
-#endif
-#if LOM_MQUEUE
-		LOCC_mqPurge();
-#endif /* LOM_MQUEUE */
+/* Time (in ms) before the next stored message can be published */
+static int32_t LOCC_storeWaitMs(LiveObjectsClient_t* loc) {
+	uint64_t now = LO_sys_timeUs();
+	if (now + LOCC_STORE_BURST_US >= loc->store_next_us) {
+		return 0;
 	}
+	return (int32_t) ((loc->store_next_us - LOCC_STORE_BURST_US - now + 999) / 1000);
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-static int LOCC_connectStart(void) {
+/* Publish the stored data messages, in order, at most LOC_STORE_REPLAY_RATE per second
+ * (and LOC_STORE_REPLAY_BURST at once) */
+static void LOCC_processStore(LiveObjectsClient_t* loc) {
+	char* p_msg;
+	uint8_t type;
+	int len;
+	uint64_t now;
+
+	if ((loc->store == NULL) || (LO_store_backlog(loc->store) == 0)) {
+		return;
+	}
+	while ((loc->state_connected) && (LOCC_storeWaitMs(loc) == 0)) {
+		p_msg = LO_mpool_alloc(LOM_MSG_PAYLOAD_OFFSET + LOM_JSON_BUF_USER_SZ);
+		if (p_msg == NULL) {
+			LOTRACE_ERR("LOCC_processStore: ERROR alloc");
+			break;
+		}
+		memset(p_msg, 0, sizeof(LOMsgHeader_t));
+		LOM_MSG_HDR(p_msg)->payload_offset = LOM_MSG_PAYLOAD_OFFSET;
+		len = LO_store_read(loc->store, &type, p_msg + LOM_MSG_PAYLOAD_OFFSET, LOM_JSON_BUF_USER_SZ);
+		if (len == 0) {
+			LO_mpool_free(p_msg);
+			break;
+		}
+		if (len > 0) {
+			LOM_MSG_HDR(p_msg)->msg_type = type;
+			LOM_MSG_HDR(p_msg)->payload_len = (uint32_t) len;
+			if (LOCC_MqttPublishMsg(loc, p_msg, 0, 0)) {
+				/* Connection lost ? kept in the store */
+				LO_mpool_free(p_msg);
+				break;
+			}
+		}
+		else {
+			LOTRACE_ERR("LOCC_processStore: record too long, skipped");
+		}
+		LO_mpool_free(p_msg);
+		LO_store_consume(loc->store);
+
+		now = LO_sys_timeUs();
+		if (loc->store_next_us < now) {
+			loc->store_next_us = now;
+		}
+		loc->store_next_us += LOCC_STORE_INTERVAL_US;
+	}
+}
+#endif /* LOCC_STORE */
+
+#if LOCC_BATCH
+/* --------------------------------------------------------------------------------- */
+/* Publish a message of a batch (detached from the batch, its mutex not locked) */
+static void LOCC_batchPublish(LiveObjectsClient_t* loc, LOCCBatch_t* batch, LOCCBatchMsg_t* msg) {
+	const char* p_msg;
+	uint32_t len;
+	int ret = -1;
+
+	if (msg->nb == 0) {
+		LO_mpool_free(msg->p_msg);
+		return;
+	}
+	p_msg = LO_msg_batch_end(msg->p_msg, &msg->jw);
+	if (p_msg) {
+		len = LOM_MSG_HDR(p_msg)->payload_len;
+#if LOCC_STORE
+		if (LOCC_storeUsed(loc)) {
+			ret = LOCC_storeAppend(loc, p_msg);
+		}
+		else
+#endif
+		if ((loc->state_connected) && (LOCC_threadIsClient(loc))) {
+			/* Linger time elapsed: publish now, after the messages already queued */
+			LOCC_processPendingMesssage(loc);
+			ret = LOCC_MqttPublishMsg(loc, p_msg, 0, 0);
+			LO_mpool_free(p_msg);
+		}
+		else if (loc->state_connected) {
+			ret = LOCC_mqPut(loc, p_msg);
+			if (ret) {
+				LO_mpool_free(p_msg);
+			}
+		}
+		else {
+			LO_mpool_free(p_msg);
+		}
+	}
+	if (ret) {
+		LOTRACE_ERR("ERROR while publishing a batch of %"PRIu32" samples !", msg->nb);
+		LO_ATOMIC_ADD(&batch->stats.bt_dropped, msg->nb);
+		return;
+	}
+	LO_ATOMIC_ADD(&batch->stats.bt_messages, 1);
+	LO_ATOMIC_ADD(&batch->stats.bt_samples, msg->nb);
+	LO_ATOMIC_ADD(&batch->stats.bt_bytes, len);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Add a sample (current values of the data set) to its batch. The message is published when it
+ * holds batch_size samples, or when the next sample may not fit in it */
+static int LOCC_batchPush(LiveObjectsClient_t* loc, int data_hdl) {
+	LOCCBatch_t* batch = &loc->batch[data_hdl];
+	LOMSetOfData_t* p_dataSet = &loc->Set_Data[data_hdl];
+	LOCCBatchMsg_t out;
+	uint8_t first = 0;
+	int len = -1;
+
+	out.p_msg = NULL;
+	LO_sys_mutexLock(batch->mutex);
+	if ((batch->cur.p_msg) && (LO_msg_batch_room(&batch->cur.jw) < batch->sample_max)) {
+		out = batch->cur;
+		batch->cur.p_msg = NULL;
+		LO_ATOMIC_ADD(&batch->stats.bt_by_room, 1);
+	}
+	while (1) {
+		if (batch->cur.p_msg == NULL) {
+			batch->cur.p_msg = LO_msg_batch_begin(MTYPE_PUB_DATA, p_dataSet, &batch->cur.jw);
+			if (batch->cur.p_msg == NULL) {
+				break;
+			}
+			batch->cur.nb = 0;
+			batch->cur.first_us = LO_sys_timeUs();
+			first = 1;
+		}
+		len = LO_msg_batch_add(&batch->cur.jw, p_dataSet);
+		if ((len >= 0) || (batch->cur.nb == 0) || (out.p_msg)) {
+			break;
+		}
+		/* Larger than the previous samples, published in the next message */
+		out = batch->cur;
+		batch->cur.p_msg = NULL;
+		LO_ATOMIC_ADD(&batch->stats.bt_by_room, 1);
+	}
+	if (len >= 0) {
+		batch->cur.nb++;
+		if ((uint32_t) len > batch->sample_max) {
+			batch->sample_max = (uint32_t) len;
+		}
+		if ((batch->cur.nb >= batch->size) && (out.p_msg == NULL)) {
+			out = batch->cur;
+			batch->cur.p_msg = NULL;
+		}
+	}
+	LO_sys_mutexUnlock(batch->mutex);
+
+	if (out.p_msg) {
+		LOCC_batchPublish(loc, batch, &out);
+	}
+	if (len < 0) {
+		LOTRACE_ERR("ERROR - sample of data_hdl=%d not batched", data_hdl);
+		LO_ATOMIC_ADD(&batch->stats.bt_dropped, 1);
+		return -1;
+	}
+	if (first) {
+		/* The client thread publishes the message after linger_ms */
+		LO_sys_eventSignal(loc->event);
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Detach the message of a batch to be published now, or in *p_wait_ms */
+static uint8_t LOCC_batchExpired(LOCCBatch_t* batch, uint64_t now, int32_t* p_wait_ms, LOCCBatchMsg_t* out) {
+	uint64_t end_us;
+	uint8_t expired = 0;
+
+	LO_sys_mutexLock(batch->mutex);
+	if ((batch->size) && (batch->cur.p_msg) && (batch->cur.nb)) {
+		end_us = batch->cur.first_us + (uint64_t) batch->linger_ms * 1000;
+		if (end_us <= now) {
+			if (out) {
+				*out = batch->cur;
+				batch->cur.p_msg = NULL;
+				expired = 1;
+			}
+			else if (p_wait_ms) {
+				*p_wait_ms = 0;
+			}
+		}
+		else if ((p_wait_ms) && ((end_us - now + 999) / 1000 < (uint64_t) *p_wait_ms)) {
+			*p_wait_ms = (int32_t) ((end_us - now + 999) / 1000);
+		}
+	}
+	LO_sys_mutexUnlock(batch->mutex);
+	return expired;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Publish the batches waiting for more than their linger time */
+static void LOCC_processBatch(LiveObjectsClient_t* loc) {
+	LOCCBatchMsg_t out;
+	uint64_t now = LO_sys_timeUs();
+	int i;
+
+	for (i = 0; i < LOC_MAX_OF_DATA_SET; i++) {
+		if ((loc->batch[i].size) && (LOCC_batchExpired(&loc->batch[i], now, NULL, &out))) {
+			LO_ATOMIC_ADD(&loc->batch[i].stats.bt_by_linger, 1);
+			LOCC_batchPublish(loc, &loc->batch[i], &out);
+		}
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Time (in ms) before the next batch has to be published */
+static int32_t LOCC_batchWaitMs(LiveObjectsClient_t* loc, int32_t tmo_ms) {
+	uint64_t now = LO_sys_timeUs();
+	int i;
+
+	for (i = 0; i < LOC_MAX_OF_DATA_SET; i++) {
+		if (loc->batch[i].size) {
+			LOCC_batchExpired(&loc->batch[i], now, &tmo_ms, NULL);
+		}
+	}
+	return tmo_ms;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Release the message being filled (samples lost) */
+static void LOCC_batchRelease(LOCCBatch_t* batch) {
+	if (batch->mutex == NULL) {
+		/* Instance not initialized */
+		return;
+	}
+	LO_sys_mutexLock(batch->mutex);
+	if (batch->cur.p_msg) {
+		LO_ATOMIC_ADD(&batch->stats.bt_dropped, batch->cur.nb);
+		LO_mpool_free(batch->cur.p_msg);
+		batch->cur.p_msg = NULL;
+	}
+	LO_sys_mutexUnlock(batch->mutex);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Data set removed: no more batching (the mutex is kept) */
+static void LOCC_batchReset(LOCCBatch_t* batch) {
+	LOSysMutex_t* mutex = batch->mutex;
+	LOCC_batchRelease(batch);
+	memset(batch, 0, sizeof(LOCCBatch_t));
+	batch->mutex = mutex;
+}
+#endif /* LOCC_BATCH */
+
+#if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
+/* --------------------------------------------------------------------------------- */
+/* Status set removed: encode plan and shadow released (the mutex is kept) */
+static void LOCC_statusReset(LOMSetOfStatus_t* p_statusSet) {
+	LOSysMutex_t* mutex = p_statusSet->mutex;
+	LO_msg_plan_release(&p_statusSet->data_set);
+	LO_msg_shadow_release(&p_statusSet->shadow);
+	memset(p_statusSet, 0, sizeof(LOMSetOfStatus_t));
+	p_statusSet->mutex = mutex;
+}
+#endif
+
+/* --------------------------------------------------------------------------------- */
+/* Release what is allocated for the status and data sets: encode plans, shadows, batches */
+static void LOCC_setsRelease(LiveObjectsClient_t* loc) {
+#if LOCC_BATCH
+	{
+		int i;
+		for (i = 0; i < LOC_MAX_OF_DATA_SET; i++) {
+			LOCC_batchReset(&loc->batch[i]);
+		}
+	}
+#endif
+#if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
+	{
+		int i;
+		for (i = 0; i < LOC_MAX_OF_STATUS_SET; i++) {
+			LOCC_statusReset(&loc->Set_Status[i]);
+		}
+	}
+#endif
+#if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
+	{
+		int i;
+		for (i = 0; i < LOC_MAX_OF_DATA_SET; i++) {
+			LO_msg_plan_release(&loc->Set_Data[i].data_set);
+		}
+	}
+#endif
+	(void) loc;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LOCC_setStreamId(LiveObjectsClient_t* loc, uint8_t stream_prefix, LOMSetOfData_t* p_dataSet, const char* stream_id) {
+	if (stream_prefix == 1) {
+		int len = snprintf(p_dataSet->stream_id, sizeof(p_dataSet->stream_id) - 1, "urn:lo:nsid:%s:%s!%s",
+				loc->dev_name_space, loc->dev_id, stream_id);
+		if (len > 0) {
+			p_dataSet->stream_id[len] = 0;
+		}
+	}
+	else if (stream_prefix == 2) {
+		int len = snprintf(p_dataSet->stream_id, sizeof(p_dataSet->stream_id) - 1, "%s:%s!%s", loc->dev_name_space,
+				loc->dev_id, stream_id);
+		if (len > 0)
+			p_dataSet->stream_id[len] = 0;
+	}
+	else {
+		size_t len = strlen(stream_id);
+		memset(p_dataSet->stream_id, 0, sizeof(p_dataSet->stream_id));
+		memcpy(p_dataSet->stream_id, stream_id,
+				len < sizeof(p_dataSet->stream_id) ? len : sizeof(p_dataSet->stream_id));
+		p_dataSet->stream_id[sizeof(p_dataSet->stream_id) - 1] = 0;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void LOCC_controlFeature(LiveObjectsClient_t* loc, uint8_t* enable_ptr, int topic_num) {
+	int ret;
+	if (*enable_ptr == 0x01) {
+		LOTRACE_INF("LOCC_controlFeature: ENABLE topic_num=%d", topic_num);
+		ret = LOCC_SubscibeTopic(loc, topic_num);
+		if (ret == 0) {
+			LOTRACE_NOTICE("LOCC_controlFeature: OK to enable topic_num=%d", topic_num);
+			*enable_ptr = 0x11;
+		}
+	}
+	else if (*enable_ptr == 0x10) {
+		LOTRACE_NOTICE("LOCC_controlFeature: DISABLE topic_num=%d", topic_num);
+		ret = LOCC_UnsubscibeTopic(loc, topic_num);
+		if (ret == 0) {
+			*enable_ptr = 0x00;
+		}
+	}
+}
+
+/* ================================================================================= */
+/* Reconnection scheduler
+ */
+/* --------------------------------------------------------------------------------- */
+/* Delay before the next connection attempt: none for the first one, then exponential
+ * backoff up to retry_max_ms, with a jitter (half of the delay is random) so that the
+ * devices disconnected at the same time do not reconnect at the same time */
+static uint32_t LOCC_retryDelay(LiveObjectsClient_t* loc) {
+	uint32_t n = loc->retry_attempt++;
+	uint32_t delay;
+
+	if (n == 0) {
+		return 0;
+	}
+	for (delay = loc->retry_base_ms; (n > 1) && (delay < loc->retry_max_ms); n--) {
+		delay = (delay > loc->retry_max_ms / 2) ? loc->retry_max_ms : delay * 2;
+	}
+	if (delay > loc->retry_max_ms) {
+		delay = loc->retry_max_ms;
+	}
+
+	/* xorshift32 */
+	if (loc->retry_seed == 0) {
+		loc->retry_seed = ((uint32_t) (uintptr_t) loc ^ (uint32_t) LO_sys_timeUs()) | 1;
+	}
+	loc->retry_seed ^= loc->retry_seed << 13;
+	loc->retry_seed ^= loc->retry_seed >> 17;
+	loc->retry_seed ^= loc->retry_seed << 5;
+	return (delay / 2) + (loc->retry_seed % (delay / 2 + 1));
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Set the time of the next connection attempt */
+static uint32_t LOCC_retrySchedule(LiveObjectsClient_t* loc) {
+	uint32_t delay = LOCC_retryDelay(loc);
+	TimerCountdownMS(&loc->retry_timer, delay);
+	loc->retry_stats.rc_next_ms = delay;
+	if (delay) {
+		LOTRACE_NOTICE("Next connection attempt in %"PRIu32" milliseconds ...", delay);
+	}
+	return delay;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Connection lost: the first attempt is done at once if the connection was stable
+ * (otherwise the backoff goes on, the server may close each new connection) */
+static void LOCC_retryDown(LiveObjectsClient_t* loc) {
+	uint64_t now = LO_sys_timeUs();
+	if ((now - loc->retry_up_us) >= (uint64_t) LOC_MQTT_API_KEEPALIVEINTERVAL_SEC * 1000000) {
+		loc->retry_attempt = 0;
+	}
+	loc->retry_down_us = now;
+	/* Wake up when a network interface comes back */
+	LO_sys_eventNetwork(loc->event, 1);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Connected: time to reconnect */
+static void LOCC_retryUp(LiveObjectsClient_t* loc) {
+	uint64_t now = LO_sys_timeUs();
+	LiveObjectsD_ReconnectStats_t* st = &loc->retry_stats;
+
+	loc->retry_up_us = now;
+	loc->retry_now = 0;
+	st->rc_next_ms = 0;
+	LO_sys_eventNetwork(loc->event, 0);
+	if (loc->retry_down_us) {
+		uint32_t ms = (uint32_t) ((now - loc->retry_down_us) / 1000);
+		uint32_t i;
+		for (i = 0; (i < LOD_RECONNECT_HIST_NB - 1) && (ms >= (125U << i)); i++) {
+		}
+		st->rc_hist[i]++;
+		st->rc_reconnects++;
+		st->rc_last_ms = ms;
+		if (ms > st->rc_max_ms) {
+			st->rc_max_ms = ms;
+		}
+		loc->retry_down_us = 0;
+		LOTRACE_INF("Reconnected in %"PRIu32" milliseconds", ms);
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Network back (or connection attempt forced): the next attempt is done at once */
+static uint8_t LOCC_retryWakeUp(LiveObjectsClient_t* loc, int events) {
+	if ((loc->retry_now) || ((events > 0) && (events & LO_SYS_EVENT_NETW))) {
+		LOTRACE_NOTICE("Network changed: connection attempt now");
+		loc->retry_now = 0;
+		return 1;
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Wait for the next connection attempt (LiveObjectsInstance_Run) */
+static void LOCC_retryWait(LiveObjectsClient_t* loc) {
+	int events;
+	if (LOCC_retrySchedule(loc) == 0) {
+		return;
+	}
+	while ((loc->state_run > 0) && (!TimerIsExpired(&loc->retry_timer))) {
+		events = LO_sys_eventWait(loc->event, TimerLeftMS(&loc->retry_timer));
+		if (LOCC_retryWakeUp(loc, events)) {
+			break;
+		}
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void LOCC_connectInit(LiveObjectsClient_t* loc, uint8_t mode) {
+	loc->cfg_first = 1;
+	if (mode == 0) {
+		loc->TopicSub[TOPIC_CFG_UPD].subscribed = 0;
+		loc->TopicSub[TOPIC_COMMAND].subscribed = 0;
+		loc->TopicSub[TOPIC_RSC_UPD].subscribed = 0;
+
+#if LOC_FEATURE_LO_PARAMS
+		memset(&loc->Set_UpdatedParams, 0, sizeof(loc->Set_UpdatedParams));
+#endif
+#if LOM_MQUEUE
+		LOCC_mqPurge(loc);
+#endif /* LOM_MQUEUE */
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LOCC_connectStart(LiveObjectsClient_t* loc) {
+	LiveObjectsD_ReconnectStats_t* st = &loc->retry_stats;
+	uint64_t start_us;
 	int rc;
 
-	rc = netw_connect(&_LOClient_MQTTClient_network, &_LOClient_params_connect);
+	st->rc_attempts++;
+	st->rc_mqtt_ms = 0;
+	rc = netw_connect(&loc->MQTTClient_network, &loc->params_connect);
+	netw_getConnectTimes(&loc->MQTTClient_network, &st->rc_dns_ms, &st->rc_tcp_ms, &st->rc_tls_ms);
 	if (rc) {
 		LOTRACE_ERR("Connection failed, rc=%d", rc);
+		loc->retry_stats.rc_failures++;
 		return rc;
 	}
 
-	rc = LOCC_MqttConnect();
+	start_us = LO_sys_timeUs();
+	rc = LOCC_MqttConnect(loc);
+	st->rc_mqtt_ms = (uint32_t) ((LO_sys_timeUs() - start_us) / 1000);
+	LOTRACE_INF("Connection times: DNS %"PRIu32" ms, TCP %"PRIu32" ms, TLS %"PRIu32" ms, MQTT %"PRIu32" ms",
+			st->rc_dns_ms, st->rc_tcp_ms, st->rc_tls_ms, st->rc_mqtt_ms);
 	if (rc) {
 		LOTRACE_ERR("MqttConnect failed, rc=%d", rc);
+		loc->retry_stats.rc_failures++;
 		return rc;
 	}
 
+	LOCC_retryUp(loc);
 	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-static void LOCC_connectOK(void) {
+static void LOCC_connectOK(LiveObjectsClient_t* loc) {
 	int ret;
+#if LOM_MQUEUE
+	if (loc->inflight_nb) {
+		LOTRACE_DBG1("In-flight messages: %u", loc->inflight_nb);
+		LOCC_inflightResend(loc);
+	}
+#endif
 #if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
 	LOTRACE_DBG1("Device Status ....");
-	ret = LOCC_processStatus(1);
+	ret = LOCC_processStatus(loc, 1);
 	LOTRACE_DBG1("Device Status, ret=%d", ret);
 #endif
 
 #if LOC_FEATURE_LO_RESOURCES
 	LOTRACE_DBG1("Device Resources ....");
-	ret = LOCC_processResources(1);
+	ret = LOCC_processResources(loc, 1);
 	LOTRACE_DBG1("Device Resources, ret=%d", ret);
 #endif
 
 #if LOC_FEATURE_LO_PARAMS_1
 	LOTRACE_DBG1("Device Config ....");
-	ret = LOCC_processConfig();
+	ret = LOCC_processConfig(loc);
 	LOTRACE_DBG1("Device Config, ret=%d", ret);
 #endif
 
 #if LOC_FEATURE_LO_RESOURCES
-	if (_LOClient_Set_Rsc.rsc_ptr) {
+	if (loc->Set_Rsc.rsc_ptr) {
 		LOTRACE_DBG1("Subcribe TOPIC_RSC_UPD=%d....", TOPIC_RSC_UPD);
-		ret = LOCC_SubscibeTopic(TOPIC_RSC_UPD);
+		ret = LOCC_SubscibeTopic(loc, TOPIC_RSC_UPD);
 		LOTRACE_DBG1("Subcribe TOPIC_RSC_UPD, ret=%d", ret);
 	}
 #endif
@@ -1066,6 +1919,85 @@ static void LOCC_connectOK(void) {
  * ---------------------------------------------------------
  */
 
+/* --------------------------------------------------------------------------------- */
+/*  */
+LiveObjectsClient_t* LiveObjectsInstance_Create(void) {
+	/* Aligned for the message queue (LOMQueue_t) */
+	LiveObjectsClient_t* loc = (LiveObjectsClient_t*) MEM_ALLOC_ALIGNED(LO_MQ_CACHE_LINE_SZ,
+			sizeof(LiveObjectsClient_t));
+	if (loc == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (size=%u)", (unsigned) sizeof(LiveObjectsClient_t));
+		return NULL;
+	}
+	LOCC_instanceInit(loc);
+	loc->allocated = 1;
+	return loc;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_Destroy(LiveObjectsClient_t* loc) {
+	if (loc == NULL) {
+		return -1;
+	}
+	if (((loc->state_run != 0) && (loc->state_run != -2)) || (loc->group)) {
+		LOTRACE_ERR("%p: ERROR - LiveObjects Client thread is running (state=%d)", loc, loc->state_run);
+		return -1;
+	}
+	if (loc->state_connected) {
+		LiveObjectsInstance_Disconnect(loc);
+	}
+#if LOC_FEATURE_LO_RESOURCES
+	LO_wget_close(&loc->wget);
+#endif
+	LOCC_setsRelease(loc);
+#if LOCC_BATCH
+	{
+		int i;
+		for (i = 0; i < LOC_MAX_OF_DATA_SET; i++) {
+			LO_sys_mutexDelete(loc->batch[i].mutex);
+			loc->batch[i].mutex = NULL;
+		}
+	}
+#endif
+#if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
+	{
+		int i;
+		for (i = 0; i < LOC_MAX_OF_STATUS_SET; i++) {
+			LO_sys_mutexDelete(loc->Set_Status[i].mutex);
+			loc->Set_Status[i].mutex = NULL;
+		}
+	}
+#endif
+#if LOM_MQUEUE
+	LOCC_inflightPurge(loc);
+	if (loc->queue.slots) {
+		LO_mq_purge(&loc->queue);
+		LO_mq_delete(&loc->queue);
+	}
+#endif
+#if LOCC_STORE
+	LO_store_close(loc->store);
+	loc->store = NULL;
+#endif
+	netw_tls_destroy(&loc->MQTTClient_network);
+	LO_sys_eventDelete(loc->event);
+
+	if (loc->allocated) {
+		MEM_FREE(loc);
+	}
+	else {
+		LOCC_instanceInit(loc);
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+LiveObjectsClient_t* LiveObjectsInstance_Default(void) {
+	return LOCC_default();
+}
+
 /* --------------------------------------------------------------------------------- */
 /*  */
 void LiveObjectsClient_InitDbgTrace(lotrace_level_t level) {
@@ -1105,14 +2037,14 @@ int LiveObjectsClient_CheckApiKey(const char* apikey) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_Init(void* net_iface_handler, unsigned long long apikey_p1_, unsigned long long apikey_p2_) {
+int LiveObjectsInstance_Init(LiveObjectsClient_t* loc, void* net_iface_handler, unsigned long long apikey_p1_, unsigned long long apikey_p2_) {
 	int rc;
 	char tmpApikey[APIKEY_LENGTH];
 
-	apikey_p1 = apikey_p1_;
-	apikey_p2 = apikey_p2_;
+	loc->apikey_p1 = apikey_p1_;
+	loc->apikey_p2 = apikey_p2_;
 
-	rc = apikeyconv(tmpApikey, APIKEY_LENGTH);
+	rc = apikeyconv(loc, tmpApikey, APIKEY_LENGTH);
 
 	if (rc == -1) {
 		LOTRACE_ERR("Apikeyconv failed, rc= %d", rc);
@@ -1126,41 +2058,81 @@ int LiveObjectsClient_Init(void* net_iface_handler, unsigned long long apikey_p1
 
 	LO_sys_init();
 
-#if LOM_MQUEUE
-	LOCC_mqInit();
-#endif
+	if (loc->event == NULL) {
+		/* Without events, the client thread polls as before */
+		loc->event = LO_sys_eventCreate();
+	}
 
+#if LOCC_BATCH
+	{
+		int i;
+		for (i = 0; i < LOC_MAX_OF_DATA_SET; i++) {
+			if ((loc->batch[i].mutex == NULL) && ((loc->batch[i].mutex = LO_sys_mutexCreate()) == NULL)) {
+				return -1;
+			}
+		}
+	}
+#endif
 #if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
-	memset(&_LOClient_Set_Status, 0, sizeof(_LOClient_Set_Status));
+	{
+		int i;
+		for (i = 0; i < LOC_MAX_OF_STATUS_SET; i++) {
+			if ((loc->Set_Status[i].mutex == NULL)
+					&& ((loc->Set_Status[i].mutex = LO_sys_mutexCreate()) == NULL)) {
+				return -1;
+			}
+		}
+	}
+#endif
+
+#if LOM_MQUEUE
+	rc = LO_mpool_init();
+	if (rc) {
+		LOTRACE_ERR("Error to initialize the pool of messages, rc=%d", rc);
+		return rc;
+	}
+
+	rc = LOCC_mqInit(loc);
+	if (rc) {
+		LOTRACE_ERR("Error to initialize the message queue, rc=%d", rc);
+		return rc;
+	}
 #endif
+
+	/* Initialized again: the sets attached before are removed (status sets reset, mutexes kept) */
+	LOCC_setsRelease(loc);
 #if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
-	memset(&_LOClient_Set_Data, 0, sizeof(_LOClient_Set_Data));
+	memset(&loc->Set_Data, 0, sizeof(loc->Set_Data));
 #endif
 #if LOC_FEATURE_LO_PARAMS
-	memset(&_LOClient_Set_Params, 0, sizeof(_LOClient_Set_Params));
-	memset(&_LOClient_Set_UpdatedParams, 0, sizeof(_LOClient_Set_UpdatedParams));
+	memset(&loc->Set_Params, 0, sizeof(loc->Set_Params));
+	memset(&loc->Set_UpdatedParams, 0, sizeof(loc->Set_UpdatedParams));
 #endif
 #if LOC_FEATURE_LO_COMMANDS
-	memset(&_LOClient_Set_Cmd, 0, sizeof(_LOClient_Set_Cmd));
+	memset(&loc->Set_Cmd, 0, sizeof(loc->Set_Cmd));
 #endif
 #if LOC_FEATURE_LO_RESOURCES
-	memset(&_LOClient_Set_Rsc, 0, sizeof(_LOClient_Set_Rsc));
-	memset(&_LOClient_Set_UpdatedRsc, 0, sizeof(_LOClient_Set_UpdatedRsc));
+	memset(&loc->Set_Rsc, 0, sizeof(loc->Set_Rsc));
+	memset(&loc->Set_UpdatedRsc, 0, sizeof(loc->Set_UpdatedRsc));
 #endif
 
-	rc = netw_init(&_LOClient_MQTTClient_network, net_iface_handler);
+	rc = netw_init(&loc->MQTTClient_network, net_iface_handler);
 	if (rc) {
 		LOTRACE_ERR("Error to initialize the network wrapper, rc=%d", rc);
 		return rc;
 	}
 
-	MQTTClientInit(&_LOClient_mqtt_ctx, &_LOClient_MQTTClient_network,
+	MQTTClientInit(&loc->mqtt_ctx, &loc->MQTTClient_network,
 			LOC_MQTT_DEF_COMMAND_TIMEOUT,
-			_LOClient_mqtt_buffer_snd, LOC_MQTT_DEF_SND_SZ,
-			_LOClient_mqtt_buffer_rcv, LOC_MQTT_DEF_RCV_SZ);
+			loc->mqtt_buffer_snd, LOC_MQTT_DEF_SND_SZ,
+			loc->mqtt_buffer_rcv, LOC_MQTT_DEF_RCV_SZ);
+	loc->mqtt_ctx.context = loc;
+#if LOM_MQUEUE
+	loc->mqtt_ctx.pubAckHandler = LOCC_inflightAck;
+#endif
 
 #if SECURITY_ENABLED && ((LOC_SERV_PORT  == 1884) || (LOC_SERV_PORT  == 8883))
-	rc = LOCC_EnableTLS();
+	rc = LOCC_EnableTLS(loc);
 	if (rc) {
 		return rc;
 	}
@@ -1173,37 +2145,118 @@ int LiveObjectsClient_Init(void* net_iface_handler, unsigned long long apikey_p1
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_SetDevId(const char* dev_id) {
+int LiveObjectsInstance_SetQueueParams(LiveObjectsClient_t* loc, uint32_t capacity, LiveObjectsD_MqPolicy_t policy, uint32_t timeout_ms) {
+#if LOM_MQUEUE
+	if ((capacity == 0) || (policy < LOD_MQ_DROP_NEWEST) || (policy > LOD_MQ_BLOCK)) {
+		LOTRACE_ERR("Invalid parameters - capacity=%"PRIu32" policy=%d", capacity, policy);
+		return -1;
+	}
+	loc->queue_capacity = capacity;
+	loc->queue_policy = (uint8_t) policy;
+	loc->queue_timeout_ms = timeout_ms;
+	LO_mq_setPolicy(&loc->queue, policy, timeout_ms);
+	return 0;
+#else
+	LOTRACE_NOTICE("Not supported");
+	return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_SetRetryParams(LiveObjectsClient_t* loc, uint32_t delay_ms, uint32_t max_delay_ms) {
+	if ((delay_ms == 0) || (max_delay_ms < delay_ms)) {
+		LOTRACE_ERR("Invalid parameters - delay=%"PRIu32" max=%"PRIu32, delay_ms, max_delay_ms);
+		return -1;
+	}
+	loc->retry_base_ms = delay_ms;
+	loc->retry_max_ms = max_delay_ms;
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_NetworkChanged(LiveObjectsClient_t* loc) {
+	if (loc->state_connected) {
+		return 0;
+	}
+	loc->retry_now = 1;
+	LO_sys_eventSignal(loc->event);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_SetStore(LiveObjectsClient_t* loc, const char* dir, uint32_t max_bytes) {
+#if LOCC_STORE
+	if ((dir == NULL) || (*dir == 0)) {
+		LOTRACE_ERR("Invalid parameters - no directory");
+		return -1;
+	}
+	if (loc->store) {
+		LOTRACE_ERR("Store already set");
+		return -1;
+	}
+	loc->store = LO_store_open(dir, (max_bytes) ? max_bytes : LOC_STORE_MAX_SZ);
+	if (loc->store == NULL) {
+		return -1;
+	}
+	LOTRACE_INF("Store %s: %"PRIu32" messages to replay", dir, LO_store_backlog(loc->store));
+	return 0;
+#else
+	(void)dir;
+	(void)max_bytes;
+	LOTRACE_NOTICE("Not supported");
+	return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_SetTlsSessionFile(LiveObjectsClient_t* loc, const char* path) {
+#if SECURITY_ENABLED
+	return netw_tls_sessionFile(&loc->MQTTClient_network, path);
+#else
+	(void) loc;
+	(void) path;
+	LOTRACE_NOTICE("Not supported");
+	return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_SetDevId(LiveObjectsClient_t* loc, const char* dev_id) {
 	if ((dev_id) &&(*dev_id)) {
 		size_t len = strlen(dev_id);
-		memset(_LOClient_dev_id, 0, sizeof(_LOClient_dev_id));
-		memcpy(_LOClient_dev_id, dev_id, len < sizeof(_LOClient_dev_id) ? len : sizeof(_LOClient_dev_id));
-		_LOClient_dev_id[sizeof(_LOClient_dev_id) - 1] = 0;
+		memset(loc->dev_id, 0, sizeof(loc->dev_id));
+		memcpy(loc->dev_id, dev_id, len < sizeof(loc->dev_id) ? len : sizeof(loc->dev_id));
+		loc->dev_id[sizeof(loc->dev_id) - 1] = 0;
 
-		if (strlen(_LOClient_dev_id) != len) {
-			LOTRACE_ERR("Error to set dev_id, rc=%d != %d ", strlen(_LOClient_dev_id), len);
+		if (strlen(loc->dev_id) != len) {
+			LOTRACE_ERR("Error to set dev_id, rc=%d != %d ", strlen(loc->dev_id), len);
 			return -1;
 		}
 	}
-	LOTRACE_NOTICE("dev_id=\"%s\"", _LOClient_dev_id);
+	LOTRACE_NOTICE("dev_id=\"%s\"", loc->dev_id);
 	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_SetNameSpace(const char* name_space) {
+int LiveObjectsInstance_SetNameSpace(LiveObjectsClient_t* loc, const char* name_space) {
 	if ((name_space) &&(*name_space)) {
 		size_t len = strlen(name_space);
-		memset(_LOClient_dev_name_space, 0, sizeof(_LOClient_dev_id));
-		memcpy(_LOClient_dev_name_space, name_space,
-				len < sizeof(_LOClient_dev_name_space) ? len : sizeof(_LOClient_dev_name_space));
-		_LOClient_dev_name_space[sizeof(_LOClient_dev_name_space) - 1] = 0;
-		if (strlen(_LOClient_dev_name_space) != len) {
-			LOTRACE_ERR("Error to set name_space, rc=%d != %d ", strlen(_LOClient_dev_name_space), len);
+		memset(loc->dev_name_space, 0, sizeof(loc->dev_id));
+		memcpy(loc->dev_name_space, name_space,
+				len < sizeof(loc->dev_name_space) ? len : sizeof(loc->dev_name_space));
+		loc->dev_name_space[sizeof(loc->dev_name_space) - 1] = 0;
+		if (strlen(loc->dev_name_space) != len) {
+			LOTRACE_ERR("Error to set name_space, rc=%d != %d ", strlen(loc->dev_name_space), len);
 			return -1;
 		}
 	}
-	LOTRACE_NOTICE("name_space=\"%s\"", _LOClient_dev_name_space);
+	LOTRACE_NOTICE("name_space=\"%s\"", loc->dev_name_space);
 	return 0;
 }
 
@@ -1247,12 +2300,12 @@ int LiveObjectsClient_DnsResolve(void) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_AttachCfgParams(const LiveObjectsD_Param_t* param_ptr, int32_t param_nb,
+int LiveObjectsInstance_AttachCfgParams(LiveObjectsClient_t* loc, const LiveObjectsD_Param_t* param_ptr, int32_t param_nb,
 		LiveObjectsD_CallbackParams_t callback) {
 #if LOC_FEATURE_LO_PARAMS
-	_LOClient_Set_Params.param_set.param_ptr = param_ptr;
-	_LOClient_Set_Params.param_set.param_nb = param_nb;
-	_LOClient_Set_Params.param_callback = callback;
+	loc->Set_Params.param_set.param_ptr = param_ptr;
+	loc->Set_Params.param_set.param_nb = param_nb;
+	loc->Set_Params.param_callback = callback;
 
 	LOTRACE_INF("nb=%"PRIi32" callback=%p", param_nb, callback);
 
@@ -1264,7 +2317,7 @@ int LiveObjectsClient_AttachCfgParams(const LiveObjectsD_Param_t* param_ptr, int
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_AttachStatus(const LiveObjectsD_Data_t* data_ptr, int32_t data_nb) {
+int LiveObjectsInstance_AttachStatus(LiveObjectsClient_t* loc, const LiveObjectsD_Data_t* data_ptr, int32_t data_nb) {
 
 #if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
 	int status_hdl;
@@ -1272,16 +2325,25 @@ int LiveObjectsClient_AttachStatus(const LiveObjectsD_Data_t* data_ptr, int32_t
 		return -1;
 	}
 	for (status_hdl = 0; status_hdl < LOC_MAX_OF_STATUS_SET; status_hdl++) {
-		if (_LOClient_Set_Status[status_hdl].data_set.data_ptr == NULL) {
+		if (loc->Set_Status[status_hdl].data_set.data_ptr == NULL) {
 			break;
 		}
 	}
 
+	if ((status_hdl < LOC_MAX_OF_STATUS_SET) && (loc->Set_Status[status_hdl].mutex == NULL)) {
+		LOTRACE_ERR("Not initialized");
+		return -1;
+	}
 	if (status_hdl < LOC_MAX_OF_STATUS_SET) {
-		_LOClient_Set_Status[status_hdl].data_set.data_ptr = data_ptr;
-		_LOClient_Set_Status[status_hdl].data_set.data_nb = data_nb;
+		loc->Set_Status[status_hdl].data_set.data_ptr = data_ptr;
+		loc->Set_Status[status_hdl].data_set.data_nb = data_nb;
+		loc->Set_Status[status_hdl].data_set.encoding = LOD_ENCODING_JSON;
+		LO_msg_plan_compile(&loc->Set_Status[status_hdl].data_set);
+#if (LOC_STATUS_RESYNC_MS > 0)
+		LiveObjectsInstance_SetStatusDelta(loc, status_hdl, LOC_STATUS_RESYNC_MS);
+#endif
 #if LOM_PUSH_FLAG
-		_LOClient_Set_Status[status_hdl].pushtoLOServer = 1;
+		loc->Set_Status[status_hdl].pushtoLOServer = 1;
 #endif
 
 		LOTRACE_INF("nb=%"PRIi32, data_nb);
@@ -1293,7 +2355,7 @@ int LiveObjectsClient_AttachStatus(const LiveObjectsD_Data_t* data_ptr, int32_t
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_AttachData(uint8_t stream_prefix, const char* stream_id, const char* model, const char* tags,
+int LiveObjectsInstance_AttachData(LiveObjectsClient_t* loc, uint8_t stream_prefix, const char* stream_id, const char* model, const char* tags,
 		const LiveObjectsD_GpsFix_t* gps_ptr, const LiveObjectsD_Data_t* data_ptr, int32_t data_nb) {
 
 #if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
@@ -1302,7 +2364,7 @@ int LiveObjectsClient_AttachData(uint8_t stream_prefix, const char* stream_id, c
 		return -1;
 	}
 	for (data_hdl = 0; data_hdl < LOC_MAX_OF_DATA_SET; data_hdl++) {
-		if (_LOClient_Set_Data[data_hdl].stream_id[0] == 0) {
+		if (loc->Set_Data[data_hdl].stream_id[0] == 0) {
 			break;
 		}
 	}
@@ -1311,9 +2373,9 @@ int LiveObjectsClient_AttachData(uint8_t stream_prefix, const char* stream_id, c
 #if (LOM_SETOFDATA_MODEL_SZ > 0) || (LOM_SETOFDATA_TAGS_SZ > 0)
 		size_t len;
 #endif
-		LOMSetOfData_t* p_dataSet = &_LOClient_Set_Data[data_hdl];
+		LOMSetOfData_t* p_dataSet = &loc->Set_Data[data_hdl];
 
-		int ret = LOCC_setStreamId(stream_prefix, p_dataSet, stream_id);
+		int ret = LOCC_setStreamId(loc, stream_prefix, p_dataSet, stream_id);
 		if (ret != 0) {
 			return -1;
 		}
@@ -1348,6 +2410,9 @@ int LiveObjectsClient_AttachData(uint8_t stream_prefix, const char* stream_id, c
 
 		p_dataSet->data_set.data_ptr = data_ptr;
 		p_dataSet->data_set.data_nb = data_nb;
+		p_dataSet->data_set.encoding = LOD_ENCODING_JSON;
+		LO_msg_plan_compile(&p_dataSet->data_set);
+		LO_msg_plan_envelope(p_dataSet);
 
 		LOTRACE_INF("handle=%d nb=%"PRIi32" id=%s m=%s t=%s", data_hdl, data_nb,
 				stream_id, model, tags);
@@ -1359,13 +2424,13 @@ int LiveObjectsClient_AttachData(uint8_t stream_prefix, const char* stream_id, c
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_AttachCommands(const LiveObjectsD_Command_t* cmd_ptr, int32_t cmd_nb,
+int LiveObjectsInstance_AttachCommands(LiveObjectsClient_t* loc, const LiveObjectsD_Command_t* cmd_ptr, int32_t cmd_nb,
 		LiveObjectsD_CallbackCommand_t callback) {
 #if LOC_FEATURE_LO_COMMANDS
-	_LOClient_Set_Cmd.cmd_enable = 0;
-	_LOClient_Set_Cmd.cmd_ptr = cmd_ptr;
-	_LOClient_Set_Cmd.cmd_nb = cmd_nb;
-	_LOClient_Set_Cmd.cmd_callback = callback;
+	loc->Set_Cmd.cmd_enable = 0;
+	loc->Set_Cmd.cmd_ptr = cmd_ptr;
+	loc->Set_Cmd.cmd_nb = cmd_nb;
+	loc->Set_Cmd.cmd_callback = callback;
 
 	LOTRACE_INF("nb=%"PRIi32, cmd_nb);
 
@@ -1377,16 +2442,16 @@ int LiveObjectsClient_AttachCommands(const LiveObjectsD_Command_t* cmd_ptr, int3
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_ControlCommands(bool enable) {
+int LiveObjectsInstance_ControlCommands(LiveObjectsClient_t* loc, bool enable) {
 #if LOC_FEATURE_LO_COMMANDS
 	LOTRACE_INF("enable=%u (current state 0x%x)", enable,
-			_LOClient_Set_Cmd.cmd_enable);
+			loc->Set_Cmd.cmd_enable);
 	if (enable) {
-		_LOClient_Set_Cmd.cmd_enable = 0x01;
+		loc->Set_Cmd.cmd_enable = 0x01;
 	}
 	else {
-		if (_LOClient_Set_Cmd.cmd_enable & 0x10) {
-			_LOClient_Set_Cmd.cmd_enable = 0x10;
+		if (loc->Set_Cmd.cmd_enable & 0x10) {
+			loc->Set_Cmd.cmd_enable = 0x10;
 		}
 	}
 #endif
@@ -1395,14 +2460,14 @@ int LiveObjectsClient_ControlCommands(bool enable) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_AttachResources(const LiveObjectsD_Resource_t* rsc_ptr, int32_t rsc_nb,
+int LiveObjectsInstance_AttachResources(LiveObjectsClient_t* loc, const LiveObjectsD_Resource_t* rsc_ptr, int32_t rsc_nb,
 		LiveObjectsD_CallbackResourceNotify_t ntfyCB, LiveObjectsD_CallbackResourceData_t dataCB) {
 #if LOC_FEATURE_LO_RESOURCES
-	_LOClient_Set_Rsc.rsc_enable = 0x01;
-	_LOClient_Set_Rsc.rsc_ptr = rsc_ptr;
-	_LOClient_Set_Rsc.rsc_nb = rsc_nb;
-	_LOClient_Set_Rsc.rsc_cb_ntfy = ntfyCB;
-	_LOClient_Set_Rsc.rsc_cb_data = dataCB;
+	loc->Set_Rsc.rsc_enable = 0x01;
+	loc->Set_Rsc.rsc_ptr = rsc_ptr;
+	loc->Set_Rsc.rsc_nb = rsc_nb;
+	loc->Set_Rsc.rsc_cb_ntfy = ntfyCB;
+	loc->Set_Rsc.rsc_cb_data = dataCB;
 
 	LOTRACE_INF("nb=%"PRIi32, rsc_nb);
 
@@ -1414,15 +2479,15 @@ int LiveObjectsClient_AttachResources(const LiveObjectsD_Resource_t* rsc_ptr, in
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_ControlResources(bool enable) {
+int LiveObjectsInstance_ControlResources(LiveObjectsClient_t* loc, bool enable) {
 #if LOC_FEATURE_LO_RESOURCES
 	LOTRACE_INF("enable=%u (current state 0x%x)", enable,
-			_LOClient_Set_Rsc.rsc_enable);
+			loc->Set_Rsc.rsc_enable);
 	if (enable) {
-		_LOClient_Set_Rsc.rsc_enable = 0x01;
+		loc->Set_Rsc.rsc_enable = 0x01;
 	}
-	else if (_LOClient_Set_Rsc.rsc_enable & 0x01) {
-		_LOClient_Set_Rsc.rsc_enable = 0x10;
+	else if (loc->Set_Rsc.rsc_enable & 0x01) {
+		loc->Set_Rsc.rsc_enable = 0x10;
 	}
 #endif
 	return 0;
@@ -1430,11 +2495,13 @@ int LiveObjectsClient_ControlResources(bool enable) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_ChangeDataStreamId(uint8_t prefix, int data_hdl, const char* stream_id) {
+int LiveObjectsInstance_ChangeDataStreamId(LiveObjectsClient_t* loc, uint8_t prefix, int data_hdl, const char* stream_id) {
 #if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
-	if ((data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET) && _LOClient_Set_Data[data_hdl].stream_id[0]
+	if ((data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET) && loc->Set_Data[data_hdl].stream_id[0]
 			&& (stream_id) &&(*stream_id)) {
-		int ret = LOCC_setStreamId(prefix, &_LOClient_Set_Data[data_hdl], stream_id);
+		int ret = LOCC_setStreamId(loc, prefix, &loc->Set_Data[data_hdl], stream_id);
+		/* without envelope (i.e. error), the messages are encoded without the plan */
+		LO_msg_plan_envelope(&loc->Set_Data[data_hdl]);
 		return ret;
 	}
 #endif
@@ -1443,11 +2510,15 @@ int LiveObjectsClient_ChangeDataStreamId(uint8_t prefix, int data_hdl, const cha
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_RemoveData(int data_hdl) {
+int LiveObjectsInstance_RemoveData(LiveObjectsClient_t* loc, int data_hdl) {
 #if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
-	if ((data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET) && _LOClient_Set_Data[data_hdl].stream_id[0]) {
-		_LOClient_Set_Data[data_hdl].data_set.data_ptr = NULL;
-		memset(&_LOClient_Set_Data[data_hdl], 0, sizeof(LOMSetOfData_t));
+	if ((data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET) && loc->Set_Data[data_hdl].stream_id[0]) {
+#if LOCC_BATCH
+		LOCC_batchReset(&loc->batch[data_hdl]);
+#endif
+		LO_msg_plan_release(&loc->Set_Data[data_hdl].data_set);
+		loc->Set_Data[data_hdl].data_set.data_ptr = NULL;
+		memset(&loc->Set_Data[data_hdl], 0, sizeof(LOMSetOfData_t));
 		return 0;
 	}
 #endif
@@ -1456,69 +2527,69 @@ int LiveObjectsClient_RemoveData(int data_hdl) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_RemoveCommands(void) {
+int LiveObjectsInstance_RemoveCommands(LiveObjectsClient_t* loc) {
 #if LOC_FEATURE_LO_COMMANDS
-	memset(&_LOClient_Set_Cmd, 0, sizeof(_LOClient_Set_Cmd));
+	memset(&loc->Set_Cmd, 0, sizeof(loc->Set_Cmd));
 #endif
 	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_RemoveResources(void) {
+int LiveObjectsInstance_RemoveResources(LiveObjectsClient_t* loc) {
 #if LOC_FEATURE_LO_RESOURCES
-	memset(&_LOClient_Set_Rsc, 0, sizeof(_LOClient_Set_Rsc));
+	memset(&loc->Set_Rsc, 0, sizeof(loc->Set_Rsc));
 #endif
 	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_Connect(void) {
+int LiveObjectsInstance_Connect(LiveObjectsClient_t* loc) {
 	int rc;
 
-	LOCC_connectInit(0);
+	LOCC_connectInit(loc, 0);
 
-	rc = LOCC_connectStart();
+	rc = LOCC_connectStart(loc);
 	if (rc) {
 		LOTRACE_ERR("connection failed, rc=%d", rc);
 	}
 	else {
-		LOCC_connectOK();
+		LOCC_connectOK(loc);
 	}
 	return rc;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_Disconnect(void) {
+int LiveObjectsInstance_Disconnect(LiveObjectsClient_t* loc) {
 	int rc;
-	rc = MQTTDisconnect(&_LOClient_mqtt_ctx);
+	rc = MQTTDisconnect(&loc->mqtt_ctx);
 	if (rc) {
 		LOTRACE_ERR("MQTTDisconnect failed, rc=%d", rc);
 	}
-	netw_disconnect(&_LOClient_MQTTClient_network, 0);
-	_LOClient_state_connected = 0;
+	netw_disconnect(&loc->MQTTClient_network, 0);
+	loc->state_connected = 0;
 	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_Yield(int timeout_ms) {
+int LiveObjectsInstance_Yield(LiveObjectsClient_t* loc, int timeout_ms) {
 	int ret = -1;
-	if (_LOClient_state_connected) {
+	if (loc->state_connected) {
 		LOTRACE_DBG_VERBOSE("CONNECTED => MQTTYield(%d ms)...", timeout_ms);
-		ret = MQTTYield(&_LOClient_mqtt_ctx, timeout_ms);
+		ret = MQTTYield(&loc->mqtt_ctx, timeout_ms);
 		LOTRACE_DBG_VERBOSE("CONNECTED => MQTTYield(%d ms) ========> ret=%d.", timeout_ms,
 				ret);
 		if (ret < 0) {
 			LOTRACE_DBG1("ret=%d  !!", ret);
 		}
 
-		if (netw_isLost(&_LOClient_MQTTClient_network)) {
+		if ((ret == FAILURE) || (netw_isLost(&loc->MQTTClient_network))) {
 			LOTRACE_NOTICE("LOST !!");
-			netw_disconnect(&_LOClient_MQTTClient_network, 0);
-			_LOClient_state_connected = 0;
+			netw_disconnect(&loc->MQTTClient_network, 0);
+			loc->state_connected = 0;
 			ret = -1;
 		}
 		else {
@@ -1534,27 +2605,28 @@ int LiveObjectsClient_Yield(int timeout_ms) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_PushResources(void) {
+int LiveObjectsInstance_PushResources(LiveObjectsClient_t* loc) {
 #if LOC_FEATURE_LO_RESOURCES
-	if ((_LOClient_state_connected) &&(_LOClient_Set_Rsc.rsc_ptr)) {
+	if ((loc->state_connected) &&(loc->Set_Rsc.rsc_ptr)) {
 #if LOM_PUSH_ASYNC
-		_LOClient_Set_Rsc.pushtoLOServer = 1;
+		loc->Set_Rsc.pushtoLOServer = 1;
+		LO_sys_eventSignal(loc->event);
 		return 0;
 #else
-		uint8_t from = LO_sys_threadIsLiveObjectsClient() ? 0 : MTYPE_PUB_RSC;
-		const char *p_msg = LO_msg_encode_resources(from, &_LOClient_Set_Rsc);
+		uint8_t from = LOCC_threadIsClient(loc) ? 0 : MTYPE_PUB_RSC;
+		const char *p_msg = LO_msg_encode_resources(from, &loc->Set_Rsc);
 		if (p_msg) {
 			if (from == 0) {
 				/* Publish now because it is LiveObjects Client thread */
-				return LOCC_MqttPublish(QOS0, "dev/rsc", p_msg);
+				return LOCC_MqttPublish(loc, QOS0, "dev/rsc", p_msg);
 			}
 			/* otherwise put it in the queue */
-			if (LOCC_mqPut(p_msg) == 0) {
+			if (LOCC_mqPut(loc, p_msg) == 0) {
 				LOTRACE_INF("msg is put in queue !!");
 				return 0;
 			}
-			LOTRACE_ERR("ERROR to put in queue - MEM_FREE %p x%x", p_msg, *p_msg);
-			MEM_FREE(p_msg);
+			LOTRACE_ERR("ERROR to put in queue - release %p x%x", p_msg, *p_msg);
+			LO_mpool_free(p_msg);
 		}
 #endif
 	}
@@ -1564,28 +2636,40 @@ int LiveObjectsClient_PushResources(void) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_PushStatus(int handle) {
+int LiveObjectsInstance_PushStatus(LiveObjectsClient_t* loc, int handle) {
 #if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
-	if ((_LOClient_state_connected) &&(handle >= 0) && (handle < LOC_MAX_OF_STATUS_SET)
-			&& (_LOClient_Set_Status[handle].data_set.data_ptr)) {
+	if ((loc->state_connected) &&(handle >= 0) && (handle < LOC_MAX_OF_STATUS_SET)
+			&& (loc->Set_Status[handle].data_set.data_ptr)) {
 #if LOM_PUSH_ASYNC
-		_LOClient_Set_Status[handle].pushtoLOServer = 1;
+		loc->Set_Status[handle].pushtoLOServer = 1;
+		LO_sys_eventSignal(loc->event);
 		return 0;
 #else
-		uint8_t from = LO_sys_threadIsLiveObjectsClient() ? 0 : MTYPE_PUB_STATUS;
-		const char *p_msg = LO_msg_encode_status(from, &_LOClient_Set_Status[handle].data_set);
-		if (p_msg) {
+		uint8_t from = LOCC_threadIsClient(loc) ? 0 : MTYPE_PUB_STATUS;
+		uint32_t len;
+		const char *p_msg;
+		int ret = LOCC_statusEncode(&loc->Set_Status[handle], from, 0, &p_msg, &len);
+		if (ret == 1) {
+			/* Delta mode, no change since the last message */
+			return 0;
+		}
+		if (ret == 0) {
 			if (from == 0) {
 				/* Publish now because it is LiveObjects Client thread */
-				return LOCC_MqttPublish(QOS0, "dev/info", p_msg);
+				ret = LOCC_MqttPublishLen(loc, QOS0, "dev/info", p_msg, len);
+				if (ret) {
+					LOCC_statusLost(&loc->Set_Status[handle]);
+				}
+				return ret;
 			}
 			/* otherwise put it in the queue */
-			if (LOCC_mqPut(p_msg) == 0) {
+			if (LOCC_mqPut(loc, p_msg) == 0) {
 				LOTRACE_INF("msg is put in queue !!");
 				return 0;
 			}
-			LOTRACE_ERR("ERROR to put in queue - MEM_FREE %p x%x", p_msg, *p_msg);
-			MEM_FREE(p_msg);
+			LOTRACE_ERR("ERROR to put in queue - release %p x%x", p_msg, *p_msg);
+			LO_mpool_free(p_msg);
+			LOCC_statusLost(&loc->Set_Status[handle]);
 		}
 #endif
 	}
@@ -1595,29 +2679,51 @@ int LiveObjectsClient_PushStatus(int handle) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_PushData(int data_hdl) {
+int LiveObjectsInstance_PushData(LiveObjectsClient_t* loc, int data_hdl) {
+#if LOCC_BATCH
+	if ((data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET) && (loc->batch[data_hdl].size)
+			&& loc->Set_Data[data_hdl].stream_id[0] && loc->Set_Data[data_hdl].data_set.data_ptr
+			&& (loc->Set_Data[data_hdl].data_set.encoding == LOD_ENCODING_JSON)) {
+		/* Batch of samples in JSON only */
+		return LOCC_batchPush(loc, data_hdl);
+	}
+#endif
+#if LOCC_STORE
+	if (LOCC_storeUsed(loc) && (data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET)
+			&& loc->Set_Data[data_hdl].stream_id[0] && loc->Set_Data[data_hdl].data_set.data_ptr) {
+		/* Disconnected, or older messages not yet replayed (keep the order): save it in the store */
+		const char *p_msg = LO_msg_encode_data(MTYPE_PUB_DATA, &loc->Set_Data[data_hdl], NULL);
+		if ((p_msg) && (LOCC_storeAppend(loc, p_msg) == 0)) {
+			return 0;
+		}
+		LOTRACE_ERR("ERROR while storing data !");
+		return -1;
+	}
+#endif
 #if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
-	if (_LOClient_state_connected && (data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET)
-			&& _LOClient_Set_Data[data_hdl].stream_id[0] && _LOClient_Set_Data[data_hdl].data_set.data_ptr) {
+	if (loc->state_connected && (data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET)
+			&& loc->Set_Data[data_hdl].stream_id[0] && loc->Set_Data[data_hdl].data_set.data_ptr) {
 #if LOM_PUSH_ASYNC
 		LOTRACE_INF("ASYNC data_hdl=%d", data_hdl);
-		_LOClient_Set_Data[data_hdl].pushtoLOServer = 1;
+		loc->Set_Data[data_hdl].pushtoLOServer = 1;
+		LO_sys_eventSignal(loc->event);
 		return 0;
 #else
-		uint8_t from = LO_sys_threadIsLiveObjectsClient() ? 0 : MTYPE_PUB_DATA;
-		const char *p_msg = LO_msg_encode_data(from, &_LOClient_Set_Data[data_hdl]);
+		uint8_t from = LOCC_threadIsClient(loc) ? 0 : MTYPE_PUB_DATA;
+		uint32_t len;
+		const char *p_msg = LO_msg_encode_data(from, &loc->Set_Data[data_hdl], &len);
 		if (p_msg) {
 			if (from == 0) {
 				/* Publish now because it is LiveObjects Client thread */
-				return LOCC_MqttPublish(QOS0, "dev/data", p_msg);
+				return LOCC_MqttPublishLen(loc, QOS0, "dev/data", p_msg, len);
 			}
 			/* otherwise put it in the queue */
-			if (LOCC_mqPut(p_msg) == 0) {
+			if (LOCC_mqPut(loc, p_msg) == 0) {
 				LOTRACE_DBG1("msg is put in queue !!");
 				return 0;
 			}
-			LOTRACE_ERR("ERROR to put in queue - MEM_FREE %p x%x", p_msg, *p_msg);
-			MEM_FREE(p_msg);
+			LOTRACE_ERR("ERROR to put in queue - release %p x%x", p_msg, *p_msg);
+			LO_mpool_free(p_msg);
 		}
 #endif
 	}
@@ -1628,27 +2734,151 @@ int LiveObjectsClient_PushData(int data_hdl) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_PushCfgParams(void) {
+int LiveObjectsInstance_SetDataBatch(LiveObjectsClient_t* loc, int data_hdl, uint32_t batch_size, uint32_t linger_ms) {
+#if LOCC_BATCH
+	if ((data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET) && loc->Set_Data[data_hdl].stream_id[0]) {
+		LOCCBatch_t* batch = &loc->batch[data_hdl];
+		LOCCBatchMsg_t out;
+
+		out.p_msg = NULL;
+		LO_sys_mutexLock(batch->mutex);
+		if (batch_size > 1) {
+			batch->size = batch_size;
+			batch->linger_ms = linger_ms;
+			batch->stats.bt_size = batch_size;
+		}
+		else {
+			/* No more batching: publish the samples already gathered */
+			out = batch->cur;
+			batch->cur.p_msg = NULL;
+			batch->size = 0;
+		}
+		LO_sys_mutexUnlock(batch->mutex);
+		if (out.p_msg) {
+			LOCC_batchPublish(loc, batch, &out);
+		}
+		LOTRACE_INF("data_hdl=%d batch_size=%"PRIu32" linger_ms=%"PRIu32, data_hdl, batch_size, linger_ms);
+		LO_sys_eventSignal(loc->event);
+		return 0;
+	}
+#else
+	(void) loc;
+	(void) data_hdl;
+	(void) batch_size;
+	(void) linger_ms;
+#endif
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LOCC_encodingValid(LiveObjectsD_Encoding_t encoding) {
+#if LOC_FEATURE_CBOR
+	return (encoding == LOD_ENCODING_JSON) || (encoding == LOD_ENCODING_CBOR);
+#else
+	return (encoding == LOD_ENCODING_JSON);
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_SetDataEncoding(LiveObjectsClient_t* loc, int data_hdl, LiveObjectsD_Encoding_t encoding) {
+#if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
+	if ((data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET) && loc->Set_Data[data_hdl].stream_id[0]
+			&& LOCC_encodingValid(encoding)) {
+		loc->Set_Data[data_hdl].data_set.encoding = (uint8_t) encoding;
+		LOTRACE_INF("data_hdl=%d encoding=%d", data_hdl, encoding);
+		return 0;
+	}
+#endif
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_SetStatusEncoding(LiveObjectsClient_t* loc, int status_hdl, LiveObjectsD_Encoding_t encoding) {
+#if LOC_FEATURE_LO_STATUS && (LOC_MAX_OF_DATA_SET > 0)
+	if ((status_hdl >= 0) && (status_hdl < LOC_MAX_OF_STATUS_SET) && loc->Set_Status[status_hdl].data_set.data_ptr
+			&& LOCC_encodingValid(encoding)) {
+		loc->Set_Status[status_hdl].data_set.encoding = (uint8_t) encoding;
+		LOTRACE_INF("status_hdl=%d encoding=%d", status_hdl, encoding);
+		return 0;
+	}
+#endif
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_SetStatusDelta(LiveObjectsClient_t* loc, int status_hdl, uint32_t resync_ms) {
+#if LOC_FEATURE_LO_STATUS && (LOC_MAX_OF_DATA_SET > 0)
+	if ((status_hdl >= 0) && (status_hdl < LOC_MAX_OF_STATUS_SET) && loc->Set_Status[status_hdl].data_set.data_ptr) {
+		LOMSetOfStatus_t* p_statusSet = &loc->Set_Status[status_hdl];
+		int ret = 0;
+
+		LO_sys_mutexLock(p_statusSet->mutex);
+		if (resync_ms == 0) {
+			LO_msg_shadow_release(&p_statusSet->shadow);
+		}
+		else {
+			if (p_statusSet->shadow.values == NULL) {
+				ret = LO_msg_shadow_init(&p_statusSet->shadow, &p_statusSet->data_set);
+			}
+			p_statusSet->shadow.resync_ms = resync_ms;
+		}
+		LO_sys_mutexUnlock(p_statusSet->mutex);
+		LOTRACE_INF("status_hdl=%d resync_ms=%"PRIu32" ret=%d", status_hdl, resync_ms, ret);
+		return ret;
+	}
+#else
+	(void) loc;
+	(void) status_hdl;
+	(void) resync_ms;
+#endif
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Always encoded in a message of the pool, kept until its PUBACK */
+int LiveObjectsInstance_PushDataQos1(LiveObjectsClient_t* loc, int data_hdl,
+		LiveObjectsD_CallbackPubAck_t callback, void* msg_ctx) {
+#if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0) && LOM_MQUEUE
+	if (loc->queue.slots && (data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET)
+			&& loc->Set_Data[data_hdl].stream_id[0] && loc->Set_Data[data_hdl].data_set.data_ptr) {
+		char *p_msg = (char*) LO_msg_encode_data(MTYPE_PUB_DATA, &loc->Set_Data[data_hdl], NULL);
+		if (p_msg) {
+			return LOCC_mqPutQos1(loc, p_msg, callback, msg_ctx);
+		}
+	}
+#endif
+	LOTRACE_ERR("ERROR while publishing data !");
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_PushCfgParams(LiveObjectsClient_t* loc) {
 #if LOC_FEATURE_LO_PARAMS
-	if ((_LOClient_state_connected) &&(_LOClient_Set_Params.param_set.param_ptr)) {
+	if ((loc->state_connected) &&(loc->Set_Params.param_set.param_ptr)) {
 #if LOM_PUSH_ASYNC
-		_LOClient_Set_Params.pushtoLOServer = 1;
+		loc->Set_Params.pushtoLOServer = 1;
+		LO_sys_eventSignal(loc->event);
 		return 0;
 #else
-		uint8_t from = LO_sys_threadIsLiveObjectsClient() ? 0 : MTYPE_PUB_PARAM;
-		const char *p_msg = LO_msg_encode_params_all(from, &_LOClient_Set_Params.param_set, 0);
+		uint8_t from = LOCC_threadIsClient(loc) ? 0 : MTYPE_PUB_PARAM;
+		const char *p_msg = LO_msg_encode_params_all(from, &loc->Set_Params.param_set, 0);
 		if (p_msg) {
 			if (from == 0) {
 				/* Publish now because it is LiveObjects Client thread */
-				return LOCC_MqttPublish(QOS0, "dev/cfg", p_msg);
+				return LOCC_MqttPublish(loc, QOS0, "dev/cfg", p_msg);
 			}
 			/* otherwise put it in the queue */
-			if (LOCC_mqPut(p_msg) == 0) {
+			if (LOCC_mqPut(loc, p_msg) == 0) {
 				LOTRACE_INF("msg is put in queue !!");
 				return 0;
 			}
-			LOTRACE_ERR("ERROR to put in queue - MEM_FREE %p x%x", p_msg, *p_msg);
-			MEM_FREE(p_msg);
+			LOTRACE_ERR("ERROR to put in queue - release %p x%x", p_msg, *p_msg);
+			LO_mpool_free(p_msg);
 		}
 #endif
 	}
@@ -1658,27 +2888,27 @@ int LiveObjectsClient_PushCfgParams(void) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_CommandResponse(int32_t cid, const LiveObjectsD_Data_t* data_ptr, int data_nb) {
+int LiveObjectsInstance_CommandResponse(LiveObjectsClient_t* loc, int32_t cid, const LiveObjectsD_Data_t* data_ptr, int data_nb) {
 #if LOC_FEATURE_LO_COMMANDS
-	if (_LOClient_state_connected) {
+	if (loc->state_connected) {
 		const char *p_msg ;
-		uint8_t from = LO_sys_threadIsLiveObjectsClient() ? 0 : MTYPE_PUB_CMD_RSP;
+		uint8_t from = LOCC_threadIsClient(loc) ? 0 : MTYPE_PUB_CMD_RSP;
 		LOTRACE_INF("from=x%x cid= %"PRIi32" obj_ptr=x%p  obj_nb=%d ...", from, cid,
 				data_ptr, data_nb);
 		p_msg = LO_msg_encode_cmd_resp(from, cid, data_ptr, data_nb);
 		if (p_msg) {
 			if (from == 0) {
 				/* Publish now because it is LOM Client thread (negative response ...) */
-				return LOCC_MqttPublish(QOS0, "dev/cmd/res", p_msg);
+				return LOCC_MqttPublish(loc, QOS0, "dev/cmd/res", p_msg);
 			}
 #if LOM_MQUEUE
 			/* otherwise put it in the queue */
-			if (LOCC_mqPut(p_msg) == 0) {
+			if (LOCC_mqPut(loc, p_msg) == 0) {
 				LOTRACE_INF("msg is put in queue !!");
 				return 0;
 			}
-			LOTRACE_ERR("ERROR to put in queue - MEM_FREE %p x%x", p_msg, *p_msg);
-			MEM_FREE(p_msg);
+			LOTRACE_ERR("ERROR to put in queue - release %p x%x", p_msg, *p_msg);
+			LO_mpool_free(p_msg);
 #else
 			LOTRACE_ERR("ERROR - not supported in this config");
 #endif
@@ -1690,38 +2920,38 @@ int LiveObjectsClient_CommandResponse(int32_t cid, const LiveObjectsD_Data_t* da
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_RscGetChunck(const LiveObjectsD_Resource_t* rsc_ptr, char* data_ptr, int data_len) {
+int LiveObjectsInstance_RscGetChunck(LiveObjectsClient_t* loc, const LiveObjectsD_Resource_t* rsc_ptr, char* data_ptr, int data_len) {
 #if LOC_FEATURE_LO_RESOURCES
 	int ret;
-	/* see code in LOCC_processGetRsc() function */
-	if ((_LOClient_Set_UpdatedRsc.ursc_cid) && (_LOClient_Set_UpdatedRsc.ursc_obj_ptr == rsc_ptr)) {
-		ret = LO_wget_data(data_ptr, data_len);
+	/* see code in LOCC_processGetRsc(loc) function */
+	if ((loc->Set_UpdatedRsc.ursc_cid) && (loc->Set_UpdatedRsc.ursc_obj_ptr == rsc_ptr)) {
+		ret = LO_wget_data(&loc->wget, data_ptr, data_len);
 		if (ret > 0) {
 			/* Update checksum md5 and offset */
 #if LOC_FEATURE_MBEDTLS
-			mbedtls_md5_update(&_LOClient_Set_UpdatedRsc.md5_ctx, (const unsigned char *) data_ptr, (size_t) ret);
+			mbedtls_md5_update(&loc->Set_UpdatedRsc.md5_ctx, (const unsigned char *) data_ptr, (size_t) ret);
 #endif
-			_LOClient_Set_UpdatedRsc.ursc_offset += ret;
+			loc->Set_UpdatedRsc.ursc_offset += ret;
 			LOTRACE_DBG1("(len=%d): read len=%d => new offset=%"PRIu32"/%"PRIu32, data_len,
-					ret, _LOClient_Set_UpdatedRsc.ursc_offset, _LOClient_Set_UpdatedRsc.ursc_size);
+					ret, loc->Set_UpdatedRsc.ursc_offset, loc->Set_UpdatedRsc.ursc_size);
 		}
 		else if (ret == 0) {
 			LOTRACE_NOTICE(
 					"No byte while reading %d bytes (offset=%"PRIu32"/%"PRIu32" of  %s)",
-					data_len, _LOClient_Set_UpdatedRsc.ursc_offset, _LOClient_Set_UpdatedRsc.ursc_size,
+					data_len, loc->Set_UpdatedRsc.ursc_offset, loc->Set_UpdatedRsc.ursc_size,
 					rsc_ptr->rsc_name);
 		}
 		else {
 			/*TODO: implement a procedure to retry the operation. at the last offset/md5 */
 			LOTRACE_ERR(
 					"ERROR(%d) while reading %d bytes (offset=%"PRIu32"/%"PRIu32" of  %s)",
-					ret, data_len, _LOClient_Set_UpdatedRsc.ursc_offset, _LOClient_Set_UpdatedRsc.ursc_size,
+					ret, data_len, loc->Set_UpdatedRsc.ursc_offset, loc->Set_UpdatedRsc.ursc_size,
 					rsc_ptr->rsc_name);
 		}
 	}
 	else {
 		LOTRACE_ERR("ERROR - No running resource download !");
-		LO_wget_close();
+		LO_wget_close(&loc->wget);
 		ret = -1;
 	}
 	return ret;
@@ -1732,49 +2962,57 @@ int LiveObjectsClient_RscGetChunck(const LiveObjectsD_Resource_t* rsc_ptr, char*
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_Cycle(int timeout_ms) {
+int LiveObjectsInstance_Cycle(LiveObjectsClient_t* loc, int timeout_ms) {
 	int ret;
 
-	if (!_LOClient_state_connected) {
+	if (!loc->state_connected) {
 		LOTRACE_INF("(tms=%d): ERROR - Not connected !!.", timeout_ms);
 		return -1;
 	}
 
 	LOTRACE_DBG1("(tms=%d) ...", timeout_ms);
 
+#if LOCC_BATCH
+	/*  -- Batches of data samples waiting for more than their linger time ? */
+	LOCC_processBatch(loc);
+#endif
 	/*  -- Pending user messages ? (command responses, ...) */
 #if LOM_MQUEUE
-	LOCC_processPendingMesssage();
+	LOCC_processPendingMesssage(loc);
+#endif
+#if LOCC_STORE
+	/*  -- Data messages stored while disconnected ? */
+	LOCC_processStore(loc);
 #endif
 
 #if LOC_FEATURE_LO_PARAMS
 	/* Something to publish ?  */
 	/*  -- Config Parameters ? */
-	ret = LOCC_processConfig();
+	ret = LOCC_processConfig(loc);
 #endif
 
 #if LOM_PUSH_ASYNC
 #if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
 	/*  -- 'Info' ? */
-	ret = LOCC_processStatus(0);
+	ret = LOCC_processStatus(loc, 0);
 #endif
 #if  LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
 	/*  -- 'Collected data' ? */
-	ret = LOCC_processData(0);
+	ret = LOCC_processData(loc, 0);
 #endif
 #endif /* LOM_PUSH_ASYNC */
 
 #if LOC_FEATURE_LO_RESOURCES
-	LOCC_processResources(0);
+	LOCC_processResources(loc, 0);
 
-	LOCC_processGetRsc();
+	LOCC_processGetRsc(loc);
 #endif
 
 	/* Get and process some MQTT messages received from the LiveObject Server */
-	ret = LiveObjectsClient_Yield(timeout_ms);
+	ret = LiveObjectsInstance_Yield(loc, timeout_ms);
 	if (ret) {
 		LOTRACE_NOTICE("ret=%d => Device Disconnecting ...", ret);
-		ret = LiveObjectsClient_Disconnect();
+		ret = LiveObjectsInstance_Disconnect(loc);
 		if (ret) {
 			LOTRACE_ERR("Device Disconnect, ret=%d", ret);
 		}
@@ -1782,10 +3020,10 @@ int LiveObjectsClient_Cycle(int timeout_ms) {
 	}
 
 #if LOC_FEATURE_LO_COMMANDS
-	LOCC_controlFeature(&_LOClient_Set_Cmd.cmd_enable, TOPIC_COMMAND);
+	LOCC_controlFeature(loc, &loc->Set_Cmd.cmd_enable, TOPIC_COMMAND);
 #endif
 #if LOC_FEATURE_LO_RESOURCES
-	LOCC_controlFeature(&_LOClient_Set_Rsc.rsc_enable, TOPIC_RSC_UPD);
+	LOCC_controlFeature(loc, &loc->Set_Rsc.rsc_enable, TOPIC_RSC_UPD);
 #endif
 	return 0;
 }
@@ -1794,48 +3032,151 @@ int LiveObjectsClient_Cycle(int timeout_ms) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int8_t LiveObjectsClient_ThreadState(void) {
-	return _LOClient_state_run;
+int8_t LiveObjectsInstance_ThreadState(LiveObjectsClient_t* loc) {
+	return loc->state_run;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LiveObjectsClient_Stop(void) {
-	if (_LOClient_state_run > 0) {
-		_LOClient_state_run = -1;
+int LiveObjectsInstance_Stop(LiveObjectsClient_t* loc) {
+	if (loc->state_run > 0) {
+		loc->state_run = -1;
+		LO_sys_eventSignal(loc->event);
 		return 0;
 	}
 	return -1;
 }
 
+/* --------------------------------------------------------------------------------- */
+/* Publish what has to be published: pending user messages, config parameters, ... */
+static void LOCC_runProcess(LiveObjectsClient_t* loc) {
+#if LOCC_BATCH
+	/*  -- Batches of data samples waiting for more than their linger time ? */
+	LOCC_processBatch(loc);
+#endif
+	/*  -- Pending user messages ? (command responses, ...) */
+#if LOM_MQUEUE
+	LOCC_processPendingMesssage(loc);
+#endif
+#if LOCC_STORE
+	/*  -- Data messages stored while disconnected ? */
+	LOCC_processStore(loc);
+#endif
+
+#if LOC_FEATURE_LO_PARAMS
+	/* Something to publish ? */
+	/*  -- Config Parameters ? */
+	LOCC_processConfig(loc);
+#endif
+
+#if LOM_PUSH_ASYNC
+#if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
+	/*  -- 'Info' ? */
+	LOCC_processStatus(loc, 0);
+#endif
+#if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
+	/*  -- 'Collected data' ? */
+	LOCC_processData(loc, 0);
+#endif
+#endif /* LOM_PUSH_ASYNC */
+
+#if LOC_FEATURE_LO_RESOURCES
+	LOCC_processResources(loc, 0);
+
+	LOCC_processGetRsc(loc);
+#endif
+}
+
 /* --------------------------------------------------------------------------------- */
 /*  */
-void LiveObjectsClient_Run(LiveObjectsD_CallbackState_t callback) {
+static void LOCC_runControl(LiveObjectsClient_t* loc) {
+#if LOC_FEATURE_LO_COMMANDS
+	LOCC_controlFeature(loc, &loc->Set_Cmd.cmd_enable, TOPIC_COMMAND);
+#endif
+#if LOC_FEATURE_LO_RESOURCES
+	LOCC_controlFeature(loc, &loc->Set_Rsc.rsc_enable, TOPIC_RSC_UPD);
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Max time to wait for an event: resource download, keepalive to send, stored message to replay,
+ * or LOC_RUN_WAIT_MAX_MS */
+static int32_t LOCC_runTimeout(LiveObjectsClient_t* loc) {
+	int32_t tmo_ms = LOC_RUN_WAIT_MAX_MS;
+
+#if LOC_FEATURE_LO_RESOURCES
+	if (loc->Set_UpdatedRsc.ursc_connected) {
+		/* Resource download in progress */
+		tmo_ms = 0;
+	}
+#endif
+	if (loc->mqtt_ctx.keepAliveInterval) {
+		/* Time to send the next PINGREQ (or to check the PINGRESP) */
+		int32_t ping_ms = TimerLeftMS(&loc->mqtt_ctx.ping_timer);
+		if (ping_ms < tmo_ms) {
+			tmo_ms = ping_ms;
+		}
+	}
+#if LOCC_STORE
+	if ((loc->store) && (LO_store_backlog(loc->store))) {
+		/* Next stored message to replay */
+		int32_t store_ms = LOCC_storeWaitMs(loc);
+		if (store_ms < tmo_ms) {
+			tmo_ms = store_ms;
+		}
+	}
+#endif
+#if LOCC_BATCH
+	/* Next batch of data samples to publish */
+	tmo_ms = LOCC_batchWaitMs(loc, tmo_ms);
+#endif
+	return tmo_ms;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Sleep until something has to be done: data received from the server, message pushed
+ * by a user thread, keepalive to send, or LOC_RUN_WAIT_MAX_MS elapsed.
+ */
+static int LOCC_waitEvent(LiveObjectsClient_t* loc) {
+	if (netw_bytesAvailable(&loc->MQTTClient_network) > 0) {
+		/* Already decrypted by the TLS layer, the socket will not be signaled */
+		return LO_SYS_EVENT_SOCK;
+	}
+	return LO_sys_eventWait(loc->event, LOCC_runTimeout(loc));
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LiveObjectsInstance_Run(LiveObjectsClient_t* loc, LiveObjectsD_CallbackState_t callback) {
 	int ret;
 	uint32_t loop_cnt;
 
-	LO_sys_threadRun();
-	_LOClient_state_run = 1;
+	loc->thread_id = LO_sys_threadSelf();
+	LOTRACE_WARN("LiveObjectsClient %p: thread_id= x%lx", loc, (unsigned long) loc->thread_id);
+	loc->state_run = 1;
 
-	while (_LOClient_state_run > 0) {
+	while (loc->state_run > 0) {
 		ret = -1;
 		loop_cnt = 0;
 
-		LOCC_connectInit(0);
+		LOCC_connectInit(loc, 0);
 
-		while (_LOClient_state_run > 0) {
+		while (loc->state_run > 0) {
+			LOCC_retryWait(loc);
+			if (loc->state_run <= 0) {
+				break;
+			}
 			LOTRACE_DBG1("Try connection ...");
 			if (callback) {
 				callback(CSTATE_CONNECTING);
 			}
-			ret = LOCC_connectStart();
+			ret = LOCC_connectStart(loc);
 			if (ret == 0) {
 				break;
 			}
-			WAIT_MS(5000);
 		}
 
-		if ((_LOClient_state_run > 0) && (_LOClient_state_connected)) {
+		if ((loc->state_run > 0) && (loc->state_connected)) {
 
 			LO_sys_threadCheck();
 
@@ -1843,72 +3184,51 @@ void LiveObjectsClient_Run(LiveObjectsD_CallbackState_t callback) {
 				callback(CSTATE_CONNECTED);
 			}
 
-			LOCC_connectOK();
+			LOCC_connectOK(loc);
 
+			LO_sys_eventSocket(loc->event, loc->MQTTClient_network.my_socket);
 		}
 
-		while ((_LOClient_state_run > 0) && (_LOClient_state_connected)) {
+		while ((loc->state_run > 0) && (loc->state_connected)) {
 
 			++loop_cnt;
 			if ((loop_cnt % 10) == 0) {
 				LOTRACE_DBG1("I am alive - %"PRIu32, loop_cnt);
 			}
 
-			/*  -- Pending user messages ? (command responses, ...) */
-#if LOM_MQUEUE
-			LOCC_processPendingMesssage();
-#endif
-
-#if LOC_FEATURE_LO_PARAMS
-			/* Something to publish ? */
-			/*  -- Config Parameters ? */
-			ret = LOCC_processConfig();
-#endif
-
-#if LOM_PUSH_ASYNC
-#if LOC_FEATURE_LO_STATUS  && (LOC_MAX_OF_DATA_SET > 0)
-			/*  -- 'Info' ? */
-			ret = LOCC_processStatus(0);
-#endif
-#if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
-			/*  -- 'Collected data' ? */
-			ret = LOCC_processData(0);
-#endif
-#endif /* LOM_PUSH_ASYNC */
-
-#if LOC_FEATURE_LO_RESOURCES
-			LOCC_processResources(0);
+			LOCC_runProcess(loc);
 
-			LOCC_processGetRsc();
-#endif
+			/* Wait for something to do */
+			ret = LOCC_waitEvent(loc);
+			if (ret == LO_SYS_EVENT_USER) {
+				/* Only messages pushed by user threads, publish them now */
+				continue;
+			}
 
 			/* Get and process some MQTT messages received from the LiveObject Server */
-			ret = LiveObjectsClient_Yield(100);
+			ret = LiveObjectsInstance_Yield(loc, 1);
 			if (ret) {
 				LOTRACE_ERR("Device Yield, ret=%d", ret);
 				break;
 			}
-#if LOC_FEATURE_LO_COMMANDS
-			LOCC_controlFeature(&_LOClient_Set_Cmd.cmd_enable, TOPIC_COMMAND);
-#endif
-#if LOC_FEATURE_LO_RESOURCES
-			LOCC_controlFeature(&_LOClient_Set_Rsc.rsc_enable, TOPIC_RSC_UPD);
-#endif
+			LOCC_runControl(loc);
 			ret = 0;
 		}
+		LO_sys_eventSocket(loc->event, -1);
 		LOTRACE_NOTICE("Device Disconnecting ...");
-		ret = LiveObjectsClient_Disconnect();
+		ret = LiveObjectsInstance_Disconnect(loc);
 		if (ret) {
 			LOTRACE_ERR("Device Disconnect, ret=%d", ret);
 		}
 		if (callback) {
 			callback(CSTATE_DISCONNECTED);
 		}
-		LOTRACE_NOTICE("WAIT 5 seconds ...");
-		WAIT_MS(5000);
+		LOCC_retryDown(loc);
 	}
+	LO_sys_eventNetwork(loc->event, 0);
 
-	_LOClient_state_run = -2;
+	loc->state_run = -2;
+	loc->thread_id = 0;
 
 	if (callback) {
 		callback(CSTATE_DOWN);
@@ -1916,46 +3236,643 @@ void LiveObjectsClient_Run(LiveObjectsD_CallbackState_t callback) {
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-int LiveObjectsClient_ThreadStart(LiveObjectsD_CallbackState_t callback) {
-	int ret;
-	LOTRACE_INF("(callback=x%p) ...", callback);
-	ret = LO_sys_threadStart((void const *) callback);
-	if (ret)
-		LOTRACE_ERR("(x%p) ret=%d", callback, ret);
+/* Instance run by a gateway worker (see loc_gateway.c) */
+int LOCC_instanceAttach(LiveObjectsClient_t* loc, LOSysEventGroup_t* grp, LiveObjectsD_CallbackState_t callback) {
+	if ((loc->event == NULL) || (loc->group) || ((loc->state_run != 0) && (loc->state_run != -2))) {
+		LOTRACE_ERR("%p: ERROR - not initialized or already running (state=%d)", loc, loc->state_run);
+		return -1;
+	}
+	loc->thread_callback = callback;
+	loc->state_run = 0;
+	loc->group = grp;
+	if (LO_sys_groupAdd(grp, loc->event, loc)) {
+		loc->group = NULL;
+		return -1;
+	}
+	/* First step as soon as possible */
+	LO_sys_eventSignal(loc->event);
+	return 0;
+}
 
-	return ret;
+/* --------------------------------------------------------------------------------- */
+/* Connection failed or lost: schedule the next attempt */
+static void LOCC_stepRetry(LiveObjectsClient_t* loc) {
+	LO_sys_eventTimer(loc->event, LOCC_retrySchedule(loc));
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-int LiveObjectsClient_Publish(const char* topicName, const char* payload_data) {
-#if LOM_MQUEUE
-	char* p_msg;
-	short tlen = strlen(topicName);
-	int len = 1 + 2 + tlen + 1 + strlen(payload_data) + 2;
-	p_msg = (char*) MEM_ALLOC(len);
-	if (p_msg) {
-		char *pc = p_msg;
-		*pc++ = MTYPE_PUB_USR_MSG;     /* 1- Set the message type */
-		memcpy(pc, &tlen, 2);          /* 2- Copy the topic length */
-		pc += 2;
-		strcpy(pc, topicName);         /* 3- Copy the topic */
-		pc += tlen;
-		*pc++ = 0;
-		strcpy(pc, payload_data);      /* 4- Copy the payload */
-		LOTRACE_NOTICE("MEM_ALLOC msg=x%p msg_type=x%x", p_msg, *p_msg);
-		if (LOCC_mqPut(p_msg) == 0) {  /* 5- Put in the queue */
-			return 0;
-		}
-		LOTRACE_ERR("ERROR to enqueue msg -> MEM_FREE msg %p x%x", p_msg, *p_msg);
-		MEM_FREE(p_msg);
-	}
-	else {
-		LOTRACE_ERR("MALLOC ERROR");
+/* Same processing as one loop of LiveObjectsInstance_Run(), but the gateway worker waits
+ * for the events of all its instances.
+ */
+int LOCC_instanceStep(LiveObjectsClient_t* loc, LOCCStepInfo_t* info) {
+	LiveObjectsD_CallbackState_t callback = loc->thread_callback;
+	uint32_t published = loc->stat_published;
+	uint32_t received = loc->stat_received;
+	int first = 0;
+	int events;
+	int ret;
+
+	info->connected = 0;
+	info->published = 0;
+	info->received = 0;
+
+	events = LO_sys_eventPoll(loc->event);
+
+	if (loc->state_run == 0) {
+		loc->thread_id = LO_sys_threadSelf();
+		loc->state_run = 1;
+		TimerInit(&loc->retry_timer);
+		first = 1;
 	}
-#else
-	LOTRACE_NOTICE("Not supported");
+
+	if (loc->state_run < 0) {
+		/* Stopped by LiveObjectsInstance_Stop() */
+		if (loc->state_connected) {
+			LO_sys_eventSocket(loc->event, -1);
+			LiveObjectsInstance_Disconnect(loc);
+			info->connected = -1;
+			if (callback) {
+				callback(CSTATE_DISCONNECTED);
+			}
+		}
+		LO_sys_eventTimer(loc->event, -1);
+		LO_sys_eventNetwork(loc->event, 0);
+		LO_sys_groupRemove(loc->group, loc->event);
+		loc->group = NULL;
+		loc->thread_id = 0;
+		loc->state_run = -2;
+		if (callback) {
+			callback(CSTATE_DOWN);
+		}
+		return -1;
+	}
+
+	if (!loc->state_connected) {
+		if ((!TimerIsExpired(&loc->retry_timer)) && (!LOCC_retryWakeUp(loc, events))) {
+			LO_sys_eventTimer(loc->event, TimerLeftMS(&loc->retry_timer));
+			return first;
+		}
+		if (callback) {
+			callback(CSTATE_CONNECTING);
+		}
+		LOCC_connectInit(loc, 0);
+		/* Synchronous: the other instances of the worker wait (see LiveObjectsClient_Gateway.h) */
+		ret = LOCC_connectStart(loc);
+		if ((ret) || (!loc->state_connected)) {
+			LOCC_stepRetry(loc);
+			return first;
+		}
+		info->connected = 1;
+		if (callback) {
+			callback(CSTATE_CONNECTED);
+		}
+		LOCC_connectOK(loc);
+		LO_sys_eventSocket(loc->event, loc->MQTTClient_network.my_socket);
+	}
+
+	LOCC_runProcess(loc);
+
+	if ((events & LO_SYS_EVENT_SOCK) || (netw_bytesAvailable(&loc->MQTTClient_network) > 0)
+			|| ((loc->mqtt_ctx.keepAliveInterval) && (TimerIsExpired(&loc->mqtt_ctx.ping_timer)))) {
+		/* Get and process some MQTT messages received from the LiveObject Server */
+		ret = LiveObjectsInstance_Yield(loc, 1);
+		if (ret) {
+			LOTRACE_ERR("Device Yield, ret=%d", ret);
+			LO_sys_eventSocket(loc->event, -1);
+			LiveObjectsInstance_Disconnect(loc);
+			info->connected = (info->connected) ? 0 : -1;
+			if (callback) {
+				callback(CSTATE_DISCONNECTED);
+			}
+			LOCC_retryDown(loc);
+			LOCC_stepRetry(loc);
+		}
+		else {
+			LOCC_runControl(loc);
+		}
+	}
+
+	if (loc->state_connected) {
+		LO_sys_eventTimer(loc->event,
+				(netw_bytesAvailable(&loc->MQTTClient_network) > 0) ? 0 : LOCC_runTimeout(loc));
+	}
+
+	info->published = loc->stat_published - published;
+	info->received = loc->stat_received - received;
+	return first;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Entry point of the thread started by LiveObjectsInstance_ThreadStart() */
+static void LOCC_threadExec(void* argument) {
+	LiveObjectsClient_t* loc = (LiveObjectsClient_t*) argument;
+	LiveObjectsInstance_Run(loc, loc->thread_callback);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_ThreadStart(LiveObjectsClient_t* loc, LiveObjectsD_CallbackState_t callback) {
+	int ret;
+	LOTRACE_INF("(callback=x%p) ...", callback);
+	loc->thread_callback = callback;
+	ret = LO_sys_threadStart(LOCC_threadExec, loc);
+	if (ret)
+		LOTRACE_ERR("(x%p) ret=%d", callback, ret);
+
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Allocate a user message: the topic is copied just before the payload
+ * (and before the packet id with QoS 1) */
+#if LOM_MQUEUE
+static char* LOCC_publishAlloc(const char* topicName, const char* payload_data, uint8_t qos) {
+	char* p_msg;
+	uint32_t tlen = strlen(topicName);
+	uint32_t plen = strlen(payload_data);
+	uint32_t offset = sizeof(LOMsgHeader_t) + LOM_MSG_MQTT_HDR_SZ + tlen;
+	if ((tlen == 0) || (offset > 0xFFFF)) {
+		LOTRACE_ERR("Bad topic, len=%"PRIu32, tlen);
+		return NULL;
+	}
+	p_msg = LO_mpool_alloc(offset + plen + 1);
+	if (p_msg) {
+		LOMsgHeader_t* hdr = LOM_MSG_HDR(p_msg);
+		memset(hdr, 0, sizeof(LOMsgHeader_t));
+		hdr->msg_type = MTYPE_PUB_USR_MSG;         /* 1- Set the message type */
+		hdr->qos = qos;
+		hdr->topic_len = tlen;                     /* 2- Set the topic and payload lengths */
+		hdr->payload_offset = offset;
+		hdr->payload_len = plen;
+		memcpy((char*) LOM_MSG_TOPIC(p_msg), topicName, tlen);  /* 3- Copy the topic before the payload */
+		memcpy(p_msg + offset, payload_data, plen + 1);           /* 4- Copy the payload */
+		LOTRACE_NOTICE("alloc msg=x%p msg_type=x%x", p_msg, *p_msg);
+	}
+	else {
+		LOTRACE_ERR("MALLOC ERROR");
+	}
+	return p_msg;
+}
+#endif
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_Publish(LiveObjectsClient_t* loc, const char* topicName, const char* payload_data) {
+#if LOM_MQUEUE
+	char* p_msg = LOCC_publishAlloc(topicName, payload_data, QOS0);
+	if (p_msg) {
+		if (LOCC_mqPut(loc, p_msg) == 0) {  /* 5- Put in the queue */
+			return 0;
+		}
+		LOTRACE_ERR("ERROR to enqueue msg -> release msg %p x%x", p_msg, *p_msg);
+		LO_mpool_free(p_msg);
+	}
+#else
+	LOTRACE_NOTICE("Not supported");
+#endif
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_PublishQos1(LiveObjectsClient_t* loc, const char* topicName, const char* payload_data,
+		LiveObjectsD_CallbackPubAck_t callback, void* msg_ctx) {
+#if LOM_MQUEUE
+	char* p_msg;
+	if (loc->queue.slots == NULL) {
+		LOTRACE_ERR("Not initialized");
+		return -1;
+	}
+	p_msg = LOCC_publishAlloc(topicName, payload_data, QOS1);
+	if (p_msg) {
+		return LOCC_mqPutQos1(loc, p_msg, callback, msg_ctx);
+	}
+#else
+	LOTRACE_NOTICE("Not supported");
+#endif
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_GetQueueStats(LiveObjectsClient_t* loc, LiveObjectsD_MqStats_t* stats) {
+	if (stats == NULL) {
+		return -1;
+	}
+#if LOM_MQUEUE
+	LO_mq_getStats(&loc->queue, stats);
+	return 0;
+#else
+	memset(stats, 0, sizeof(LiveObjectsD_MqStats_t));
+	return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_GetInflightStats(LiveObjectsClient_t* loc, LiveObjectsD_InflightStats_t* stats) {
+	if (stats == NULL) {
+		return -1;
+	}
+	memset(stats, 0, sizeof(LiveObjectsD_InflightStats_t));
+#if LOM_MQUEUE
+	stats->inf_window = LOC_MQTT_INFLIGHT_MAX;
+	stats->inf_depth = LO_ATOMIC_LOAD(&loc->inflight_nb);
+	stats->inf_high_water = LO_ATOMIC_LOAD(&loc->inflight_high_water);
+	stats->inf_acked = LO_ATOMIC_LOAD(&loc->inflight_acked);
+	stats->inf_retransmitted = LO_ATOMIC_LOAD(&loc->inflight_retransmitted);
+	stats->inf_dropped = LO_ATOMIC_LOAD(&loc->inflight_dropped);
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_GetStoreStats(LiveObjectsClient_t* loc, LiveObjectsD_StoreStats_t* stats) {
+	if (stats == NULL) {
+		return -1;
+	}
+	memset(stats, 0, sizeof(LiveObjectsD_StoreStats_t));
+#if LOCC_STORE
+	if (loc->store) {
+		LO_store_getStats(loc->store, stats);
+		return 0;
+	}
+#endif
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_GetTlsStats(LiveObjectsClient_t* loc, LiveObjectsD_TlsStats_t* stats) {
+	if (stats == NULL) {
+		return -1;
+	}
+	netw_tls_getStats(&loc->MQTTClient_network, stats);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_GetDataBatchStats(LiveObjectsClient_t* loc, int data_hdl, LiveObjectsD_BatchStats_t* stats) {
+#if LOCC_BATCH
+	if ((stats) && (data_hdl >= 0) && (data_hdl < LOC_MAX_OF_DATA_SET)) {
+		LOCCBatch_t* batch = &loc->batch[data_hdl];
+		if (batch->mutex == NULL) {
+			memset(stats, 0, sizeof(LiveObjectsD_BatchStats_t));
+			return 0;
+		}
+		LO_sys_mutexLock(batch->mutex);
+		*stats = batch->stats;
+		LO_sys_mutexUnlock(batch->mutex);
+		if ((stats->bt_messages) && (stats->bt_size)) {
+			stats->bt_fill_pct = (uint32_t) (((uint64_t) stats->bt_samples * 100)
+					/ ((uint64_t) stats->bt_messages * stats->bt_size));
+		}
+		if (stats->bt_samples) {
+			stats->bt_bytes_per_sample = stats->bt_bytes / stats->bt_samples;
+		}
+		return 0;
+	}
+#else
+	(void) loc;
+	(void) data_hdl;
+	(void) stats;
+#endif
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsInstance_GetReconnectStats(LiveObjectsClient_t* loc, LiveObjectsD_ReconnectStats_t* stats) {
+	if (stats == NULL) {
+		return -1;
+	}
+	*stats = loc->retry_stats;
+	if ((!loc->state_connected) && (stats->rc_next_ms)) {
+		stats->rc_next_ms = (TimerIsExpired(&loc->retry_timer)) ? 0 : TimerLeftMS(&loc->retry_timer);
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_GetPoolStats(LiveObjectsD_PoolStats_t* stats) {
+	if (stats == NULL) {
+		return -1;
+	}
+#if LOM_MQUEUE
+	LO_mpool_getStats(stats);
+	return 0;
+#else
+	memset(stats, 0, sizeof(LiveObjectsD_PoolStats_t));
+	return -1;
+#endif
+}
+
+/* ================================================================================= */
+/* Public Functions : default instance
+ * -----------------------------------
+ */
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_Init(void* network_itf_handle, unsigned long long apikey_p1_, unsigned long long apikey_p2_) {
+	return LiveObjectsInstance_Init(LOCC_default(), network_itf_handle, apikey_p1_, apikey_p2_);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetQueueParams(uint32_t capacity, LiveObjectsD_MqPolicy_t policy, uint32_t timeout_ms) {
+	return LiveObjectsInstance_SetQueueParams(LOCC_default(), capacity, policy, timeout_ms);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetRetryParams(uint32_t delay_ms, uint32_t max_delay_ms) {
+	return LiveObjectsInstance_SetRetryParams(LOCC_default(), delay_ms, max_delay_ms);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_NetworkChanged(void) {
+	return LiveObjectsInstance_NetworkChanged(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetStore(const char* dir, uint32_t max_bytes) {
+	return LiveObjectsInstance_SetStore(LOCC_default(), dir, max_bytes);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetTlsSessionFile(const char* path) {
+	return LiveObjectsInstance_SetTlsSessionFile(LOCC_default(), path);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetDevId(const char* dev_id) {
+	return LiveObjectsInstance_SetDevId(LOCC_default(), dev_id);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetNameSpace(const char* name_space) {
+	return LiveObjectsInstance_SetNameSpace(LOCC_default(), name_space);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_AttachCfgParams(const LiveObjectsD_Param_t* param_ptr, int32_t param_nb,
+		LiveObjectsD_CallbackParams_t callback) {
+	return LiveObjectsInstance_AttachCfgParams(LOCC_default(), param_ptr, param_nb, callback);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_AttachStatus(const LiveObjectsD_Data_t* data_ptr, int32_t data_nb) {
+	return LiveObjectsInstance_AttachStatus(LOCC_default(), data_ptr, data_nb);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_AttachData(uint8_t stream_prefix, const char* stream_id, const char* model, const char* tags,
+		const LiveObjectsD_GpsFix_t* gps_ptr, const LiveObjectsD_Data_t* data_ptr, int32_t data_nb) {
+	return LiveObjectsInstance_AttachData(LOCC_default(), stream_prefix, stream_id, model, tags, gps_ptr, data_ptr, data_nb);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_AttachCommands(const LiveObjectsD_Command_t* cmd_ptr, int32_t cmd_nb,
+		LiveObjectsD_CallbackCommand_t callback) {
+	return LiveObjectsInstance_AttachCommands(LOCC_default(), cmd_ptr, cmd_nb, callback);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_ControlCommands(bool enable) {
+	return LiveObjectsInstance_ControlCommands(LOCC_default(), enable);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_AttachResources(const LiveObjectsD_Resource_t* rsc_ptr, int32_t rsc_nb,
+		LiveObjectsD_CallbackResourceNotify_t ntfyCB, LiveObjectsD_CallbackResourceData_t dataCB) {
+	return LiveObjectsInstance_AttachResources(LOCC_default(), rsc_ptr, rsc_nb, ntfyCB, dataCB);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_ControlResources(bool enable) {
+	return LiveObjectsInstance_ControlResources(LOCC_default(), enable);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_ChangeDataStreamId(uint8_t prefix, int data_hdl, const char* stream_id) {
+	return LiveObjectsInstance_ChangeDataStreamId(LOCC_default(), prefix, data_hdl, stream_id);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_RemoveData(int data_hdl) {
+	return LiveObjectsInstance_RemoveData(LOCC_default(), data_hdl);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_RemoveCommands(void) {
+	return LiveObjectsInstance_RemoveCommands(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_RemoveResources(void) {
+	return LiveObjectsInstance_RemoveResources(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_Connect(void) {
+	return LiveObjectsInstance_Connect(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_Disconnect(void) {
+	return LiveObjectsInstance_Disconnect(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_Yield(int timeout_ms) {
+	return LiveObjectsInstance_Yield(LOCC_default(), timeout_ms);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_PushResources(void) {
+	return LiveObjectsInstance_PushResources(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_PushStatus(int handle) {
+	return LiveObjectsInstance_PushStatus(LOCC_default(), handle);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_PushData(int data_hdl) {
+	return LiveObjectsInstance_PushData(LOCC_default(), data_hdl);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_PushDataQos1(int data_hdl, LiveObjectsD_CallbackPubAck_t callback, void* msg_ctx) {
+	return LiveObjectsInstance_PushDataQos1(LOCC_default(), data_hdl, callback, msg_ctx);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_PushCfgParams(void) {
+	return LiveObjectsInstance_PushCfgParams(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_CommandResponse(int32_t cid, const LiveObjectsD_Data_t* data_ptr, int data_nb) {
+	return LiveObjectsInstance_CommandResponse(LOCC_default(), cid, data_ptr, data_nb);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_RscGetChunck(const LiveObjectsD_Resource_t* rsc_ptr, char* data_ptr, int data_len) {
+	return LiveObjectsInstance_RscGetChunck(LOCC_default(), rsc_ptr, data_ptr, data_len);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_Cycle(int timeout_ms) {
+	return LiveObjectsInstance_Cycle(LOCC_default(), timeout_ms);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int8_t LiveObjectsClient_ThreadState(void) {
+	return LiveObjectsInstance_ThreadState(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_Stop(void) {
+	return LiveObjectsInstance_Stop(LOCC_default());
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LiveObjectsClient_Run(LiveObjectsD_CallbackState_t callback) {
+	LiveObjectsInstance_Run(LOCC_default(), callback);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_ThreadStart(LiveObjectsD_CallbackState_t callback) {
+	return LiveObjectsInstance_ThreadStart(LOCC_default(), callback);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_Publish(const char* topicName, const char* payload_data) {
+	return LiveObjectsInstance_Publish(LOCC_default(), topicName, payload_data);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_PublishQos1(const char* topicName, const char* payload_data,
+		LiveObjectsD_CallbackPubAck_t callback, void* msg_ctx) {
+	return LiveObjectsInstance_PublishQos1(LOCC_default(), topicName, payload_data, callback, msg_ctx);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_GetQueueStats(LiveObjectsD_MqStats_t* stats) {
+	return LiveObjectsInstance_GetQueueStats(LOCC_default(), stats);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_GetInflightStats(LiveObjectsD_InflightStats_t* stats) {
+	return LiveObjectsInstance_GetInflightStats(LOCC_default(), stats);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_GetStoreStats(LiveObjectsD_StoreStats_t* stats) {
+	return LiveObjectsInstance_GetStoreStats(LOCC_default(), stats);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_GetTlsStats(LiveObjectsD_TlsStats_t* stats) {
+	return LiveObjectsInstance_GetTlsStats(LOCC_default(), stats);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_GetReconnectStats(LiveObjectsD_ReconnectStats_t* stats) {
+	return LiveObjectsInstance_GetReconnectStats(LOCC_default(), stats);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetDataBatch(int handle, uint32_t batch_size, uint32_t linger_ms) {
+	return LiveObjectsInstance_SetDataBatch(LOCC_default(), handle, batch_size, linger_ms);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetDataEncoding(int handle, LiveObjectsD_Encoding_t encoding) {
+	return LiveObjectsInstance_SetDataEncoding(LOCC_default(), handle, encoding);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetDataEncoder(int handle, LiveObjectsD_DataEncoder_t encoder, void* ctx) {
+#if LOC_FEATURE_LO_DATA && (LOC_MAX_OF_DATA_SET > 0)
+	LiveObjectsClient_t* loc = LOCC_default();
+	if ((handle >= 0) && (handle < LOC_MAX_OF_DATA_SET) && loc->Set_Data[handle].stream_id[0]) {
+		loc->Set_Data[handle].encoder = encoder;
+		loc->Set_Data[handle].encoder_ctx = ctx;
+		LOTRACE_INF("data_hdl=%d encoder=%p", handle, encoder);
+		return 0;
+	}
+#else
+	(void) handle;
+	(void) encoder;
+	(void) ctx;
 #endif
 	return -1;
 }
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetStatusEncoding(int handle, LiveObjectsD_Encoding_t encoding) {
+	return LiveObjectsInstance_SetStatusEncoding(LOCC_default(), handle, encoding);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_SetStatusDelta(int handle, uint32_t resync_ms) {
+	return LiveObjectsInstance_SetStatusDelta(LOCC_default(), handle, resync_ms);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsClient_GetDataBatchStats(int handle, LiveObjectsD_BatchStats_t* stats) {
+	return LiveObjectsInstance_GetDataBatchStats(LOCC_default(), handle, stats);
+}
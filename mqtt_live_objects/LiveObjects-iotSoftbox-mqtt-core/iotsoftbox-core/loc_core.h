@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file   loc_core.h
+ * @brief  Services of the LiveObjects Client core used by the gateway workers
+ *
+ */
+
+#ifndef __loc_core_H_
+#define __loc_core_H_
+
+#include <stdint.h>
+
+#include "liveobjects-client/LiveObjectsClient_Instance.h"
+
+#include "loc_sys.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/** Activity of an instance during one step */
+typedef struct {
+	int8_t   connected;   /* +1: connected, -1: disconnected during this step */
+	uint32_t published;   /* Number of MQTT messages published during this step */
+	uint32_t received;    /* Number of MQTT messages received during this step */
+} LOCCStepInfo_t;
+
+/* Add the events of the instance to the group of a gateway worker */
+int LOCC_instanceAttach(LiveObjectsClient_t* loc, LOSysEventGroup_t* grp, LiveObjectsD_CallbackState_t callback);
+
+/* Do what has to be done by the instance (connection, messages to publish, data received, ...)
+ * without waiting, and arm the timer of its events for the next step.
+ * Return 1 for the first step, 0 for the next ones and -1 when the instance is stopped
+ * (removed from the group, it can be destroyed now) */
+int LOCC_instanceStep(LiveObjectsClient_t* loc, LOCCStepInfo_t* info);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __loc_core_H_ */
@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file  loc_gateway.c
+ * @brief Gateway: LiveObjects Client instances run by a pool of worker threads
+ */
+
+#include "liveobjects-client/LiveObjectsClient_Config.h"
+#include "liveobjects-client/LiveObjectsClient_Gateway.h"
+
+#include "loc_core.h"
+#include "loc_sys.h"
+
+#ifndef TRACE_GROUP
+#define TRACE_GROUP "GATEWAY"
+#endif
+#include "liveobjects-sys/loc_trace.h"
+
+#include <string.h>
+
+#include "liveobjects-sys/LiveObjectsClient_Platform.h"
+#include "platform_default.h"
+
+/* Max number of ready instances got by one wait of a worker */
+#define LOGW_READY_MAX    64
+
+/* Worker thread, running a shard of instances */
+typedef struct {
+	LOSysEventGroup_t* group;
+
+	/* Instances already started by this worker (only used by the worker thread) */
+	LiveObjectsClient_t** sessions;
+	uint32_t session_nb;
+	uint32_t session_max;
+
+	volatile uint32_t attached;      /* Number of attached instances (started or not) */
+	volatile int8_t   state;         /* 0: not started, 1: running, -1: stop requested, -2: ended (atomic) */
+
+	/* Statistics, written by the worker thread */
+	volatile uint32_t cnt_connected;
+	volatile uint32_t cnt_published;
+	volatile uint32_t cnt_received;
+	volatile uint32_t cnt_steps;
+	volatile uint64_t step_us_total;
+	volatile uint32_t step_us_max;
+} LOGwWorker_t;
+
+struct LiveObjectsGateway {
+	uint32_t worker_nb;
+	volatile uint8_t stopping;
+	uint64_t start_us;
+	LOGwWorker_t worker[LOC_GATEWAY_WORKER_MAX];
+};
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LOGW_sessionAdd(LOGwWorker_t* w, LiveObjectsClient_t* loc) {
+	if (w->session_nb >= w->session_max) {
+		uint32_t max = (w->session_max) ? 2 * w->session_max : 64;
+		LiveObjectsClient_t** sessions = (LiveObjectsClient_t**) MEM_ALLOC(max * sizeof(LiveObjectsClient_t*));
+		if (sessions == NULL) {
+			LOTRACE_ERR("MEM_ALLOC ERROR (%u sessions)", max);
+			return -1;
+		}
+		if (w->sessions) {
+			memcpy(sessions, w->sessions, w->session_nb * sizeof(LiveObjectsClient_t*));
+			MEM_FREE(w->sessions);
+		}
+		w->sessions = sessions;
+		w->session_max = max;
+	}
+	w->sessions[w->session_nb++] = loc;
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void LOGW_sessionRemove(LOGwWorker_t* w, LiveObjectsClient_t* loc) {
+	uint32_t i;
+	for (i = 0; i < w->session_nb; i++) {
+		if (w->sessions[i] == loc) {
+			w->sessions[i] = w->sessions[--w->session_nb];
+			return;
+		}
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void LOGW_step(LOGwWorker_t* w, LiveObjectsClient_t* loc) {
+	LOCCStepInfo_t info;
+	uint64_t t0 = LO_sys_timeUs();
+	uint32_t dt;
+	int ret;
+
+	ret = LOCC_instanceStep(loc, &info);
+
+	dt = (uint32_t) (LO_sys_timeUs() - t0);
+	LO_ATOMIC_ADD(&w->cnt_steps, 1);
+	LO_ATOMIC_ADD(&w->step_us_total, dt);
+	if (dt > w->step_us_max) {
+		LO_ATOMIC_STORE(&w->step_us_max, dt);
+	}
+	if (info.published) {
+		LO_ATOMIC_ADD(&w->cnt_published, info.published);
+	}
+	if (info.received) {
+		LO_ATOMIC_ADD(&w->cnt_received, info.received);
+	}
+	if (info.connected) {
+		LO_ATOMIC_ADD(&w->cnt_connected, (uint32_t) (int32_t) info.connected);
+	}
+
+	if (ret > 0) {
+		if (LOGW_sessionAdd(w, loc)) {
+			LOTRACE_ERR("%p: ERROR - cannot keep this instance, stop it", loc);
+			LiveObjectsInstance_Stop(loc);
+		}
+	}
+	else if (ret < 0) {
+		/* Stopped: the instance may be destroyed by the user from now */
+		LOGW_sessionRemove(w, loc);
+		LO_ATOMIC_ADD(&w->attached, (uint32_t) -1);
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Entry point of a worker thread */
+static void LOGW_workerExec(void* argument) {
+	LOGwWorker_t* w = (LOGwWorker_t*) argument;
+	void* ready[LOGW_READY_MAX];
+	uint32_t i;
+	int n;
+
+	LOTRACE_INF("Worker %p: running ...", w);
+
+	while (1) {
+		if (LO_ATOMIC_LOAD(&w->state) < 0) {
+			/* Stop the instances started since the last loop (no effect on the others) */
+			for (i = 0; i < w->session_nb; i++) {
+				LiveObjectsInstance_Stop(w->sessions[i]);
+			}
+			if (LO_ATOMIC_LOAD(&w->attached) == 0) {
+				break;
+			}
+		}
+
+		n = LO_sys_groupWait(w->group, -1, ready, LOGW_READY_MAX);
+		if (n < 0) {
+			WAIT_MS(10);
+			continue;
+		}
+		for (i = 0; i < (uint32_t) n; i++) {
+			LOGW_step(w, (LiveObjectsClient_t*) ready[i]);
+		}
+	}
+
+	LOTRACE_INF("Worker %p: end", w);
+	LO_ATOMIC_STORE(&w->state, -2);
+}
+
+/* ================================================================================= */
+/* Public Functions
+ * ----------------
+ */
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+LiveObjectsGateway_t* LiveObjectsGateway_Create(uint32_t worker_nb) {
+	LiveObjectsGateway_t* gw;
+	uint32_t i;
+
+	if (worker_nb == 0) {
+		worker_nb = LO_sys_cpuCount();
+	}
+	if (worker_nb > LOC_GATEWAY_WORKER_MAX) {
+		worker_nb = LOC_GATEWAY_WORKER_MAX;
+	}
+
+	LO_sys_init();
+
+	gw = (LiveObjectsGateway_t*) MEM_ALLOC(sizeof(LiveObjectsGateway_t));
+	if (gw == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (size=%u)", (unsigned) sizeof(LiveObjectsGateway_t));
+		return NULL;
+	}
+	memset(gw, 0, sizeof(LiveObjectsGateway_t));
+	gw->worker_nb = worker_nb;
+
+	for (i = 0; i < worker_nb; i++) {
+		gw->worker[i].group = LO_sys_groupCreate();
+		if (gw->worker[i].group == NULL) {
+			LiveObjectsGateway_Destroy(gw);
+			return NULL;
+		}
+	}
+	LOTRACE_INF("Gateway %p: %u workers", gw, worker_nb);
+	return gw;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsGateway_Start(LiveObjectsGateway_t* gw) {
+	uint32_t i;
+
+	if ((gw == NULL) || (gw->stopping)) {
+		return -1;
+	}
+	gw->start_us = LO_sys_timeUs();
+	for (i = 0; i < gw->worker_nb; i++) {
+		LOGwWorker_t* w = &gw->worker[i];
+		int8_t state = 0;
+		if (!LO_ATOMIC_CAS(&w->state, &state, 1)) {
+			continue;
+		}
+		if (LO_sys_threadStart(LOGW_workerExec, w)) {
+			LOTRACE_ERR("ERROR to start the worker %u", i);
+			LO_ATOMIC_STORE(&w->state, 0);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsGateway_Attach(LiveObjectsGateway_t* gw, LiveObjectsClient_t* loc,
+		LiveObjectsD_CallbackState_t callback) {
+	LOGwWorker_t* w;
+	uint32_t i, idx = 0;
+
+	if ((gw == NULL) || (loc == NULL) || (gw->stopping)) {
+		return -1;
+	}
+
+	/* The least loaded worker */
+	for (i = 1; i < gw->worker_nb; i++) {
+		if (LO_ATOMIC_LOAD(&gw->worker[i].attached) < LO_ATOMIC_LOAD(&gw->worker[idx].attached)) {
+			idx = i;
+		}
+	}
+	w = &gw->worker[idx];
+
+	LO_ATOMIC_ADD(&w->attached, 1);
+	if (LOCC_instanceAttach(loc, w->group, callback)) {
+		LO_ATOMIC_ADD(&w->attached, (uint32_t) -1);
+		return -1;
+	}
+	LOTRACE_DBG1("%p attached to worker %u", loc, idx);
+	return (int) idx;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsGateway_Stop(LiveObjectsGateway_t* gw) {
+	uint32_t i;
+
+	if (gw == NULL) {
+		return -1;
+	}
+	gw->stopping = 1;
+	for (i = 0; i < gw->worker_nb; i++) {
+		LOGwWorker_t* w = &gw->worker[i];
+		int8_t state = 1;
+		if (LO_ATOMIC_CAS(&w->state, &state, -1)) {
+			LO_sys_groupSignal(w->group);
+		}
+	}
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsGateway_Destroy(LiveObjectsGateway_t* gw) {
+	uint32_t i;
+
+	if (gw == NULL) {
+		return -1;
+	}
+	for (i = 0; i < gw->worker_nb; i++) {
+		LOGwWorker_t* w = &gw->worker[i];
+		int8_t state = LO_ATOMIC_LOAD(&w->state);
+		if ((state == 0) && (LO_ATOMIC_LOAD(&w->attached))) {
+			LOTRACE_ERR("ERROR - worker %u not started, %u instances attached", i, w->attached);
+			return -1;
+		}
+		if (state > 0) {
+			LOTRACE_ERR("ERROR - worker %u is running (LiveObjectsGateway_Stop not called)", i);
+			return -1;
+		}
+	}
+	for (i = 0; i < gw->worker_nb; i++) {
+		LOGwWorker_t* w = &gw->worker[i];
+		while (LO_ATOMIC_LOAD(&w->state) == -1) {
+			WAIT_MS(10);
+		}
+		LO_sys_groupDelete(w->group);
+		if (w->sessions) {
+			MEM_FREE(w->sessions);
+		}
+	}
+	MEM_FREE(gw);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LiveObjectsGateway_GetStats(LiveObjectsGateway_t* gw, LiveObjectsD_GatewayStats_t* stats) {
+	uint64_t step_us_total = 0;
+	uint32_t i;
+
+	if ((gw == NULL) || (stats == NULL)) {
+		return -1;
+	}
+	memset(stats, 0, sizeof(LiveObjectsD_GatewayStats_t));
+	stats->gw_workers = gw->worker_nb;
+	if (gw->start_us) {
+		stats->gw_elapsed_ms = (uint32_t) ((LO_sys_timeUs() - gw->start_us) / 1000);
+	}
+	for (i = 0; i < gw->worker_nb; i++) {
+		LOGwWorker_t* w = &gw->worker[i];
+		uint32_t step_max = LO_ATOMIC_LOAD(&w->step_us_max);
+		stats->gw_sessions += LO_ATOMIC_LOAD(&w->attached);
+		stats->gw_connected += LO_ATOMIC_LOAD(&w->cnt_connected);
+		stats->gw_published += LO_ATOMIC_LOAD(&w->cnt_published);
+		stats->gw_received += LO_ATOMIC_LOAD(&w->cnt_received);
+		stats->gw_steps += LO_ATOMIC_LOAD(&w->cnt_steps);
+		step_us_total += LO_ATOMIC_LOAD(&w->step_us_total);
+		if (step_max > stats->gw_step_max_us) {
+			stats->gw_step_max_us = step_max;
+		}
+	}
+	if (stats->gw_steps) {
+		stats->gw_step_avg_us = (uint32_t) (step_us_total / stats->gw_steps);
+	}
+	return 0;
+}
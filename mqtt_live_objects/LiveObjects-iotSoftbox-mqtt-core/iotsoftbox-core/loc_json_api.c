@@ -11,6 +11,7 @@
  */
 
 #include "loc_json_api.h"
+#include "liveobjects-client/LiveObjectsClient_Toolbox.h"
 
 #ifndef TRACE_GROUP
 #define TRACE_GROUP "JSON"
@@ -108,30 +109,50 @@ LiveObjectsD_Type_t LO_getDataTypeFromStrL(const char* p, uint32_t len) {
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-int LO_json_begin(char *pbuf, uint32_t sz) {
-	int rc;
-	rc = snprintf(pbuf, sz, "{");
-	if (rc != 1) {
-		LOTRACE_ERR("failed %d", rc);
+/* Append 'len' bytes at the write cursor, keeping the text null-terminated */
+static int LO_json_put(LOJsonWriter_t* jw, const char* p, uint32_t len) {
+	if (jw->err) {
+		return -1;
+	}
+	if (jw->buf_len + len >= jw->buf_sz) {
+		LOTRACE_ERR("too short - len=%"PRIu32" + %"PRIu32" >= sz=%"PRIu32, jw->buf_len, len, jw->buf_sz);
+		jw->err = 1;
 		return -1;
 	}
+	memcpy(jw->buf_ptr + jw->buf_len, p, len);
+	jw->buf_len += len;
+	jw->buf_ptr[jw->buf_len] = 0;
 	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_end(char *pbuf, uint32_t sz) {
-	int rc;
-	int len = sz - strlen(pbuf);
-	char* pcur = pbuf + strlen(pbuf);
-	if (*(pcur - 1) == ',') {
-		pcur--;
-		len++;
-	}
-	rc = snprintf(pcur, sz, "}");
-	if (rc != 1) {
-		LOTRACE_ERR("failed %d", rc);
+static int LO_json_puts(LOJsonWriter_t* jw, const char* p) {
+	return LO_json_put(jw, p, strlen(p));
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Append a number (already formatted in 'num') followed by 'sep' */
+static int LO_json_put_num(LOJsonWriter_t* jw, char* num, int len, char sep) {
+	if (sep) {
+		num[len++] = sep;
+	}
+	return LO_json_put(jw, num, len);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Remove the separator written after the last element, if any */
+static void LO_json_trim_comma(LOJsonWriter_t* jw) {
+	if ((jw->buf_len > 0) && (jw->buf_ptr[jw->buf_len - 1] == ',')) {
+		jw->buf_len--;
+		jw->buf_ptr[jw->buf_len] = 0;
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LO_json_put_name(LOJsonWriter_t* jw, const char* name) {
+	if ((LO_json_put(jw, "\"", 1)) || (LO_json_puts(jw, name)) || (LO_json_put(jw, "\":", 2))) {
 		return -1;
 	}
 	return 0;
@@ -139,13 +160,26 @@ int LO_json_end(char *pbuf, uint32_t sz) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_add_section_start(const char* section_name, char *pbuf, uint32_t sz) {
-	int rc;
-	int len = sz - strlen(pbuf);
-	char* pcur = pbuf + strlen(pbuf);
-	rc = snprintf(pcur, len, "\"%s\": {", section_name);
-	if (rc < 0) {
-		LOTRACE_ERR("(%s): failed, rc=%d", section_name, rc);
+void LO_json_init(LOJsonWriter_t* jw, char *pbuf, uint32_t sz) {
+	jw->buf_ptr = pbuf;
+	jw->buf_sz = sz;
+	jw->buf_len = 0;
+	jw->err = 0;
+	if ((pbuf == NULL) || (sz == 0)) {
+		jw->buf_sz = 0;
+		jw->err = 1;
+	}
+	else {
+		*pbuf = 0;
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_json_begin(LOJsonWriter_t* jw) {
+	jw->buf_len = 0;
+	if (LO_json_put(jw, "{", 1)) {
+		LOTRACE_ERR("failed");
 		return -1;
 	}
 	return 0;
@@ -153,17 +187,10 @@ int LO_json_add_section_start(const char* section_name, char *pbuf, uint32_t sz)
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_add_section_end(char *pbuf, uint32_t sz) {
-	int rc;
-	int len = sz - strlen(pbuf);
-	char* pcur = pbuf + strlen(pbuf);
-	if (*(pcur - 1) == ',') {
-		pcur--;
-		len++;
-	}
-	rc = snprintf(pcur, len, "},");
-	if (rc != 2) {
-		LOTRACE_ERR("failed, rc=%d", rc);
+int LO_json_end(LOJsonWriter_t* jw) {
+	LO_json_trim_comma(jw);
+	if (LO_json_put(jw, "}", 1)) {
+		LOTRACE_ERR("failed");
 		return -1;
 	}
 	return 0;
@@ -171,15 +198,20 @@ int LO_json_add_section_end(char *pbuf, uint32_t sz) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_begin_section(char *pbuf, uint32_t sz, const char* section_name) {
-	int rc;
-	rc = snprintf(pbuf, sz, "{\"%s\":{", section_name);
-	if (rc <= 0) {
-		LOTRACE_ERR("failed %d", rc);
+int LO_json_add_section_start(const char* section_name, LOJsonWriter_t* jw) {
+	if ((LO_json_put_name(jw, section_name)) || (LO_json_put(jw, " {", 2))) {
+		LOTRACE_ERR("(%s): failed", section_name);
 		return -1;
 	}
-	if (rc == (int) sz) {
-		LOTRACE_ERR("too short %d", rc);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_json_add_section_end(LOJsonWriter_t* jw) {
+	LO_json_trim_comma(jw);
+	if (LO_json_put(jw, "},", 2)) {
+		LOTRACE_ERR("failed");
 		return -1;
 	}
 	return 0;
@@ -187,17 +219,9 @@ int LO_json_begin_section(char *pbuf, uint32_t sz, const char* section_name) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_end_section(char *pbuf, uint32_t sz) {
-	int rc;
-	int len = sz - strlen(pbuf);
-	char* pcur = pbuf + strlen(pbuf);
-	if (*(pcur - 1) == ',') {
-		pcur--;
-		len++;
-	}
-	rc = snprintf(pcur, len, "}}");
-	if (rc != 2) {
-		LOTRACE_ERR("failed %d != 2", rc);
+int LO_json_add_array_start(const char* array_name, LOJsonWriter_t* jw) {
+	if ((LO_json_put_name(jw, array_name)) || (LO_json_put(jw, "[", 1))) {
+		LOTRACE_ERR("(%s): failed", array_name);
 		return -1;
 	}
 	return 0;
@@ -205,29 +229,44 @@ int LO_json_end_section(char *pbuf, uint32_t sz) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_add_name_int(const char* name, int32_t value, char *pbuf, uint32_t sz) {
-	int rc;
-	int len = sz - strlen(pbuf);
-	char* pcur = pbuf + strlen(pbuf);
-
-	rc = snprintf(pcur, len, "\"%s\":%"PRIi32",", name, value);
-	if (rc < 0) {
-		LOTRACE_ERR("(%s, %"PRIi32"): failed, rc=%d", name, value, rc);
+int LO_json_add_array_end(LOJsonWriter_t* jw) {
+	LO_json_trim_comma(jw);
+	if (LO_json_put(jw, "],", 2)) {
+		LOTRACE_ERR("failed");
 		return -1;
 	}
 	return 0;
 }
 
+/* --------------------------------------------------------------------------------- */
+/* Object element of an array */
+int LO_json_add_object_start(LOJsonWriter_t* jw) {
+	return LO_json_put(jw, "{", 1);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_json_add_object_end(LOJsonWriter_t* jw) {
+	LO_json_trim_comma(jw);
+	return LO_json_put(jw, "},", 2);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Go back to a previous length of the JSON text (i.e. element that does not fit in the buffer) */
+void LO_json_rewind(LOJsonWriter_t* jw, uint32_t len) {
+	if ((jw->buf_sz) && (len <= jw->buf_len)) {
+		jw->buf_len = len;
+		jw->buf_ptr[len] = 0;
+		jw->err = 0;
+	}
+}
+
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_add_name_str(const char* name, const char* value, char *pbuf, uint32_t sz) {
-	int rc;
-	int len = sz - strlen(pbuf);
-	char* pcur = pbuf + strlen(pbuf);
-
-	rc = snprintf(pcur, len, "\"%s\":\"%s\",", name, value);
-	if (rc < 0) {
-		LOTRACE_ERR("(%s, %s): failed, rc=%d", name, value, rc);
+int LO_json_begin_section(LOJsonWriter_t* jw, const char* section_name) {
+	jw->buf_len = 0;
+	if ((LO_json_put(jw, "{", 1)) || (LO_json_put_name(jw, section_name)) || (LO_json_put(jw, "{", 1))) {
+		LOTRACE_ERR("(%s): failed", section_name);
 		return -1;
 	}
 	return 0;
@@ -235,14 +274,10 @@ int LO_json_add_name_str(const char* name, const char* value, char *pbuf, uint32
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_add_name_array(const char* name, const char* array, char *pbuf, uint32_t sz) {
-	int rc;
-	int len = sz - strlen(pbuf);
-	char* pcur = pbuf + strlen(pbuf);
-
-	rc = snprintf(pcur, len, "\"%s\":[%s],", name, array);
-	if (rc < 0) {
-		LOTRACE_ERR("(%s, %s): failed, rc=%d", name, array, rc);
+int LO_json_end_section(LOJsonWriter_t* jw) {
+	LO_json_trim_comma(jw);
+	if (LO_json_put(jw, "}}", 2)) {
+		LOTRACE_ERR("failed");
 		return -1;
 	}
 	return 0;
@@ -250,110 +285,221 @@ int LO_json_add_name_array(const char* name, const char* array, char *pbuf, uint
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_add_item(const LiveObjectsD_Data_t* data_ptr, char *pbuf, uint32_t sz) {
-	int rc;
-	short i;
-	short dim;
-	char* data_value_ptr;
-	int len = sz - strlen(pbuf);
-	char* pcur = pbuf + strlen(pbuf);
-
-	if (data_ptr == NULL) {
-		LOTRACE_ERR("Invalid Arguments - data_ptr = NULL ");
+int LO_json_add_name_int(const char* name, int32_t value, LOJsonWriter_t* jw) {
+	char num[LO_FMT_NUM_SZ + 1];
+	if ((LO_json_put_name(jw, name)) || (LO_json_put_num(jw, num, LO_fmt_i32(num, value), ','))) {
+		LOTRACE_ERR("(%s, %"PRIi32"): failed", name, value);
 		return -1;
 	}
-	if ((data_ptr->data_name == NULL) || (data_ptr->data_value == NULL) || (data_ptr->data_dim <= 0)) {
-		LOTRACE_ERR("Invalid DataDef - name=%p  value=%p dim=%d", 
-			data_ptr->data_name, data_ptr->data_value, data_ptr->data_dim);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_json_add_name_str(const char* name, const char* value, LOJsonWriter_t* jw) {
+	if ((LO_json_put_name(jw, name)) || (LO_json_put(jw, "\"", 1)) || (LO_json_puts(jw, value))
+			|| (LO_json_put(jw, "\",", 2))) {
+		LOTRACE_ERR("(%s, %s): failed", name, value);
 		return -1;
 	}
-	
-	rc = snprintf(pcur, len, "\"%s\":", data_ptr->data_name);
-	if (rc < 0) {
-		LOTRACE_ERR("(%d, %s): failed, rc=%d", data_ptr->data_type, data_ptr->data_name, rc);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_json_add_name_array(const char* name, const char* array, LOJsonWriter_t* jw) {
+	if ((LO_json_put_name(jw, name)) || (LO_json_put(jw, "[", 1)) || (LO_json_puts(jw, array))
+			|| (LO_json_put(jw, "],", 2))) {
+		LOTRACE_ERR("(%s, %s): failed", name, array);
 		return -1;
 	}
-	len = sz - strlen(pbuf);
-	pcur = pbuf + strlen(pbuf);
-	if (len < 4) { /* at least 4 free bytes remmaining in buffer */
-		LOTRACE_ERR("(%d, %s): failed, free len = %d < 4", data_ptr->data_type, data_ptr->data_name, len);
-		return -1;
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Value writers, one per data type: each value is followed by a comma */
+static int LO_json_value_int32(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const int32_t* v = (const int32_t*) data_ptr->data_value;
+	char num[LO_FMT_NUM_SZ + 1];
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_json_put_num(jw, num, LO_fmt_i32(num, v[i]), ',')) {
+			return -1;
+		}
 	}
-	dim = data_ptr->data_dim;
-	if (dim > 1) {
-		*pcur++ = '[';
-		len--;
+	return 0;
+}
+
+static int LO_json_value_int16(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const int16_t* v = (const int16_t*) data_ptr->data_value;
+	char num[LO_FMT_NUM_SZ + 1];
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_json_put_num(jw, num, LO_fmt_i32(num, v[i]), ',')) {
+			return -1;
+		}
 	}
-	else if (dim <= 0) {
-		LOTRACE_ERR("(%d, %s): force dim=%d to 1", data_ptr->data_type, data_ptr->data_name, dim);
-		dim = 1;
+	return 0;
+}
+
+static int LO_json_value_int8(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const int8_t* v = (const int8_t*) data_ptr->data_value;
+	char num[LO_FMT_NUM_SZ + 1];
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_json_put_num(jw, num, LO_fmt_i32(num, v[i]), ',')) {
+			return -1;
+		}
 	}
+	return 0;
+}
 
-	data_value_ptr = (char*)data_ptr->data_value;
-	for (i=0;i<dim;i++) {
-		switch (data_ptr->data_type) {
-		case LOD_TYPE_INT32:
-			rc = snprintf(pcur, len, "%"PRIi32",", *((int32_t*) data_value_ptr));
-			if (dim > 1) data_value_ptr += sizeof(int32_t);
-			break;
-		case LOD_TYPE_INT16:
-			rc = snprintf(pcur, len, "%"PRIi16",", *((int16_t*)data_value_ptr));
-			if (dim > 1) data_value_ptr += sizeof(int16_t);			
-			break;
-		case LOD_TYPE_INT8:
-			rc = snprintf(pcur, len, "%"PRIi8"," , *((int8_t*)data_value_ptr));
-			if (dim > 1) data_value_ptr += sizeof(int8_t);
-			break;
-		case LOD_TYPE_UINT32:
-			rc = snprintf(pcur, len, "%"PRIu32",", *((uint32_t*)data_value_ptr));
-			if (dim > 1) data_value_ptr += sizeof(uint32_t);
-			break;
-		case LOD_TYPE_UINT16:
-			rc = snprintf(pcur, len, "%"PRIu16",", *((uint16_t*)data_value_ptr));
-			if (dim > 1) data_value_ptr += sizeof(uint16_t);
-			break;
-		case LOD_TYPE_UINT8:
-			rc = snprintf(pcur, len, "%"PRIu8"," , *((uint8_t*)data_value_ptr));
-			if (dim > 1) data_value_ptr += sizeof(uint8_t);
-			break;
-		case LOD_TYPE_FLOAT:
-			rc = snprintf(pcur, len, "%f,", *((float*)data_value_ptr));
-			if (dim > 1) data_value_ptr += sizeof(float);
-			break;
-		case LOD_TYPE_DOUBLE:
-			rc = snprintf(pcur, len, "%lf,", *((double*)data_value_ptr));
-			if (dim > 1) data_value_ptr += sizeof(double);
-			break;
-		case LOD_TYPE_BOOL:
-			rc = snprintf(pcur, len, "%s,", *((uint8_t*)data_value_ptr) ? "true" : "false");
-			if (dim > 1) data_value_ptr += sizeof(uint8_t);
-			break;
-		case LOD_TYPE_STRING_C:
-			rc = snprintf(pcur, len, "\"%s\",", (const char*)data_value_ptr);
-			if (dim > 1) data_value_ptr += sizeof(char*);
-			break;
-		default:
-			LOTRACE_ERR("failed  - unknown type %d", data_ptr->data_type);
+static int LO_json_value_uint32(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const uint32_t* v = (const uint32_t*) data_ptr->data_value;
+	char num[LO_FMT_NUM_SZ + 1];
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_json_put_num(jw, num, LO_fmt_u32(num, v[i]), ',')) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int LO_json_value_uint16(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const uint16_t* v = (const uint16_t*) data_ptr->data_value;
+	char num[LO_FMT_NUM_SZ + 1];
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_json_put_num(jw, num, LO_fmt_u32(num, v[i]), ',')) {
 			return -1;
 		}
-		if (dim > 1) {
-			len = sz - strlen(pbuf);
-			pcur = pbuf + strlen(pbuf);
-			if (len < 2) { /* at least 2 free bytes remmaining in buffer */
-				LOTRACE_ERR("(%d, %s)[%d]: failed, free len = %d < 2", data_ptr->data_type, data_ptr->data_name, i, len);
-				return -1;
-			}		
+	}
+	return 0;
+}
+
+static int LO_json_value_uint8(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const uint8_t* v = (const uint8_t*) data_ptr->data_value;
+	char num[LO_FMT_NUM_SZ + 1];
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_json_put_num(jw, num, LO_fmt_u32(num, v[i]), ',')) {
+			return -1;
 		}
 	}
-	if (dim > 1) {
-		pcur--;
-		if ((*pcur != ',')  || (len < 2)){
-			LOTRACE_ERR("(%d, %s): failed, unexpected char %c or free len = %d", data_ptr->data_type, data_ptr->data_name, *pcur, len);
+	return 0;
+}
+
+static int LO_json_value_float(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const float* v = (const float*) data_ptr->data_value;
+	char num[LO_FMT_NUM_SZ + 1];
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_json_put_num(jw, num, LO_fmt_float(num, v[i], data_ptr->data_prec), ',')) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int LO_json_value_double(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const double* v = (const double*) data_ptr->data_value;
+	char num[LO_FMT_NUM_SZ + 1];
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if (LO_json_put_num(jw, num, LO_fmt_double(num, v[i], data_ptr->data_prec), ',')) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int LO_json_value_bool(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	const uint8_t* v = (const uint8_t*) data_ptr->data_value;
+	int i;
+	for (i = 0; i < data_ptr->data_dim; i++) {
+		if ((v[i]) ? LO_json_put(jw, "true,", 5) : LO_json_put(jw, "false,", 6)) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* One null-terminated string, whatever data_dim */
+static int LO_json_value_string(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr) {
+	if ((LO_json_put(jw, "\"", 1)) || (LO_json_puts(jw, (const char*) data_ptr->data_value))
+			|| (LO_json_put(jw, "\",", 2))) {
+		return -1;
+	}
+	return 0;
+}
+
+static const LOJsonValueWriter_t _LO_json_valueWriter[LOD_TYPE_MAX_NOT_USED] = {
+	NULL,
+	LO_json_value_int32,
+	LO_json_value_int16,
+	LO_json_value_int8,
+	LO_json_value_uint32,
+	LO_json_value_uint16,
+	LO_json_value_uint8,
+	LO_json_value_string,
+	LO_json_value_bool,
+	LO_json_value_float,
+	LO_json_value_double
+};
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+LOJsonValueWriter_t LO_json_value_writer(LiveObjectsD_Type_t data_type) {
+	if ((data_type > LOD_TYPE_UNKNOWN) && (data_type < LOD_TYPE_MAX_NOT_USED)) {
+		return _LO_json_valueWriter[data_type];
+	}
+	return NULL;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Append a fragment of JSON text rendered in advance (i.e. '"name":') */
+int LO_json_add_fragment(const char* p, uint32_t len, LOJsonWriter_t* jw) {
+	return LO_json_put(jw, p, len);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Value (or array of values) of a data element, using the writer of its type */
+int LO_json_add_value(LOJsonValueWriter_t writer, const LiveObjectsD_Data_t* data_ptr, LOJsonWriter_t* jw) {
+	if ((data_ptr->data_dim > 1) && (data_ptr->data_type != LOD_TYPE_STRING_C)) {
+		if ((LO_json_put(jw, "[", 1)) || (writer(jw, data_ptr))) {
 			return -1;
 		}
-		*pcur++ = ']';
-		*pcur++ = ',';
-		*pcur = 0;
+		LO_json_trim_comma(jw);
+		return LO_json_put(jw, "],", 2);
+	}
+	return writer(jw, data_ptr);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_json_add_item(const LiveObjectsD_Data_t* data_ptr, LOJsonWriter_t* jw) {
+	LOJsonValueWriter_t writer;
+
+	if (data_ptr == NULL) {
+		LOTRACE_ERR("Invalid Arguments - data_ptr = NULL ");
+		return -1;
+	}
+	if ((data_ptr->data_name == NULL) || (data_ptr->data_value == NULL) || (data_ptr->data_dim <= 0)) {
+		LOTRACE_ERR("Invalid DataDef - name=%p  value=%p dim=%d", 
+			data_ptr->data_name, data_ptr->data_value, data_ptr->data_dim);
+		return -1;
+	}
+	writer = LO_json_value_writer(data_ptr->data_type);
+	if (writer == NULL) {
+		LOTRACE_ERR("failed  - unknown type %d", data_ptr->data_type);
+		return -1;
+	}
+
+	if ((LO_json_put_name(jw, data_ptr->data_name)) || (LO_json_add_value(writer, data_ptr, jw))) {
+		LOTRACE_ERR("(%d, %s): failed, free len = %"PRIu32, data_ptr->data_type, data_ptr->data_name,
+				jw->buf_sz - jw->buf_len);
+		return -1;
 	}
 	LOTRACE_DBG1("OK - type=%d=%s name=%s", data_ptr->data_type, LO_getDataTypeToStr(data_ptr->data_type),
 			data_ptr->data_name);
@@ -362,38 +508,42 @@ int LO_json_add_item(const LiveObjectsD_Data_t* data_ptr, char *pbuf, uint32_t s
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_json_add_param(const LiveObjectsD_Data_t* data_ptr, char *pbuf, uint32_t sz) {
+int LO_json_add_param(const LiveObjectsD_Data_t* data_ptr, LOJsonWriter_t* jw) {
 	if ((data_ptr->data_type == LOD_TYPE_INT32) || (data_ptr->data_type == LOD_TYPE_UINT32)
 			|| (data_ptr->data_type == LOD_TYPE_STRING_C) || (data_ptr->data_type == LOD_TYPE_FLOAT)) {
 		int rc;
-		int len = sz - strlen(pbuf);
-		char* pcur = pbuf + strlen(pbuf);
+		char num[LO_FMT_NUM_SZ + 1];
 
-		rc = snprintf(pcur, len, "\"%s\":{", data_ptr->data_name);
-		if (rc < 0) {
-			LOTRACE_ERR("(%d, %s): failed, rc=%d", data_ptr->data_type, data_ptr->data_name, rc);
+		if ((LO_json_put_name(jw, data_ptr->data_name)) || (LO_json_put(jw, "{", 1))) {
+			LOTRACE_ERR("(%d, %s): failed", data_ptr->data_type, data_ptr->data_name);
 			return -1;
 		}
 
-		len = sz - strlen(pbuf);
-		pcur = pbuf + strlen(pbuf);
 		switch (data_ptr->data_type) {
 		case LOD_TYPE_INT32:
-			rc = snprintf(pcur, len, "\"t\":\"i32\",\"v\":%d},", *((int*) data_ptr->data_value));
+			rc = (LO_json_put(jw, "\"t\":\"i32\",\"v\":", 14))
+					|| (LO_json_put_num(jw, num, LO_fmt_i32(num, *((int32_t*) data_ptr->data_value)), '}'));
 			break;
 		case LOD_TYPE_UINT32:
-			rc = snprintf(pcur, len, "\"t\":\"u32\",\"v\":%u},", *((unsigned int*) data_ptr->data_value));
+			rc = (LO_json_put(jw, "\"t\":\"u32\",\"v\":", 14))
+					|| (LO_json_put_num(jw, num, LO_fmt_u32(num, *((uint32_t*) data_ptr->data_value)), '}'));
 			break;
 		case LOD_TYPE_FLOAT:
-			rc = snprintf(pcur, len, "\"t\":\"f64\",\"v\":%f},", *((float*) data_ptr->data_value));
+			rc = (LO_json_put(jw, "\"t\":\"f64\",\"v\":", 14))
+					|| (LO_json_put_num(jw, num, LO_fmt_float(num, *((float*) data_ptr->data_value), data_ptr->data_prec), '}'));
 			break;
 		case LOD_TYPE_STRING_C:
-			rc = snprintf(pcur, len, "\"t\":\"str\",\"v\":\"%s\"},", (const char*) data_ptr->data_value);
+			rc = (LO_json_put(jw, "\"t\":\"str\",\"v\":\"", 15)) || (LO_json_puts(jw, (const char*) data_ptr->data_value))
+					|| (LO_json_put(jw, "\"}", 2));
 			break;
 		default:
 			LOTRACE_ERR("LO_json_add_param: failed -  type %d not implemented", data_ptr->data_type);
 			return -1;
 		}
+		if ((rc) || (LO_json_put(jw, ",", 1))) {
+			LOTRACE_ERR("(%d, %s): failed", data_ptr->data_type, data_ptr->data_name);
+			return -1;
+		}
 		LOTRACE_DBG1("OK - type=%d=%s name=%s", data_ptr->data_type,
 				LO_getDataTypeToStr(data_ptr->data_type), data_ptr->data_name);
 		return 0;
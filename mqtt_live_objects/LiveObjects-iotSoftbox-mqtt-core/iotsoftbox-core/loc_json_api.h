@@ -25,27 +25,62 @@ const char* LO_getDataTypeToStr(LiveObjectsD_Type_t objType);
 
 LiveObjectsD_Type_t LO_getDataTypeFromStrL(const char* p, uint32_t len);
 
-int LO_json_begin(char *pbuf, uint32_t sz);
+/**
+ * JSON writer context.
+ * Keeps track of the current length of the JSON text, so that each append
+ * operation is done in place at the write cursor (no strlen on the whole buffer).
+ */
+typedef struct {
+	char*    buf_ptr;  /*!< Output buffer */
+	uint32_t buf_sz;   /*!< Size of the output buffer, including the terminating null character */
+	uint32_t buf_len;  /*!< Current length of the JSON text */
+	int      err;      /*!< Sticky error: set when an append operation does not fit in the buffer */
+} LOJsonWriter_t;
+
+void LO_json_init(LOJsonWriter_t* jw, char *pbuf, uint32_t sz);
+
+int LO_json_begin(LOJsonWriter_t* jw);
+
+int LO_json_end(LOJsonWriter_t* jw);
+
+int LO_json_begin_section(LOJsonWriter_t* jw, const char* name);
+
+int LO_json_end_section(LOJsonWriter_t* jw);
+
+int LO_json_add_section_start(const char* section_name, LOJsonWriter_t* jw);
 
-int LO_json_end(char *pbuf, uint32_t sz);
+int LO_json_add_section_end(LOJsonWriter_t* jw);
 
-int LO_json_begin_section(char *pbuf, uint32_t sz, const char* name);
+int LO_json_add_array_start(const char* array_name, LOJsonWriter_t* jw);
 
-int LO_json_end_section(char *pbuf, uint32_t sz);
+int LO_json_add_array_end(LOJsonWriter_t* jw);
 
-int LO_json_add_section_start(const char* section_name, char *pbuf, uint32_t sz);
+int LO_json_add_object_start(LOJsonWriter_t* jw);
 
-int LO_json_add_section_end(char *pbuf, uint32_t sz);
+int LO_json_add_object_end(LOJsonWriter_t* jw);
+
+void LO_json_rewind(LOJsonWriter_t* jw, uint32_t len);
+
+int LO_json_add_name_int(const char* name, int32_t value, LOJsonWriter_t* jw);
+
+int LO_json_add_name_str(const char* name, const char* value, LOJsonWriter_t* jw);
+
+int LO_json_add_name_array(const char* name, const char* array, LOJsonWriter_t* jw);
+
+/**
+ * Writer of the value(s) of a data element of a given type, each one followed by a comma.
+ */
+typedef int (*LOJsonValueWriter_t)(LOJsonWriter_t* jw, const LiveObjectsD_Data_t* data_ptr);
 
-int LO_json_add_name_int(const char* name, int32_t value, char *pbuf, uint32_t sz);
+LOJsonValueWriter_t LO_json_value_writer(LiveObjectsD_Type_t data_type);
 
-int LO_json_add_name_str(const char* name, const char* value, char *pbuf, uint32_t sz);
+int LO_json_add_fragment(const char* p, uint32_t len, LOJsonWriter_t* jw);
 
-int LO_json_add_name_array(const char* name, const char* array, char *pbuf, uint32_t sz);
+int LO_json_add_value(LOJsonValueWriter_t writer, const LiveObjectsD_Data_t* p, LOJsonWriter_t* jw);
 
-int LO_json_add_item(const LiveObjectsD_Data_t* p, char *pbuf, uint32_t sz);
+int LO_json_add_item(const LiveObjectsD_Data_t* p, LOJsonWriter_t* jw);
 
-int LO_json_add_param(const LiveObjectsD_Data_t* p, char *pbuf, uint32_t sz);
+int LO_json_add_param(const LiveObjectsD_Data_t* p, LOJsonWriter_t* jw);
 
 #if defined(__cplusplus)
 }
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file  loc_mpool.c
+ * @brief Pool of fixed-size blocks for the outbound messages
+ */
+
+#include "liveobjects-client/LiveObjectsClient_Config.h"
+
+#include "loc_mpool.h"
+#include "loc_mqueue.h"
+
+#ifndef TRACE_GROUP
+#define TRACE_GROUP "POOL"
+#endif
+#include "liveobjects-sys/loc_trace.h"
+
+#include <string.h>
+
+#include "liveobjects-sys/LiveObjectsClient_Platform.h"
+#include "platform_default.h"
+
+/* Size of blocks, aligned on 8 bytes: 1/4, 1/2 and 1 JSON user buffer, plus the message header and headroom */
+#define LO_MPOOL_BLK_SZ(div)   ((((LOM_JSON_BUF_USER_SZ / (div)) + LOM_MSG_PAYLOAD_OFFSET) + 7) & ~7)
+
+static const uint32_t _LO_mpool_blk_sz[LOD_POOL_CLASS_NB] = {
+	LO_MPOOL_BLK_SZ(4), LO_MPOOL_BLK_SZ(2), LO_MPOOL_BLK_SZ(1)
+};
+
+#if LOM_MSG_POOL_NB > 0
+static uint64_t _LO_mpool_arena[(LOM_MSG_POOL_NB * (LO_MPOOL_BLK_SZ(4) + LO_MPOOL_BLK_SZ(2) + LO_MPOOL_BLK_SZ(1))) / 8];
+#endif
+
+static struct {
+	char*             blk_first;
+	char*             blk_end;
+	LOMQueue_t        free_blks;
+	volatile uint32_t cnt_alloc;
+	volatile uint32_t cnt_free;
+	volatile uint32_t peak;
+} _LO_mpool_class[LOD_POOL_CLASS_NB];
+
+static uint8_t           _LO_mpool_ready = 0;
+static volatile uint32_t _LO_mpool_heap_alloc = 0;
+static volatile uint32_t _LO_mpool_heap_free = 0;
+static volatile uint32_t _LO_mpool_failures = 0;
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void LO_mpool_updatePeak(int idx) {
+	uint32_t in_use = LO_ATOMIC_LOAD(&_LO_mpool_class[idx].cnt_alloc) - LO_ATOMIC_LOAD(&_LO_mpool_class[idx].cnt_free);
+	uint32_t peak = LO_ATOMIC_LOAD(&_LO_mpool_class[idx].peak);
+	while ((in_use > peak) && (in_use <= LOM_MSG_POOL_NB)) {
+		if (LO_ATOMIC_CAS(&_LO_mpool_class[idx].peak, &peak, in_use)) {
+			break;
+		}
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_mpool_init(void) {
+#if LOM_MSG_POOL_NB > 0
+	char* p = (char*) _LO_mpool_arena;
+	int idx;
+	if (_LO_mpool_ready) {
+		/* Blocks can still be used by some user threads */
+		return 0;
+	}
+	for (idx = 0; idx < LOD_POOL_CLASS_NB; idx++) {
+		int i;
+		/* Twice the number of blocks, so that a free slot is always found when a block is released */
+		if (LO_mq_init(&_LO_mpool_class[idx].free_blks, 2 * LOM_MSG_POOL_NB, LOD_MQ_DROP_NEWEST, 0, NULL)) {
+			LOTRACE_ERR("Error to initialize the free list of class %d", idx);
+			return -1;
+		}
+		_LO_mpool_class[idx].blk_first = p;
+		for (i = 0; i < LOM_MSG_POOL_NB; i++) {
+			LO_mq_put(&_LO_mpool_class[idx].free_blks, p);
+			p += _LO_mpool_blk_sz[idx];
+		}
+		_LO_mpool_class[idx].blk_end = p;
+		LOTRACE_DBG1("class %d: %d blocks of %"PRIu32" bytes", idx, LOM_MSG_POOL_NB, _LO_mpool_blk_sz[idx]);
+	}
+	_LO_mpool_ready = 1;
+#endif
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+char* LO_mpool_alloc(uint32_t len) {
+	char* p;
+	int idx;
+	for (idx = 0; (_LO_mpool_ready) && (idx < LOD_POOL_CLASS_NB); idx++) {
+		if (len <= _LO_mpool_blk_sz[idx]) {
+			p = (char*) LO_mq_get(&_LO_mpool_class[idx].free_blks);
+			if (p) {
+				LO_ATOMIC_ADD(&_LO_mpool_class[idx].cnt_alloc, 1);
+				LO_mpool_updatePeak(idx);
+				return p;
+			}
+		}
+	}
+	/* Pool is exhausted, or message is too large */
+	p = MEM_ALLOC(len);
+	if (p) {
+		LOTRACE_DBG1("MEM_ALLOC %p len=%"PRIu32, p, len);
+		LO_ATOMIC_ADD(&_LO_mpool_heap_alloc, 1);
+	}
+	else {
+		LOTRACE_ERR("MEM_ALLOC ERROR (len=%"PRIu32")", len);
+		LO_ATOMIC_ADD(&_LO_mpool_failures, 1);
+	}
+	return p;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_mpool_free(const char* p) {
+	int idx;
+	if (p == NULL) {
+		return;
+	}
+	for (idx = 0; idx < LOD_POOL_CLASS_NB; idx++) {
+		if ((p >= _LO_mpool_class[idx].blk_first) && (p < _LO_mpool_class[idx].blk_end)) {
+			LO_ATOMIC_ADD(&_LO_mpool_class[idx].cnt_free, 1);
+			while (LO_mq_put(&_LO_mpool_class[idx].free_blks, p)) {
+				/* Slot still held by a concurrent consumer */
+				WAIT_MS(0);
+			}
+			return;
+		}
+	}
+	LOTRACE_DBG1("MEM_FREE %p", p);
+	LO_ATOMIC_ADD(&_LO_mpool_heap_free, 1);
+	MEM_FREE(p);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_mpool_getStats(LiveObjectsD_PoolStats_t* stats) {
+	int idx;
+	for (idx = 0; idx < LOD_POOL_CLASS_NB; idx++) {
+		uint32_t cnt_alloc = LO_ATOMIC_LOAD(&_LO_mpool_class[idx].cnt_alloc);
+		stats->pool_class[idx].blk_sz = _LO_mpool_blk_sz[idx];
+		stats->pool_class[idx].blk_nb = (_LO_mpool_ready) ? LOM_MSG_POOL_NB : 0;
+		stats->pool_class[idx].blk_in_use = cnt_alloc - LO_ATOMIC_LOAD(&_LO_mpool_class[idx].cnt_free);
+		stats->pool_class[idx].blk_peak = LO_ATOMIC_LOAD(&_LO_mpool_class[idx].peak);
+		stats->pool_class[idx].blk_alloc = cnt_alloc;
+	}
+	stats->pool_heap_alloc = LO_ATOMIC_LOAD(&_LO_mpool_heap_alloc);
+	stats->pool_heap_in_use = stats->pool_heap_alloc - LO_ATOMIC_LOAD(&_LO_mpool_heap_free);
+	stats->pool_failures = LO_ATOMIC_LOAD(&_LO_mpool_failures);
+}
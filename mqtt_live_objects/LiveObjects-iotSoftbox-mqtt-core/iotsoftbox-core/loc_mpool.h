@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file   loc_mpool.h
+ * @brief  Pool of fixed-size blocks for the outbound messages
+ *
+ * The pool is a static arena split into LOD_POOL_CLASS_NB size classes
+ * (derived from LOM_JSON_BUF_USER_SZ), each one with LOM_MSG_POOL_NB blocks.
+ * Free blocks are kept in lock-free queues, so that any thread can allocate
+ * or release a block without lock.
+ * When no block is available (or the requested size is too large),
+ * the block is allocated with MEM_ALLOC.
+ *
+ * A queued message starts with a LOMsgHeader_t, followed by some free space
+ * (headroom) where the MQTT fixed header, the topic and the packet id (QoS 1) are
+ * written just before the payload when the message is published, so that it is
+ * sent without copy.
+ * A message published with QoS 1 is kept until its PUBACK is received, to be sent
+ * again after a reconnection.
+ */
+
+#ifndef __loc_mpool_H_
+#define __loc_mpool_H_
+
+#include <stdint.h>
+
+#include "liveobjects-client/LiveObjectsClient_Config.h"
+#include "liveobjects-client/LiveObjectsClient_Defs.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * @brief Header of a queued message
+ */
+typedef struct {
+	uint8_t  msg_type;        /*!< Type of message, always the first byte */
+	uint8_t  qos;             /*!< MQTT QoS: 0 or 1 */
+	uint16_t topic_len;       /*!< Length of the topic stored before the payload (see LOM_MSG_TOPIC), 0 if not stored */
+	uint16_t payload_offset;  /*!< Offset of the payload from the beginning of the message */
+	uint32_t payload_len;     /*!< Length of the payload (terminated by a NUL character) */
+	LiveObjectsD_CallbackPubAck_t ack_callback;  /*!< QoS 1: called when the message is acknowledged or released */
+	void*    ack_ctx;         /*!< QoS 1: user context given to ack_callback */
+} LOMsgHeader_t;
+
+/** Max size of the MQTT fixed header (type + remaining length), of the topic length and of the packet id */
+#define LOM_MSG_MQTT_HDR_SZ        (1 + 4 + 2 + 2)
+
+/** Offset of the payload in a queued message encoded by the library, with room for the MQTT header and the topic */
+#define LOM_MSG_PAYLOAD_OFFSET     ((sizeof(LOMsgHeader_t) + LOM_MSG_MQTT_HDR_SZ + LOC_MQTT_DEF_TOPIC_NAME_SZ + 7) & ~7)
+
+#define LOM_MSG_HDR(p_msg)         ((LOMsgHeader_t*)(p_msg))
+#define LOM_MSG_PAYLOAD(p_msg)     ((p_msg) + LOM_MSG_HDR(p_msg)->payload_offset)
+
+/** Topic stored in the message: just before the payload, or just before the packet id (QoS 1) */
+#define LOM_MSG_TOPIC(p_msg)       (LOM_MSG_PAYLOAD(p_msg) - LOM_MSG_HDR(p_msg)->topic_len \
+                                        - ((LOM_MSG_HDR(p_msg)->qos) ? 2 : 0))
+
+int   LO_mpool_init(void);
+
+char* LO_mpool_alloc(uint32_t len);
+
+void  LO_mpool_free(const char* p);
+
+void  LO_mpool_getStats(LiveObjectsD_PoolStats_t* stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __loc_mpool_H_ */
@@ -0,0 +1,218 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file  loc_mqueue.c
+ * @brief Bounded lock-free message queue
+ */
+
+#include "loc_mqueue.h"
+
+#ifndef TRACE_GROUP
+#define TRACE_GROUP "MQ"
+#endif
+#include "liveobjects-sys/loc_trace.h"
+
+#include <string.h>
+
+#include "liveobjects-sys/LiveObjectsClient_Platform.h"
+#include "platform_default.h"
+
+#include "loc_sys.h"
+
+/* --------------------------------------------------------------------------------- */
+/* Try to put a message in a free slot. Returns -1 if the queue is full */
+static int LO_mq_tryPut(LOMQueue_t* q, const char* p_msg) {
+	LOMQueueSlot_t* slot;
+	uint32_t pos = LO_ATOMIC_LOAD(&q->iwrite);
+	for (;;) {
+		int32_t dif;
+		slot = &q->slots[pos & q->mask];
+		dif = (int32_t) (LO_ATOMIC_LOAD(&slot->seq) - pos);
+		if (dif == 0) {
+			if (LO_ATOMIC_CAS(&q->iwrite, &pos, pos + 1)) {
+				break;
+			}
+			/* pos is updated with the current value */
+		}
+		else if (dif < 0) {
+			return -1;
+		}
+		else {
+			pos = LO_ATOMIC_LOAD(&q->iwrite);
+		}
+	}
+	slot->msg = p_msg;
+	LO_ATOMIC_STORE(&slot->seq, pos + 1);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void LO_mq_updateHighWater(LOMQueue_t* q) {
+	uint32_t depth = LO_ATOMIC_LOAD(&q->iwrite) - LO_ATOMIC_LOAD(&q->iread);
+	uint32_t hw = LO_ATOMIC_LOAD(&q->high_water);
+	while ((depth > hw) && (depth <= q->mask + 1)) {
+		if (LO_ATOMIC_CAS(&q->high_water, &hw, depth)) {
+			break;
+		}
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_mq_init(LOMQueue_t* q, uint32_t capacity, LiveObjectsD_MqPolicy_t policy, uint32_t timeout_ms,
+		LOMQueueRelease_t release) {
+	uint32_t nb = 2;
+	uint32_t i;
+
+	LO_mq_delete(q);
+
+	while (nb < capacity) {
+		nb <<= 1;
+	}
+	q->slots = (LOMQueueSlot_t*) MEM_ALLOC(nb * sizeof(LOMQueueSlot_t));
+	if (q->slots == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (capacity=%"PRIu32")", nb);
+		return -1;
+	}
+	for (i = 0; i < nb; i++) {
+		q->slots[i].seq = i;
+		q->slots[i].msg = NULL;
+	}
+	q->mask = nb - 1;
+	q->iwrite = 0;
+	q->iread = 0;
+	q->release = release;
+	q->cnt_put = 0;
+	q->cnt_dropped = 0;
+	q->high_water = 0;
+	LO_mq_setPolicy(q, policy, timeout_ms);
+	LOTRACE_DBG1("capacity=%"PRIu32" (requested %"PRIu32") policy=%d", nb, capacity, policy);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_mq_delete(LOMQueue_t* q) {
+	if (q->slots) {
+		LO_mq_purge(q);
+		MEM_FREE(q->slots);
+	}
+	memset(q, 0, sizeof(LOMQueue_t));
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_mq_setPolicy(LOMQueue_t* q, LiveObjectsD_MqPolicy_t policy, uint32_t timeout_ms) {
+	q->policy = (uint8_t) policy;
+	q->timeout_ms = timeout_ms;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_mq_put(LOMQueue_t* q, const char* p_msg) {
+	uint64_t deadline_us = 0;
+
+	if ((q->slots == NULL) || (p_msg == NULL)) {
+		return -1;
+	}
+	while (LO_mq_tryPut(q, p_msg)) {
+		/* Queue is full */
+		if (q->policy == LOD_MQ_DROP_OLDEST) {
+			const char* p_old = LO_mq_get(q);
+			if (p_old) {
+				LOTRACE_DBG1("full - release the oldest msg %p", p_old);
+				LO_ATOMIC_ADD(&q->cnt_dropped, 1);
+				if (q->release) {
+					q->release(p_old);
+				}
+			}
+		}
+		else if (q->policy == LOD_MQ_BLOCK) {
+			uint64_t now_us = LO_sys_timeUs();
+			if (deadline_us == 0) {
+				deadline_us = now_us + ((uint64_t) q->timeout_ms * 1000);
+			}
+			if (now_us >= deadline_us) {
+				LOTRACE_WARN("full - msg %p is rejected after %"PRIu32" ms", p_msg, q->timeout_ms);
+				LO_ATOMIC_ADD(&q->cnt_dropped, 1);
+				return -1;
+			}
+			WAIT_MS(1);
+		}
+		else {
+			LOTRACE_WARN("full - msg %p is rejected", p_msg);
+			LO_ATOMIC_ADD(&q->cnt_dropped, 1);
+			return -1;
+		}
+	}
+	LO_ATOMIC_ADD(&q->cnt_put, 1);
+	LO_mq_updateHighWater(q);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+const char* LO_mq_get(LOMQueue_t* q) {
+	LOMQueueSlot_t* slot;
+	const char* p_msg;
+	uint32_t pos;
+
+	if (q->slots == NULL) {
+		return NULL;
+	}
+	pos = LO_ATOMIC_LOAD(&q->iread);
+	for (;;) {
+		int32_t dif;
+		slot = &q->slots[pos & q->mask];
+		dif = (int32_t) (LO_ATOMIC_LOAD(&slot->seq) - (pos + 1));
+		if (dif == 0) {
+			/* The consumer competes with producers releasing the oldest message */
+			if (LO_ATOMIC_CAS(&q->iread, &pos, pos + 1)) {
+				break;
+			}
+		}
+		else if (dif < 0) {
+			return NULL;
+		}
+		else {
+			pos = LO_ATOMIC_LOAD(&q->iread);
+		}
+	}
+	p_msg = slot->msg;
+	slot->msg = NULL;
+	LO_ATOMIC_STORE(&slot->seq, pos + q->mask + 1);
+	return p_msg;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_mq_purge(LOMQueue_t* q) {
+	const char* p_msg;
+	while ((p_msg = LO_mq_get(q)) != NULL) {
+		LOTRACE_DBG1("release msg %p x%x", p_msg, *p_msg);
+		if (q->release) {
+			q->release(p_msg);
+		}
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_mq_getStats(const LOMQueue_t* q, LiveObjectsD_MqStats_t* stats) {
+	uint32_t iread = LO_ATOMIC_LOAD(&q->iread);
+	stats->mq_capacity = (q->slots) ? q->mask + 1 : 0;
+	stats->mq_depth = LO_ATOMIC_LOAD(&q->iwrite) - iread;
+	if (stats->mq_depth > stats->mq_capacity) {
+		stats->mq_depth = stats->mq_capacity;
+	}
+	stats->mq_high_water = LO_ATOMIC_LOAD(&q->high_water);
+	stats->mq_put = LO_ATOMIC_LOAD(&q->cnt_put);
+	stats->mq_dropped = LO_ATOMIC_LOAD(&q->cnt_dropped);
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file   loc_mqueue.h
+ * @brief  Bounded lock-free message queue (multiple producers)
+ *
+ * Each slot holds a sequence number (D. Vyukov's bounded queue): producers
+ * and consumer only use atomic operations, no mutex is shared between the
+ * user threads and the LiveObjects Client thread.
+ */
+
+#ifndef __loc_mqueue_H_
+#define __loc_mqueue_H_
+
+#include <stdint.h>
+
+#include "liveobjects-client/LiveObjectsClient_Defs.h"
+#include "liveobjects-sys/LiveObjectsClient_Platform.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/** Function called to release a message dropped or purged by the queue */
+typedef void (*LOMQueueRelease_t)(const char* p_msg);
+
+typedef struct {
+	volatile uint32_t   seq;
+	const char*         msg;
+} LOMQueueSlot_t;
+
+/** Size of a cache line, to keep the producer and consumer indexes in different cache lines */
+#ifndef LO_MQ_CACHE_LINE_SZ
+#define LO_MQ_CACHE_LINE_SZ 64
+#endif
+
+/** Queue aligned on a cache line: a LOMQueue_t (or a structure that contains it)
+ *  allocated from the heap must be allocated with MEM_ALLOC_ALIGNED */
+typedef struct {
+	LOMQueueSlot_t*     slots;
+	uint32_t            mask;        /* Number of slots - 1 (number of slots is a power of two) */
+	volatile uint32_t   iwrite LO_ALIGNED(LO_MQ_CACHE_LINE_SZ); /* Next position to write (producers) */
+	volatile uint32_t   iread LO_ALIGNED(LO_MQ_CACHE_LINE_SZ);  /* Next position to read (consumer) */
+	volatile uint8_t    policy LO_ALIGNED(LO_MQ_CACHE_LINE_SZ); /* LiveObjectsD_MqPolicy_t */
+	volatile uint32_t   timeout_ms;  /* Max time to wait for a free slot (LOD_MQ_BLOCK) */
+	LOMQueueRelease_t   release;
+	volatile uint32_t   cnt_put;
+	volatile uint32_t   cnt_dropped;
+	volatile uint32_t   high_water;
+} LOMQueue_t;
+
+int         LO_mq_init(LOMQueue_t* q, uint32_t capacity, LiveObjectsD_MqPolicy_t policy, uint32_t timeout_ms,
+		LOMQueueRelease_t release);
+
+void        LO_mq_delete(LOMQueue_t* q);
+
+void        LO_mq_setPolicy(LOMQueue_t* q, LiveObjectsD_MqPolicy_t policy, uint32_t timeout_ms);
+
+int         LO_mq_put(LOMQueue_t* q, const char* p_msg);
+
+const char* LO_mq_get(LOMQueue_t* q);
+
+void        LO_mq_purge(LOMQueue_t* q);
+
+void        LO_mq_getStats(const LOMQueue_t* q, LiveObjectsD_MqStats_t* stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __loc_mqueue_H_ */
@@ -17,6 +17,8 @@
 
 #include "liveobjects-client/LiveObjectsClient_Config.h"
 #include "liveobjects-client/LiveObjectsClient_Defs.h"
+#include "loc_json_api.h"
+#include "loc_sys.h"
 
 #if LOC_FEATURE_MBEDTLS
 #include "mbedtls/config.h"
@@ -42,14 +44,28 @@ typedef struct
 #define LOM_PUSH_FLAG         1
 #endif
 
+/**
+ * @brief Encode plan of a data element: JSON name rendered once, and writer of the values of its type
+ */
+typedef struct {
+	const char* name;                      /*!< '"name":' (not null-terminated) */
+	uint16_t name_len;                     /*!< Length of name */
+	LOJsonValueWriter_t writer;            /*!< Writer of the value(s) */
+} LOMPlanItem_t;
+
 /**
  * @brief Define an array of simple LiveObjects data elements
  */
 typedef struct {
 	const LiveObjectsD_Data_t* data_ptr;   /*!< Address of the first simple LiveObjects data element in array */
 	int data_nb;                           /*!< Number of elements in array */
+	LOMPlanItem_t* plan;                   /*!< Encode plan of the elements, compiled when attached (or NULL) */
+	uint8_t encoding;                      /*!< Encoding of the messages: LiveObjectsD_Encoding_t */
 } LOMArrayOfData_t;
 
+/** Size of the constant parts of a 'data' message: stream id, model and tags */
+#define LOM_PLAN_ENV_SZ   (LOM_SETOFDATA_STREAM_ID_SZ + LOM_SETOFDATA_MODEL_SZ + LOM_SETOFDATA_TAGS_SZ + 24)
+
 /**
  * @brief Define an array of LiveObjects configuration parameter elements
  */
@@ -58,11 +74,28 @@ typedef struct {
 	int param_nb;                           /*!< Number of elements in array */
 } LOMArrayOfParams_t;
 
+/** Element i of an array of data is set in a mask (bit per element, NULL: all the elements) */
+#define LOM_MASK_ISSET(mask, i)  ((mask == NULL) || ((mask)[(i) >> 3] & (1 << ((i) & 7))))
+
+/**
+ * @brief Shadow copy of the last published values of an array of data elements
+ */
+typedef struct {
+	uint8_t* values;            /*!< Published copy, followed by the pending copy (NULL: no shadow) */
+	uint8_t* mask;              /*!< Elements changed in the pending copy */
+	uint32_t size;              /*!< Size of a copy */
+	uint8_t valid;              /*!< The published copy is known */
+	uint32_t resync_ms;         /*!< Max time between two messages with all the elements */
+	uint64_t full_us;           /*!< Time of the last message with all the elements */
+} LOMShadow_t;
+
 /**
  * @brief Define a set of user 'status' to be published to the LiveObjects server
  */
 typedef struct {
 	LOMArrayOfData_t data_set;  /*!< Array of data : 'status' elements */
+	LOMShadow_t shadow;         /*!< Delta mode: last published values (protected by mutex) */
+	LOSysMutex_t* mutex;        /*!< Mutex of the shadow, created by LiveObjectsInstance_Init */
 #if LOM_PUSH_FLAG
 	uint8_t pushtoLOServer;     /*!< flag to publish 'info' to the LiveObject Server */
 #endif
@@ -88,6 +121,12 @@ typedef struct {
 #if LOM_PUSH_FLAG
 	uint8_t pushtoLOServer; /*!< flag to forward 'collected data' to the LiveObject Server */
 #endif
+	char plan_env[LOM_PLAN_ENV_SZ]; /*!< Encode plan: '"s":"..",' '"m":"..",' '"t":[..],' */
+	uint16_t plan_s_len;    /*!< Length of the stream id part in plan_env (0: no plan) */
+	uint16_t plan_m_len;    /*!< Length of the model part */
+	uint16_t plan_t_len;    /*!< Length of the tags part */
+	LiveObjectsD_DataEncoder_t encoder;  /*!< User encoder of the "v" section in JSON (or NULL) */
+	void* encoder_ctx;                   /*!< Context of the user encoder */
 } LOMSetOfData_t;
 
 /**
@@ -159,9 +198,36 @@ typedef struct {
 
 } LOMSetOfUpdatedResource_t;
 
-const char* LO_msg_encode_status(uint8_t from, const LOMArrayOfData_t* p);
+/* Encode plans, to render only the values when a set is published */
+int LO_msg_plan_compile(LOMArrayOfData_t* p);
+
+void LO_msg_plan_release(LOMArrayOfData_t* p);
+
+int LO_msg_plan_envelope(LOMSetOfData_t* p);
+
+/* Shadow of the last published values */
+int LO_msg_shadow_init(LOMShadow_t* pShadow, const LOMArrayOfData_t* p);
+
+void LO_msg_shadow_release(LOMShadow_t* pShadow);
+
+int LO_msg_shadow_diff(LOMShadow_t* pShadow, const LOMArrayOfData_t* p, uint8_t full);
+
+void LO_msg_shadow_commit(LOMShadow_t* pShadow);
+
+/* Length of the payload in *p_len (if not NULL): a CBOR payload is not null-terminated.
+ * Only the elements set in the mask are encoded (NULL: all the elements). */
+const char* LO_msg_encode_status(uint8_t from, const LOMArrayOfData_t* p, const uint8_t* mask, uint32_t* p_len);
+
+const char* LO_msg_encode_data(uint8_t from, const LOMSetOfData_t* p, uint32_t* p_len);
+
+/* Batch of data samples, encoded in a message of the pool */
+char* LO_msg_batch_begin(uint8_t from, const LOMSetOfData_t* p, LOJsonWriter_t* jw);
+
+int LO_msg_batch_add(LOJsonWriter_t* jw, const LOMSetOfData_t* p);
+
+uint32_t LO_msg_batch_room(const LOJsonWriter_t* jw);
 
-const char* LO_msg_encode_data(uint8_t from, const LOMSetOfData_t* p);
+const char* LO_msg_batch_end(char* p_msg, LOJsonWriter_t* jw);
 
 const char* LO_msg_encode_resources(uint8_t from, const LOMSetOfResources_t* p);
 
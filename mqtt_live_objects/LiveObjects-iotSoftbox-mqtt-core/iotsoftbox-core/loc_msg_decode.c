@@ -7,11 +7,13 @@
  */
 /**
  * @file  loc_msg_decode.c
- * @brief Decode and process the received JSON messages
+ * @brief Decode and process the received JSON (or CBOR) messages
  */
 
 #include "loc_msg.h"
 #include "loc_json_api.h"
+#include "loc_cbor.h"
+#include "liveobjects-client/LiveObjectsClient_Toolbox.h"
 
 #ifndef TRACE_GROUP
 #define TRACE_GROUP "JMSG"
@@ -30,8 +32,12 @@
 #include "liveobjects-sys/LiveObjectsClient_Platform.h"
 #include "platform_default.h"
 
+#ifndef MSG_DBG
 #define MSG_DBG       2
+#endif
+#ifndef MSG_DUMP
 #define MSG_DUMP      1
+#endif
 #define SANITY_CHECK  0
 
 /* --------------------------------------------------------------------------------- */
@@ -273,6 +279,34 @@ static int get_CorrelationId(int32_t* pCid, const char* payload_data, const jsmn
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_PARAMS
+/* Checks shared by the JSON and CBOR decoders: give the decoded value to the user callback,
+ * then copy it in the user variable. Only the types supported by updateCnfParam are accepted,
+ * and a numeric value is given only if the parameter has a user variable. */
+static int LO_msg_param_apply(const LiveObjectsD_Param_t* param_ptr, const void* value, uint32_t len,
+		LiveObjectsD_CallbackParams_t cfgCB) {
+	int ret;
+	switch (param_ptr->parm_data.data_type) {
+	case LOD_TYPE_STRING_C:
+		return cfgCB(param_ptr, value, (int) len);
+	case LOD_TYPE_UINT32:
+	case LOD_TYPE_INT32:
+	case LOD_TYPE_FLOAT:
+	case LOD_TYPE_DOUBLE:
+		if (param_ptr->parm_data.data_value == NULL) {
+			return 0;
+		}
+		ret = cfgCB(param_ptr, value, (int) len);
+		if (ret == 0) {
+			memcpy(param_ptr->parm_data.data_value, value, len);
+		}
+		return ret;
+	default:
+		LOTRACE_ERR("(%s): unsupported type %d ", param_ptr->parm_data.data_name,
+				param_ptr->parm_data.data_type);
+		return -1;
+	}
+}
+
 static int updateCnfParam(const char* payload_json, const jsmntok_t* token, const LiveObjectsD_Param_t* param_ptr,
 		LiveObjectsD_CallbackParams_t cfgCB) {
 	int ret;
@@ -287,7 +321,8 @@ static int updateCnfParam(const char* payload_json, const jsmntok_t* token, cons
 			LOTRACE_ERR("bad token type  %d != %d (STRING)", token->type, JSMN_STRING);
 			return -1;
 		}
-		ret = cfgCB(param_ptr, (const void*) (payload_json + token->start), token->end - token->start);
+		ret = LO_msg_param_apply(param_ptr, (const void*) (payload_json + token->start), token->end - token->start,
+				cfgCB);
 	}
 	else {
 		if (token->type != JSMN_PRIMITIVE) {
@@ -299,43 +334,33 @@ static int updateCnfParam(const char* payload_json, const jsmntok_t* token, cons
 		if (param_ptr->parm_data.data_type == LOD_TYPE_UINT32) {
 			uint32_t value;
 			ret = getValueUINT32(&value, payload_json, token);
-			if ((ret == 0) && (param_ptr->parm_data.data_value)) {
-				ret = cfgCB(param_ptr, (const void*) &value, sizeof(uint32_t));
-				if (ret == 0)
-					*((uint32_t*) param_ptr->parm_data.data_value) = value;
+			if (ret == 0) {
+				ret = LO_msg_param_apply(param_ptr, (const void*) &value, sizeof(uint32_t), cfgCB);
 			}
 		}
 		else if (param_ptr->parm_data.data_type == LOD_TYPE_INT32) {
 			int32_t value;
 			ret = getValueINT32(&value, payload_json, token);
-			if ((ret == 0) && (param_ptr->parm_data.data_value)) {
-				ret = cfgCB(param_ptr, (const void*) &value, sizeof(int32_t));
-				if (ret == 0)
-					*((int32_t*) param_ptr->parm_data.data_value) = value;
+			if (ret == 0) {
+				ret = LO_msg_param_apply(param_ptr, (const void*) &value, sizeof(int32_t), cfgCB);
 			}
 		}
 		else if (param_ptr->parm_data.data_type == LOD_TYPE_FLOAT) {
 			float value;
 			ret = getValueFLOAT(&value, payload_json, token);
-			if ((ret == 0) && (param_ptr->parm_data.data_value)) {
-				ret = cfgCB(param_ptr, (const void*) &value, sizeof(float));
-				if (ret == 0)
-					*((float*) param_ptr->parm_data.data_value) = value;
+			if (ret == 0) {
+				ret = LO_msg_param_apply(param_ptr, (const void*) &value, sizeof(float), cfgCB);
 			}
 		}
 		else if (param_ptr->parm_data.data_type == LOD_TYPE_DOUBLE) {
 			double value;
 			ret = getValueDOUBLE(&value, payload_json, token);
-			if ((ret == 0) && (param_ptr->parm_data.data_value)) {
-				ret = cfgCB(param_ptr, (const void*) &value, sizeof(double));
-				if (ret == 0)
-					*((double*) param_ptr->parm_data.data_value) = value;
+			if (ret == 0) {
+				ret = LO_msg_param_apply(param_ptr, (const void*) &value, sizeof(double), cfgCB);
 			}
 		}
 		else {
-			LOTRACE_ERR("(%s): unsupported type %d ", param_ptr->parm_data.data_name,
-					param_ptr->parm_data.data_type);
-			ret = -1;
+			ret = LO_msg_param_apply(param_ptr, NULL, 0, cfgCB);
 		}
 	}
 	return ret;
@@ -679,6 +704,154 @@ LiveObjectsD_ResourceRespCode_t LO_msg_decode_rsc_req(const char* payload_data,
 }
 #endif /* LOC_FEATURE_LO_RESOURCES */
 
+/* --------------------------------------------------------------------------------- */
+/* CBOR requests: same structure as the JSON requests, a map instead of a JSON object.
+ * A JSON message starts with '{' (or a white space), never with a CBOR map header. */
+#if LOC_FEATURE_CBOR && (LOC_FEATURE_LO_PARAMS || LOC_FEATURE_LO_COMMANDS)
+static int LO_msg_isCbor(const char* payload_data, uint32_t payload_len) {
+	uint8_t ib = (payload_len) ? (uint8_t) payload_data[0] : 0;
+	return (ib >= 0xA0) && (ib <= 0xBB);
+}
+
+static int LO_cbor_isKey(const char* p, uint32_t len, const char* name) {
+	return (len == strlen(name)) && (!memcmp(p, name, len));
+}
+#endif
+
+#if LOC_FEATURE_CBOR && LOC_FEATURE_LO_PARAMS
+/* {"cfg":{"name":{"t":"u32","v":value},..},"cid":n} */
+static int LO_msg_decode_params_cbor(const char* payload_data, uint32_t payload_len, const LOMSetOfParams_t* pSetCfg,
+		LOMSetofUpdatedParams_t* pSetCfgUpdate) {
+	LOCborReader_t cr;
+	LOCborReader_t cfg;
+	uint32_t nb;
+	uint32_t size = 0;
+	const char* pc;
+	uint32_t len;
+
+	/* First pass: correlation id, and position of the parameters */
+	LO_cbor_reader_init(&cr, (const uint8_t*) payload_data, payload_len);
+	LO_cbor_reader_init(&cfg, NULL, 0);
+	if (LO_cbor_get_map(&cr, &nb)) {
+		LOTRACE_ERR("Bad CBOR format");
+		return -1;
+	}
+	while ((nb--) && (cr.err == 0)) {
+		int64_t cid;
+		if (LO_cbor_get_text(&cr, &pc, &len)) {
+			break;
+		}
+		if (LO_cbor_isKey(pc, len, "cid")) {
+			if ((LO_cbor_get_int(&cr, &cid) == 0) && (cid >= INT32_MIN) && (cid <= INT32_MAX)) {
+				pSetCfgUpdate->cid = (int32_t) cid;
+			}
+		}
+		else if (LO_cbor_isKey(pc, len, "cfg")) {
+			cfg = cr;
+			LO_cbor_skip(&cr);
+		}
+		else {
+			LO_cbor_skip(&cr);
+		}
+	}
+	if ((cr.err) || (LO_cbor_get_map(&cfg, &size))) {
+		LOTRACE_ERR("Bad CBOR format, expected 'cfg' (cid=%"PRIi32")", pSetCfgUpdate->cid);
+		return -1;
+	}
+	LOTRACE_DBG1("%"PRIu32" parameters (CBOR) ...", size);
+
+	/* Now, get each configuration parameter */
+	while (size--) {
+		const LiveObjectsD_Param_t* param_ptr = NULL;
+		LiveObjectsD_Type_t type = LOD_TYPE_UNKNOWN;
+		LOCborReader_t val;
+		uint32_t fields;
+		int i;
+
+		val.err = -1;
+		if ((LO_cbor_get_text(&cfg, &pc, &len)) || (LO_cbor_get_map(&cfg, &fields))) {
+			LOTRACE_ERR("Bad CBOR param format");
+			return -2;
+		}
+		for (i = 0; i < pSetCfg->param_set.param_nb; i++) {
+			if (LO_cbor_isKey(pc, len, pSetCfg->param_set.param_ptr[i].parm_data.data_name)) {
+				param_ptr = &pSetCfg->param_set.param_ptr[i];
+				break;
+			}
+		}
+		while (fields--) {
+			const char* key;
+			uint32_t key_len;
+			if (LO_cbor_get_text(&cfg, &key, &key_len)) {
+				return -2;
+			}
+			if (LO_cbor_isKey(key, key_len, "t")) {
+				const char* t;
+				uint32_t t_len;
+				if (LO_cbor_get_text(&cfg, &t, &t_len)) {
+					return -2;
+				}
+				type = LO_getDataTypeFromStrL(t, t_len);
+			}
+			else {
+				if (LO_cbor_isKey(key, key_len, "v")) {
+					val = cfg;
+				}
+				if (LO_cbor_skip(&cfg)) {
+					return -2;
+				}
+			}
+		}
+
+		if (param_ptr == NULL) {
+			LOTRACE_NOTICE("param %.*s - not found", (int) len, pc);
+		}
+		else if (type != param_ptr->parm_data.data_type) {
+			LOTRACE_NOTICE("param %s - bad type - received %d != expected %d",
+					param_ptr->parm_data.data_name, type, param_ptr->parm_data.data_type);
+		}
+		else if (val.err) {
+			LOTRACE_NOTICE("param %s - no value", param_ptr->parm_data.data_name);
+		}
+		else {
+			union {
+				int32_t i32;
+				uint32_t u32;
+				float f;
+				double d;
+				const char* str;
+			} value;
+			uint32_t value_len = 0;
+			switch (type) {
+			case LOD_TYPE_STRING_C:
+			case LOD_TYPE_INT32:
+			case LOD_TYPE_UINT32:
+			case LOD_TYPE_FLOAT:
+			case LOD_TYPE_DOUBLE:
+				if (LO_cbor_get_typed(&val, type, &value, &value_len)) {
+					LOTRACE_NOTICE("param %s - bad value", param_ptr->parm_data.data_name);
+				}
+				else if (type == LOD_TYPE_STRING_C) {
+					LO_msg_param_apply(param_ptr, (const void*) value.str, value_len, pSetCfg->param_callback);
+				}
+				else {
+					value_len = (type == LOD_TYPE_DOUBLE) ? sizeof(double) : 4;
+					LO_msg_param_apply(param_ptr, (const void*) &value, value_len, pSetCfg->param_callback);
+				}
+				break;
+			default:
+				LO_msg_param_apply(param_ptr, NULL, 0, pSetCfg->param_callback);
+				break;
+			}
+			if (pSetCfgUpdate->nb_of_params < LOC_MAX_OF_PARSED_PARAMS) {
+				pSetCfgUpdate->tab_of_param_ptr[pSetCfgUpdate->nb_of_params++] = param_ptr;
+			}
+		}
+	}
+	return 0;
+}
+#endif /* LOC_FEATURE_CBOR && LOC_FEATURE_LO_PARAMS */
+
 /* --------------------------------------------------------------------------------- */
 /* Decode a received JSON message to update configuration parameters
  */
@@ -708,6 +881,12 @@ int LO_msg_decode_params_req(const char* payload_data, uint32_t payload_len, con
 	pSetCfgUpdate->cid = 0;
 	pSetCfgUpdate->nb_of_params = 0;
 
+#if LOC_FEATURE_CBOR
+	if (LO_msg_isCbor(payload_data, payload_len)) {
+		return LO_msg_decode_params_cbor(payload_data, payload_len, pSetCfg, pSetCfgUpdate);
+	}
+#endif
+
 	memset(&tokens, 0, sizeof(tokens));
 	jsmn_init(&parser);
 	token_cnt = jsmn_parse(&parser, payload_data, payload_len, tokens, NB_TK_FOR_PARMS);
@@ -846,6 +1025,181 @@ int LO_msg_decode_params_req(const char* payload_data, uint32_t payload_len, con
 }
 #endif /* LOC_FEATURE_LO_PARAMS */
 
+/* --------------------------------------------------------------------------------- */
+/* {"req":"name","arg":{"name":value,..},"cid":n}
+ * The arguments are given to the user as in a JSON request: text of the value, and arg_type 1 for a string. */
+#if LOC_FEATURE_CBOR && LOC_FEATURE_LO_COMMANDS
+static int LO_msg_cbor_argText(LOCborReader_t* cr, char* num, const char** p, uint32_t* len, uint16_t* type) {
+	int major = LO_cbor_peek(cr);
+	*type = 0;
+	if (major == LO_CBOR_TEXT) {
+		*type = 1;
+		return LO_cbor_get_text(cr, p, len);
+	}
+	*p = num;
+	if ((major == LO_CBOR_UINT) || (major == LO_CBOR_NINT)) {
+		int64_t i;
+		if (LO_cbor_get_int(cr, &i)) {
+			return -1;
+		}
+		if (i < 0) {
+			num[0] = '-';
+			*len = 1 + LO_fmt_u64(num + 1, (uint64_t) (-(i + 1)) + 1);
+		}
+		else {
+			*len = LO_fmt_u64(num, (uint64_t) i);
+		}
+		return 0;
+	}
+	if ((major == LO_CBOR_SIMPLE) && ((cr->buf_ptr[cr->pos] == 0xF4) || (cr->buf_ptr[cr->pos] == 0xF5))) {
+		uint8_t b;
+		LO_cbor_get_bool(cr, &b);
+		*p = (b) ? "true" : "false";
+		*len = (b) ? 4 : 5;
+		return 0;
+	}
+	if (major == LO_CBOR_SIMPLE) {
+		double d;
+		if (LO_cbor_get_double(cr, &d)) {
+			return -1;
+		}
+		*len = LO_fmt_double(num, d, LOD_PREC_SHORTEST);
+		return 0;
+	}
+	return -1;
+}
+
+static int LO_msg_decode_cmd_cbor(const char* payload_data, uint32_t payload_len, const LOMSetofCommands_t* pSetCmd,
+		int32_t* pCid) {
+	LOCborReader_t cr;
+	LOCborReader_t arg;
+	const LiveObjectsD_Command_t* cmd_ptr = NULL;
+	LiveObjectsD_CommandRequestBlock_t* pReqBlk;
+	LiveObjectsD_CommandArg_t* pArgs;
+	char num[LO_FMT_NUM_SZ];
+	char* pLine;
+	const char* pc;
+	const char* req = NULL;
+	uint32_t req_len = 0;
+	uint32_t len;
+	uint32_t nb;
+	uint32_t size = 0;
+	uint32_t i;
+	int blk_len;
+	int ret;
+
+	LO_cbor_reader_init(&cr, (const uint8_t*) payload_data, payload_len);
+	LO_cbor_reader_init(&arg, NULL, 0);
+	if (LO_cbor_get_map(&cr, &nb)) {
+		LOTRACE_ERR("Bad CBOR format");
+		return -1;
+	}
+	while ((nb--) && (cr.err == 0)) {
+		int64_t cid;
+		if (LO_cbor_get_text(&cr, &pc, &len)) {
+			break;
+		}
+		if (LO_cbor_isKey(pc, len, "cid")) {
+			if ((LO_cbor_get_int(&cr, &cid) == 0) && (cid >= INT32_MIN) && (cid <= INT32_MAX)) {
+				*pCid = (int32_t) cid;
+			}
+		}
+		else if (LO_cbor_isKey(pc, len, "req")) {
+			LO_cbor_get_text(&cr, &req, &req_len);
+		}
+		else {
+			if (LO_cbor_isKey(pc, len, "arg")) {
+				arg = cr;
+			}
+			LO_cbor_skip(&cr);
+		}
+	}
+	if ((cr.err) || (req == NULL)) {
+		LOTRACE_ERR("Bad CBOR format (cid=%"PRIi32")", *pCid);
+		return -2;
+	}
+
+	// Is it registered by user ?
+	LOTRACE_INF("command \"%.*s\"  (NumberOfCommands=%d) ..", (int) req_len, req, pSetCmd->cmd_nb);
+	for (i = 0; i < (uint32_t) pSetCmd->cmd_nb; i++) {
+		if (LO_cbor_isKey(req, req_len, pSetCmd->cmd_ptr[i].cmd_name)) {
+			cmd_ptr = &pSetCmd->cmd_ptr[i];
+			break;
+		}
+	}
+	if (cmd_ptr == NULL) {
+		LOTRACE_ERR("cid=%"PRIi32" - command \"%.*s\" not registered ", *pCid, (int) req_len, req);
+		return -3;
+	}
+	if (pSetCmd->cmd_callback == NULL) {
+		LOTRACE_ERR("cid=%"PRIi32" - command \"%.*s\" - No function to process command", *pCid, (int) req_len, req);
+		return -4;
+	}
+
+	// Size of the arguments (first pass), then copy them in the request block
+	blk_len = sizeof(LiveObjectsD_CommandRequestHeader_t);
+	if (arg.buf_ptr) {
+		LOCborReader_t tmp;
+		if (LO_cbor_get_map(&arg, &size)) {
+			LOTRACE_ERR("Bad CBOR format - \"arg\" is not a map");
+			return -2;
+		}
+		tmp = arg;
+		if (size) {
+			blk_len = sizeof(LiveObjectsD_CommandRequestBlock_t) + (size - 1) * sizeof(LiveObjectsD_CommandArg_t);
+		}
+		for (i = 0; i < size; i++) {
+			uint16_t type;
+			if (LO_cbor_get_text(&tmp, &pc, &len)) {
+				return -2;
+			}
+			blk_len += len + 1;
+			if (LO_msg_cbor_argText(&tmp, num, &pc, &len, &type)) {
+				LOTRACE_ERR("format not supported for arg[%"PRIu32"]", i);
+				return -2;
+			}
+			blk_len += len + 1;
+		}
+	}
+
+	pReqBlk = (LiveObjectsD_CommandRequestBlock_t*) MEM_ALLOC(blk_len);
+	if (pReqBlk == NULL) {
+		LOTRACE_ERR("nb_params=%"PRIu32" - MEM_ALLOC ERROR, len=%d", size, blk_len);
+		return -6;
+	}
+	pReqBlk->hd.cmd_blk_len = blk_len;
+	pReqBlk->hd.cmd_ptr = cmd_ptr;
+	pReqBlk->hd.cmd_cid = *pCid;
+	pReqBlk->hd.cmd_args_nb = 0;
+
+	if (size) {
+		pArgs = (LiveObjectsD_CommandArg_t*) pReqBlk->args_array;
+		pLine = (char*) pReqBlk + sizeof(LiveObjectsD_CommandRequestBlock_t)
+				+ (size - 1) * sizeof(LiveObjectsD_CommandArg_t);
+		for (i = 0; i < size; i++, pArgs++) {
+			LO_cbor_get_text(&arg, &pc, &len);
+			pArgs->arg_name = pLine;
+			memcpy(pLine, pc, len);
+			pLine += len;
+			*pLine++ = 0;
+
+			LO_msg_cbor_argText(&arg, num, &pc, &len, &pArgs->arg_type);
+			pArgs->arg_value = pLine;
+			memcpy(pLine, pc, len);
+			pLine += len;
+			*pLine++ = 0;
+
+			LOTRACE_INF("arg \"%s\" = (%u) %s", pArgs->arg_name, pArgs->arg_type, pArgs->arg_value);
+			pReqBlk->hd.cmd_args_nb++;
+		}
+	}
+
+	ret = pSetCmd->cmd_callback(pReqBlk);
+	MEM_FREE(pReqBlk);
+	return ret;
+}
+#endif /* LOC_FEATURE_CBOR && LOC_FEATURE_LO_COMMANDS */
+
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_COMMANDS
@@ -867,6 +1221,12 @@ int LO_msg_decode_cmd_req(const char* payload_data, uint32_t payload_len, const
 
 	*pCid = 0;
 
+#if LOC_FEATURE_CBOR
+	if (LO_msg_isCbor(payload_data, payload_len)) {
+		return LO_msg_decode_cmd_cbor(payload_data, payload_len, pSetCmd, pCid);
+	}
+#endif
+
 	memset(&tokens, 0, sizeof(tokens));
 	jsmn_init(&parser);
 	token_cnt = jsmn_parse(&parser, payload_data, payload_len, tokens, 20);
@@ -15,6 +15,9 @@
 
 #include "loc_msg.h"
 #include "loc_json_api.h"
+#include "loc_cbor.h"
+#include "loc_mpool.h"
+#include "liveobjects-client/LiveObjectsClient_Toolbox.h"
 #include "loc_sys.h"
 
 #ifndef TRACE_GROUP
@@ -29,49 +32,447 @@
 #include "liveobjects-sys/LiveObjectsClient_Platform.h"
 #include "platform_default.h"
 
+/* --------------------------------------------------------------------------------- */
+/* Encode plan of an array of data elements, compiled when the array is attached: the JSON
+ * names are rendered once, and the value writer of each element is selected by its type.
+ * Only the name, type and dimension of the elements must not change after this compilation.
+ */
+int LO_msg_plan_compile(LOMArrayOfData_t* pObjSet) {
+	const LiveObjectsD_Data_t* data_ptr = pObjSet->data_ptr;
+	LOMPlanItem_t* plan;
+	uint32_t sz;
+	char* p;
+	int i;
+
+	LO_msg_plan_release(pObjSet);
+	if ((data_ptr == NULL) || (pObjSet->data_nb <= 0)) {
+		return -1;
+	}
+
+	sz = pObjSet->data_nb * sizeof(LOMPlanItem_t);
+	for (i = 0; i < pObjSet->data_nb; i++) {
+		if ((data_ptr[i].data_name == NULL) || (data_ptr[i].data_value == NULL) || (data_ptr[i].data_dim <= 0)
+				|| (LO_json_value_writer(data_ptr[i].data_type) == NULL) || (strlen(data_ptr[i].data_name) > 1024)) {
+			/* Encoded without plan: the error is reported when the data are published */
+			LOTRACE_WARN("[%d] - Invalid DataDef (type=%d name=%p), no encode plan", i, data_ptr[i].data_type,
+					data_ptr[i].data_name);
+			return -1;
+		}
+		sz += strlen(data_ptr[i].data_name) + 3;
+	}
+
+	plan = (LOMPlanItem_t*) MEM_ALLOC(sz);
+	if (plan == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (size=%"PRIu32")", sz);
+		return -1;
+	}
+	p = (char*) (plan + pObjSet->data_nb);
+	for (i = 0; i < pObjSet->data_nb; i++) {
+		size_t len = strlen(data_ptr[i].data_name);
+		plan[i].name = p;
+		plan[i].name_len = (uint16_t) (len + 3);
+		plan[i].writer = LO_json_value_writer(data_ptr[i].data_type);
+		*p++ = '"';
+		memcpy(p, data_ptr[i].data_name, len);
+		p += len;
+		*p++ = '"';
+		*p++ = ':';
+	}
+	pObjSet->plan = plan;
+	LOTRACE_DBG1("nb=%d size=%"PRIu32, pObjSet->data_nb, sz);
+	return 0;
+}
+
 /* --------------------------------------------------------------------------------- */
 /*  */
-static const char* LO_msg_encode_status_buf(char* buf_ptr, uint32_t buf_len, const LOMArrayOfData_t* pObjSet) {
-	int ret, i;
-	const LiveObjectsD_Data_t* data_ptr;
-	ret = LO_json_begin_section(buf_ptr, buf_len, "info");
-	if (ret) {
-		LOTRACE_ERR("failed (LO_json_begin)");
-		return NULL;
+void LO_msg_plan_release(LOMArrayOfData_t* pObjSet) {
+	if (pObjSet->plan) {
+		MEM_FREE(pObjSet->plan);
+		pObjSet->plan = NULL;
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Size of the value of a data element in a shadow: values copied, 32-bit hash of a string
+ * (one null-terminated string, whatever data_dim) */
+static uint32_t LO_msg_shadow_itemSize(const LiveObjectsD_Data_t* data_ptr) {
+	uint32_t sz;
+	switch (data_ptr->data_type) {
+	case LOD_TYPE_STRING_C:
+		return sizeof(uint32_t);
+	case LOD_TYPE_INT32:
+	case LOD_TYPE_UINT32:
+	case LOD_TYPE_FLOAT:
+		sz = sizeof(uint32_t);
+		break;
+	case LOD_TYPE_INT16:
+	case LOD_TYPE_UINT16:
+		sz = sizeof(uint16_t);
+		break;
+	case LOD_TYPE_DOUBLE:
+		sz = sizeof(double);
+		break;
+	default:
+		sz = sizeof(uint8_t);
+		break;
+	}
+	return sz * ((data_ptr->data_dim > 0) ? data_ptr->data_dim : 1);
+}
+
+/* FNV-1a */
+static uint32_t LO_msg_shadow_hash(const char* p) {
+	uint32_t h = 2166136261u;
+	while (*p) {
+		h = (h ^ (uint8_t) *p++) * 16777619u;
 	}
-	data_ptr = pObjSet->data_ptr;
+	return h;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Shadow copy of the last published values of an array of data elements, to publish only
+ * the elements changed since then. The values are compared when the array is encoded
+ * (pending copy), and this copy becomes the published one once the message is sent. */
+int LO_msg_shadow_init(LOMShadow_t* pShadow, const LOMArrayOfData_t* pObjSet) {
+	uint32_t sz = 0;
+	int i;
+
+	LO_msg_shadow_release(pShadow);
 	for (i = 0; i < pObjSet->data_nb; i++) {
+		sz += LO_msg_shadow_itemSize(&pObjSet->data_ptr[i]);
+	}
+	pShadow->values = (uint8_t*) MEM_ALLOC(2 * sz + (pObjSet->data_nb + 7) / 8);
+	if (pShadow->values == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (size=%"PRIu32")", 2 * sz);
+		return -1;
+	}
+	pShadow->mask = pShadow->values + 2 * sz;
+	pShadow->size = sz;
+	pShadow->valid = 0;
+	LOTRACE_DBG1("nb=%d size=%"PRIu32, pObjSet->data_nb, sz);
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void LO_msg_shadow_release(LOMShadow_t* pShadow) {
+	if (pShadow->values) {
+		MEM_FREE(pShadow->values);
+	}
+	pShadow->values = NULL;
+	pShadow->mask = NULL;
+	pShadow->size = 0;
+	pShadow->valid = 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Take the pending copy of the current values, and set the mask of the elements changed since
+ * the published copy (all the elements if full is set, or if there is no published copy).
+ * Return the number of elements in the mask. */
+int LO_msg_shadow_diff(LOMShadow_t* pShadow, const LOMArrayOfData_t* pObjSet, uint8_t full) {
+	const LiveObjectsD_Data_t* data_ptr = pObjSet->data_ptr;
+	uint8_t* published = pShadow->values;
+	uint8_t* pending = pShadow->values + pShadow->size;
+	int nb = 0;
+	int i;
+
+	if (!pShadow->valid) {
+		full = 1;
+	}
+	memset(pShadow->mask, 0, (pObjSet->data_nb + 7) / 8);
+	for (i = 0; i < pObjSet->data_nb; i++, data_ptr++) {
+		uint32_t sz = LO_msg_shadow_itemSize(data_ptr);
+		if (data_ptr->data_type == LOD_TYPE_STRING_C) {
+			uint32_t h = LO_msg_shadow_hash((const char*) data_ptr->data_value);
+			memcpy(pending, &h, sizeof(uint32_t));
+		}
+		else {
+			memcpy(pending, data_ptr->data_value, sz);
+		}
+		if ((full) || (memcmp(pending, published, sz))) {
+			pShadow->mask[i >> 3] |= (uint8_t) (1 << (i & 7));
+			nb++;
+		}
+		pending += sz;
+		published += sz;
+	}
+	return nb;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* The pending copy has been published */
+void LO_msg_shadow_commit(LOMShadow_t* pShadow) {
+	memcpy(pShadow->values, pShadow->values + pShadow->size, pShadow->size);
+	pShadow->valid = 1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Elements of the array (only the ones set in the mask, if any) with their current values,
+ * using the encode plan if any */
+static int LO_msg_encode_items(const LOMArrayOfData_t* pObjSet, const uint8_t* mask, LOJsonWriter_t* jw) {
+	const LiveObjectsD_Data_t* data_ptr = pObjSet->data_ptr;
+	int i;
+
+	if (pObjSet->plan) {
+		const LOMPlanItem_t* item = pObjSet->plan;
+		for (i = 0; i < pObjSet->data_nb; i++, item++, data_ptr++) {
+			if (!LOM_MASK_ISSET(mask, i)) {
+				continue;
+			}
+			if ((LO_json_add_fragment(item->name, item->name_len, jw))
+					|| (LO_json_add_value(item->writer, data_ptr, jw))) {
+				LOTRACE_ERR("(%d, %s): failed, free len = %"PRIu32, data_ptr->data_type, data_ptr->data_name,
+						jw->buf_sz - jw->buf_len);
+				return -1;
+			}
+		}
+		return 0;
+	}
+
+	for (i = 0; i < pObjSet->data_nb; i++, data_ptr++) {
+		if (!LOM_MASK_ISSET(mask, i)) {
+			continue;
+		}
 		LOTRACE_DBG1("[%d] - data_type=%d=%s data_name=%s", i, data_ptr->data_type,
 				LO_getDataTypeToStr(data_ptr->data_type), data_ptr->data_name);
-		ret = LO_json_add_item(data_ptr, buf_ptr, buf_len);
-		if (ret) {
+		if (LO_json_add_item(data_ptr, jw)) {
 			LOTRACE_ERR("failed (LO_json_add_item)");
-			return NULL;
+			return -1;
 		}
-		data_ptr++;
 	}
-	ret = LO_json_end_section(buf_ptr, buf_len);
+	return 0;
+}
+
+#if LOC_FEATURE_LO_DATA
+/* --------------------------------------------------------------------------------- */
+/* Render the constant parts of the 'data' messages of this set: stream id, model and tags.
+ * To be called again when one of them is changed. */
+int LO_msg_plan_envelope(LOMSetOfData_t* pSetData) {
+	LOJsonWriter_t jw;
+	uint32_t s_end;
+	uint32_t m_end;
+	int ret;
+
+	pSetData->plan_s_len = 0;
+	LO_json_init(&jw, pSetData->plan_env, sizeof(pSetData->plan_env));
+
+	ret = LO_json_add_name_str("s", pSetData->stream_id, &jw);
+	s_end = jw.buf_len;
+#if (LOM_SETOFDATA_MODEL_SZ > 0)
+	if (ret == 0) {
+		ret = LO_json_add_name_str("m", pSetData->model, &jw);
+	}
+#endif
+	m_end = jw.buf_len;
+#if (LOM_SETOFDATA_TAGS_SZ > 0)
+	if ((ret == 0) && (pSetData->tags[0])) {
+		ret = LO_json_add_name_array("t", pSetData->tags, &jw);
+	}
+#endif
 	if (ret) {
-		LOTRACE_ERR("failed (LO_json_end)");
+		LOTRACE_ERR("failed, stream_id=%s", pSetData->stream_id);
+		return -1;
+	}
+	pSetData->plan_m_len = (uint16_t) (m_end - s_end);
+	pSetData->plan_t_len = (uint16_t) (jw.buf_len - m_end);
+	pSetData->plan_s_len = (uint16_t) s_end;
+	return 0;
+}
+#endif /* LOC_FEATURE_LO_DATA */
+
+#if LOC_FEATURE_CBOR
+/* --------------------------------------------------------------------------------- */
+/* CBOR encoding, in the buffer of the JSON writer: same structure as the JSON message.
+ * The length of the payload is set in jw->buf_len (no terminating null character). */
+static int LO_msg_cbor_items(LOCborWriter_t* cw, const LOMArrayOfData_t* pObjSet, const uint8_t* mask) {
+	uint32_t nb = 0;
+	int i;
+	for (i = 0; i < pObjSet->data_nb; i++) {
+		if (LOM_MASK_ISSET(mask, i)) {
+			nb++;
+		}
+	}
+	if (LO_cbor_put_map(cw, nb)) {
+		return -1;
+	}
+	for (i = 0; i < pObjSet->data_nb; i++) {
+		if (!LOM_MASK_ISSET(mask, i)) {
+			continue;
+		}
+		if (LO_cbor_put_item(cw, &pObjSet->data_ptr[i])) {
+			LOTRACE_ERR("failed (item %d)", i);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static const char* LO_msg_cbor_done(LOJsonWriter_t* jw, const LOCborWriter_t* cw) {
+	if (cw->err) {
+		LOTRACE_ERR("failed (CBOR buffer too small: %"PRIu32" bytes)", cw->buf_sz);
 		return NULL;
 	}
-	return buf_ptr;
+	jw->buf_len = cw->buf_len;
+	return jw->buf_ptr;
+}
+
+/* {"info":{items}} */
+static const char* LO_msg_encode_status_cbor(LOJsonWriter_t* jw, const LOMArrayOfData_t* pObjSet,
+		const uint8_t* mask) {
+	LOCborWriter_t cw;
+	LO_cbor_init(&cw, (uint8_t*) jw->buf_ptr, jw->buf_sz);
+	if ((LO_cbor_put_map(&cw, 1) == 0) && (LO_cbor_put_str(&cw, "info") == 0)) {
+		LO_msg_cbor_items(&cw, pObjSet, mask);
+	}
+	return LO_msg_cbor_done(jw, &cw);
+}
+
+#if LOC_FEATURE_LO_DATA
+/* {"s":"..","ts":"..","m":"..","loc":[lat,long],"v":{items},"t":["..",..]} */
+static const char* LO_msg_encode_data_cbor(LOJsonWriter_t* jw, const LOMSetOfData_t* pSetData) {
+	LOCborWriter_t cw;
+	uint32_t nb = 2;
+	int gps = (pSetData->gps_ptr) && (pSetData->gps_ptr->gps_valid);
+
+	if (pSetData->timestamp[0]) {
+		nb++;
+	}
+#if (LOM_SETOFDATA_MODEL_SZ > 0)
+	nb++;
+#endif
+	if (gps) {
+		nb++;
+	}
+#if (LOM_SETOFDATA_TAGS_SZ > 0)
+	if (pSetData->tags[0]) {
+		nb++;
+	}
+#endif
+
+	LO_cbor_init(&cw, (uint8_t*) jw->buf_ptr, jw->buf_sz);
+	LO_cbor_put_map(&cw, nb);
+	LO_cbor_put_str(&cw, "s");
+	LO_cbor_put_str(&cw, pSetData->stream_id);
+	if (pSetData->timestamp[0]) {
+		LO_cbor_put_str(&cw, "ts");
+		LO_cbor_put_str(&cw, pSetData->timestamp);
+	}
+#if (LOM_SETOFDATA_MODEL_SZ > 0)
+	LO_cbor_put_str(&cw, "m");
+	LO_cbor_put_str(&cw, pSetData->model);
+#endif
+	if (gps) {
+		LO_cbor_put_str(&cw, "loc");
+		LO_cbor_put_array(&cw, 2);
+		LO_cbor_put_float(&cw, pSetData->gps_ptr->gps_lat);
+		LO_cbor_put_float(&cw, pSetData->gps_ptr->gps_long);
+	}
+	LO_cbor_put_str(&cw, "v");
+	LO_msg_cbor_items(&cw, &pSetData->data_set, NULL);
+#if (LOM_SETOFDATA_TAGS_SZ > 0)
+	if (pSetData->tags[0]) {
+		LO_cbor_put_str(&cw, "t");
+		LO_cbor_put_tags(&cw, pSetData->tags);
+	}
+#endif
+	return LO_msg_cbor_done(jw, &cw);
 }
+#endif /* LOC_FEATURE_LO_DATA */
+#endif /* LOC_FEATURE_CBOR */
 
 /* --------------------------------------------------------------------------------- */
 /*  */
+static const char* LO_msg_encode_status_buf(LOJsonWriter_t* jw, const LOMArrayOfData_t* pObjSet,
+		const uint8_t* mask) {
+	int ret;
+#if LOC_FEATURE_CBOR
+	if (pObjSet->encoding == LOD_ENCODING_CBOR) {
+		return LO_msg_encode_status_cbor(jw, pObjSet, mask);
+	}
+#endif
+	ret = LO_json_begin_section(jw, "info");
+	if (ret) {
+		LOTRACE_ERR("failed (LO_json_begin)");
+		return NULL;
+	}
+	ret = LO_msg_encode_items(pObjSet, mask, jw);
+	if (ret) {
+		return NULL;
+	}
+	ret = LO_json_end_section(jw);
+	if (ret) {
+		LOTRACE_ERR("failed (LO_json_end)");
+		return NULL;
+	}
+	return jw->buf_ptr;
+}
+
 #if LOC_FEATURE_LO_DATA
-static const char* LO_msg_encode_data_buf(char* buf_ptr, uint32_t buf_len, const LOMSetOfData_t* pSetData) {
+/* --------------------------------------------------------------------------------- */
+/* "v" section written by the user encoder of the set, directly in the buffer */
+static int LO_msg_encode_values_user(const LOMSetOfData_t* pSetData, LOJsonWriter_t* jw) {
+	int len;
+	if (LO_json_add_fragment("\"v\":", 4, jw)) {
+		return -1;
+	}
+	len = pSetData->encoder(pSetData->encoder_ctx, jw->buf_ptr + jw->buf_len, jw->buf_sz - jw->buf_len);
+	if ((len < 0) || (jw->buf_len + (uint32_t) len >= jw->buf_sz)) {
+		LOTRACE_ERR("failed (user encoder), free len = %"PRIu32, jw->buf_sz - jw->buf_len);
+		jw->buf_ptr[jw->buf_len] = 0;
+		jw->err = 1;
+		return -1;
+	}
+	jw->buf_len += (uint32_t) len;
+	jw->buf_ptr[jw->buf_len] = 0;
+	return LO_json_add_fragment(",", 1, jw);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* "v" section of a data message: values encoded by the user function of the set, or from its table */
+static int LO_msg_encode_values(const LOMSetOfData_t* pSetData, LOJsonWriter_t* jw) {
 	int ret;
+	if (pSetData->encoder) {
+		return LO_msg_encode_values_user(pSetData, jw);
+	}
 
-	ret = LO_json_begin(buf_ptr, buf_len);
+	ret = LO_json_add_section_start("v", jw);
+	if (ret) {
+		LOTRACE_ERR("failed (add section v)");
+	}
+	if (ret == 0) {
+		ret = LO_msg_encode_items(&pSetData->data_set, NULL, jw);
+	}
+	if (ret == 0) {
+		ret = LO_json_add_section_end(jw);
+		if (ret) {
+			LOTRACE_ERR("failed (end section v)");
+		}
+	}
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static const char* LO_msg_encode_data_buf(LOJsonWriter_t* jw, const LOMSetOfData_t* pSetData) {
+	int ret;
+#if LOC_FEATURE_CBOR
+	if (pSetData->data_set.encoding == LOD_ENCODING_CBOR) {
+		return LO_msg_encode_data_cbor(jw, pSetData);
+	}
+#endif
+
+	ret = LO_json_begin(jw);
 	if (ret) {
 		LOTRACE_ERR("failed (LO_json_begin)");
 	}
 
 	if (ret == 0) {
 		// stream id
-		ret = LO_json_add_name_str("s", pSetData->stream_id, buf_ptr, buf_len);
+		if (pSetData->plan_s_len) {
+			ret = LO_json_add_fragment(pSetData->plan_env, pSetData->plan_s_len, jw);
+		}
+		else {
+			ret = LO_json_add_name_str("s", pSetData->stream_id, jw);
+		}
 		if (ret) {
 			LOTRACE_ERR("failed (stream_id)");
 		}
@@ -79,7 +480,7 @@ static const char* LO_msg_encode_data_buf(char* buf_ptr, uint32_t buf_len, const
 
 	// timestamp
 	if ((ret == 0) && (pSetData->timestamp[0])) {
-		ret = LO_json_add_name_str("ts", pSetData->timestamp, buf_ptr, buf_len);
+		ret = LO_json_add_name_str("ts", pSetData->timestamp, jw);
 		if (ret)
 			LOTRACE_ERR("failed (timestamp)");
 	}
@@ -87,7 +488,12 @@ static const char* LO_msg_encode_data_buf(char* buf_ptr, uint32_t buf_len, const
 #if (LOM_SETOFDATA_MODEL_SZ > 0)
 	if (ret == 0) {
 		// model
-		ret = LO_json_add_name_str("m", pSetData->model, buf_ptr, buf_len);
+		if (pSetData->plan_s_len) {
+			ret = LO_json_add_fragment(pSetData->plan_env + pSetData->plan_s_len, pSetData->plan_m_len, jw);
+		}
+		else {
+			ret = LO_json_add_name_str("m", pSetData->model, jw);
+		}
 		if (ret)
 			LOTRACE_ERR("failed (model)");
 	}
@@ -95,67 +501,51 @@ static const char* LO_msg_encode_data_buf(char* buf_ptr, uint32_t buf_len, const
 
 	// Add GPS localization
 	if ((ret == 0) && (pSetData->gps_ptr) && (pSetData->gps_ptr->gps_valid)) {
-		char msg[80];
-		snprintf(msg, sizeof(msg) - 1, "%3.6f,%3.6f", pSetData->gps_ptr->gps_lat, pSetData->gps_ptr->gps_long);
-		ret = LO_json_add_name_array("loc", msg, buf_ptr, buf_len);
+		char msg[2 * LO_FMT_NUM_SZ];
+		int len = LO_fmt_float(msg, pSetData->gps_ptr->gps_lat, 6);
+		msg[len++] = ',';
+		len += LO_fmt_float(msg + len, pSetData->gps_ptr->gps_long, 6);
+		msg[len] = 0;
+		ret = LO_json_add_name_array("loc", msg, jw);
 	}
 
 	if (ret == 0) {
-		ret = LO_json_add_section_start("v", buf_ptr, buf_len);
-		if (ret)
-			LOTRACE_ERR("failed (add section v)");
-	}
-
-	if (ret == 0) {
-		int i;
-		const LiveObjectsD_Data_t* data_ptr = pSetData->data_set.data_ptr;
-		for (i = 0; i < pSetData->data_set.data_nb; i++) {
-			LOTRACE_DBG1("[%d] - data_type=%d=%s data_name=%s", i, data_ptr->data_type,
-					LO_getDataTypeToStr(data_ptr->data_type), data_ptr->data_name);
-			ret = LO_json_add_item(data_ptr, buf_ptr, buf_len);
-			if (ret) {
-				LOTRACE_ERR("failed (LO_json_add_item)");
-				break;
-			}
-			data_ptr++;
-		}
-	}
-
-	if (ret == 0) {
-		ret = LO_json_add_section_end(buf_ptr, buf_len);
-		if (ret) {
-			LOTRACE_ERR("failed (end section v)");
-		}
+		ret = LO_msg_encode_values(pSetData, jw);
 	}
 
 #if (LOM_SETOFDATA_TAGS_SZ > 0)
-	if ((ret == 0) && (pSetData->tags[0])) {
-		ret = LO_json_add_name_array("t", pSetData->tags, buf_ptr, buf_len);
+	if ((ret == 0) && (pSetData->plan_s_len)) {
+		ret = LO_json_add_fragment(pSetData->plan_env + pSetData->plan_s_len + pSetData->plan_m_len,
+				pSetData->plan_t_len, jw);
+		if (ret)
+			LOTRACE_ERR("failed (tags)");
+	}
+	else if ((ret == 0) && (pSetData->tags[0])) {
+		ret = LO_json_add_name_array("t", pSetData->tags, jw);
 		if (ret)
 			LOTRACE_ERR("failed (LO_json_add_name_str(\"t\", ...)");
 	}
 #endif
 
 	if (ret == 0) {
-		ret = LO_json_end(buf_ptr, buf_len);
+		ret = LO_json_end(jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_end)");
 		}
 	}
 
-	return (ret == 0) ? buf_ptr : NULL;
+	return (ret == 0) ? jw->buf_ptr : NULL;
 }
 #endif /* LOC_FEATURE_LO_DATA */
 
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_RESOURCES
-static const char* LO_msg_encode_resources_buf(char* buf_ptr, uint32_t buf_len,
-		const LOMSetOfResources_t* pSetResources) {
+static const char* LO_msg_encode_resources_buf(LOJsonWriter_t* jw, const LOMSetOfResources_t* pSetResources) {
 	int ret, i;
 	const LiveObjectsD_Resource_t* rsc_ptr;
 
-	ret = LO_json_begin_section(buf_ptr, buf_len, "rsc");
+	ret = LO_json_begin_section(jw, "rsc");
 	if (ret) {
 		LOTRACE_ERR("failed (LO_json_begin)");
 		return NULL;
@@ -164,22 +554,22 @@ static const char* LO_msg_encode_resources_buf(char* buf_ptr, uint32_t buf_len,
 	for (i = 0; i < pSetResources->rsc_nb; i++) {
 		LOTRACE_DBG1("[%d] - rsc_name=%s version=%s", i, rsc_ptr->rsc_name, rsc_ptr->rsc_version_ptr);
 		if (ret == 0) {
-			ret = LO_json_add_section_start(rsc_ptr->rsc_name, buf_ptr, buf_len);
+			ret = LO_json_add_section_start(rsc_ptr->rsc_name, jw);
 		}
 		if (ret == 0) {
-			ret = LO_json_add_name_str("v", rsc_ptr->rsc_version_ptr, buf_ptr, buf_len);
+			ret = LO_json_add_name_str("v", rsc_ptr->rsc_version_ptr, jw);
 		}
 
 		// metadata section: empty
 		if (ret == 0) {
-			ret = LO_json_add_section_start("m", buf_ptr, buf_len);
+			ret = LO_json_add_section_start("m", jw);
 		}
 		if (ret == 0) {
-			ret = LO_json_add_section_end(buf_ptr, buf_len);
+			ret = LO_json_add_section_end(jw);
 		}
 
 		if (ret == 0) {
-			ret = LO_json_add_section_end(buf_ptr, buf_len);
+			ret = LO_json_add_section_end(jw);
 		}
 		if (ret) {
 			LOTRACE_ERR("failed (rsc[%d] - rsc_name=%s version=%s)", i, rsc_ptr->rsc_name,
@@ -188,24 +578,24 @@ static const char* LO_msg_encode_resources_buf(char* buf_ptr, uint32_t buf_len,
 		}
 		rsc_ptr++;
 	}
-	ret = LO_json_end_section(buf_ptr, buf_len);
+	ret = LO_json_end_section(jw);
 	if (ret) {
 		LOTRACE_ERR("failed (LO_json_end)");
 		return NULL;
 	}
-	return buf_ptr;
+	return jw->buf_ptr;
 }
 #endif
 
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_PARAMS
-const char* LO_msg_encode_params_all_buf(char* buf_ptr, uint32_t buf_len, const LOMArrayOfParams_t* params_array,
+const char* LO_msg_encode_params_all_buf(LOJsonWriter_t* jw, const LOMArrayOfParams_t* params_array,
 		int32_t cid) {
 	int ret, i;
 	const LiveObjectsD_Param_t* param_ptr;
 
-	ret = LO_json_begin_section(buf_ptr, buf_len, "cfg");
+	ret = LO_json_begin_section(jw, "cfg");
 	if (ret) {
 		LOTRACE_ERR("failed (LO_json_begin)");
 		return NULL;
@@ -214,7 +604,7 @@ const char* LO_msg_encode_params_all_buf(char* buf_ptr, uint32_t buf_len, const
 	for (i = 0; i < params_array->param_nb; i++) {
 		LOTRACE_DBG1("[%d] - data_type=%d=%s data_name=%s ...", i, param_ptr->parm_data.data_type,
 				LO_getDataTypeToStr(param_ptr->parm_data.data_type), param_ptr->parm_data.data_name);
-		ret = LO_json_add_param(&param_ptr->parm_data, buf_ptr, buf_len);
+		ret = LO_json_add_param(&param_ptr->parm_data, jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_add_param)");
 			return NULL;
@@ -224,40 +614,40 @@ const char* LO_msg_encode_params_all_buf(char* buf_ptr, uint32_t buf_len, const
 
 	if (cid) {
 		if (ret == 0) {
-			ret = LO_json_add_section_end(buf_ptr, buf_len);
+			ret = LO_json_add_section_end(jw);
 			if (ret) {
 				LOTRACE_ERR("failed (LO_json_end_section)");
 			}
 		}
 
 		if (ret == 0) {
-			ret = LO_json_add_name_int("cid", cid, buf_ptr, buf_len);
+			ret = LO_json_add_name_int("cid", cid, jw);
 			if (ret) {
 				LOTRACE_ERR("failed while adding cid=%"PRIi32", rc=%d", cid, ret);
 			}
 		}
 		if (ret == 0) {
-			ret = LO_json_end(buf_ptr, buf_len);
+			ret = LO_json_end(jw);
 			if (ret) {
 				LOTRACE_ERR("failed (LO_json_end)");
 			}
 		}
 	}
 	else {
-		ret = LO_json_end_section(buf_ptr, buf_len);
+		ret = LO_json_end_section(jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_end)");
 			return NULL;
 		}
 	}
-	return buf_ptr;
+	return jw->buf_ptr;
 }
 #endif /* LOC_FEATURE_LO_PARAMS */
 
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_COMMANDS
-static const char* LO_msg_encode_cmd_resp_buf(char* buf_ptr, uint32_t buf_len, int32_t cid,
+static const char* LO_msg_encode_cmd_resp_buf(LOJsonWriter_t* jw, int32_t cid,
 		const LiveObjectsD_Data_t* data_ptr, int data_nb) {
 	int ret;
 
@@ -266,7 +656,7 @@ static const char* LO_msg_encode_cmd_resp_buf(char* buf_ptr, uint32_t buf_len, i
 		return NULL;
 	}
 
-	ret = LO_json_begin_section(buf_ptr, buf_len, "res");
+	ret = LO_json_begin_section(jw, "res");
 	if (ret) {
 		LOTRACE_ERR("failed (LO_json_begin)");
 	}
@@ -277,7 +667,7 @@ static const char* LO_msg_encode_cmd_resp_buf(char* buf_ptr, uint32_t buf_len, i
 		for (i = 0; i < data_nb; i++) {
 			LOTRACE_DBG1("[%d] - data_type=%d=%s data_name=%s", i, p_data->data_type,
 					LO_getDataTypeToStr(p_data->data_type), p_data->data_name);
-			ret = LO_json_add_item(p_data, buf_ptr, buf_len);
+			ret = LO_json_add_item(p_data, jw);
 			if (ret) {
 				LOTRACE_ERR("failed (LO_json_add_item)");
 				break;
@@ -287,24 +677,24 @@ static const char* LO_msg_encode_cmd_resp_buf(char* buf_ptr, uint32_t buf_len, i
 	}
 
 	if (ret == 0) {
-		ret = LO_json_add_section_end(buf_ptr, buf_len);
+		ret = LO_json_add_section_end(jw);
 		if (ret)
 			LOTRACE_ERR("failed (LO_json_end_section)");
 	}
 
 	if (ret == 0) {
-		ret = LO_json_add_name_int("cid", cid, buf_ptr, buf_len);
+		ret = LO_json_add_name_int("cid", cid, jw);
 		if (ret)
 			LOTRACE_ERR("failed while adding cid=%"PRIi32", rc=%d", cid, ret);
 	}
 
 	if (ret == 0) {
-		ret = LO_json_end(buf_ptr, buf_len);
+		ret = LO_json_end(jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_end)");
 		}
 	}
-	return (ret == 0) ? buf_ptr : NULL;
+	return (ret == 0) ? jw->buf_ptr : NULL;
 }
 #endif /* LOC_FEATURE_LO_COMMANDS */
 
@@ -313,7 +703,12 @@ static const char* LO_msg_encode_cmd_resp_buf(char* buf_ptr, uint32_t buf_len, i
 /* --------------------------------------------------------------------------------- */
 /*  */
 
-static char _LO_msg_buf[LOM_JSON_BUF_SZ];
+#ifndef LO_THREAD_LOCAL
+#define LO_THREAD_LOCAL
+#endif
+
+/* Used by the LiveObjects Client thread, one buffer per thread when several instances are running */
+static LO_THREAD_LOCAL char _LO_msg_buf[LOM_JSON_BUF_SZ];
 
 /* --------------------------------------------------------------------------------- */
 /*  */
@@ -330,13 +725,15 @@ static const char* lib_rsc_res[] = {
 
 const char* LO_msg_encode_rsc_result(int32_t cid, LiveObjectsD_ResourceRespCode_t result) {
 	int ret;
+	LOJsonWriter_t jw;
 
 	if (cid == 0) {
 		LOTRACE_ERR("failed, invalid parameters cid=%"PRIu32, cid);
 		return NULL;
 	}
 
-	ret = LO_json_begin(_LO_msg_buf, LOM_JSON_BUF_SZ);
+	LO_json_init(&jw, _LO_msg_buf, LOM_JSON_BUF_SZ);
+	ret = LO_json_begin(&jw);
 	if (ret) {
 		LOTRACE_ERR("failed (LO_json_begin)");
 	}
@@ -347,8 +744,7 @@ const char* LO_msg_encode_rsc_result(int32_t cid, LiveObjectsD_ResourceRespCode_
 			res_idx = RSC_RSP_ERR_INTERNAL_ERROR;
 		LOTRACE_INF("cid=%"PRIi32", result=%d -> %d res=%s", cid, result, res_idx,
 				lib_rsc_res[res_idx]);
-		ret = LO_json_add_name_str("res", lib_rsc_res[res_idx], _LO_msg_buf,
-		LOM_JSON_BUF_SZ);
+		ret = LO_json_add_name_str("res", lib_rsc_res[res_idx], &jw);
 		if (ret) {
 			LOTRACE_ERR("failed while adding res=%d %d %s, rc=%d", result, res_idx,
 					lib_rsc_res[res_idx], ret);
@@ -356,19 +752,19 @@ const char* LO_msg_encode_rsc_result(int32_t cid, LiveObjectsD_ResourceRespCode_
 	}
 
 	if (ret == 0) {
-		ret = LO_json_add_name_int("cid", cid, _LO_msg_buf, LOM_JSON_BUF_SZ);
+		ret = LO_json_add_name_int("cid", cid, &jw);
 		if (ret) {
 			LOTRACE_ERR("failed while adding cid=%"PRIi32", rc=%d", cid, ret);
 		}
 	}
 
 	if (ret == 0) {
-		ret = LO_json_end(_LO_msg_buf, LOM_JSON_BUF_SZ);
+		ret = LO_json_end(&jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_end)");
 		}
 	}
-	return (ret == 0) ? _LO_msg_buf : NULL;
+	return (ret == 0) ? jw.buf_ptr : NULL;
 }
 #endif /* LOC_FEATURE_LO_RESOURCES */
 
@@ -377,6 +773,7 @@ const char* LO_msg_encode_rsc_result(int32_t cid, LiveObjectsD_ResourceRespCode_
 #if LOC_FEATURE_LO_PARAMS
 const char* LO_msg_encode_params_update(const LOMSetofUpdatedParams_t* pParamUpdateSet) {
 	int ret;
+	LOJsonWriter_t jw;
 
 	if (pParamUpdateSet == NULL) {
 		LOTRACE_ERR("failed, invalid parameters pParamUpdateSet=%p", pParamUpdateSet);
@@ -393,7 +790,8 @@ const char* LO_msg_encode_params_update(const LOMSetofUpdatedParams_t* pParamUpd
 		return NULL;
 	}
 
-	ret = LO_json_begin_section(_LO_msg_buf, LOM_JSON_BUF_SZ, "cfg");
+	LO_json_init(&jw, _LO_msg_buf, LOM_JSON_BUF_SZ);
+	ret = LO_json_begin_section(&jw, "cfg");
 	if (ret) {
 		LOTRACE_ERR("failed (LO_json_begin)");
 	}
@@ -410,7 +808,7 @@ const char* LO_msg_encode_params_update(const LOMSetofUpdatedParams_t* pParamUpd
 			}
 			LOTRACE_DBG1("[%d] - data_type=%d=%s data_name=%s ...", i, param_ptr->parm_data.data_type,
 					LO_getDataTypeToStr(param_ptr->parm_data.data_type), param_ptr->parm_data.data_name);
-			ret = LO_json_add_param(&param_ptr->parm_data, _LO_msg_buf, LOM_JSON_BUF_SZ);
+			ret = LO_json_add_param(&param_ptr->parm_data, &jw);
 			if (ret) {
 				LOTRACE_ERR("failed (LO_json_add_param)");
 				break;
@@ -418,27 +816,26 @@ const char* LO_msg_encode_params_update(const LOMSetofUpdatedParams_t* pParamUpd
 		}
 	}
 	if (ret == 0) {
-		ret = LO_json_add_section_end(_LO_msg_buf, LOM_JSON_BUF_SZ);
+		ret = LO_json_add_section_end(&jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_end_section)");
 		}
 	}
 
 	if (ret == 0) {
-		ret = LO_json_add_name_int("cid", pParamUpdateSet->cid, _LO_msg_buf,
-		LOM_JSON_BUF_SZ);
+		ret = LO_json_add_name_int("cid", pParamUpdateSet->cid, &jw);
 		if (ret) {
 			LOTRACE_ERR("failed while adding cid=%"PRIi32", rc=%d", pParamUpdateSet->cid, ret);
 		}
 	}
 
 	if (ret == 0) {
-		ret = LO_json_end(_LO_msg_buf, LOM_JSON_BUF_SZ);
+		ret = LO_json_end(&jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_end)");
 		}
 	}
-	return (ret == 0) ? _LO_msg_buf : NULL;
+	return (ret == 0) ? jw.buf_ptr : NULL;
 }
 #endif /* LOC_FEATURE_LO_PARAMS */
 
@@ -454,13 +851,15 @@ static const char* lib_res[] = {
 
 const char* LO_msg_encode_cmd_result(int32_t cid, int result) {
 	int ret;
+	LOJsonWriter_t jw;
 
 	if (cid == 0) {
 		LOTRACE_ERR("failed, invalid parameters cid=%"PRIu32, cid);
 		return NULL;
 	}
 
-	ret = LO_json_begin_section(_LO_msg_buf, LOM_JSON_BUF_SZ, "res");
+	LO_json_init(&jw, _LO_msg_buf, LOM_JSON_BUF_SZ);
+	ret = LO_json_begin_section(&jw, "res");
 	if (ret) {
 		LOTRACE_ERR("failed (LO_json_begin)");
 	}
@@ -469,46 +868,44 @@ const char* LO_msg_encode_cmd_result(int32_t cid, int result) {
 		if (result < 0) {
 			int err_idx = -result - 1;
 			LOTRACE_WARN("ERROR result=%d  err_idx=%d", result, err_idx);
-			ret = LO_json_add_name_int("lom_err_code", result, _LO_msg_buf,
-			LOM_JSON_BUF_SZ);
+			ret = LO_json_add_name_int("lom_err_code", result, &jw);
 			if (ret) {
 				LOTRACE_ERR("failed (LO_json_end_section)");
 			}
 
 			if ((ret == 0) && (err_idx >= 0) && (err_idx < 4)) {
-				ret = LO_json_add_name_str("lom_error", lib_res[err_idx], _LO_msg_buf,
-				LOM_JSON_BUF_SZ);
+				ret = LO_json_add_name_str("lom_error", lib_res[err_idx], &jw);
 			}
 		}
 		else if (result > 0) { // User code
-			ret = LO_json_add_name_int("result", result, _LO_msg_buf, LOM_JSON_BUF_SZ);
+			ret = LO_json_add_name_int("result", result, &jw);
 		}
 		else { /* result == 0,  Not called => pending request; Delayed response procssed by user. */
-			; /* ret = LO_json_add_name_str("status", "pending", _LO_msg_buf, LOM_JSON_BUF_SZ); */
+			; /* ret = LO_json_add_name_str("status", "pending", &jw); */
 		}
 	}
 
 	if (ret == 0) {
-		ret = LO_json_add_section_end(_LO_msg_buf, LOM_JSON_BUF_SZ);
+		ret = LO_json_add_section_end(&jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_end_section)");
 		}
 	}
 
 	if (ret == 0) {
-		ret = LO_json_add_name_int("cid", cid, _LO_msg_buf, LOM_JSON_BUF_SZ);
+		ret = LO_json_add_name_int("cid", cid, &jw);
 		if (ret) {
 			LOTRACE_ERR("failed while adding cid=%"PRIi32", rc=%d", cid, ret);
 		}
 	}
 
 	if (ret == 0) {
-		ret = LO_json_end(_LO_msg_buf, LOM_JSON_BUF_SZ);
+		ret = LO_json_end(&jw);
 		if (ret) {
 			LOTRACE_ERR("failed (LO_json_end)");
 		}
 	}
-	return (ret == 0) ? _LO_msg_buf : NULL;
+	return (ret == 0) ? jw.buf_ptr : NULL;
 }
 #endif /* LOC_FEATURE_LO_COMMANDS */
 
@@ -518,29 +915,37 @@ const char* LO_msg_encode_cmd_result(int32_t cid, int result) {
 /*  */
 #if LOM_MQUEUE && (LOM_JSON_BUF_USER_SZ > 0) && (LOC_FEATURE_LO_STATUS || LOC_FEATURE_LO_PARAMS || LOC_FEATURE_LO_DATA || LOC_FEATURE_LO_COMMANDS || LOC_FEATURE_LO_RESOURCES)
 #define LOM_ENCODE_MQUEUE 1
-static char _LO_msg_buf_user[LOM_JSON_BUF_USER_SZ];
 #else
 #define LOM_ENCODE_MQUEUE 0
 #endif
 
 /* --------------------------------------------------------------------------------- */
-/*  */
+/* Allocate a message in the pool, and set the JSON writer on its payload area.
+ * The JSON message is directly encoded in this buffer (no intermediate copy).
+ */
 #if LOM_ENCODE_MQUEUE
-static const char* LO_msg_alloc(uint8_t from, const char* p_msg) {
-	char* p = NULL;
-	int len = strlen(p_msg);
-	if (len > 0) {
-		len += 3;
-		p = (char*) MEM_ALLOC(len);
-		if (p) {
-			LOTRACE_DBG1("LO_msg_alloc(from %x) - MEM_ALLOC %p len=%d", from, p, len);
-			*p = from;            /* First byte is used to indicate the type of message */
-			strcpy(p + 1, p_msg); /* And copy JSON msg in this allocated buffer */
-		}
-		else {
-			LOTRACE_ERR("LO_msg_alloc(from %x): ERROR MEM_ALLOC(len=%d)", from, len);
-		}
+static char* LO_msg_alloc(uint8_t from, LOJsonWriter_t* jw) {
+	char* p = LO_mpool_alloc(LOM_MSG_PAYLOAD_OFFSET + LOM_JSON_BUF_USER_SZ);
+	if (p == NULL) {
+		LOTRACE_ERR("LO_msg_alloc(from %x): ERROR alloc", from);
+		return NULL;
+	}
+	memset(p, 0, sizeof(LOMsgHeader_t));
+	LOM_MSG_HDR(p)->msg_type = from;     /* First byte is used to indicate the type of message */
+	LOM_MSG_HDR(p)->payload_offset = LOM_MSG_PAYLOAD_OFFSET;
+	LO_json_init(jw, p + LOM_MSG_PAYLOAD_OFFSET, LOM_JSON_BUF_USER_SZ);
+	LOTRACE_DBG1("LO_msg_alloc(from %x) - %p", from, p);
+	return p;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Complete the message header when the JSON encoding is successful, otherwise release the message. */
+static const char* LO_msg_done(char* p, const char* p_json, const LOJsonWriter_t* jw) {
+	if (p_json == NULL) {
+		LO_mpool_free(p);
+		return NULL;
 	}
+	LOM_MSG_HDR(p)->payload_len = jw->buf_len;
 	return p;
 }
 #endif /* LOM_MQUEUE */
@@ -551,21 +956,18 @@ static const char* LO_msg_alloc(uint8_t from, const char* p_msg) {
 const char* LO_msg_encode_cmd_resp(uint8_t from, int32_t cid, const LiveObjectsD_Data_t* data_ptr, int data_nb) {
 
 	const char *p_msg;
+	LOJsonWriter_t jw;
 	if (from == 0) { /* Called by the LOM Client Thread. */
-		p_msg = LO_msg_encode_cmd_resp_buf(_LO_msg_buf, LOM_JSON_BUF_SZ, cid, data_ptr, data_nb);
+		LO_json_init(&jw, _LO_msg_buf, LOM_JSON_BUF_SZ);
+		p_msg = LO_msg_encode_cmd_resp_buf(&jw, cid, data_ptr, data_nb);
 	}
 	else {
 #if LOM_ENCODE_MQUEUE
-		/* Use a local buffer to build JSON message */
-		if (MSG_MUTEX_LOCK()) {
-			LOTRACE_ERR("Error to lock mutex");
+		char* p = LO_msg_alloc(from, &jw);
+		if (p == NULL) {
 			return NULL;
 		}
-		p_msg = LO_msg_encode_cmd_resp_buf(_LO_msg_buf_user, LOM_JSON_BUF_USER_SZ, cid, data_ptr, data_nb);
-		if (p_msg) {
-			p_msg = LO_msg_alloc(from, p_msg);
-		}
-		MSG_MUTEX_UNLOCK();
+		p_msg = LO_msg_done(p, LO_msg_encode_cmd_resp_buf(&jw, cid, data_ptr, data_nb), &jw);
 #else
 		LOTRACE_ERR("ERROR - Not supported");
 		p_msg = NULL;
@@ -578,8 +980,10 @@ const char* LO_msg_encode_cmd_resp(uint8_t from, int32_t cid, const LiveObjectsD
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_STATUS
-const char* LO_msg_encode_status(uint8_t from, const LOMArrayOfData_t* pObjSet) {
+const char* LO_msg_encode_status(uint8_t from, const LOMArrayOfData_t* pObjSet, const uint8_t* mask,
+		uint32_t* p_len) {
 	const char *p_msg;
+	LOJsonWriter_t jw;
 
 	if (pObjSet == NULL) {
 		LOTRACE_ERR("failed, invalid parameters pObjSet=%p", pObjSet);
@@ -591,20 +995,22 @@ const char* LO_msg_encode_status(uint8_t from, const LOMArrayOfData_t* pObjSet)
 	}
 
 	if (from == 0) { /* Called by the LiveObjects Client Thread. */
-		p_msg = LO_msg_encode_status_buf(_LO_msg_buf, LOM_JSON_BUF_SZ, pObjSet);
+		LO_json_init(&jw, _LO_msg_buf, LOM_JSON_BUF_SZ);
+		p_msg = LO_msg_encode_status_buf(&jw, pObjSet, mask);
+		if ((p_msg) && (p_len)) {
+			*p_len = jw.buf_len;
+		}
 	}
 	else {
 #if LOM_ENCODE_MQUEUE
-		/* Use a local buffer to build JSON message */
-		if (MSG_MUTEX_LOCK()) {
-			LOTRACE_ERR("Error to lock mutex");
+		char* p = LO_msg_alloc(from, &jw);
+		if (p == NULL) {
 			return NULL;
 		}
-		p_msg = LO_msg_encode_status_buf(_LO_msg_buf_user, LOM_JSON_BUF_USER_SZ, pObjSet);
-		if (p_msg) {
-			p_msg = LO_msg_alloc(from, p_msg);
+		p_msg = LO_msg_done(p, LO_msg_encode_status_buf(&jw, pObjSet, mask), &jw);
+		if ((p_msg) && (p_len)) {
+			*p_len = jw.buf_len;
 		}
-		MSG_MUTEX_UNLOCK();
 #else
 		LOTRACE_ERR("ERROR - Not supported");
 		p_msg = NULL;
@@ -617,8 +1023,9 @@ const char* LO_msg_encode_status(uint8_t from, const LOMArrayOfData_t* pObjSet)
 /* --------------------------------------------------------------------------------- */
 /*  */
 #if LOC_FEATURE_LO_DATA
-const char* LO_msg_encode_data(uint8_t from, const LOMSetOfData_t* pSetData) {
+const char* LO_msg_encode_data(uint8_t from, const LOMSetOfData_t* pSetData, uint32_t* p_len) {
 	const char *p_msg;
+	LOJsonWriter_t jw;
 
 	if ((pSetData == NULL) || (pSetData->stream_id[0] == 0)) {
 		LOTRACE_ERR("failed, invalid parameters pDataSet=%p", pSetData);
@@ -630,20 +1037,22 @@ const char* LO_msg_encode_data(uint8_t from, const LOMSetOfData_t* pSetData) {
 		return NULL;
 	}
 	if (from == 0) { // Called by the LiveObjects Client Thread.
-		p_msg = LO_msg_encode_data_buf(_LO_msg_buf, LOM_JSON_BUF_SZ, pSetData);
+		LO_json_init(&jw, _LO_msg_buf, LOM_JSON_BUF_SZ);
+		p_msg = LO_msg_encode_data_buf(&jw, pSetData);
+		if ((p_msg) && (p_len)) {
+			*p_len = jw.buf_len;
+		}
 	}
 	else {
 #if LOM_ENCODE_MQUEUE
-		// Use a local buffer to build JSON message
-		if (MSG_MUTEX_LOCK()) {
-			LOTRACE_ERR("Error to lock mutex");
+		char* p = LO_msg_alloc(from, &jw);
+		if (p == NULL) {
 			return NULL;
 		}
-		p_msg = LO_msg_encode_data_buf(_LO_msg_buf_user, LOM_JSON_BUF_USER_SZ, pSetData);
-		if (p_msg) {
-			p_msg = LO_msg_alloc(from, p_msg);
+		p_msg = LO_msg_done(p, LO_msg_encode_data_buf(&jw, pSetData), &jw);
+		if ((p_msg) && (p_len)) {
+			*p_len = jw.buf_len;
 		}
-		MSG_MUTEX_UNLOCK();
 #else
 		LOTRACE_ERR("ERROR - Not supported");
 		p_msg = NULL;
@@ -651,6 +1060,100 @@ const char* LO_msg_encode_data(uint8_t from, const LOMSetOfData_t* pSetData) {
 	}
 	return p_msg;
 }
+
+#if LOM_ENCODE_MQUEUE
+/* --------------------------------------------------------------------------------- */
+/* Batch of samples of a data set: stream id, model and tags are encoded once, followed by
+ * the array of samples, each one with its timestamp, location and values:
+ *   {"s":"..","m":"..","t":[..],"samples":[{"ts":"..","loc":[..],"v":{..}},..]}
+ */
+char* LO_msg_batch_begin(uint8_t from, const LOMSetOfData_t* pSetData, LOJsonWriter_t* jw) {
+	int ret;
+	char* p = LO_msg_alloc(from, jw);
+	if (p == NULL) {
+		return NULL;
+	}
+
+	ret = LO_json_begin(jw);
+	if ((ret == 0) && (pSetData->plan_s_len)) {
+		/* Encode plan: stream id, model and tags rendered in advance */
+		ret = LO_json_add_fragment(pSetData->plan_env,
+				(uint32_t) pSetData->plan_s_len + pSetData->plan_m_len + pSetData->plan_t_len, jw);
+	}
+	else if (ret == 0) {
+		ret = LO_json_add_name_str("s", pSetData->stream_id, jw);
+#if (LOM_SETOFDATA_MODEL_SZ > 0)
+		if (ret == 0) {
+			ret = LO_json_add_name_str("m", pSetData->model, jw);
+		}
+#endif
+#if (LOM_SETOFDATA_TAGS_SZ > 0)
+		if ((ret == 0) && (pSetData->tags[0])) {
+			ret = LO_json_add_name_array("t", pSetData->tags, jw);
+		}
+#endif
+	}
+	if (ret == 0) {
+		ret = LO_json_add_array_start("samples", jw);
+	}
+	if (ret) {
+		LOTRACE_ERR("failed");
+		LO_mpool_free(p);
+		return NULL;
+	}
+	return p;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Add a sample: current values of the data set, timestamped now.
+ * Return its length, or -1 if it does not fit in the message (left unchanged) */
+int LO_msg_batch_add(LOJsonWriter_t* jw, const LOMSetOfData_t* pSetData) {
+	uint32_t start = jw->buf_len;
+	char ts[32];
+	int ret;
+
+	ret = LO_json_add_object_start(jw);
+	if ((ret == 0) && (LO_sys_dateStr(ts, sizeof(ts)))) {
+		ret = LO_json_add_name_str("ts", ts, jw);
+	}
+	if ((ret == 0) && (pSetData->gps_ptr) && (pSetData->gps_ptr->gps_valid)) {
+		char msg[2 * LO_FMT_NUM_SZ];
+		int len = LO_fmt_float(msg, pSetData->gps_ptr->gps_lat, 6);
+		msg[len++] = ',';
+		len += LO_fmt_float(msg + len, pSetData->gps_ptr->gps_long, 6);
+		msg[len] = 0;
+		ret = LO_json_add_name_array("loc", msg, jw);
+	}
+	if (ret == 0) {
+		ret = LO_msg_encode_values(pSetData, jw);
+	}
+	if (ret == 0) {
+		ret = LO_json_add_object_end(jw);
+	}
+	/* Room for the end of the message: "]}" instead of the last comma */
+	if ((ret) || (jw->buf_len + 1 >= jw->buf_sz)) {
+		LO_json_rewind(jw, start);
+		return -1;
+	}
+	return (int) (jw->buf_len - start);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Size available for the next sample */
+uint32_t LO_msg_batch_room(const LOJsonWriter_t* jw) {
+	return (jw->buf_len + 2 < jw->buf_sz) ? jw->buf_sz - jw->buf_len - 2 : 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Complete the message (at least one sample), or release it */
+const char* LO_msg_batch_end(char* p_msg, LOJsonWriter_t* jw) {
+	int ret = LO_json_add_array_end(jw);
+	if (ret == 0) {
+		ret = LO_json_end(jw);
+	}
+	return LO_msg_done(p_msg, (ret == 0) ? jw->buf_ptr : NULL, jw);
+}
+#endif /* LOM_ENCODE_MQUEUE */
 #endif /* LOC_FEATURE_LO_DATA */
 
 /* --------------------------------------------------------------------------------- */
@@ -658,6 +1161,7 @@ const char* LO_msg_encode_data(uint8_t from, const LOMSetOfData_t* pSetData) {
 #if LOC_FEATURE_LO_RESOURCES
 const char* LO_msg_encode_resources(uint8_t from, const LOMSetOfResources_t* pSetResources) {
 	const char *p_msg;
+	LOJsonWriter_t jw;
 
 	if (pSetResources == NULL) {
 		LOTRACE_ERR("failed, invalid parameters pSetResources=%p", pSetResources);
@@ -669,20 +1173,16 @@ const char* LO_msg_encode_resources(uint8_t from, const LOMSetOfResources_t* pSe
 	}
 
 	if (from == 0) { // Called by the LiveObjects Client Thread.
-		p_msg = LO_msg_encode_resources_buf(_LO_msg_buf, LOM_JSON_BUF_SZ, pSetResources);
+		LO_json_init(&jw, _LO_msg_buf, LOM_JSON_BUF_SZ);
+		p_msg = LO_msg_encode_resources_buf(&jw, pSetResources);
 	}
 	else {
 #if LOM_ENCODE_MQUEUE
-		// Use a local buffer to build JSON message
-		if (MSG_MUTEX_LOCK()) {
-			LOTRACE_ERR("Error to lock mutex");
+		char* p = LO_msg_alloc(from, &jw);
+		if (p == NULL) {
 			return NULL;
 		}
-		p_msg = LO_msg_encode_resources_buf(_LO_msg_buf_user, LOM_JSON_BUF_USER_SZ, pSetResources);
-		if (p_msg) {
-			p_msg = LO_msg_alloc(from, p_msg);
-		}
-		MSG_MUTEX_UNLOCK();
+		p_msg = LO_msg_done(p, LO_msg_encode_resources_buf(&jw, pSetResources), &jw);
 #else
 		LOTRACE_ERR("ERROR - Not supported");
 		p_msg = NULL;
@@ -697,6 +1197,7 @@ const char* LO_msg_encode_resources(uint8_t from, const LOMSetOfResources_t* pSe
 #if LOC_FEATURE_LO_PARAMS
 const char* LO_msg_encode_params_all(uint8_t from, const LOMArrayOfParams_t* params_array, int32_t cid) {
 	const char *p_msg;
+	LOJsonWriter_t jw;
 	if (params_array == NULL) {
 		LOTRACE_ERR("encode_params_all: failed, invalid parameters params_array=%p", params_array);
 		return NULL;
@@ -706,20 +1207,16 @@ const char* LO_msg_encode_params_all(uint8_t from, const LOMArrayOfParams_t* par
 		return NULL;
 	}
 	if (from == 0) { // Called by the LiveObjects Client Thread.
-		p_msg = LO_msg_encode_params_all_buf(_LO_msg_buf, LOM_JSON_BUF_SZ, params_array, cid);
+		LO_json_init(&jw, _LO_msg_buf, LOM_JSON_BUF_SZ);
+		p_msg = LO_msg_encode_params_all_buf(&jw, params_array, cid);
 	}
 	else {
 #if LOM_ENCODE_MQUEUE
-		// Use a local buffer to build JSON message
-		if (MSG_MUTEX_LOCK()) {
-			LOTRACE_ERR("Error to lock mutex");
+		char* p = LO_msg_alloc(from, &jw);
+		if (p == NULL) {
 			return NULL;
 		}
-		p_msg = LO_msg_encode_params_all_buf(_LO_msg_buf_user, LOM_JSON_BUF_USER_SZ, params_array, cid);
-		if (p_msg) {
-			p_msg = LO_msg_alloc(from, p_msg);
-		}
-		MSG_MUTEX_UNLOCK();
+		p_msg = LO_msg_done(p, LO_msg_encode_params_all_buf(&jw, params_array, cid), &jw);
 #else
 		LOTRACE_ERR("ERROR - Not supported");
 		p_msg = NULL;
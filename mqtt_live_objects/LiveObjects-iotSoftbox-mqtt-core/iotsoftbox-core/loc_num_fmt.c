@@ -0,0 +1,486 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file  loc_num_fmt.c
+ * @brief Numeric formatting functions (see LiveObjectsClient_Toolbox.h)
+ *
+ * Integers are formatted two digits at a time using a lookup table.
+ * Floating-point values are formatted with the Grisu2 algorithm (Florian Loitsch,
+ * "Printing Floating-Point Numbers Quickly and Accurately with Integers", 2010):
+ * the produced digits always read back to the same value, and are the shortest
+ * ones in almost all cases. Only integer arithmetic is used.
+ */
+
+#include "liveobjects-client/LiveObjectsClient_Toolbox.h"
+
+#include <string.h>
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static const char _LO_fmt_digits2[200] = {
+	'0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+	'1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+	'2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+	'3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+	'4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+	'5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+	'6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+	'7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+	'8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+	'9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+static const uint64_t _LO_fmt_pow10[20] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+	1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL,
+	1000000000000000000ULL, 10000000000000000000ULL
+};
+
+/* Highest number of decimal places with the fixed precision format */
+#define LO_FMT_PREC_MAX     15
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_fmt_u32(char* p, uint32_t value) {
+	char tmp[10];
+	char* pt = tmp + sizeof(tmp);
+	int len;
+	while (value >= 100) {
+		uint32_t q = value / 100;
+		pt -= 2;
+		memcpy(pt, &_LO_fmt_digits2[(value - q * 100) * 2], 2);
+		value = q;
+	}
+	if (value >= 10) {
+		pt -= 2;
+		memcpy(pt, &_LO_fmt_digits2[value * 2], 2);
+	}
+	else {
+		*--pt = (char) ('0' + value);
+	}
+	len = (int) (tmp + sizeof(tmp) - pt);
+	memcpy(p, pt, len);
+	return len;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_fmt_i32(char* p, int32_t value) {
+	if (value < 0) {
+		*p = '-';
+		return 1 + LO_fmt_u32(p + 1, (uint32_t) 0 - (uint32_t) value);
+	}
+	return LO_fmt_u32(p, (uint32_t) value);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_fmt_u64(char* p, uint64_t value) {
+	char tmp[20];
+	char* pt = tmp + sizeof(tmp);
+	int len;
+	if (value <= 0xFFFFFFFFULL) {
+		return LO_fmt_u32(p, (uint32_t) value);
+	}
+	while (value >= 100) {
+		uint64_t q = value / 100;
+		pt -= 2;
+		memcpy(pt, &_LO_fmt_digits2[(value - q * 100) * 2], 2);
+		value = q;
+	}
+	if (value >= 10) {
+		pt -= 2;
+		memcpy(pt, &_LO_fmt_digits2[value * 2], 2);
+	}
+	else {
+		*--pt = (char) ('0' + value);
+	}
+	len = (int) (tmp + sizeof(tmp) - pt);
+	memcpy(p, pt, len);
+	return len;
+}
+
+/* ================================================================================= */
+/* Grisu2                                                                            */
+/* ================================================================================= */
+
+/* Floating-point value f * 2^e, with a 64-bit significand */
+typedef struct {
+	uint64_t f;
+	int      e;
+} LO_fmt_fp_t;
+
+/* Normalized significands (bit 63 set) and binary exponents of 10^k, k = -348, -340, ..., 340 */
+static const uint64_t _LO_fmt_cached_f[87] = {
+	0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+	0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+	0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+	0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+	0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+	0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+	0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+	0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+	0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+	0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+	0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+	0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+	0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+	0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+	0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+	0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+	0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+	0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+	0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+	0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+	0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+	0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+	0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+	0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+	0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+	0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+	0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+	0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+	0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+static const int16_t _LO_fmt_cached_e[87] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+	-954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+	-688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+	-422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+	-157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+	109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+	641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+	907, 933, 960, 986, 1013, 1039, 1066
+};
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static LO_fmt_fp_t LO_fmt_fp_normalize(uint64_t f, int e) {
+	LO_fmt_fp_t r;
+	if (!(f >> 32)) { f <<= 32; e -= 32; }
+	if (!(f >> 48)) { f <<= 16; e -= 16; }
+	if (!(f >> 56)) { f <<= 8; e -= 8; }
+	if (!(f >> 60)) { f <<= 4; e -= 4; }
+	if (!(f >> 62)) { f <<= 2; e -= 2; }
+	if (!(f >> 63)) { f <<= 1; e -= 1; }
+	r.f = f;
+	r.e = e;
+	return r;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Multiply two values, the result is rounded to 64 bits */
+static LO_fmt_fp_t LO_fmt_fp_mul(LO_fmt_fp_t x, LO_fmt_fp_t y) {
+	const uint64_t M32 = 0xFFFFFFFFULL;
+	LO_fmt_fp_t r;
+	uint64_t a = x.f >> 32;
+	uint64_t b = x.f & M32;
+	uint64_t c = y.f >> 32;
+	uint64_t d = y.f & M32;
+	uint64_t ac = a * c;
+	uint64_t bc = b * c;
+	uint64_t ad = a * d;
+	uint64_t bd = b * d;
+	uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+	tmp += 1ULL << 31;
+	r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+	r.e = x.e + y.e + 64;
+	return r;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Get the cached power of ten c = 10^-K such that the binary exponent of c * 2^e is in [-60, -32] */
+static LO_fmt_fp_t LO_fmt_cached_power(int e, int* K) {
+	LO_fmt_fp_t r;
+	double dk = (-61 - e) * 0.30102999566398114 + 347; /* always positive */
+	int k = (int) dk;
+	unsigned int idx;
+	if (k != dk) {
+		k++;
+	}
+	idx = (unsigned int) ((k >> 3) + 1);
+	*K = -(-348 + (int) (idx << 3));
+	r.f = _LO_fmt_cached_f[idx];
+	r.e = _LO_fmt_cached_e[idx];
+	return r;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Move the last digit closer to the exact value, while staying in the safe interval */
+static void LO_fmt_grisu_round(char* buf, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+	while ((rest < wp_w) && (delta - rest >= ten_kappa)
+			&& ((rest + ten_kappa < wp_w) || (wp_w - rest > rest + ten_kappa - wp_w))) {
+		buf[len - 1]--;
+		rest += ten_kappa;
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static int LO_fmt_count_digits32(uint32_t n) {
+	int cnt = 1;
+	while ((cnt < 10) && (n >= (uint32_t) _LO_fmt_pow10[cnt])) {
+		cnt++;
+	}
+	return cnt;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Generate the shortest digits of a value in the interval [Mp - delta, Mp] */
+static int LO_fmt_digit_gen(LO_fmt_fp_t W, LO_fmt_fp_t Mp, uint64_t delta, char* buf, int* K) {
+	const int one_e = -Mp.e;
+	const uint64_t one_f = 1ULL << one_e;
+	const uint64_t wp_w = Mp.f - W.f;
+	uint32_t p1 = (uint32_t) (Mp.f >> one_e);
+	uint64_t p2 = Mp.f & (one_f - 1);
+	int kappa = LO_fmt_count_digits32(p1);
+	int len = 0;
+
+	while (kappa > 0) {
+		uint32_t d = p1 / (uint32_t) _LO_fmt_pow10[kappa - 1];
+		p1 %= (uint32_t) _LO_fmt_pow10[kappa - 1];
+		if (d || len) {
+			buf[len++] = (char) ('0' + d);
+		}
+		kappa--;
+		if ((((uint64_t) p1) << one_e) + p2 <= delta) {
+			*K += kappa;
+			LO_fmt_grisu_round(buf, len, delta, (((uint64_t) p1) << one_e) + p2, _LO_fmt_pow10[kappa] << one_e, wp_w);
+			return len;
+		}
+	}
+
+	for (;;) {
+		uint32_t d;
+		p2 *= 10;
+		delta *= 10;
+		d = (uint32_t) (p2 >> one_e);
+		if (d || len) {
+			buf[len++] = (char) ('0' + d);
+		}
+		p2 &= one_f - 1;
+		kappa--;
+		if (p2 < delta) {
+			*K += kappa;
+			LO_fmt_grisu_round(buf, len, delta, p2, one_f, (-kappa < 20) ? wp_w * _LO_fmt_pow10[-kappa] : 0);
+			return len;
+		}
+	}
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Digits of the value f * 2^e: the value is buf[0..len[ * 10^K
+ * The rounding interval is the one of the source floating-point type:
+ * half an ulp on each side, the lower side is halved when the significand is a power of two. */
+static int LO_fmt_grisu2(uint64_t f, int e, int lower_closer, char* buf, int* K) {
+	LO_fmt_fp_t w = LO_fmt_fp_normalize(f, e);
+	LO_fmt_fp_t w_p = LO_fmt_fp_normalize((f << 1) + 1, e - 1);
+	LO_fmt_fp_t w_m;
+	LO_fmt_fp_t c_mk;
+
+	if (lower_closer) {
+		w_m.f = (f << 2) - 1;
+		w_m.e = e - 2;
+	}
+	else {
+		w_m.f = (f << 1) - 1;
+		w_m.e = e - 1;
+	}
+	w_m.f <<= w_m.e - w_p.e;
+	w_m.e = w_p.e;
+
+	c_mk = LO_fmt_cached_power(w_p.e, K);
+	w = LO_fmt_fp_mul(w, c_mk);
+	w_p = LO_fmt_fp_mul(w_p, c_mk);
+	w_m = LO_fmt_fp_mul(w_m, c_mk);
+	w_m.f++;
+	w_p.f--;
+	return LO_fmt_digit_gen(w, w_p, w_p.f - w_m.f, buf, K);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Write the digits buf[0..len[ * 10^K as a JSON number */
+static int LO_fmt_prettify(char* p, const char* buf, int len, int K) {
+	char* q = p;
+	int kk = len + K; /* 10^(kk-1) <= v < 10^kk */
+
+	if ((K >= 0) && (kk <= 21)) {
+		/* 1234e7 -> 12340000000.0 */
+		memcpy(q, buf, len);
+		q += len;
+		memset(q, '0', K);
+		q += K;
+		*q++ = '.';
+		*q++ = '0';
+	}
+	else if ((kk > 0) && (kk <= 21)) {
+		/* 1234e-2 -> 12.34 */
+		memcpy(q, buf, kk);
+		q += kk;
+		*q++ = '.';
+		memcpy(q, buf + kk, len - kk);
+		q += len - kk;
+	}
+	else if ((kk > -6) && (kk <= 0)) {
+		/* 1234e-6 -> 0.001234 */
+		*q++ = '0';
+		*q++ = '.';
+		memset(q, '0', -kk);
+		q += -kk;
+		memcpy(q, buf, len);
+		q += len;
+	}
+	else {
+		/* 1234e30 -> 1.234e33 */
+		int exp10 = kk - 1;
+		*q++ = buf[0];
+		if (len > 1) {
+			*q++ = '.';
+			memcpy(q, buf + 1, len - 1);
+			q += len - 1;
+		}
+		*q++ = 'e';
+		if (exp10 < 0) {
+			*q++ = '-';
+			exp10 = -exp10;
+		}
+		q += LO_fmt_u32(q, (uint32_t) exp10);
+	}
+	return (int) (q - p);
+}
+
+/* ================================================================================= */
+
+/* --------------------------------------------------------------------------------- */
+/* Positive value rounded to 'prec' decimal places. Returns -1 if the value is too large. */
+static int LO_fmt_fixed(char* p, double value, int prec) {
+	char* q = p;
+	uint64_t scale;
+	uint64_t n;
+	uint64_t fpart;
+	double x;
+
+	if (prec > LO_FMT_PREC_MAX) {
+		prec = LO_FMT_PREC_MAX;
+	}
+	scale = _LO_fmt_pow10[prec];
+	x = value * (double) scale + 0.5;
+	if (x >= 9007199254740992.0) { /* 2^53: the scaled value is no longer an exact integer */
+		return -1;
+	}
+	n = (uint64_t) x;
+	fpart = n % scale;
+	q += LO_fmt_u64(q, n / scale);
+	*q++ = '.';
+	if (fpart == 0) {
+		*q++ = '0';
+	}
+	else {
+		int i;
+		for (i = prec; i > 0; i--) {
+			q[i - 1] = (char) ('0' + fpart % 10);
+			fpart /= 10;
+		}
+		q += prec;
+		while (q[-1] == '0') {
+			q--;
+		}
+	}
+	return (int) (q - p);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_fmt_double(char* p, double value, int8_t prec) {
+	union {
+		double   d;
+		uint64_t u;
+	} v;
+	char buf[20];
+	int biased_e;
+	uint64_t sig;
+	int len, K;
+	int sign_len = 0;
+
+	v.d = value;
+	biased_e = (int) ((v.u >> 52) & 0x7FF);
+	sig = v.u & 0x000FFFFFFFFFFFFFULL;
+
+	if (biased_e == 0x7FF) {
+		memcpy(p, "null", 4);
+		return 4;
+	}
+	if ((biased_e == 0) && (sig == 0)) {
+		memcpy(p, "0.0", 3);
+		return 3;
+	}
+	if (v.u >> 63) {
+		*p++ = '-';
+		value = -value;
+		sign_len = 1;
+	}
+	if (prec > 0) {
+		len = LO_fmt_fixed(p, value, prec);
+		if (len > 0) {
+			return sign_len + len;
+		}
+	}
+	if (biased_e) {
+		len = LO_fmt_grisu2(sig | 0x0010000000000000ULL, biased_e - 1075, (sig == 0) && (biased_e > 1), buf, &K);
+	}
+	else {
+		len = LO_fmt_grisu2(sig, -1074, 0, buf, &K);
+	}
+	return sign_len + LO_fmt_prettify(p, buf, len, K);
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int LO_fmt_float(char* p, float value, int8_t prec) {
+	union {
+		float    f;
+		uint32_t u;
+	} v;
+	char buf[20];
+	int biased_e;
+	uint32_t sig;
+	int len, K;
+	int sign_len = 0;
+
+	if (prec > 0) {
+		return LO_fmt_double(p, (double) value, prec);
+	}
+
+	v.f = value;
+	biased_e = (int) ((v.u >> 23) & 0xFF);
+	sig = v.u & 0x007FFFFF;
+
+	if (biased_e == 0xFF) {
+		memcpy(p, "null", 4);
+		return 4;
+	}
+	if ((biased_e == 0) && (sig == 0)) {
+		memcpy(p, "0.0", 3);
+		return 3;
+	}
+	if (v.u >> 31) {
+		*p++ = '-';
+		sign_len = 1;
+	}
+	if (biased_e) {
+		len = LO_fmt_grisu2(sig | 0x00800000, biased_e - 150, (sig == 0) && (biased_e > 1), buf, &K);
+	}
+	else {
+		len = LO_fmt_grisu2(sig, -149, 0, buf, &K);
+	}
+	return sign_len + LO_fmt_prettify(p, buf, len, K);
+}
@@ -30,6 +30,11 @@ int LO_sock_dnsSetFQDN(const char* fqdn, const char* ip_address);
 
 int LO_sock_connect(short retry, const char* remoteHostAddress, uint16_t remoteHostPort, socketHandle_t *pHdl);
 
+/* Connect to the first reachable address of the host (IPv6 and IPv4 attempts raced, RFC 8305), within tmo_ms
+ * milliseconds (0: no limit). If p_dns_ms is not NULL, it is set to the duration of the DNS resolution. */
+int LO_sock_connectTmo(const char* remoteHostAddress, uint16_t remoteHostPort, uint32_t tmo_ms, socketHandle_t *pHdl,
+		uint32_t* p_dns_ms);
+
 void LO_sock_disconnect(socketHandle_t *pHdl);
 
 int LO_sock_send(socketHandle_t hdl, const char* buf_ptr);
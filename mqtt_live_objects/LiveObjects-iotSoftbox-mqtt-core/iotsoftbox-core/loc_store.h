@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file   loc_store.h
+ * @brief  Store and forward: append-only log of the messages to be published later
+ *
+ * The log is a set of fixed size segment files in one directory, memory-mapped.
+ * Records are appended to the last segment, and read (then consumed) from the
+ * first one. The read position is kept in the first segment, so that the records
+ * not yet consumed are found again after a restart of the process.
+ * When the max disk usage is reached, the oldest segment is released.
+ */
+
+#ifndef __loc_store_H_
+#define __loc_store_H_
+
+#include <stdint.h>
+
+#include "liveobjects-client/LiveObjectsClient_Defs.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/** Opaque handle of a store */
+typedef struct LOStore_s LOStore_t;
+
+/* Open (or create) the store in the directory dir, using at most max_bytes on disk */
+LOStore_t*  LO_store_open(const char* dir, uint32_t max_bytes);
+
+void        LO_store_close(LOStore_t* st);
+
+/* Append a record (thread safe). Return 0 if successful */
+int         LO_store_append(LOStore_t* st, uint8_t type, const char* data, uint32_t len);
+
+/* Copy the oldest record (and a NUL character) in buf, without consuming it.
+ * Return its length, 0 if the store is empty, or -1 if buf is too small */
+int         LO_store_read(LOStore_t* st, uint8_t* type, char* buf, uint32_t buf_sz);
+
+/* Consume the oldest record (the one returned by LO_store_read) */
+void        LO_store_consume(LOStore_t* st);
+
+/* Number of records not yet consumed */
+uint32_t    LO_store_backlog(LOStore_t* st);
+
+void        LO_store_getStats(LOStore_t* st, LiveObjectsD_StoreStats_t* stats);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __loc_store_H_ */
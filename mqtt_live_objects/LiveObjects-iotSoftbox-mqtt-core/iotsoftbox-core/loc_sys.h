@@ -23,26 +23,97 @@ extern "C" {
 
 #define LO_SYS_MUTEX_NB    2
 
-#define MQ_MUTEX_LOCK()     LO_sys_mutex_lock(0)
-#define MQ_MUTEX_UNLOCK()   LO_sys_mutex_unlock(0)
+#define TLS_MUTEX_LOCK()    LO_sys_mutex_lock(0)
+#define TLS_MUTEX_UNLOCK()  LO_sys_mutex_unlock(0)
 
-#define MSG_MUTEX_LOCK()    LO_sys_mutex_lock(1)
-#define MSG_MUTEX_UNLOCK()  LO_sys_mutex_unlock(1)
+#define DNS_MUTEX_LOCK()      LO_sys_mutex_lock(1)
+#define DNS_MUTEX_UNLOCK()    LO_sys_mutex_unlock(1)
 
 void    LO_sys_init(void);
 
-void    LO_sys_threadRun(void);
+/** Function executed by a thread started by LO_sys_threadStart */
+typedef void (*LO_sys_threadFunc_t)(void* argument);
 
-uint8_t LO_sys_threadIsLiveObjectsClient(void);
+uintptr_t LO_sys_threadSelf(void);
 
-int     LO_sys_threadStart(void const *argument);
+int     LO_sys_threadStart(LO_sys_threadFunc_t func, void* argument);
 
 void    LO_sys_threadCheck(void);
 
+/** Number of CPU cores available to run the threads */
+uint32_t LO_sys_cpuCount(void);
+
+/** Monotonic time in microseconds */
+uint64_t LO_sys_timeUs(void);
+
+/** Current UTC date and time in ISO 8601 format, with milliseconds (i.e. 2017-05-04T12:30:45.123Z).
+ * Return the length of the string, 0 if the date is unknown */
+int     LO_sys_dateStr(char* buf, uint32_t sz);
+
+/** Replace the content of a file (readable only by the user), atomically. Return 0 if successful */
+int     LO_sys_fileSave(const char* path, const void* data, uint32_t len);
+
+/** Content of a file (at most max_len bytes), allocated with MEM_ALLOC, or NULL */
+char*   LO_sys_fileLoad(const char* path, uint32_t max_len, uint32_t* p_len);
+
 uint8_t LO_sys_mutex_lock(uint8_t idx);
 void    LO_sys_mutex_unlock(uint8_t idx);
 
-void    LO_sys_mutex_unlock(uint8_t idx);
+/** Mutex of one object (i.e. state of a LiveObjects Client instance), instead of a global mutex */
+typedef struct LOSysMutex_s LOSysMutex_t;
+
+LOSysMutex_t* LO_sys_mutexCreate(void);
+
+void    LO_sys_mutexDelete(LOSysMutex_t* mtx);
+
+void    LO_sys_mutexLock(LOSysMutex_t* mtx);
+
+void    LO_sys_mutexUnlock(LOSysMutex_t* mtx);
+
+/* Events waited by the LiveObjects Client thread (bit mask returned by LO_sys_eventWait) */
+#define LO_SYS_EVENT_SOCK   0x01   /* Data received on the MQTT socket */
+#define LO_SYS_EVENT_USER   0x02   /* Signaled by LO_sys_eventSignal (message pushed by a user thread, ...) */
+#define LO_SYS_EVENT_TIMER  0x04   /* Timeout */
+#define LO_SYS_EVENT_NETW   0x08   /* Network interface or address changed (see LO_sys_eventNetwork) */
+
+/** Set of events waited by one LiveObjects Client instance */
+typedef struct LOSysEvent_s LOSysEvent_t;
+
+LOSysEvent_t* LO_sys_eventCreate(void);
+
+void    LO_sys_eventDelete(LOSysEvent_t* ev);
+
+void    LO_sys_eventSocket(LOSysEvent_t* ev, int sock_fd);
+
+void    LO_sys_eventSignal(LOSysEvent_t* ev);
+
+int     LO_sys_eventWait(LOSysEvent_t* ev, int32_t timeout_ms);
+
+/* Get the pending events without waiting (set of events in a group) */
+int     LO_sys_eventPoll(LOSysEvent_t* ev);
+
+/* Signal LO_SYS_EVENT_TIMER after timeout_ms (0: at once, negative value: never) */
+void    LO_sys_eventTimer(LOSysEvent_t* ev, int32_t timeout_ms);
+
+/* Signal LO_SYS_EVENT_NETW when a network interface or address changes (while enabled) */
+void    LO_sys_eventNetwork(LOSysEvent_t* ev, uint8_t enable);
+
+/** Group of event sets, waited by one gateway worker thread */
+typedef struct LOSysEventGroup_s LOSysEventGroup_t;
+
+LOSysEventGroup_t* LO_sys_groupCreate(void);
+
+void    LO_sys_groupDelete(LOSysEventGroup_t* grp);
+
+int     LO_sys_groupAdd(LOSysEventGroup_t* grp, LOSysEvent_t* ev, void* ctx);
+
+void    LO_sys_groupRemove(LOSysEventGroup_t* grp, LOSysEvent_t* ev);
+
+void    LO_sys_groupSignal(LOSysEventGroup_t* grp);
+
+/* Wait until some event sets are signaled, and return the number of their contexts
+ * copied in ctx_list (0: timeout or group signaled, -1: error) */
+int     LO_sys_groupWait(LOSysEventGroup_t* grp, int32_t timeout_ms, void** ctx_list, int ctx_max);
 
 #if defined(__cplusplus)
 }
@@ -36,9 +36,6 @@
 #define HTTP_HD_CONTENT_RANGE        "Content-Range:"
 #define HTTP_HD_APPLICATION_CONTEXT  "X-Application-Context:"
 
-static socketHandle_t _wget_sock_hdl;
-static char _wget_buffer[400];
-
 /* --------------------------------------------------------------------------------- */
 /*  */
 static void wget_build_get_query(char* buf_ptr, int buf_len, const char* pURL, const char* pHost, uint32_t offset) {
@@ -71,21 +68,21 @@ static void wget_build_get_query(char* buf_ptr, int buf_len, const char* pURL, c
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-static int wget_query(const char* pURL, const char* pHost, uint32_t rsc_size, uint32_t rsc_offset) {
+static int wget_query(LOWget_t* wget, const char* pURL, const char* pHost, uint32_t rsc_size, uint32_t rsc_offset) {
 	int ret;
 	int http_value;
 	uint32_t http_content_length;
 	char* pc;
 
-	wget_build_get_query(_wget_buffer, sizeof(_wget_buffer) - 1, pURL, pHost, rsc_offset);
+	wget_build_get_query(wget->buffer, sizeof(wget->buffer) - 1, pURL, pHost, rsc_offset);
 
-	ret = LO_sock_send(_wget_sock_hdl, _wget_buffer);
+	ret = LO_sock_send(wget->sock_hdl, wget->buffer);
 	if (ret) {
 		LOTRACE_ERR("Error while sending HTTP GET query to %s", pHost);
 		return -1;
 	}
 
-	ret = LO_sock_read_line(_wget_sock_hdl, _wget_buffer, sizeof(_wget_buffer) - 1);
+	ret = LO_sock_read_line(wget->sock_hdl, wget->buffer, sizeof(wget->buffer) - 1);
 	if (ret <= 0) {
 		LOTRACE_ERR("Error while reading the HTTP GET response from %s", pHost);
 		return -1;
@@ -93,14 +90,14 @@ static int wget_query(const char* pURL, const char* pHost, uint32_t rsc_size, ui
 
 	/* Parse HTTP response */
 	http_value = 0;
-	ret = sscanf(_wget_buffer, "HTTP/%*d.%*d %d %*s", &http_value);
+	ret = sscanf(wget->buffer, "HTTP/%*d.%*d %d %*s", &http_value);
 	if (ret != 1) {
 		/* Cannot match string, error */
-		LOTRACE_ERR("Not a correct HTTP answer : %d <%s>", ret, _wget_buffer);
+		LOTRACE_ERR("Not a correct HTTP answer : %d <%s>", ret, wget->buffer);
 		return -1;
 	}
 
-	LOTRACE_INF("rsp_code=%d <%s>", http_value, _wget_buffer);
+	LOTRACE_INF("rsp_code=%d <%s>", http_value, wget->buffer);
 	if ((http_value != 200) && !((http_value == 206) && (rsc_offset > 0))) {
 		LOTRACE_ERR("Unexpected HTTP Resp code %d", http_value);
 		return -1;
@@ -108,7 +105,7 @@ static int wget_query(const char* pURL, const char* pHost, uint32_t rsc_size, ui
 
 	http_content_length = 0;
 	while (1) {
-		ret = LO_sock_read_line(_wget_sock_hdl, _wget_buffer, sizeof(_wget_buffer) - 1);
+		ret = LO_sock_read_line(wget->sock_hdl, wget->buffer, sizeof(wget->buffer) - 1);
 		if (ret < 0) {
 			LOTRACE_WARN("Error while reading HTTP headers");
 			return -1;
@@ -117,21 +114,21 @@ static int wget_query(const char* pURL, const char* pHost, uint32_t rsc_size, ui
 			break;
 		}
 
-		LOTRACE_INF("http header: <%s>", _wget_buffer);
-		pc = strstr(_wget_buffer, ":");
+		LOTRACE_INF("http header: <%s>", wget->buffer);
+		pc = strstr(wget->buffer, ":");
 		if (pc != NULL) {
 			pc++;
 			LOTRACE_DBG1("value after ':' =  %s", pc);
-			if (!strncasecmp(_wget_buffer, HTTP_HD_CONTENT_LENGTH, strlen(HTTP_HD_CONTENT_LENGTH))) {
+			if (!strncasecmp(wget->buffer, HTTP_HD_CONTENT_LENGTH, strlen(HTTP_HD_CONTENT_LENGTH))) {
 				ret = sscanf(pc, "%"PRIu32, &http_content_length);
-				LOTRACE_DBG1("data len=%"PRIu32" {%s}", http_content_length, _wget_buffer);
+				LOTRACE_DBG1("data len=%"PRIu32" {%s}", http_content_length, wget->buffer);
 			}
-			else if (!strncasecmp(_wget_buffer, HTTP_HD_CONTENT_RANGE, strlen(HTTP_HD_CONTENT_RANGE))) {
+			else if (!strncasecmp(wget->buffer, HTTP_HD_CONTENT_RANGE, strlen(HTTP_HD_CONTENT_RANGE))) {
 				LOTRACE_INF(" ---- byte range %s", pc);
 			}
 		}
 		else {
-			LOTRACE_WARN(" BAD HEADER FORMAT <%s>", _wget_buffer);
+			LOTRACE_WARN(" BAD HEADER FORMAT <%s>", wget->buffer);
 			return -1;
 		}
 	}
@@ -154,16 +151,16 @@ static int wget_query(const char* pURL, const char* pHost, uint32_t rsc_size, ui
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-void LO_wget_close(void) {
-	if (_wget_sock_hdl) {
+void LO_wget_close(LOWget_t* wget) {
+	if (wget->sock_hdl) {
 		LOTRACE_INF("CLOSE TCP connection");
-		LO_sock_disconnect(&_wget_sock_hdl);
+		LO_sock_disconnect(&wget->sock_hdl);
 	}
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_wget_start(const char* uri, uint32_t rsc_size, uint32_t rsc_offset) {
+int LO_wget_start(LOWget_t* wget, const char* uri, uint32_t rsc_size, uint32_t rsc_offset) {
 	int ret;
 	const char* pc = uri;
 	const char* ps;
@@ -213,16 +210,16 @@ int LO_wget_start(const char* uri, uint32_t rsc_size, uint32_t rsc_offset) {
 	}
 
 	LOTRACE_DBG1("Connect to %s:%d ....", host_name, host_port);
-	ret = LO_sock_connect(2, host_name, host_port, &_wget_sock_hdl);
+	ret = LO_sock_connect(2, host_name, host_port, &wget->sock_hdl);
 	if (ret < 0) {
 		LOTRACE_ERR("Error while connecting to %s:%d", host_name, host_port);
 		return -1;
 	}
 
-	ret = wget_query(pc, host_name, rsc_size, rsc_offset);
+	ret = wget_query(wget, pc, host_name, rsc_size, rsc_offset);
 	if (ret < 0) {
 		LOTRACE_ERR("Error while processing HTTP GET query to %s:%d", host_name, host_port);
-		LO_sock_disconnect(&_wget_sock_hdl);
+		LO_sock_disconnect(&wget->sock_hdl);
 		return -1;
 	}
 
@@ -231,20 +228,20 @@ int LO_wget_start(const char* uri, uint32_t rsc_size, uint32_t rsc_offset) {
 
 /* --------------------------------------------------------------------------------- */
 /*  */
-int LO_wget_data(char* pData, int len) {
+int LO_wget_data(LOWget_t* wget, char* pData, int len) {
 	int ret;
 
-	if (_wget_sock_hdl == SOCKETHANDLE_NULL) {
+	if (wget->sock_hdl == SOCKETHANDLE_NULL) {
 		LOTRACE_ERR("(len=%d) -> NO SOCKET !!", len);
 		return -1;
 	}
 
 	LOTRACE_DBG1("(len=%d) ....", len);
 
-	ret = LO_sock_recv(_wget_sock_hdl, pData, len);
+	ret = LO_sock_recv(wget->sock_hdl, pData, len);
 	if (ret < 0) {
 		LOTRACE_ERR("(len=%d) -> ERROR %d", len, ret);
-		LO_sock_disconnect(&_wget_sock_hdl);
+		LO_sock_disconnect(&wget->sock_hdl);
 		return -1;
 	}
 
@@ -17,15 +17,23 @@
 
 #include <stdint.h>
 
+#include "liveobjects-sys/socket_defs.h"
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
-int LO_wget_start(const char* uri, uint32_t size, uint32_t offset);
+/** Context of a HTTP GET request (one per LiveObjects Client instance) */
+typedef struct {
+	socketHandle_t sock_hdl;
+	char           buffer[400];
+} LOWget_t;
+
+int LO_wget_start(LOWget_t* wget, const char* uri, uint32_t size, uint32_t offset);
 
-int LO_wget_data(char* pData, int len);
+int LO_wget_data(LOWget_t* wget, char* pData, int len);
 
-void LO_wget_close(void);
+void LO_wget_close(LOWget_t* wget);
 
 #if defined(__cplusplus)
 }
@@ -61,7 +61,9 @@ int f_netw_sock_setup(Network *pNetwork);
 
 int f_netw_sock_close(Network *pNetwork);
 
-int f_netw_sock_connect(Network *pNetwork, const char* RemoteHostAddress, uint16_t RemoteHostPort, uint32_t tmo_ms);
+/* Connect within tmo_ms milliseconds (0: no limit), p_dns_ms (if not NULL) is set to the duration of the DNS resolution */
+int f_netw_sock_connect(Network *pNetwork, const char* RemoteHostAddress, uint16_t RemoteHostPort, uint32_t tmo_ms,
+		uint32_t* p_dns_ms);
 
 /*
  * mbetls compatible interface (see mbedtls_ssl_set_bio() function called in netw_wrapper.c)
@@ -72,6 +74,29 @@ int f_netw_sock_recv(void *pNetwork, unsigned char *buf, size_t len);
 
 int f_netw_sock_recv_timeout(void *pNetwork, unsigned char *buf, size_t len, uint32_t tmo);
 
+/*
+ * Kernel TLS (see LOC_NETW_KTLS): record layer of a TLS 1.2 AES-GCM connection done by the socket
+ */
+#define NETW_KTLS_TX     0x01
+#define NETW_KTLS_RX     0x02
+
+/* Keys and state of one direction, once the handshake is done */
+typedef struct {
+	uint8_t key[32];
+	uint8_t key_len;   /* 16 (AES-128) or 32 (AES-256) */
+	uint8_t salt[4];   /* Implicit part of the nonce (fixed IV) */
+	uint8_t seq[8];    /* Sequence number of the next record */
+} netw_ktls_crypto_t;
+
+/* Give the record layer to the kernel: return the directions done (NETW_KTLS_TX, NETW_KTLS_RX), 0 if not supported */
+uint8_t f_netw_sock_ktls_start(Network *pNetwork, const netw_ktls_crypto_t* tx, const netw_ktls_crypto_t* rx);
+
+/* Read the data of the application records decrypted by the kernel */
+int f_netw_sock_ktls_recv_timeout(void *pNetwork, unsigned char *buf, size_t len, uint32_t tmo);
+
+/* Send the close_notify alert, encrypted by the kernel */
+int f_netw_sock_ktls_close_notify(Network *pNetwork);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -16,6 +16,7 @@
 
 #include "netw_wrapper.h"
 #include "netw_sock.h"
+#include "loc_sys.h"
 
 #include "liveobjects-client/LiveObjectsClient_Config.h"
 
@@ -69,6 +70,7 @@ void LOCC_mqtt_dump_msg(const unsigned char* p_buf);
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/certs.h"
 #include "mbedtls/x509.h"
+#include "mbedtls/asn1.h"
 #include "mbedtls/error.h"
 #include "mbedtls/entropy_poll.h"
 
@@ -81,21 +83,99 @@ void LOCC_mqtt_dump_msg(const unsigned char* p_buf);
 
 #endif /* LOC_FEATURE_MBEDTLS */
 
-static uint8_t _netw_tls_enabled;
+#if LOC_FEATURE_MBEDTLS && LOC_TLS_SESSION_RESUME && defined(MBEDTLS_SSL_CLI_C)
+#define NETW_TLS_RESUME     1
+/* Max size of a saved session: ticket and peer certificates */
+#define NETW_TLS_SESSION_FILE_MAX  (16*1024)
+/* Max length of the path of this file */
+#define NETW_TLS_SESSION_PATH_SZ   128
+#else
+#define NETW_TLS_RESUME     0
+#endif
+
+#if LOC_FEATURE_MBEDTLS && LOC_NETW_KTLS && defined(MBEDTLS_SSL_EXPORT_KEYS) && defined(MBEDTLS_GCM_C)
+#define NETW_KTLS           1
+#else
+#define NETW_KTLS           0
+#endif
+
+#if LOC_FEATURE_MBEDTLS
+/* TLS configuration: parsed certificates and mbedtls_ssl_config, shared (read only) by all
+ * the connections with the same security parameters */
+typedef struct netw_tls_conf_s {
+	struct netw_tls_conf_s* next;
+	uint32_t refcnt;
+	LiveObjectsSecurityParams_t params;
+	bool ssl_verify;
+	mbedtls_ssl_config conf;
+
+	mbedtls_x509_crt cacert;
+	mbedtls_x509_crt clicert;
+	mbedtls_pk_context pkey;
+} netw_tls_conf_t;
+#endif
+
+#if NETW_KTLS
+/* Keys of an AES-GCM connection, exported by mbedtls when its handshake derives them */
+typedef struct {
+	uint8_t used;
+	uint8_t key_len;
+	unsigned char keys[2 * 32];  /* Client write key, then server write key */
+	unsigned char ivs[2 * 4];    /* Client and server fixed IV */
+} netw_ktls_keys_t;
+#endif
+
+/* Context of one network connection, stored in pNetwork->netw_ctx */
+typedef struct {
+	uint8_t tls_enabled;
+	uint8_t ktls;                  /* Directions of the record layer done by the kernel (NETW_KTLS_TX, NETW_KTLS_RX) */
+#if LOC_FEATURE_MBEDTLS
+	uint8_t tls_run;
+	uint32_t read_timeout_ms;
+	netw_tls_conf_t* tls_conf;
+	mbedtls_ssl_context ssl;
+#if NETW_KTLS
+	mbedtls_ssl_config ktls_conf;  /* Copy of tls_conf->conf, exporting the keys to this connection */
+	netw_ktls_keys_t ktls_keys;    /* Keys of the last handshake, until netw_ktls_start */
+#endif
+#if NETW_TLS_RESUME
+	mbedtls_ssl_session session;   /* Last session established, offered by the next handshake */
+	uint32_t session_peer;         /* Server of this session (hash of its address and port), 0 if none */
+	char session_file[NETW_TLS_SESSION_PATH_SZ]; /* File where the session is saved (to be resumed after a restart), or "" */
+#endif
+	LiveObjectsD_TlsStats_t tls_stats;
+#endif
+	/* Durations (in milliseconds) of the phases of the last connection */
+	uint32_t dns_ms;
+	uint32_t tcp_ms;
+	uint32_t tls_ms;
+	/* Receive buffer: bytes read from the socket (or TLS layer) and not yet given to the MQTT client */
+	uint32_t rx_start;
+	uint32_t rx_end;
+	unsigned char rx_buf[LOC_NETW_RX_BUF_SZ];
+#if LOC_NETW_TX_BUF_SZ > 0
+	/* Transmit buffer: MQTT packets gathered between netw_batchStart and netw_batchFlush */
+	uint8_t tx_batch;
+	uint32_t tx_len;
+	unsigned char tx_buf[LOC_NETW_TX_BUF_SZ];
+#endif
+} netw_ctx_t;
+
+#define NETW_CTX(pNetwork)    ((netw_ctx_t*) (pNetwork)->netw_ctx)
 
 #if LOC_FEATURE_MBEDTLS
 static const char* _netw_passwd = "";
 
-static uint8_t _netw_tls_run;
-static bool _netw_ssl_verify = false;
-static mbedtls_ssl_config _netw_conf;
-static mbedtls_ssl_context _netw_ssl;
-static mbedtls_entropy_context _netw_entropy;
-static mbedtls_ctr_drbg_context _netw_ctr_drbg;
+/* List of TLS configurations in use, protected by TLS_MUTEX */
+static netw_tls_conf_t* _netw_tls_confs = NULL;
 
-static mbedtls_x509_crt _netw_cacert;
-static mbedtls_x509_crt _netw_clicert;
-static mbedtls_pk_context _netw_pkey;
+/* Random generator of all the configurations: seeded with the first one, freed with the last one.
+ * Protected by TLS_MUTEX */
+static struct {
+	uint8_t seeded;
+	mbedtls_entropy_context entropy;
+	mbedtls_ctr_drbg_context ctr_drbg;
+} _netw_rng;
 
 #if MBEDTLS_TIMER
 static struct {
@@ -200,29 +280,52 @@ int f_timing_get_delay( void *data )
 
 #endif
 
+#if LOC_FEATURE_MBEDTLS
+/* --------------------------------------------------------------------------------- */
+/* Receive callback of mbedtls, with the read timeout of this connection */
+static int netw_tls_recv_timeout(void *pNetwork, unsigned char *buf, size_t len, uint32_t tmo) {
+	(void) tmo;
+	return f_netw_sock_recv_timeout(pNetwork, buf, len, NETW_CTX((Network*) pNetwork)->read_timeout_ms);
+}
+#endif
+
 /* --------------------------------------------------------------------------------- */
 /*  */
 void netw_disconnect(Network *pNetwork, int mode) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	if (ctx == NULL) {
+		return;
+	}
 	if (f_netw_sock_isOpen(pNetwork)) {
 #if LOC_FEATURE_MBEDTLS
-		if (_netw_tls_run) {
+		if ((ctx->tls_run) && (ctx->ktls & NETW_KTLS_TX)) {
+			/* mbedtls no longer knows the sequence number */
+			f_netw_sock_ktls_close_notify(pNetwork);
+		}
+		else if (ctx->tls_run) {
 			int ret;
 			LOTRACE_INF("mbedtls_ssl_close_notify ...");
 			do {
-				ret = mbedtls_ssl_close_notify(&_netw_ssl);
+				ret = mbedtls_ssl_close_notify(&ctx->ssl);
 			} while (ret == MBEDTLS_ERR_SSL_WANT_WRITE);
 			LOTRACE_INF("mbedtls_ssl_close_notify ret=%d", ret);
 		}
-		if (_netw_tls_enabled) {
+		if (ctx->tls_enabled) {
 			LOTRACE_INF("SSL RESET ...");
-			mbedtls_ssl_session_reset(&_netw_ssl);
+			mbedtls_ssl_session_reset(&ctx->ssl);
 		}
 #endif
 		f_netw_sock_close(pNetwork);
 	}
 	LOTRACE_INF("RESET");
+	ctx->rx_start = ctx->rx_end = 0;
+#if LOC_NETW_TX_BUF_SZ > 0
+	ctx->tx_batch = 0;
+	ctx->tx_len = 0;
+#endif
+	ctx->ktls = 0;
 #if LOC_FEATURE_MBEDTLS
-	_netw_tls_run = 0;
+	ctx->tls_run = 0;
 #endif
 }
 
@@ -236,22 +339,35 @@ unsigned char netw_isLost(Network *pNetwork) {
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-int netw_mqtt_write(Network *pNetwork, unsigned char *pMsg, int len, int timeout_ms) {
-	int written = 0;
-	LOTRACE_DBG1("(%p/%p, len=%d,timeout_ms=%d, tsl=%d) ...", pNetwork, pNetwork->my_socket, len,
-			timeout_ms, _netw_tls_enabled);
-
-#if (LOC_MQTT_DUMP_MSG & 0x02)
-	LOCC_mqtt_dump_msg(pMsg);
+/* Number of bytes already received, in the receive buffer or decrypted by the TLS layer
+ * (not signaled by the socket) */
+int netw_bytesAvailable(Network *pNetwork) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	int nb;
+	if (ctx == NULL) {
+		return 0;
+	}
+	nb = (int) (ctx->rx_end - ctx->rx_start);
+#if LOC_FEATURE_MBEDTLS
+	if (ctx->tls_run) {
+		nb += (int) mbedtls_ssl_get_bytes_avail(&ctx->ssl);
+	}
 #endif
+	return nb;
+}
 
-	if (_netw_tls_enabled) {
+/* --------------------------------------------------------------------------------- */
+/* Write to the TLS layer or the socket (encrypting itself with kTLS) */
+static int netw_send(Network *pNetwork, unsigned char *pMsg, int len, int timeout_ms) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	int written = 0;
+
+	if ((ctx->tls_enabled) && (!(ctx->ktls & NETW_KTLS_TX))) {
 #if LOC_FEATURE_MBEDTLS
 		int frags;
 		int ret;
 		for (written = 0, frags = 0; written < len; written += ret, frags++) {
-			while ((ret = mbedtls_ssl_write(&_netw_ssl, pMsg + written, len - written)) <= 0) {
+			while ((ret = mbedtls_ssl_write(&ctx->ssl, pMsg + written, len - written)) <= 0) {
 				if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
 					LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_write");
 					return ret;
@@ -275,67 +391,194 @@ int netw_mqtt_write(Network *pNetwork, unsigned char *pMsg, int len, int timeout
 	return written;
 }
 
+#if LOC_NETW_TX_BUF_SZ > 0
+/* --------------------------------------------------------------------------------- */
+/* Send the packets gathered in the transmit buffer */
+static int netw_txFlush(Network *pNetwork) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	int len = (int) ctx->tx_len;
+	int ret;
+
+	ctx->tx_len = 0;
+	if (len == 0) {
+		return 0;
+	}
+	LOTRACE_DBG1("(len=%d) ...", len);
+	ret = netw_send(pNetwork, ctx->tx_buf, len, 0);
+	return (ret == len) ? 0 : -1;
+}
+#endif
+
 /* --------------------------------------------------------------------------------- */
 /*  */
-int netw_mqtt_read(Network *pNetwork, unsigned char *pMsg, int len, int timeout_ms) {
-	int ret = -1;
+int netw_mqtt_write(Network *pNetwork, unsigned char *pMsg, int len, int timeout_ms) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	LOTRACE_DBG1("(%p/%p, len=%d,timeout_ms=%d, tsl=%d) ...", pNetwork, pNetwork->my_socket, len,
+			timeout_ms, ctx->tls_enabled);
 
-	/* LOTRACE_DBG_VERBOSE("(%p/%p, len=%d,timeout_ms=%d, tsl=%d) ...",  pNetwork, pNetwork->my_socket, len, timeout_ms, _netw_tls_enabled); */
+#if (LOC_MQTT_DUMP_MSG & 0x02)
+	LOCC_mqtt_dump_msg(pMsg);
+#endif
 
-	if (_netw_tls_enabled) {
+#if LOC_NETW_TX_BUF_SZ > 0
+	if (ctx->tx_batch) {
+		/* At most one TLS record */
+		uint32_t tx_max = LOC_NETW_TX_BUF_SZ;
 #if LOC_FEATURE_MBEDTLS
-		int rxLen = 0;
-		bool isErrorFlag = false;
-		bool isCompleteFlag = false;
-
-		if (timeout_ms >= 0) {
-			mbedtls_ssl_conf_read_timeout(&_netw_conf, timeout_ms);
+		if ((ctx->tls_enabled) && (tx_max > MBEDTLS_SSL_MAX_CONTENT_LEN)) {
+			tx_max = MBEDTLS_SSL_MAX_CONTENT_LEN;
 		}
+#endif
+		if ((ctx->tx_len + len > tx_max) && (netw_txFlush(pNetwork))) {
+			return -1;
+		}
+		if ((uint32_t) len <= tx_max) {
+			memcpy(ctx->tx_buf + ctx->tx_len, pMsg, len);
+			ctx->tx_len += len;
+			return len;
+		}
+	}
+#endif
+	return netw_send(pNetwork, pMsg, len, timeout_ms);
+}
 
-		LOTRACE_DBG_VERBOSE("(len=%d,timeout_ms=%d) ...", len, timeout_ms);
+/* --------------------------------------------------------------------------------- */
+/*  */
+void netw_batchStart(Network *pNetwork) {
+#if LOC_NETW_TX_BUF_SZ > 0
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	if (ctx) {
+		ctx->tx_batch = 1;
+	}
+#else
+	(void) pNetwork;
+#endif
+}
 
-		do {
-			ret = mbedtls_ssl_read(&_netw_ssl, pMsg, len);
-			if (ret > 0) {
-				rxLen += ret;
-			}
-			else if (ret == MBEDTLS_ERR_SSL_WANT_READ) {
-				LOTRACE_DBG_VERBOSE("(len=%d,timeout_ms=%d) - ret=x%X = MBEDTLS_ERR_SSL_WANT_READ", len,
-						timeout_ms, ret);
-				isErrorFlag = true;
-			}
-			else if (ret == MBEDTLS_ERR_SSL_TIMEOUT) {
-				LOTRACE_DBG_VERBOSE("(len=%d,timeout_ms=%d) - ret=x%X = MBEDTLS_ERR_SSL_TIMEOUT", len,
-						timeout_ms, ret);
-				isErrorFlag = true;
+/* --------------------------------------------------------------------------------- */
+/*  */
+int netw_batchFlush(Network *pNetwork) {
+#if LOC_NETW_TX_BUF_SZ > 0
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	if ((ctx == NULL) || (!ctx->tx_batch)) {
+		return 0;
+	}
+	ctx->tx_batch = 0;
+	return netw_txFlush(pNetwork);
+#else
+	(void) pNetwork;
+	return 0;
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/* One read from the TLS layer or the socket (decrypting itself with kTLS): up to len bytes, only those
+ * already available (or the first ones received before the timeout) */
+static int netw_recv(Network *pNetwork, unsigned char *buf, int len, int timeout_ms) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	int ret;
+
+	if ((ctx->tls_enabled) && (!(ctx->ktls & NETW_KTLS_RX))) {
+#if LOC_FEATURE_MBEDTLS
+		if (timeout_ms >= 0) {
+			/* A timeout of 0 means 'wait forever' for mbedtls */
+			ctx->read_timeout_ms = (timeout_ms > 0) ? timeout_ms : 1;
+		}
+		ret = mbedtls_ssl_read(&ctx->ssl, buf, len);
+		if (ret < 0) {
+			if ((ret == MBEDTLS_ERR_SSL_WANT_READ) || (ret == MBEDTLS_ERR_SSL_TIMEOUT)) {
+				LOTRACE_DBG_VERBOSE("(len=%d,timeout_ms=%d) - ret=x%X", len, timeout_ms, ret);
 			}
 			else {
 				LOTRACE_DBG1("(len=%d,timeout_ms=%d) - ret= x%X", len, timeout_ms, ret);
 				LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_read");
-				isErrorFlag = true;
 			}
-			if (rxLen >= len) {
-				isCompleteFlag = true;
-			}
-		} while (!isErrorFlag && !isCompleteFlag);
-
+		}
 #else
 		LOTRACE_ERR("Error while reading bytes: TLS required but not supported");
 		ret = -1;
 #endif
 	}
+	else if (ctx->ktls & NETW_KTLS_RX) {
+		ret = f_netw_sock_ktls_recv_timeout(pNetwork, buf, len, (timeout_ms > 0) ? timeout_ms : 0);
+		if ((ret < 0) && (ret != NETW_ERR_SSL_WANT_READ) && (ret != NETW_ERR_SSL_TIMEOUT)) {
+			LOTRACE_ERR("f_netw_sock_ktls_recv_timeout(len=%d) -> ERROR %d x%x", len, ret, ret);
+		}
+	}
 	else {
-		ret = f_netw_sock_recv_timeout(pNetwork, pMsg, len, timeout_ms);
-		if (ret < 0) {
-			if ((ret != NETW_ERR_SSL_WANT_READ) && (ret != NETW_ERR_SSL_TIMEOUT))
-				LOTRACE_ERR("f_netw_sock_recv_timeout(len=%d) -> ERROR %d x%x", len, ret, ret);
+		ret = f_netw_sock_recv_timeout(pNetwork, buf, len, (timeout_ms > 0) ? timeout_ms : 0);
+		if ((ret < 0) && (ret != NETW_ERR_SSL_WANT_READ) && (ret != NETW_ERR_SSL_TIMEOUT)) {
+			LOTRACE_ERR("f_netw_sock_recv_timeout(len=%d) -> ERROR %d x%x", len, ret, ret);
+		}
+	}
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Give len bytes to the MQTT client, from the receive buffer.
+ * The buffer is filled by reading as many bytes as possible (several MQTT packets) in one
+ * call, so that the header of a MQTT packet (read byte per byte) costs no system call. */
+int netw_mqtt_read(Network *pNetwork, unsigned char *pMsg, int len, int timeout_ms) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	uint64_t end_us = 0;
+	int rxLen = 0;
+	int ret;
+
+	/* LOTRACE_DBG_VERBOSE("(%p/%p, len=%d,timeout_ms=%d, tsl=%d) ...",  pNetwork, pNetwork->my_socket, len, timeout_ms, ctx->tls_enabled); */
+
+	while (1) {
+		uint32_t nb = ctx->rx_end - ctx->rx_start;
+		if (nb) {
+			if (nb > (uint32_t) (len - rxLen)) {
+				nb = (uint32_t) (len - rxLen);
+			}
+			memcpy(pMsg + rxLen, ctx->rx_buf + ctx->rx_start, nb);
+			rxLen += nb;
+			ctx->rx_start += nb;
+			if (ctx->rx_start == ctx->rx_end) {
+				ctx->rx_start = ctx->rx_end = 0;
+			}
+		}
+		if (rxLen >= len) {
+			break;
+		}
+
+		/* The receive buffer is empty: a first read with the given timeout, then the
+		 * end of the requested bytes within the time left */
+		if (end_us == 0) {
+			end_us = LO_sys_timeUs() + 1000 * (uint64_t) ((timeout_ms > 0) ? timeout_ms : 0);
+		}
+		else {
+			uint64_t now_us = LO_sys_timeUs();
+			timeout_ms = (now_us < end_us) ? (int) ((end_us - now_us) / 1000) : 0;
+		}
+
+		if ((len - rxLen) >= LOC_NETW_RX_BUF_SZ) {
+			/* Large payload: directly in the MQTT buffer */
+			ret = netw_recv(pNetwork, pMsg + rxLen, len - rxLen, timeout_ms);
+			if (ret > 0) {
+				rxLen += ret;
+				continue;
+			}
+		}
+		else {
+			ret = netw_recv(pNetwork, ctx->rx_buf, LOC_NETW_RX_BUF_SZ, timeout_ms);
+			if (ret > 0) {
+				ctx->rx_end = (uint32_t) ret;
+				continue;
+			}
+		}
+		/* Error, timeout or connection closed by the peer: bytes already read (if any) are
+		 * returned, the MQTT client checks the length */
+		if (rxLen == 0) {
 			return ret;
 		}
+		break;
 	}
 
-	LOTRACE_DBG_VERBOSE("netw_mqtt_read(len=%d,timeout_ms=%d) ret=%d", len, timeout_ms, ret);
+	LOTRACE_DBG_VERBOSE("netw_mqtt_read(len=%d,timeout_ms=%d) ret=%d", len, timeout_ms, rxLen);
 
-	return ret;
+	return rxLen;
 }
 
 /* --------------------------------------------------------------------------------- */
@@ -343,10 +586,11 @@ int netw_mqtt_read(Network *pNetwork, unsigned char *pMsg, int len, int timeout_
 #if 0
 void netw_mqtt_disconnect(Network *pNetwork)
 {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
 #if LOC_FEATURE_MBEDTLS
 	int ret;
 	do {
-		ret = mbedtls_ssl_close_notify(&_netw_ssl);
+		ret = mbedtls_ssl_close_notify(&ctx->ssl);
 	}while (ret == MBEDTLS_ERR_SSL_WANT_WRITE);
 #endif
 }
@@ -405,84 +649,260 @@ static int myCertVerify(void *data, mbedtls_x509_crt *crt, int depth, uint32_t *
 /* --------------------------------------------------------------------------------- */
 /*  */
 int netw_init(Network *pNetwork, void* net_iface_handler) {
-#if LOC_FEATURE_MBEDTLS
-	int ret;
-	const char *pers = "lom_tls_wrapper";
-#endif
+	netw_ctx_t* ctx;
 
 	LOTRACE_DBG1("netw_init(%p,%p)", pNetwork, net_iface_handler);
 
+	if (pNetwork == NULL) {
+		return -1;
+	}
+	if (pNetwork->netw_ctx) {
+		/* Initialized again: release the previous context */
+		netw_tls_destroy(pNetwork);
+	}
+	ctx = (netw_ctx_t*) MEM_ALLOC(sizeof(netw_ctx_t));
+	if (ctx == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR");
+		return -1;
+	}
+	memset(ctx, 0, sizeof(netw_ctx_t));
+
 	f_netw_sock_init(pNetwork, net_iface_handler);
 
-	_netw_tls_enabled = 0;
+	pNetwork->netw_ctx = ctx;
+	ctx->tls_enabled = 0;
 
 #if LOC_FEATURE_MBEDTLS
-	_netw_tls_run = 0;
-	_netw_ssl_verify = false;
+	ctx->tls_run = 0;
+	ctx->read_timeout_ms = 60000;
+	ctx->tls_conf = NULL;
 
-#if defined(MBEDTLS_DEBUG_C)
-	mbedtls_debug_set_threshold(0);
+	mbedtls_ssl_init(&ctx->ssl);
+#if NETW_TLS_RESUME
+	mbedtls_ssl_session_init(&ctx->session);
 #endif
 
-	mbedtls_ssl_init(&_netw_ssl);
-	mbedtls_ssl_config_init(&_netw_conf);
-	mbedtls_x509_crt_init(&_netw_cacert);
-	mbedtls_x509_crt_init(&_netw_clicert);
-	mbedtls_pk_init(&_netw_pkey);
-
-	mbedtls_ctr_drbg_init(&_netw_ctr_drbg);
-	mbedtls_entropy_init(&_netw_entropy);
-
 #if defined(MBEDTLS_CONFIG_NAME)
 	LOTRACE_ERR("netw_init:  MBEDTLS_CONFIG_NAME = " MBEDTLS_CONFIG_NAME);
 #endif
+#endif /* LOC_FEATURE_MBEDTLS */
 
-#if defined(MBEDTLS_DEBUG_C) && (NETW_MBEDTLS_DBG > 0)
-	mbedtls_debug_set_threshold(NETW_MBEDTLS_DBG);
-	LOTRACE_ERR("netw_init: SET MBEDTLS_DEBUG threshold=%d !!", NETW_MBEDTLS_DBG);
-	mbedtls_ssl_conf_dbg(&_netw_conf, netw_mbedtls_debug, &_netw_conf);
-#endif
+	LOTRACE_DBG1("netw_init: OK");
+
+	pNetwork->my_socket = SOCKETHANDLE_NULL;
+	pNetwork->mqttread = netw_mqtt_read;
+	pNetwork->mqttwrite = netw_mqtt_write;
+	/* pNetwork->disconnect = netw_mqtt_disconnect; */
 
-	ret = mbedtls_ctr_drbg_seed(&_netw_ctr_drbg, mbedtls_entropy_func, &_netw_entropy, (const unsigned char *) pers,
-			strlen(pers));
+	return 0;
+}
+
+#if LOC_FEATURE_MBEDTLS
+/* --------------------------------------------------------------------------------- */
+/* Random generator of the configurations, used by several connections/threads */
+static int netw_tls_random(void* p_rng, unsigned char* output, size_t output_len) {
+	int ret;
+	(void) p_rng;
+	TLS_MUTEX_LOCK();
+	ret = mbedtls_ctr_drbg_random(&_netw_rng.ctr_drbg, output, output_len);
+	TLS_MUTEX_UNLOCK();
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Seed the random generator (called with TLS_MUTEX held) */
+static int netw_tls_rngSeed(void) {
+	const char *pers = "lom_tls_wrapper";
+	int ret;
+	if (_netw_rng.seeded) {
+		return 0;
+	}
+	mbedtls_ctr_drbg_init(&_netw_rng.ctr_drbg);
+	mbedtls_entropy_init(&_netw_rng.entropy);
+	ret = mbedtls_ctr_drbg_seed(&_netw_rng.ctr_drbg, mbedtls_entropy_func, &_netw_rng.entropy,
+			(const unsigned char *) pers, strlen(pers));
 	if (ret != 0) {
 		LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ctr_drbg_seed");
-		return -1;
+		mbedtls_ctr_drbg_free(&_netw_rng.ctr_drbg);
+		mbedtls_entropy_free(&_netw_rng.entropy);
+		return ret;
 	}
-#endif /* LOC_FEATURE_MBEDTLS */
+	_netw_rng.seeded = 1;
+	return 0;
+}
 
-	LOTRACE_DBG1("netw_init: OK");
+/* --------------------------------------------------------------------------------- */
+/* Same certificates (location) and same verification ? */
+static bool netw_tls_paramsEqual(const LiveObjectsSecurityParams_t* p1, const LiveObjectsSecurityParams_t* p2) {
+	return (p1->rootCA.type == p2->rootCA.type) && (p1->rootCA.pLoc == p2->rootCA.pLoc)
+			&& (p1->deviceCert.type == p2->deviceCert.type) && (p1->deviceCert.pLoc == p2->deviceCert.pLoc)
+			&& (p1->devicePrivateKey.type == p2->devicePrivateKey.type)
+			&& (p1->devicePrivateKey.pLoc == p2->devicePrivateKey.pLoc)
+			&& (p1->rootCA.len == p2->rootCA.len) && (p1->deviceCert.len == p2->deviceCert.len)
+			&& (p1->devicePrivateKey.len == p2->devicePrivateKey.len)
+			&& (p1->serverVerificationMode == p2->serverVerificationMode);
+}
 
-	if (pNetwork) {
-		pNetwork->my_socket = SOCKETHANDLE_NULL;
-		pNetwork->mqttread = netw_mqtt_read;
-		pNetwork->mqttwrite = netw_mqtt_write;
-		/* pNetwork->disconnect = netw_mqtt_disconnect; */
+#if NETW_TLS_RESUME || NETW_KTLS
+/* --------------------------------------------------------------------------------- */
+/* Erase a buffer holding a master secret or keys */
+static void netw_zeroize(void* v, size_t n) {
+	volatile unsigned char* p = (volatile unsigned char*) v;
+	while (n--) {
+		*p++ = 0;
 	}
+}
+
+#endif
 
+#if NETW_KTLS
+/* --------------------------------------------------------------------------------- */
+/* Keys derived by the handshake of a connection (mbedtls_ssl_export_keys_t callback, p_expkey is its
+ * netw_ctx_t), kept when the cipher is AEAD: no MAC key and 4 bytes of fixed IV */
+static int netw_ktls_exportKeys(void* p_expkey, const unsigned char* ms, const unsigned char* kb, size_t maclen,
+		size_t keylen, size_t ivlen) {
+	netw_ktls_keys_t* k = &((netw_ctx_t*) p_expkey)->ktls_keys;
+	(void) ms;
+	netw_zeroize(k, sizeof(netw_ktls_keys_t));
+	if ((maclen != 0) || (ivlen != 4) || ((keylen != 16) && (keylen != 32))) {
+		return 0;
+	}
+	k->used = 1;
+	k->key_len = (uint8_t) keylen;
+	memcpy(k->keys, kb, 2 * keylen);
+	memcpy(k->ivs, kb + 2 * keylen, 2 * ivlen);
 	return 0;
 }
 
 /* --------------------------------------------------------------------------------- */
-/*  */
-int netw_setSecurity(Network *pNetwork, const LiveObjectsSecurityParams_t* params) {
-#if LOC_FEATURE_MBEDTLS
-	int ret;
+/* After the handshake, give the record layer to the kernel (TLS 1.2 AES-GCM only).
+ * The connection keeps going with mbedtls when the kernel does not support it. */
+static void netw_ktls_start(Network *pNetwork) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	const mbedtls_ssl_ciphersuite_t* suite;
+	netw_ktls_keys_t keys;
+	netw_ktls_crypto_t tx;
+	netw_ktls_crypto_t rx;
+	bool found;
+
+	ctx->ktls = 0;
+	keys = ctx->ktls_keys;
+	netw_zeroize(&ctx->ktls_keys, sizeof(ctx->ktls_keys));
+	found = (keys.used != 0);
+	if (ctx->ssl.session == NULL) {
+		netw_zeroize(&keys, sizeof(keys));
+		return;
+	}
 
-	if (params->rootCA.pLoc) {
-		LOTRACE_DBG1("Loading the CA Certificate ...");
-		if (!params->rootCA.type) {
-			ret = mbedtls_x509_crt_parse(&_netw_cacert, (const unsigned char*) params->rootCA.pLoc,
-					strlen(params->rootCA.pLoc) + 1);
+	suite = mbedtls_ssl_ciphersuite_from_id(ctx->ssl.session->ciphersuite);
+	if ((!found) || (ctx->ssl.minor_ver != MBEDTLS_SSL_MINOR_VERSION_3) || (suite == NULL)
+			|| ((suite->cipher != MBEDTLS_CIPHER_AES_128_GCM) && (suite->cipher != MBEDTLS_CIPHER_AES_256_GCM))) {
+		LOTRACE_INF("Kernel TLS not used with %s %s", mbedtls_ssl_get_version(&ctx->ssl),
+				mbedtls_ssl_get_ciphersuite(&ctx->ssl));
+		if (found) {
+			netw_zeroize(&keys, sizeof(keys));
 		}
-		else {
+		return;
+	}
+
+	/* Client endpoint: write with the client keys, read with the server keys */
+	tx.key_len = rx.key_len = keys.key_len;
+	memcpy(tx.key, keys.keys, keys.key_len);
+	memcpy(rx.key, keys.keys + keys.key_len, keys.key_len);
+	memcpy(tx.salt, keys.ivs, 4);
+	memcpy(rx.salt, keys.ivs + 4, 4);
+	memcpy(tx.seq, ctx->ssl.out_ctr, 8);
+	memcpy(rx.seq, ctx->ssl.in_ctr, 8);
+	netw_zeroize(&keys, sizeof(keys));
+
+	/* Bytes already read by mbedtls would be lost for the kernel: reading stays with mbedtls */
+	ctx->ktls = f_netw_sock_ktls_start(pNetwork, &tx,
+			((ctx->ssl.in_left == 0) && (mbedtls_ssl_get_bytes_avail(&ctx->ssl) == 0)) ? &rx : NULL);
+	if (ctx->ktls) {
+		ctx->tls_stats.tls_ktls++;
+	}
+	netw_zeroize(&tx, sizeof(tx));
+	netw_zeroize(&rx, sizeof(rx));
+}
+#endif
+
+/* --------------------------------------------------------------------------------- */
+/* Parse certificates: PEM string, file (PEM or DER), or DER data holding one or several certificates */
+static int netw_tls_crtParse(mbedtls_x509_crt* crt, const LiveObjectsSecurityRecord_t* rec) {
+	const unsigned char* p;
+	const unsigned char* end;
+	int ret;
+
+	if (rec->type == 0) {
+		return mbedtls_x509_crt_parse(crt, (const unsigned char*) rec->pLoc, strlen(rec->pLoc) + 1);
+	}
+	if (rec->type != 2) {
 #if defined(MBEDTLS_FS_IO)
-			ret = mbedtls_x509_crt_parse_file(&_netw_cacert, params->rootCA.pLoc);
+		return mbedtls_x509_crt_parse_file(crt, rec->pLoc);
 #else
-			LOTRACE_ERR("mbedtls_x509_crt_parse_file (CA Certificate): NOT SUPPORTED !");
-			return -1;
+		LOTRACE_ERR("mbedtls_x509_crt_parse_file: NOT SUPPORTED !");
+		return -1;
 #endif
+	}
+	p = (const unsigned char*) rec->pLoc;
+	end = p + rec->len;
+	ret = (p < end) ? 0 : MBEDTLS_ERR_X509_INVALID_FORMAT;
+	while ((ret == 0) && (p < end)) {
+		unsigned char* q = (unsigned char*) p;
+		size_t len;
+		/* Size of this certificate: its outer SEQUENCE */
+		ret = mbedtls_asn1_get_tag(&q, end, &len, MBEDTLS_ASN1_CONSTRUCTED | MBEDTLS_ASN1_SEQUENCE);
+		if (ret == 0) {
+			len += (size_t) (q - p);
+			ret = mbedtls_x509_crt_parse_der(crt, p, len);
+			p += len;
 		}
+	}
+	return ret;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Parse the private key: PEM string, file (PEM or DER), or DER data */
+static int netw_tls_keyParse(mbedtls_pk_context* pkey, const LiveObjectsSecurityRecord_t* rec) {
+	if (rec->type == 0) {
+		return mbedtls_pk_parse_key(pkey, (const unsigned char*) rec->pLoc, strlen(rec->pLoc) + 1,
+				(const unsigned char*) _netw_passwd, strlen(_netw_passwd));
+	}
+	if (rec->type == 2) {
+		return mbedtls_pk_parse_key(pkey, (const unsigned char*) rec->pLoc, rec->len,
+				(const unsigned char*) _netw_passwd, strlen(_netw_passwd));
+	}
+#if defined(MBEDTLS_FS_IO)
+	return mbedtls_pk_parse_keyfile(pkey, rec->pLoc, _netw_passwd);
+#else
+	LOTRACE_ERR("mbedtls_pk_parse_keyfile: NOT SUPPORTED !");
+	return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Parse the certificates and set the TLS configuration (called with TLS_MUTEX held) */
+static int netw_tls_confSetup(netw_tls_conf_t* tls, const LiveObjectsSecurityParams_t* params) {
+	int ret;
+
+	mbedtls_ssl_config_init(&tls->conf);
+	mbedtls_x509_crt_init(&tls->cacert);
+	mbedtls_x509_crt_init(&tls->clicert);
+	mbedtls_pk_init(&tls->pkey);
+
+#if defined(MBEDTLS_DEBUG_C) && (NETW_MBEDTLS_DBG > 0)
+	mbedtls_debug_set_threshold(NETW_MBEDTLS_DBG);
+	LOTRACE_ERR("netw_init: SET MBEDTLS_DEBUG threshold=%d !!", NETW_MBEDTLS_DBG);
+	mbedtls_ssl_conf_dbg(&tls->conf, netw_mbedtls_debug, &tls->conf);
+#endif
+
+	if ((ret = netw_tls_rngSeed()) != 0) {
+		return ret;
+	}
+
+	if (params->rootCA.pLoc) {
+		LOTRACE_DBG1("Loading the CA Certificate ...");
+		ret = netw_tls_crtParse(&tls->cacert, &params->rootCA);
 		if (ret < 0) {
 			LOTRACE_MBEDTLS_ERR(ret, "mbedtls_x509_crt_parse (CA Certificate)");
 			return ret;
@@ -495,18 +915,7 @@ int netw_setSecurity(Network *pNetwork, const LiveObjectsSecurityParams_t* param
 
 	if ((params->deviceCert.pLoc) && (params->devicePrivateKey.pLoc)) {
 		LOTRACE_DBG1("Loading the Client Certificate ...");
-		if (!params->deviceCert.type) {
-			ret = mbedtls_x509_crt_parse(&_netw_clicert, (const unsigned char*) params->deviceCert.pLoc,
-					strlen(params->deviceCert.pLoc) + 1);
-		}
-		else {
-#if defined(MBEDTLS_FS_IO)
-			ret = mbedtls_x509_crt_parse_file(&_netw_clicert, params->deviceCert.pLoc);
-#else
-			LOTRACE_ERR("mbedtls_x509_crt_parse_file (Client Certificate): NOT SUPPORTED !");
-			return -1;
-#endif
-		}
+		ret = netw_tls_crtParse(&tls->clicert, &params->deviceCert);
 		if (ret != 0) {
 			LOTRACE_MBEDTLS_ERR(ret, "mbedtls_x509_crt_parse (Client Certificate)");
 			return ret;
@@ -514,20 +923,7 @@ int netw_setSecurity(Network *pNetwork, const LiveObjectsSecurityParams_t* param
 		LOTRACE_INF("Client Certificate loaded: OK");
 
 		LOTRACE_DBG1("Loading the Client Key...");
-		if (!params->devicePrivateKey.type) {
-			ret = mbedtls_pk_parse_key(&_netw_pkey, (const unsigned char*) params->devicePrivateKey.pLoc,
-					strlen(params->devicePrivateKey.pLoc) + 1, (const unsigned char*) _netw_passwd,
-					strlen(_netw_passwd));
-
-		}
-		else {
-#if defined(MBEDTLS_FS_IO)
-			ret = mbedtls_pk_parse_keyfile(&_netw_pkey, params->devicePrivateKey.pLoc, _netw_passwd);
-#else
-			LOTRACE_ERR("mbedtls_pk_parse_keyfile (Private Key): NOT SUPPORTED !");
-			return -1;
-#endif
-		}
+		ret = netw_tls_keyParse(&tls->pkey, &params->devicePrivateKey);
 		if (ret != 0) {
 			LOTRACE_MBEDTLS_ERR(ret, "mbedtls_pk_parse_key (Private Key)");
 			return ret;
@@ -535,7 +931,7 @@ int netw_setSecurity(Network *pNetwork, const LiveObjectsSecurityParams_t* param
 		LOTRACE_INF("Client Key loaded: OK");
 	}
 	LOTRACE_DBG1("Setting up the SSL/TLS structure...");
-	if ((ret = mbedtls_ssl_config_defaults(&_netw_conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+	if ((ret = mbedtls_ssl_config_defaults(&tls->conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
 			MBEDTLS_SSL_PRESET_DEFAULT)) != 0) {
 		LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_config_defaults");
 		return ret;
@@ -546,58 +942,441 @@ int netw_setSecurity(Network *pNetwork, const LiveObjectsSecurityParams_t* param
 		int authmode;
 		if (params->serverVerificationMode) {
 			LOTRACE_INF("ssl authmode: REQUIRED (%d)", params->serverVerificationMode);
-			_netw_ssl_verify = true;
+			tls->ssl_verify = true;
 			//authmode = MBEDTLS_SSL_VERIFY_OPTIONAL;
 			authmode = MBEDTLS_SSL_VERIFY_REQUIRED;
 			if (params->serverVerificationMode != 2) {
 				LOTRACE_INF("ssl authmode: + myCertVerify");
-				mbedtls_ssl_conf_verify(&_netw_conf, myCertVerify, NULL);
+				mbedtls_ssl_conf_verify(&tls->conf, myCertVerify, NULL);
 			}
 		}
 		else {
 			LOTRACE_WARN("ssl authmode: NONE");
-			_netw_ssl_verify = false;
+			tls->ssl_verify = false;
 			authmode = MBEDTLS_SSL_VERIFY_NONE;
 		}
-		mbedtls_ssl_conf_authmode(&_netw_conf, authmode);
+		mbedtls_ssl_conf_authmode(&tls->conf, authmode);
 	}
 #else  /* MBEDTLS_VERIFY */
 	LOTRACE_WARN("ssl authmode: NONE (MBEDTLS_VERIFY=0)");
-	_netw_ssl_verify = false;
-	mbedtls_ssl_conf_authmode(&_netw_conf, MBEDTLS_SSL_VERIFY_NONE);
+	tls->ssl_verify = false;
+	mbedtls_ssl_conf_authmode(&tls->conf, MBEDTLS_SSL_VERIFY_NONE);
 #endif /* MBEDTLS_VERIFY */
 
-	mbedtls_ssl_conf_rng(&_netw_conf, mbedtls_ctr_drbg_random, &_netw_ctr_drbg);
+	/* Called by the TLS handshake of each connection using this configuration */
+	mbedtls_ssl_conf_rng(&tls->conf, netw_tls_random, NULL);
+	mbedtls_ssl_conf_read_timeout(&tls->conf, 60000);
+
+#if MBEDTLS_DTLS_TIMER && defined(MBEDTLS_SSL_PROTO_DTLS)
+	mbedtls_ssl_conf_handshake_timeout( &tls->conf, MBEDTLS_DTLS_TIMER_MIN, MBEDTLS_DTLS_TIMER_MAX );
+#endif
 
 
-	mbedtls_ssl_conf_ca_chain(&_netw_conf, &_netw_cacert, NULL);
+	mbedtls_ssl_conf_ca_chain(&tls->conf, &tls->cacert, NULL);
+
+#if NETW_TLS_RESUME && defined(MBEDTLS_SSL_SESSION_TICKETS)
+	mbedtls_ssl_conf_session_tickets(&tls->conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
 
 #if 1
-	if ((_netw_ssl_verify) &&(params->deviceCert.pLoc) && (params->devicePrivateKey.pLoc)) {
-		if (0 != (ret = mbedtls_ssl_conf_own_cert(&_netw_conf, &_netw_clicert, &_netw_pkey))) {
+	if ((tls->ssl_verify) &&(params->deviceCert.pLoc) && (params->devicePrivateKey.pLoc)) {
+		if (0 != (ret = mbedtls_ssl_conf_own_cert(&tls->conf, &tls->clicert, &tls->pkey))) {
 			LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_conf_own_cert");
 			return ret;
 		}
 	}
 #endif
 
-	if ((ret = mbedtls_ssl_setup(&_netw_ssl, &_netw_conf)) != 0) {
+	return 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void netw_tls_confFree(netw_tls_conf_t* tls) {
+	mbedtls_x509_crt_free(&tls->clicert);
+	mbedtls_x509_crt_free(&tls->cacert);
+	mbedtls_pk_free(&tls->pkey);
+	mbedtls_ssl_config_free(&tls->conf);
+	MEM_FREE(tls);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Get the TLS configuration of these security parameters, parsed only once */
+static netw_tls_conf_t* netw_tls_confGet(const LiveObjectsSecurityParams_t* params) {
+	netw_tls_conf_t* tls;
+
+	TLS_MUTEX_LOCK();
+	for (tls = _netw_tls_confs; tls; tls = tls->next) {
+		if (netw_tls_paramsEqual(&tls->params, params)) {
+			tls->refcnt++;
+			TLS_MUTEX_UNLOCK();
+			LOTRACE_DBG1("Shared TLS configuration %p, refcnt=%u", tls, tls->refcnt);
+			return tls;
+		}
+	}
+
+	tls = (netw_tls_conf_t*) MEM_ALLOC(sizeof(netw_tls_conf_t));
+	if (tls == NULL) {
+		TLS_MUTEX_UNLOCK();
+		LOTRACE_ERR("MEM_ALLOC ERROR");
+		return NULL;
+	}
+	memset(tls, 0, sizeof(netw_tls_conf_t));
+	tls->params = *params;
+	if (netw_tls_confSetup(tls, params)) {
+		TLS_MUTEX_UNLOCK();
+		netw_tls_confFree(tls);
+		return NULL;
+	}
+	tls->refcnt = 1;
+	tls->next = _netw_tls_confs;
+	_netw_tls_confs = tls;
+	TLS_MUTEX_UNLOCK();
+	return tls;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+static void netw_tls_confRelease(netw_tls_conf_t* tls) {
+	netw_tls_conf_t** pp;
+
+	TLS_MUTEX_LOCK();
+	if (--tls->refcnt) {
+		TLS_MUTEX_UNLOCK();
+		return;
+	}
+	for (pp = &_netw_tls_confs; *pp; pp = &(*pp)->next) {
+		if (*pp == tls) {
+			*pp = tls->next;
+			break;
+		}
+	}
+	if ((_netw_tls_confs == NULL) && (_netw_rng.seeded)) {
+		mbedtls_ctr_drbg_free(&_netw_rng.ctr_drbg);
+		mbedtls_entropy_free(&_netw_rng.entropy);
+		_netw_rng.seeded = 0;
+	}
+	TLS_MUTEX_UNLOCK();
+	netw_tls_confFree(tls);
+}
+#endif /* LOC_FEATURE_MBEDTLS */
+
+#if NETW_TLS_RESUME
+/* --------------------------------------------------------------------------------- */
+/* Identifier of the server: hash of its address and port (never 0) */
+static uint32_t netw_tls_peer(const LiveObjectsNetConnectParams_t* params) {
+	const char* p;
+	uint32_t h = 2166136261U;
+	for (p = params->RemoteHostAddress; (p) && (*p); p++) {
+		h = (h ^ (uint8_t) *p) * 16777619U;
+	}
+	h = (h ^ params->RemoteHostPort) * 16777619U;
+	return (h) ? h : 1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Forget the session */
+static void netw_tls_sessionClear(netw_ctx_t* ctx) {
+	mbedtls_ssl_session_free(&ctx->session);
+	mbedtls_ssl_session_init(&ctx->session);
+	ctx->session_peer = 0;
+}
+
+#define NETW_PUT32(p, v)  do { uint32_t _v = (uint32_t) (v); memcpy(p, &_v, 4); p += 4; } while (0)
+#define NETW_GET32(p)     ((p) += 4, netw_get32((p) - 4))
+
+static uint32_t netw_get32(const unsigned char* p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+/* Saved session: "LOT1", peer, ciphersuite, compression, verify_result, id_len, id, master,
+ * ticket_lifetime, ticket_len, mfl_code, trunc_hmac, encrypt_then_mac, number of certificates,
+ * then the ticket and the peer certificates (length + DER). Only read by the same host. */
+#define NETW_TLS_SESSION_HDR_SZ   (4 + 4*5 + 32 + 48 + 4*2 + 4)
+
+/* --------------------------------------------------------------------------------- */
+/* Save the session in the session file */
+static void netw_tls_sessionSave(netw_ctx_t* ctx) {
+	const mbedtls_ssl_session* ss = &ctx->session;
+	unsigned char* buf;
+	unsigned char* p;
+	uint32_t len = NETW_TLS_SESSION_HDR_SZ;
+	uint32_t ticket_len = 0;
+	uint8_t ncert = 0;
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	const mbedtls_x509_crt* crt;
+#endif
+
+	if (ctx->session_file[0] == 0) {
+		return;
+	}
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	ticket_len = (ss->ticket) ? (uint32_t) ss->ticket_len : 0;
+	len += ticket_len;
+#endif
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	for (crt = ss->peer_cert; (crt) && (crt->raw.len) && (ncert < 255); crt = crt->next, ncert++) {
+		len += 4 + (uint32_t) crt->raw.len;
+	}
+#endif
+	if (len > NETW_TLS_SESSION_FILE_MAX) {
+		LOTRACE_WARN("TLS session too large to be saved (%u bytes)", (unsigned) len);
+		return;
+	}
+	buf = (unsigned char*) MEM_ALLOC(len);
+	if (buf == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (size=%u)", (unsigned) len);
+		return;
+	}
+	p = buf;
+	memcpy(p, "LOT1", 4);
+	p += 4;
+	NETW_PUT32(p, ctx->session_peer);
+	NETW_PUT32(p, ss->ciphersuite);
+	NETW_PUT32(p, ss->compression);
+	NETW_PUT32(p, ss->verify_result);
+	NETW_PUT32(p, ss->id_len);
+	memcpy(p, ss->id, 32);
+	p += 32;
+	memcpy(p, ss->master, 48);
+	p += 48;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	NETW_PUT32(p, ss->ticket_lifetime);
+#else
+	NETW_PUT32(p, 0);
+#endif
+	NETW_PUT32(p, ticket_len);
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+	*p++ = ss->mfl_code;
+#else
+	*p++ = 0;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+	*p++ = (unsigned char) ss->trunc_hmac;
+#else
+	*p++ = 0;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+	*p++ = (unsigned char) ss->encrypt_then_mac;
+#else
+	*p++ = 0;
+#endif
+	*p++ = ncert;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	if (ticket_len) {
+		memcpy(p, ss->ticket, ticket_len);
+		p += ticket_len;
+	}
+#endif
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	for (crt = ss->peer_cert; (crt) && (ncert); crt = crt->next, ncert--) {
+		NETW_PUT32(p, crt->raw.len);
+		memcpy(p, crt->raw.p, crt->raw.len);
+		p += crt->raw.len;
+	}
+#endif
+	if (LO_sys_fileSave(ctx->session_file, buf, (uint32_t) (p - buf)) == 0) {
+		LOTRACE_DBG1("TLS session saved in %s (%u bytes)", ctx->session_file, (unsigned) (p - buf));
+	}
+	netw_zeroize(buf, len);
+	MEM_FREE(buf);
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Load the session saved in the session file (if any) */
+static int netw_tls_sessionLoad(netw_ctx_t* ctx) {
+	mbedtls_ssl_session ss;
+	unsigned char* buf;
+	const unsigned char* p;
+	const unsigned char* end;
+	uint32_t len = 0;
+	uint32_t peer;
+	uint32_t ticket_len;
+	uint8_t ncert;
+
+	buf = (unsigned char*) LO_sys_fileLoad(ctx->session_file, NETW_TLS_SESSION_FILE_MAX, &len);
+	if (buf == NULL) {
+		return -1;
+	}
+	mbedtls_ssl_session_init(&ss);
+	p = buf;
+	end = buf + len;
+	if ((len < NETW_TLS_SESSION_HDR_SZ) || (memcmp(p, "LOT1", 4))) {
+		goto bad;
+	}
+	p += 4;
+	peer = NETW_GET32(p);
+	ss.ciphersuite = (int) NETW_GET32(p);
+	ss.compression = (int) NETW_GET32(p);
+	ss.verify_result = NETW_GET32(p);
+	ss.id_len = NETW_GET32(p);
+	if (ss.id_len > 32) {
+		goto bad;
+	}
+	memcpy(ss.id, p, 32);
+	p += 32;
+	memcpy(ss.master, p, 48);
+	p += 48;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	ss.ticket_lifetime = NETW_GET32(p);
+#else
+	p += 4;
+#endif
+	ticket_len = NETW_GET32(p);
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+	ss.mfl_code = p[0];
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+	ss.trunc_hmac = p[1];
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+	ss.encrypt_then_mac = p[2];
+#endif
+	ncert = p[3];
+	p += 4;
+
+	if (ticket_len > (uint32_t) (end - p)) {
+		goto bad;
+	}
+	if (ticket_len) {
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+		ss.ticket = (unsigned char*) mbedtls_calloc(1, ticket_len);
+		if (ss.ticket == NULL) {
+			goto bad;
+		}
+		memcpy(ss.ticket, p, ticket_len);
+		ss.ticket_len = ticket_len;
+#endif
+		p += ticket_len;
+	}
+
+#if defined(MBEDTLS_X509_CRT_PARSE_C)
+	if (ncert) {
+		ss.peer_cert = (mbedtls_x509_crt*) mbedtls_calloc(1, sizeof(mbedtls_x509_crt));
+		if (ss.peer_cert == NULL) {
+			goto bad;
+		}
+		mbedtls_x509_crt_init(ss.peer_cert);
+	}
+	for (; ncert; ncert--) {
+		uint32_t crt_len;
+		if ((end - p) < 4) {
+			goto bad;
+		}
+		crt_len = NETW_GET32(p);
+		if ((crt_len > (uint32_t) (end - p)) || (mbedtls_x509_crt_parse_der(ss.peer_cert, p, crt_len))) {
+			goto bad;
+		}
+		p += crt_len;
+	}
+#endif
+
+	netw_tls_sessionClear(ctx);
+	ctx->session = ss;
+	ctx->session_peer = peer;
+	netw_zeroize(buf, len);
+	MEM_FREE(buf);
+	LOTRACE_INF("TLS session loaded from %s", ctx->session_file);
+	return 0;
+
+bad:
+	LOTRACE_WARN("%s: bad TLS session, ignored", ctx->session_file);
+	mbedtls_ssl_session_free(&ss);
+	netw_zeroize(buf, len);
+	MEM_FREE(buf);
+	return -1;
+}
+
+/* --------------------------------------------------------------------------------- */
+/* Keep the session just established, to be offered by the next handshake */
+static void netw_tls_sessionKeep(netw_ctx_t* ctx, uint32_t peer, bool resumed) {
+	mbedtls_ssl_session ss;
+	int ret;
+	bool changed = !resumed;
+
+	mbedtls_ssl_session_init(&ss);
+	if ((ret = mbedtls_ssl_get_session(&ctx->ssl, &ss)) != 0) {
+		LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_get_session");
+		mbedtls_ssl_session_free(&ss);
+		netw_tls_sessionClear(ctx);
+		return;
+	}
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+	if ((ss.ticket_len == ctx->session.ticket_len)
+			&& ((ss.ticket_len == 0) || (memcmp(ss.ticket, ctx->session.ticket, ss.ticket_len) == 0))) {
+		if ((!resumed) && (ss.ticket)) {
+			/* Ticket rejected by the server, but kept by mbedtls: it would replace the session id */
+			mbedtls_free(ss.ticket);
+			ss.ticket = NULL;
+			ss.ticket_len = 0;
+		}
+	}
+	else {
+		/* New ticket given by the server */
+		changed = true;
+	}
+#endif
+	netw_tls_sessionClear(ctx);
+	ctx->session = ss;
+	ctx->session_peer = peer;
+	if (changed) {
+		netw_tls_sessionSave(ctx);
+	}
+}
+#endif /* NETW_TLS_RESUME */
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+int netw_setSecurity(Network *pNetwork, const LiveObjectsSecurityParams_t* params) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+#if LOC_FEATURE_MBEDTLS
+	int ret;
+
+	if (ctx->tls_conf) {
+		/* Security parameters changed */
+		mbedtls_ssl_free(&ctx->ssl);
+		mbedtls_ssl_init(&ctx->ssl);
+		netw_tls_confRelease(ctx->tls_conf);
+		ctx->tls_conf = NULL;
+		ctx->tls_enabled = 0;
+#if NETW_TLS_RESUME
+		netw_tls_sessionClear(ctx);
+#endif
+	}
+
+	ctx->tls_conf = netw_tls_confGet(params);
+	if (ctx->tls_conf == NULL) {
+		return -1;
+	}
+
+#if NETW_KTLS
+	/* Shallow copy: the certificates and the RNG stay in the shared configuration (never freed with
+	 * mbedtls_ssl_config_free), only the export callback differs */
+	ctx->ktls_conf = ctx->tls_conf->conf;
+	mbedtls_ssl_conf_export_keys_cb(&ctx->ktls_conf, netw_ktls_exportKeys, ctx);
+	ret = mbedtls_ssl_setup(&ctx->ssl, &ctx->ktls_conf);
+#else
+	ret = mbedtls_ssl_setup(&ctx->ssl, &ctx->tls_conf->conf);
+#endif
+	if (ret != 0) {
 		LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_setup");
 		return ret;
 	}
 
 	if ((params->rootCertificateCommonName) && (*params->rootCertificateCommonName)) {
-		if ((ret = mbedtls_ssl_set_hostname(&_netw_ssl, params->rootCertificateCommonName)) != 0) {
+		if ((ret = mbedtls_ssl_set_hostname(&ctx->ssl, params->rootCertificateCommonName)) != 0) {
 			LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_set_hostname");
 			return ret;
 		}
 	}
 
-	_netw_tls_enabled = 1;
+	ctx->tls_enabled = 1;
 
 	return 0;
 #else  /* LOC_FEATURE_MBEDTLS */
-	_netw_tls_enabled = 0;
+	ctx->tls_enabled = 0;
 	return -1;
 #endif /* LOC_FEATURE_MBEDTLS */
 }
@@ -605,6 +1384,8 @@ int netw_setSecurity(Network *pNetwork, const LiveObjectsSecurityParams_t* param
 /* --------------------------------------------------------------------------------- */
 /*  */
 int netw_connect(Network* pNetwork, LiveObjectsNetConnectParams_t* params) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	uint64_t connect_us;
 	int ret;
 	LOTRACE_INF("Connecting to server %s:%d tmo=%u ...", params->RemoteHostAddress, params->RemoteHostPort,
 			params->TimeoutMs);
@@ -612,56 +1393,97 @@ int netw_connect(Network* pNetwork, LiveObjectsNetConnectParams_t* params) {
 	if (f_netw_sock_isOpen(pNetwork)) {
 		netw_disconnect(pNetwork, 0);
 	}
+	ctx->ktls = 0;
 #if LOC_FEATURE_MBEDTLS
-	_netw_tls_run = 0;
+	ctx->tls_run = 0;
 #endif
-	ret = f_netw_sock_connect(pNetwork, params->RemoteHostAddress, params->RemoteHostPort, params->TimeoutMs);
+	ctx->rx_start = ctx->rx_end = 0;
+	ctx->dns_ms = ctx->tcp_ms = ctx->tls_ms = 0;
+	connect_us = LO_sys_timeUs();
+	ret = f_netw_sock_connect(pNetwork, params->RemoteHostAddress, params->RemoteHostPort, params->TimeoutMs,
+			&ctx->dns_ms);
+	ctx->tcp_ms = (uint32_t) ((LO_sys_timeUs() - connect_us) / 1000) - ctx->dns_ms;
 	if (ret) {
 		LOTRACE_ERR("Failed to create TCP socket");
 		return -1;
 	}
 	LOTRACE_INF("Connected to server %s:%d OK", params->RemoteHostAddress, params->RemoteHostPort);
+	f_netw_sock_setup(pNetwork);
 
 	ret = 0;
 #if LOC_FEATURE_MBEDTLS
-	if (_netw_tls_enabled) {
-		LOTRACE_INF("Set SSL/TLS ...");
-
-		//mbedtls_ssl_conf_read_timeout(&conf, params.timeout_ms);
-		mbedtls_ssl_conf_read_timeout(&_netw_conf, 60000);
-
-#if MBEDTLS_DTLS_TIMER && defined(MBEDTLS_SSL_PROTO_DTLS)
-		mbedtls_ssl_conf_handshake_timeout( &_netw_conf, MBEDTLS_DTLS_TIMER_MIN, MBEDTLS_DTLS_TIMER_MAX );
+	if (ctx->tls_enabled) {
+		uint64_t start_us;
+		uint32_t hs_ms;
+		bool resumed = false;
+#if NETW_TLS_RESUME
+		uint32_t peer = netw_tls_peer(params);
 #endif
+		LOTRACE_INF("Set SSL/TLS ...");
 
-		mbedtls_ssl_conf_rng(&_netw_conf, mbedtls_ctr_drbg_random, &_netw_ctr_drbg);
+		/* The configuration may be shared: the read timeout is kept in the connection context */
+		ctx->read_timeout_ms = 60000;
 
-		if ((ret = mbedtls_ssl_setup(&_netw_ssl, &_netw_conf)) != 0) {
-			LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_setup");
+		/* Already set up by netw_setSecurity() */
+		if ((ret = mbedtls_ssl_session_reset(&ctx->ssl)) != 0) {
+			LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_session_reset");
 			netw_disconnect(pNetwork, 0);
 			return ret;
 		}
 
-		mbedtls_ssl_set_bio(&_netw_ssl, (void*) pNetwork, f_netw_sock_send, f_netw_sock_recv, f_netw_sock_recv_timeout);
+		mbedtls_ssl_set_bio(&ctx->ssl, (void*) pNetwork, f_netw_sock_send, f_netw_sock_recv, netw_tls_recv_timeout);
+
+#if NETW_TLS_RESUME
+		/* Offer the previous session of this server: abbreviated handshake if the server accepts it */
+		if ((ctx->session_peer == peer) && ((ret = mbedtls_ssl_set_session(&ctx->ssl, &ctx->session)) != 0)) {
+			LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_set_session");
+			netw_tls_sessionClear(ctx);
+		}
+#endif
 
 #if MBEDTLS_TIMER
 		LOTRACE_INF("Set timer callbacks ...");
-		mbedtls_ssl_set_timer_cb( &_netw_ssl, &_netw_timer, f_timing_set_delay, f_timing_get_delay );
+		mbedtls_ssl_set_timer_cb( &ctx->ssl, &_netw_timer, f_timing_set_delay, f_timing_get_delay );
 #endif
 
 		LOTRACE_INF("Performing the SSL/TLS handshake...");
-		while ((ret = mbedtls_ssl_handshake(&_netw_ssl)) != 0) {
+		start_us = LO_sys_timeUs();
+		while ((ret = mbedtls_ssl_handshake(&ctx->ssl)) != 0) {
 			if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
 				LOTRACE_MBEDTLS_ERR(ret, "mbedtls_ssl_handshake");
+				ctx->tls_stats.tls_failed++;
+#if NETW_TLS_RESUME
+				/* Do not offer this session again */
+				netw_tls_sessionClear(ctx);
+#endif
 				netw_disconnect(pNetwork, 0);
 				return ret;
 			}
 		}
-		LOTRACE_INF(" SSL/TLS handshake: OK");
+		hs_ms = (uint32_t) ((LO_sys_timeUs() - start_us) / 1000);
+		ctx->tls_ms = hs_ms;
+
+#if NETW_TLS_RESUME
+		/* Same master secret: the session is resumed */
+		resumed = (ctx->session_peer == peer) && (ctx->ssl.session)
+				&& (memcmp(ctx->ssl.session->master, ctx->session.master, sizeof(ctx->session.master)) == 0);
+		netw_tls_sessionKeep(ctx, peer, resumed);
+#endif
+		if (resumed) {
+			ctx->tls_stats.tls_resumed++;
+			ctx->tls_stats.tls_resumed_ms += hs_ms;
+			ctx->tls_stats.tls_resumed_last_ms = hs_ms;
+		}
+		else {
+			ctx->tls_stats.tls_full++;
+			ctx->tls_stats.tls_full_ms += hs_ms;
+			ctx->tls_stats.tls_full_last_ms = hs_ms;
+		}
+		LOTRACE_INF(" SSL/TLS handshake: OK (%s, %u ms)", (resumed) ? "resumed" : "full", (unsigned) hs_ms);
 
-		LOTRACE_DBG1("[ Protocol is %s ]", mbedtls_ssl_get_version(&_netw_ssl));
-		LOTRACE_DBG1("[ Ciphersuite is %s ]", mbedtls_ssl_get_ciphersuite(&_netw_ssl));
-		if ((ret = mbedtls_ssl_get_record_expansion(&_netw_ssl)) >= 0) {
+		LOTRACE_DBG1("[ Protocol is %s ]", mbedtls_ssl_get_version(&ctx->ssl));
+		LOTRACE_DBG1("[ Ciphersuite is %s ]", mbedtls_ssl_get_ciphersuite(&ctx->ssl));
+		if ((ret = mbedtls_ssl_get_record_expansion(&ctx->ssl)) >= 0) {
 			LOTRACE_DBG1("[ Record expansion is %d ]", ret);
 		}
 		else {
@@ -669,10 +1491,10 @@ int netw_connect(Network* pNetwork, LiveObjectsNetConnectParams_t* params) {
 		}
 
 		ret = 0;
-		if (_netw_ssl_verify) {
+		if (ctx->tls_conf->ssl_verify) {
 			uint32_t ssl_flags;
 			LOTRACE_INF("Verifying peer X.509 Certificate...");
-			if (0 != (ssl_flags = mbedtls_ssl_get_verify_result(&_netw_ssl))) {
+			if (0 != (ssl_flags = mbedtls_ssl_get_verify_result(&ctx->ssl))) {
 				char vrfy_buf[512];
 				mbedtls_x509_crt_verify_info(vrfy_buf, sizeof(vrfy_buf), "  ! ", ssl_flags);
 				LOTRACE_WARN("failed ssl_flags=0X%X\n%s", ssl_flags, vrfy_buf);
@@ -687,26 +1509,85 @@ int netw_connect(Network* pNetwork, LiveObjectsNetConnectParams_t* params) {
 			LOTRACE_INF("peer X.509 Certificate Verification skipped");
 		}
 
-		_netw_tls_run = 1;
+#if NETW_KTLS
+		netw_ktls_start(pNetwork);
+#endif
+		ctx->tls_run = 1;
 	}
 #endif /* LOC_FEATURE_MBEDTLS */
 
-	f_netw_sock_setup(pNetwork);
-
 	return ret;
 }
 
 /* --------------------------------------------------------------------------------- */
 /*  */
 int netw_tls_destroy(Network *pNetwork) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	if (ctx == NULL) {
+		return 0;
+	}
 #if LOC_FEATURE_MBEDTLS
-	mbedtls_x509_crt_free(&_netw_clicert);
-	mbedtls_x509_crt_free(&_netw_cacert);
-	mbedtls_pk_free(&_netw_pkey);
-	mbedtls_ssl_free(&_netw_ssl);
-	mbedtls_ssl_config_free(&_netw_conf);
-	mbedtls_ctr_drbg_free(&_netw_ctr_drbg);
-	mbedtls_entropy_free(&_netw_entropy);
+	mbedtls_ssl_free(&ctx->ssl);
+#if NETW_KTLS
+	netw_zeroize(&ctx->ktls_keys, sizeof(ctx->ktls_keys));
+#endif
+#if NETW_TLS_RESUME
+	mbedtls_ssl_session_free(&ctx->session);
+#endif
+	if (ctx->tls_conf) {
+		netw_tls_confRelease(ctx->tls_conf);
+	}
 #endif /* LOC_FEATURE_MBEDTLS */
+	MEM_FREE(ctx);
+	pNetwork->netw_ctx = NULL;
 	return 0;
 }
+
+/* --------------------------------------------------------------------------------- */
+/* Save the TLS sessions in this file, and resume the session already saved (if any) */
+int netw_tls_sessionFile(Network *pNetwork, const char* path) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	if (ctx == NULL) {
+		return -1;
+	}
+#if NETW_TLS_RESUME
+	if ((path) && (strlen(path) >= sizeof(ctx->session_file))) {
+		LOTRACE_ERR("Path too long (max %u)", (unsigned) (sizeof(ctx->session_file) - 1));
+		return -1;
+	}
+	memset(ctx->session_file, 0, sizeof(ctx->session_file));
+	if (path) {
+		strcpy(ctx->session_file, path);
+		netw_tls_sessionLoad(ctx);
+	}
+	return 0;
+#else
+	(void) path;
+	LOTRACE_NOTICE("Not supported");
+	return -1;
+#endif
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void netw_getConnectTimes(Network *pNetwork, uint32_t* p_dns_ms, uint32_t* p_tcp_ms, uint32_t* p_tls_ms) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+	*p_dns_ms = (ctx) ? ctx->dns_ms : 0;
+	*p_tcp_ms = (ctx) ? ctx->tcp_ms : 0;
+	*p_tls_ms = (ctx) ? ctx->tls_ms : 0;
+}
+
+/* --------------------------------------------------------------------------------- */
+/*  */
+void netw_tls_getStats(Network *pNetwork, LiveObjectsD_TlsStats_t* stats) {
+	netw_ctx_t* ctx = NETW_CTX(pNetwork);
+#if LOC_FEATURE_MBEDTLS
+	if (ctx) {
+		*stats = ctx->tls_stats;
+		return;
+	}
+#else
+	(void) ctx;
+#endif
+	memset(stats, 0, sizeof(LiveObjectsD_TlsStats_t));
+}
@@ -14,6 +14,7 @@
 #ifndef __netw_wrapper_H_
 #define __netw_wrapper_H_
 
+#include "liveobjects-client/LiveObjectsClient_Defs.h"
 #include "liveobjects-client/LiveObjectsClient_Security.h"
 
 #include "liveobjects-sys/mqtt_network_interface.h"
@@ -30,6 +31,8 @@ typedef struct {
 
 unsigned char netw_isLost(Network *pNetwork);
 
+int netw_bytesAvailable(Network *pNetwork);
+
 int netw_init(Network *pNetwork, void* net_iface_handler);
 
 int netw_setSecurity(Network *pNetwork, const LiveObjectsSecurityParams_t* params);
@@ -38,6 +41,23 @@ int netw_connect(Network *pNetwork, LiveObjectsNetConnectParams_t* params);
 
 void netw_disconnect(Network *pNetwork, int cause);
 
+int netw_tls_destroy(Network *pNetwork);
+
+/* Gather the next MQTT packets in the transmit buffer of the connection (see LOC_NETW_TX_BUF_SZ),
+ * to be sent together (in one TLS record) by netw_batchFlush */
+void netw_batchStart(Network *pNetwork);
+
+/* Send the packets gathered since netw_batchStart. Return 0 if successful */
+int netw_batchFlush(Network *pNetwork);
+
+int netw_tls_sessionFile(Network *pNetwork, const char* path);
+
+void netw_tls_getStats(Network *pNetwork, LiveObjectsD_TlsStats_t* stats);
+
+/* Durations (in milliseconds) of the DNS resolution, TCP connection and TLS handshake of the last connection
+ * (0 if not done) */
+void netw_getConnectTimes(Network *pNetwork, uint32_t* p_dns_ms, uint32_t* p_tcp_ms, uint32_t* p_tls_ms);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -17,26 +17,76 @@
  * - LOC_FEATURE_LO_DATA      'Collected Data' feature.
  * - LOC_FEATURE_LO_COMMANDS  'Commands' feature.
  * - LOC_FEATURE_LO_RESOURCES 'Resources' feature.
+ * - LOC_FEATURE_CBOR         CBOR encoding of data and status messages (selected per data/status set),
+ *                            and decoding of the CBOR parameter and command requests.
  * And
  *  - LOC_MQTT_DUMP_MSG        Dump MQTT message - set to 1 = text only, 2 = hexa only, 3 = text+hexa
  *
  * Tunable parameters:
 
  * - LOC_SERV_TIMEOUT  Connection Timeout in milliseconds (default 20 seconds)
+ * - LOC_SERV_ATTEMPT_DELAY_MS  Delay in milliseconds before starting a connection attempt to the next address of the
+ *                              server (alternating IPv6 and IPv4) while the previous ones are pending (default: 250)
+ * - LOC_SERV_ADDR_MAX  Max number of addresses of the server tried in a connection (default: 8)
+ * - LOC_DNS_CACHE_NB  Number of names kept in the resolver cache, 0 to disable the cache (default: 4)
+ * - LOC_DNS_CACHE_TTL_S  Time in seconds a resolved name is reused without a DNS query (default: 300 seconds)
+ * - LOC_DNS_NEGATIVE_TTL_S  Time in seconds a name which does not exist is not queried again (default: 30 seconds)
+ * - LOC_DNS_NAME_SZ  Max length (with the null character) of a name in the resolver cache (default: 64)
+ * - LOC_NETW_TCP_NODELAY  Set to 1 to disable the Nagle algorithm on the connection (default: 1)
+ * - LOC_NETW_TCP_KEEPIDLE_S  Idle time in seconds before the first TCP keepalive probe, 0 to disable the TCP keepalive
+ *                            (default: 10 seconds). A dead peer should be detected before the MQTT PINGREQ: the
+ *                            probes stop while data (PINGREQ) are not acknowledged.
+ * - LOC_NETW_TCP_KEEPINTVL_S  Time in seconds between two TCP keepalive probes (default: 5 seconds)
+ * - LOC_NETW_TCP_KEEPCNT  Number of TCP keepalive probes not answered before the connection is lost (default: 3)
+ * - LOC_NETW_TCP_USER_TIMEOUT_MS  Max time in milliseconds the data sent (or the keepalive probes) may stay not
+ *                                 acknowledged before the connection is lost, 0 for the system default
+ *                                 (default: 20000 milliseconds)
+ * - LOC_NETW_SOCK_SNDBUF  Size in bytes of the socket send buffer, 0 for the system default (default: 0)
+ * - LOC_NETW_SOCK_RCVBUF  Size in bytes of the socket receive buffer, 0 for the system default (default: 0)
  * - LOC_MQTT_API_KEEPALIVEINTERVAL_SEC  Period of MQTT Keepalive message (default: 30 seconds)
+ * - LOC_RUN_WAIT_MAX_MS  Max time in milliseconds the LiveObjects Client thread sleeps waiting for an event
+ *                        (received data, pushed message, keepalive) (default: 1000 milliseconds)
+ * - LOC_RUN_RETRY_MS  Delay in milliseconds before the second connection attempt (the first one is done at once),
+ *                     doubled after each failed attempt, with a random jitter (default: 1000 milliseconds)
+ * - LOC_RUN_RETRY_MAX_MS  Max delay in milliseconds between two connection attempts (default: 60000 milliseconds)
+ * - LOC_GATEWAY_WORKER_MAX  Max number of worker threads of a gateway (default: 16 threads)
  * - LOC_MQTT_DEF_COMMAND_TIMEOUT  Timeout in milliseconds to wait for a MQTT ACK/NACK response after sending MQTT request
  * - LOC_MQTT_DEF_SND_SZ  Size(in bytes) of static MQTT buffer used to send a MQTT message (default: 2 K bytes)
  * - LOC_MQTT_DEF_RCV_SZ  Size(in bytes) of static MQTT buffer used to receive a MQTT message (default: 2 K bytes)
+ * - LOC_NETW_RX_BUF_SZ  Size(in bytes) of the receive buffer of a connection, filled by large reads from the socket
+ *                       or the TLS layer, from which the MQTT packets are parsed (default: 1 K bytes)
+ * - LOC_NETW_TX_BUF_SZ  Size(in bytes) of the transmit buffer of a connection, where the MQTT packets published
+ *                       in a burst are gathered to be sent in one write, i.e. one TLS record (default: 2 K bytes,
+ *                       0 to send each packet on its own)
+ * - LOC_TLS_SESSION_RESUME  Resume the previous TLS session (session id or session ticket) when reconnecting
+ *                           to the same server, instead of a full handshake (default: 1 = enabled)
+ * - LOC_NETW_KTLS  After the TLS handshake, give the record encryption (TLS 1.2 AES-GCM) to the kernel (Linux kTLS),
+ *                  mbedtls being kept when the kernel does not support it (default: 0 = disabled)
  * - LOC_MQTT_DEF_TOPIC_NAME_SZ  Max Size(in bytes) of MQTT Topic name (default: 40 bytes)
  * - LOC_MQTT_DEF_DEV_ID_SZ  Max Size(in bytes) of Device Identifier (default: 20 bytes)
  * - LOC_MQTT_DEF_NAME_SPACE_SZ  Max Size(in bytes) o Name Space (default: 20 bytes)
- * - LOC_MQTT_DEF_PENDING_MSG_MAX  Max Number of pending MQTT Publish messages (default: 5 messages)
+ * - LOC_MQTT_INFLIGHT_MAX  Max number of messages published with QoS 1 and waiting for their PUBACK (default: 8 messages)
+ * - LOC_MQTT_DEF_PENDING_MSG_MAX  Max Number of pending MQTT Publish messages (default: 5 messages, rounded up to a power of two)
+ * - LOM_MQUEUE_POLICY  What to do when the message queue is full: 0 = reject the new message, 1 = release the oldest message,
+ *                      2 = wait for a free slot (default: 0, see LiveObjectsD_MqPolicy_t)
+ * - LOM_MQUEUE_TIMEOUT_MS  Max time in milliseconds to wait for a free slot in the message queue (default: 100 milliseconds)
+ * - LOM_MSG_POOL_NB  Number of blocks in each size class of the pool of queued messages, 0 to always allocate them
+ *                    from the heap (default: 8 blocks)
+ * - LOC_STORE_SEGMENT_SZ  Size (in bytes) of a segment file of the store of data messages published while disconnected
+ *                         (default: 64 K bytes)
+ * - LOC_STORE_MAX_SZ  Default max disk usage (in bytes) of this store (default: 1 M bytes)
+ * - LOC_STORE_REPLAY_RATE  Max number of stored messages published per second after the reconnection (default: 20 messages)
+ * - LOC_STORE_REPLAY_BURST  Max number of stored messages published at once (default: 5 messages)
  * - LOC_MAX_OF_COMMAND_ARGS  Max Number of arguments in command (default: 5 arguments)
  * - LOC_MAX_OF_DATA_SET  Max Number of collected data streams (or also named 'data sets')  (default: 5 data streams)
  * - LOC_MAX_OF_STATUS_SET  Max Number of status/info sets (default: 1 status set)
+ * - LOC_STATUS_RESYNC_MS  Delta mode of the status/info sets: only the changed elements are published, and all of them
+ *                         at least every LOC_STATUS_RESYNC_MS milliseconds (default: 0 = disabled, see
+ *                         LiveObjectsClient_SetStatusDelta)
  * - LOC_MAX_OF_PARSED_PARAMS Max Number of parsed parameters in a same received update param request (default: 5)
  * - LOM_JSON_BUF_SZ  Size (in bytes) of static JSON buffer used to encode the JSON payload to be sent (default: 1 K bytes)
- * - LOM_JSON_BUF_USER_SZ  Size (in bytes) of static JSON buffer used to encode a user JSON payload (default: 200 bytes)
+ * - LOM_JSON_BUF_USER_SZ  Max size (in bytes) of a JSON payload encoded by a user thread, directly in a message of the pool
+ *                         (default: 1 K bytes)
  *
  *
  * - LOM_SETOFDATA_STREAM_ID_SZ Max Size(in bytes) of Data Stream Id (default: 80 bytes)
@@ -78,17 +128,90 @@
 #ifndef LOC_FEATURE_LO_RESOURCES
 #define LOC_FEATURE_LO_RESOURCES             1
 #endif
+#ifndef LOC_FEATURE_CBOR
+#define LOC_FEATURE_CBOR                     1
+#endif
 
 /** Connection Timeout in milliseconds */
 #ifndef LOC_SERV_TIMEOUT
 #define LOC_SERV_TIMEOUT                     20000
 #endif
 
+#ifndef LOC_SERV_ATTEMPT_DELAY_MS
+#define LOC_SERV_ATTEMPT_DELAY_MS            250
+#endif
+
+#ifndef LOC_SERV_ADDR_MAX
+#define LOC_SERV_ADDR_MAX                    8
+#endif
+
+/* Resolver cache */
+#ifndef LOC_DNS_CACHE_NB
+#define LOC_DNS_CACHE_NB                     4
+#endif
+
+#ifndef LOC_DNS_CACHE_TTL_S
+#define LOC_DNS_CACHE_TTL_S                  300
+#endif
+
+#ifndef LOC_DNS_NEGATIVE_TTL_S
+#define LOC_DNS_NEGATIVE_TTL_S               30
+#endif
+
+#ifndef LOC_DNS_NAME_SZ
+#define LOC_DNS_NAME_SZ                      64
+#endif
+
+/* Socket options of the connection */
+#ifndef LOC_NETW_TCP_NODELAY
+#define LOC_NETW_TCP_NODELAY                 1
+#endif
+
+#ifndef LOC_NETW_TCP_KEEPIDLE_S
+#define LOC_NETW_TCP_KEEPIDLE_S              10
+#endif
+
+#ifndef LOC_NETW_TCP_KEEPINTVL_S
+#define LOC_NETW_TCP_KEEPINTVL_S             5
+#endif
+
+#ifndef LOC_NETW_TCP_KEEPCNT
+#define LOC_NETW_TCP_KEEPCNT                 3
+#endif
+
+#ifndef LOC_NETW_TCP_USER_TIMEOUT_MS
+#define LOC_NETW_TCP_USER_TIMEOUT_MS         20000
+#endif
+
+#ifndef LOC_NETW_SOCK_SNDBUF
+#define LOC_NETW_SOCK_SNDBUF                 0
+#endif
+
+#ifndef LOC_NETW_SOCK_RCVBUF
+#define LOC_NETW_SOCK_RCVBUF                 0
+#endif
+
 /* MQTT Default parameters */
 #ifndef LOC_MQTT_API_KEEPALIVEINTERVAL_SEC
 #define LOC_MQTT_API_KEEPALIVEINTERVAL_SEC   30
 #endif
 
+#ifndef LOC_RUN_WAIT_MAX_MS
+#define LOC_RUN_WAIT_MAX_MS                  1000
+#endif
+
+#ifndef LOC_RUN_RETRY_MS
+#define LOC_RUN_RETRY_MS                     1000
+#endif
+
+#ifndef LOC_RUN_RETRY_MAX_MS
+#define LOC_RUN_RETRY_MAX_MS                 60000
+#endif
+
+#ifndef LOC_GATEWAY_WORKER_MAX
+#define LOC_GATEWAY_WORKER_MAX               16
+#endif
+
 #ifndef LOC_MQTT_DEF_COMMAND_TIMEOUT
 #define LOC_MQTT_DEF_COMMAND_TIMEOUT         5000
 #endif
@@ -101,6 +224,22 @@
 #define LOC_MQTT_DEF_RCV_SZ                  (1024*2)
 #endif
 
+#ifndef LOC_NETW_RX_BUF_SZ
+#define LOC_NETW_RX_BUF_SZ                   1024
+#endif
+
+#ifndef LOC_NETW_TX_BUF_SZ
+#define LOC_NETW_TX_BUF_SZ                   2048
+#endif
+
+#ifndef LOC_TLS_SESSION_RESUME
+#define LOC_TLS_SESSION_RESUME               1
+#endif
+
+#ifndef LOC_NETW_KTLS
+#define LOC_NETW_KTLS                        0
+#endif
+
 #ifndef LOC_MQTT_DEF_TOPIC_NAME_SZ
 #define LOC_MQTT_DEF_TOPIC_NAME_SZ           40
 #endif
@@ -113,10 +252,42 @@
 #define LOC_MQTT_DEF_NAME_SPACE_SZ           20
 #endif
 
+#ifndef LOC_MQTT_INFLIGHT_MAX
+#define LOC_MQTT_INFLIGHT_MAX                8
+#endif
+
 #ifndef LOC_MQTT_DEF_PENDING_MSG_MAX
 #define LOC_MQTT_DEF_PENDING_MSG_MAX         5
 #endif
 
+#ifndef LOM_MQUEUE_POLICY
+#define LOM_MQUEUE_POLICY                    0
+#endif
+
+#ifndef LOM_MQUEUE_TIMEOUT_MS
+#define LOM_MQUEUE_TIMEOUT_MS                100
+#endif
+
+#ifndef LOM_MSG_POOL_NB
+#define LOM_MSG_POOL_NB                      8
+#endif
+
+#ifndef LOC_STORE_SEGMENT_SZ
+#define LOC_STORE_SEGMENT_SZ                 (1024*64)
+#endif
+
+#ifndef LOC_STORE_MAX_SZ
+#define LOC_STORE_MAX_SZ                     (1024*1024)
+#endif
+
+#ifndef LOC_STORE_REPLAY_RATE
+#define LOC_STORE_REPLAY_RATE                20
+#endif
+
+#ifndef LOC_STORE_REPLAY_BURST
+#define LOC_STORE_REPLAY_BURST               5
+#endif
+
 #ifndef LOC_MAX_OF_COMMAND_ARGS
 #define LOC_MAX_OF_COMMAND_ARGS              5
 #endif
@@ -129,6 +300,10 @@
 #define LOC_MAX_OF_STATUS_SET                1
 #endif
 
+#ifndef LOC_STATUS_RESYNC_MS
+#define LOC_STATUS_RESYNC_MS                 0
+#endif
+
 #ifndef LOC_MAX_OF_PARSED_PARAMS
 #define LOC_MAX_OF_PARSED_PARAMS             5
 #endif
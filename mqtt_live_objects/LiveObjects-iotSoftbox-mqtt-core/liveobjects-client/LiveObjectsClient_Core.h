@@ -59,7 +59,8 @@ int LiveObjectsClient_CheckApiKey(const char* apikey);
 void LiveObjectsClient_InitDbgTrace(lotrace_level_t level);
 
 /**
- * @brief Initialize the LiveObjects Client Instance (only one instance on board)
+ * @brief Initialize the default LiveObjects Client Instance
+ *        (see LiveObjectsClient_Instance.h to run several instances).
  *        This should always be called first.
  *
  * @return 0 if successful, otherwise a negative value when occur occurs.
@@ -108,14 +109,78 @@ int LiveObjectsClient_DnsResolve(void);
  *   This should be called before the LiveObjectsClient_Connect() function.
  *
  * @param domain_name       Domain name (FQDN).
- * @param ip_address        IP (v4) Address.
+ * @param ip_address        IP (v4 or v6) Address, used instead of a DNS query until the next call for this name.
  *
- * @note If IPV4 Address is NULL, the DNS resolver will be called to resolve the IP address.
+ * @note If IP Address is NULL, the DNS resolver is called now to resolve the IP address, kept in the resolver cache
+ *       (see LOC_DNS_CACHE_NB) and reused by the next connections during LOC_DNS_CACHE_TTL_S seconds.
  *
  * @return 0 if successful, otherwise a negative value when occur occurs.
  */
 int LiveObjectsClient_DnsSetFQDN(const char* domain_name, const char* ip_address);
 
+/**
+ * @brief Set the parameters of the queue of messages published by the user threads
+ *        (see LOC_MQTT_DEF_PENDING_MSG_MAX, LOM_MQUEUE_POLICY and LOM_MQUEUE_TIMEOUT_MS).
+ *   The capacity is applied by the next call to LiveObjectsClient_Init().
+ *   The overflow policy and the timeout can be changed at any time.
+ *
+ * @param capacity          Max number of pending messages (rounded up to a power of two).
+ * @param policy            What to do when the queue is full.
+ * @param timeout_ms        Max time (in milliseconds) to wait for a free slot with the LOD_MQ_BLOCK policy.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_SetQueueParams(uint32_t capacity, LiveObjectsD_MqPolicy_t policy, uint32_t timeout_ms);
+
+/**
+ * @brief Set the delays between the connection attempts (see LOC_RUN_RETRY_MS).
+ *   The first attempt after a disconnection is done at once, then the delay is doubled
+ *   after each failed attempt, up to max_delay_ms, with a random jitter of half of the delay.
+ *
+ * @param delay_ms          Delay (in milliseconds) before the second attempt.
+ * @param max_delay_ms      Max delay (in milliseconds).
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_SetRetryParams(uint32_t delay_ms, uint32_t max_delay_ms);
+
+/**
+ * @brief Notify that the network is back (i.e. interface up, new address...):
+ *        when the client is waiting for its next connection attempt, this attempt is done at once.
+ *   On Linux, the changes of the network interfaces are also detected by the client itself.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_NetworkChanged(void);
+
+/**
+ * @brief Set the directory of the store of the data messages pushed while the client is disconnected
+ *        (see LOC_STORE_SEGMENT_SZ). They are published again, in order, after the reconnection,
+ *        at most LOC_STORE_REPLAY_RATE messages per second.
+ *   The messages still stored when the process is stopped are published after the next start.
+ *   When the max disk usage is reached, the oldest messages are dropped.
+ *
+ * @param dir               Directory of the segment files (created if needed).
+ * @param max_bytes         Max disk usage (in bytes), 0 to use LOC_STORE_MAX_SZ.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_SetStore(const char* dir, uint32_t max_bytes);
+
+/**
+ * @brief Set the file where the TLS session is saved after each handshake (see LOC_TLS_SESSION_RESUME),
+ *        so that the session is also resumed after a restart of the process.
+ *   This should be called after LiveObjectsClient_Init(): the session already saved in this file
+ *   (if any) is loaded.
+ *
+ * @param path              Path of the file (copied, at most 127 characters), NULL to stop saving the session.
+ *
+ * @note The file holds the master secret of the session, it is only readable by the user.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_SetTlsSessionFile(const char* path);
+
 /* @} group end : Init */
 
 /* ================================================================== */
@@ -396,6 +461,89 @@ int LiveObjectsClient_PushStatus(int handle);
  */
 int LiveObjectsClient_PushData(int handle);
 
+/**
+ * @brief Gather the samples of a set of 'collected data' in messages of up to batch_size samples:
+ *        each LiveObjectsClient_PushData() adds the current values, with their timestamp, to the
+ *        current message, and the stream-id, model and tags are published once per message:
+ *        {"s":..,"m":..,"t":[..],"samples":[{"ts":..,"loc":[..],"v":{..}},..]}.
+ *   The message is published when it holds batch_size samples, when the next sample does not fit in it
+ *   (LOM_JSON_BUF_USER_SZ), or linger_ms after its first sample.
+ *   Batching is disabled by default (opt-in, per data set).
+ *
+ * @note A batched message is not a standard 'dev/data' message: LiveObjects stores it as one record,
+ *   with the samples in its "samples" field. The server side (a decoder, or a data processing rule) must
+ *   split it into timestamped samples.
+ *
+ * @param handle      Handle of collected data set
+ * @param batch_size  Max number of samples in a message, 0 or 1 to publish each sample in its own message.
+ * @param linger_ms   Max time (in milliseconds) a sample waits before its message is published.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_SetDataBatch(int handle, uint32_t batch_size, uint32_t linger_ms);
+
+/**
+ * @brief Select the encoding of the messages of a set of 'collected data': JSON text (default),
+ *        or CBOR (binary, same structure). A CBOR message is not batched (see LiveObjectsClient_SetDataBatch),
+ *        and the floating-point values are encoded without rounding (data_prec is not used).
+ *
+ * @param handle      Handle of collected data set
+ * @param encoding    LOD_ENCODING_JSON or LOD_ENCODING_CBOR
+ *
+ * @return 0 if successful, otherwise a negative value (i.e. CBOR not supported: LOC_FEATURE_CBOR set to 0).
+ */
+int LiveObjectsClient_SetDataEncoding(int handle, LiveObjectsD_Encoding_t encoding);
+
+/**
+ * @brief Encode the values ("v" section) of the JSON messages of a set of 'collected data' with a user function,
+ *        instead of the table of data elements. The CBOR messages are still encoded from the table.
+ *
+ * @param handle      Handle of collected data set
+ * @param encoder     User function, or NULL to encode from the table again.
+ * @param ctx         User context given to the function.
+ *
+ * @return 0 if successful, otherwise a negative value.
+ */
+int LiveObjectsClient_SetDataEncoder(int handle, LiveObjectsD_DataEncoder_t encoder, void* ctx);
+
+/**
+ * @brief Select the encoding of the messages of a set of 'status/info': JSON text (default), or CBOR.
+ *
+ * @param handle      Handle of status set
+ * @param encoding    LOD_ENCODING_JSON or LOD_ENCODING_CBOR
+ *
+ * @return 0 if successful, otherwise a negative value.
+ */
+int LiveObjectsClient_SetStatusEncoding(int handle, LiveObjectsD_Encoding_t encoding);
+
+/**
+ * @brief Publish only the changed elements of a set of 'status/info' (delta mode).
+ *        A copy of the last published values is kept (a hash for a string): each LiveObjectsClient_PushStatus()
+ *        publishes the elements changed since then, or nothing if none changed. All the elements are published
+ *        after a reconnection, after a message not published, and at least every resync_ms.
+ *
+ * @param handle      Handle of status set
+ * @param resync_ms   Max time (in milliseconds) between two messages with all the elements,
+ *                    0 to disable the delta mode (all the elements in each message, default: LOC_STATUS_RESYNC_MS).
+ *
+ * @return 0 if successful, otherwise a negative value.
+ */
+int LiveObjectsClient_SetStatusDelta(int handle, uint32_t resync_ms);
+
+/**
+ * @brief Request to publish one set of 'collected data' to LiveObjects server with QoS 1 (at least once).
+ *        The message is queued and published by the LiveObjects Client thread without waiting for its
+ *        acknowledgement: up to LOC_MQTT_INFLIGHT_MAX messages wait for their PUBACK at the same time.
+ *        Not acknowledged messages are sent again after a reconnection.
+ *
+ * @param handle      Handle of collected data set
+ * @param callback    User callback function, called when the message is acknowledged or released (or NULL).
+ * @param msg_ctx     User context given to the callback function.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_PushDataQos1(int handle, LiveObjectsD_CallbackPubAck_t callback, void* msg_ctx);
+
 /**
  * @brief Request to publish the set of configuration parameters to LiveObjects server.
  *
@@ -457,8 +605,101 @@ int LiveObjectsClient_CommandResponse(int32_t cid,
  */
 int LiveObjectsClient_Publish(const char* topic_name, const char* payload_data);
 
+/**
+ * @brief Publish a payload (JSON message) onto the topic toward a LiveObjects platform with QoS 1 (at least once).
+ *        See LiveObjectsClient_PushDataQos1().
+ *
+ * @param topic_name   Pointer to a c-string specifying the MQTT topic.
+ * @param payload_data Pointer to a c-string containing the user payload (JSON text message).
+ * @param callback     User callback function, called when the message is acknowledged or released (or NULL).
+ * @param msg_ctx      User context given to the callback function.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_PublishQos1(const char* topic_name, const char* payload_data,
+		LiveObjectsD_CallbackPubAck_t callback, void* msg_ctx);
+
 /* @} group end : Async */
 
+/* ================================================================== */
+/**
+ * \addtogroup  Stats Statistics
+ *
+ * This section describes functions to get some statistics of the LiveObjects Client.
+ * @{
+ */
+
+/**
+ * @brief Get the statistics of the queue of messages published by the user threads.
+ *
+ * @param stats        Pointer to the structure to be filled.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_GetQueueStats(LiveObjectsD_MqStats_t* stats);
+
+/**
+ * @brief Get the statistics of the messages published with QoS 1 and waiting for their acknowledgement.
+ *
+ * @param stats        Pointer to the structure to be filled.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_GetInflightStats(LiveObjectsD_InflightStats_t* stats);
+
+/**
+ * @brief Get the statistics of the store of the data messages pushed while disconnected:
+ *        disk usage, backlog, and drain rate.
+ *
+ * @param stats        Pointer to the structure to be filled.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs (no store).
+ */
+int LiveObjectsClient_GetStoreStats(LiveObjectsD_StoreStats_t* stats);
+
+/**
+ * @brief Get the statistics of the batching of a set of 'collected data': messages, samples,
+ *        fill ratio and bytes per sample.
+ *
+ * @param handle       Handle of collected data set
+ * @param stats        Pointer to the structure to be filled.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_GetDataBatchStats(int handle, LiveObjectsD_BatchStats_t* stats);
+
+/**
+ * @brief Get the statistics of the reconnections: attempts, failures, histogram of
+ *        the times to reconnect (from the loss of the connection to the next MQTT connection),
+ *        and durations of the phases (DNS, TCP, TLS, MQTT CONNECT) of the last attempt.
+ *
+ * @param stats        Pointer to the structure to be filled.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_GetReconnectStats(LiveObjectsD_ReconnectStats_t* stats);
+
+/**
+ * @brief Get the statistics of the TLS handshakes: number and duration of the full handshakes,
+ *        and of those resuming the previous session.
+ *
+ * @param stats        Pointer to the structure to be filled.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_GetTlsStats(LiveObjectsD_TlsStats_t* stats);
+
+/**
+ * @brief Get the statistics of the pool of blocks used by the queued messages.
+ *
+ * @param stats        Pointer to the structure to be filled.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsClient_GetPoolStats(LiveObjectsD_PoolStats_t* stats);
+
+/* @} group end : Stats */
+
 #if defined(__cplusplus)
 }
 #endif
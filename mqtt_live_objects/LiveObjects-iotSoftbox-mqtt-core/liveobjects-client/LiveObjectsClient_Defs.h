@@ -50,6 +50,21 @@ typedef enum {
 	LOD_TYPE_MAX_NOT_USED
 } LiveObjectsD_Type_t;
 
+/**
+ * @brief Precision policy of a floating-point user data (LOD_TYPE_FLOAT or LOD_TYPE_DOUBLE)
+ *
+ * A positive value N rounds the value to (at most) N decimal places.
+ */
+#define LOD_PREC_SHORTEST   0   /*!< Shortest representation that reads back to the same value (default) */
+
+/**
+ * @brief Encoding of the payload of the messages of a data set (or a status set)
+ */
+typedef enum {
+	LOD_ENCODING_JSON = 0,    /*!< JSON text (default) */
+	LOD_ENCODING_CBOR         /*!< CBOR (RFC 8949) binary encoding, same structure as the JSON message */
+} LiveObjectsD_Encoding_t;
+
 /**
  * @brief Define an user data (item) to build a JSON format
  */
@@ -57,7 +72,8 @@ typedef struct {
 	LiveObjectsD_Type_t data_type;  /*!< Type of user data */
 	const char*         data_name;  /*!< Name of user data (used as the JSON name) */
 	void*               data_value; /*!< Pointer to the user data (single value or array) */
-	int8_t              data_dim;   /*!< Number of values (array) */
+	int8_t              data_dim;   /*!< Number of values (array), LOD_TYPE_STRING_C: one string whatever data_dim */
+	int8_t              data_prec;  /*!< Precision policy of a floating-point value: LOD_PREC_SHORTEST or number of decimal places */
 } LiveObjectsD_Data_t;
 
 /**
@@ -142,6 +158,147 @@ typedef enum {
 	CSTATE_DOWN               /*!< Client Thread is down or stopped */
 } LiveObjectsD_State_t;
 
+/**
+ * @brief  Overflow policy of the queue of messages published by the user threads
+ */
+typedef enum {
+	LOD_MQ_DROP_NEWEST = 0,   /*!< The new message is rejected */
+	LOD_MQ_DROP_OLDEST,       /*!< The oldest pending message is released to accept the new one */
+	LOD_MQ_BLOCK              /*!< The caller waits for a free slot, up to a given timeout */
+} LiveObjectsD_MqPolicy_t;
+
+/**
+ * @brief  Statistics of the queue of messages published by the user threads
+ */
+typedef struct {
+	uint32_t mq_capacity;     /*!< Max number of pending messages */
+	uint32_t mq_depth;        /*!< Current number of pending messages */
+	uint32_t mq_high_water;   /*!< Highest number of pending messages */
+	uint32_t mq_put;          /*!< Number of messages put in the queue */
+	uint32_t mq_dropped;      /*!< Number of messages dropped because the queue was full */
+} LiveObjectsD_MqStats_t;
+
+/**
+ * @brief  Statistics of the messages published with QoS 1, waiting for their PUBACK (in-flight window)
+ */
+typedef struct {
+	uint32_t inf_window;         /*!< Max number of in-flight messages (LOC_MQTT_INFLIGHT_MAX) */
+	uint32_t inf_depth;          /*!< Current number of in-flight messages */
+	uint32_t inf_high_water;     /*!< Highest number of in-flight messages */
+	uint32_t inf_acked;          /*!< Number of messages acknowledged by the LiveObjects server */
+	uint32_t inf_retransmitted;  /*!< Number of messages sent again after a reconnection */
+	uint32_t inf_dropped;        /*!< Number of messages released without acknowledgement */
+} LiveObjectsD_InflightStats_t;
+
+/**
+ * @brief  Statistics of the store of data messages published while the client is disconnected (store and forward)
+ */
+typedef struct {
+	uint32_t st_disk_max;        /*!< Max disk usage (in bytes) */
+	uint32_t st_disk_used;       /*!< Current disk usage (in bytes), the segment files */
+	uint32_t st_segments;        /*!< Current number of segment files */
+	uint32_t st_backlog;         /*!< Number of stored messages, not yet published */
+	uint32_t st_backlog_bytes;   /*!< Size (in bytes) of the stored messages, not yet published */
+	uint32_t st_stored;          /*!< Number of messages stored */
+	uint32_t st_replayed;        /*!< Number of stored messages published */
+	uint32_t st_dropped;         /*!< Number of stored messages released because the max disk usage was reached */
+	uint32_t st_corrupt;         /*!< Number of stored messages lost because a record was corrupted */
+	uint32_t st_drain_rate;      /*!< Number of stored messages published during the last second */
+} LiveObjectsD_StoreStats_t;
+
+/**
+ * @brief  Statistics of the batching of the samples of a collected data set (see LiveObjectsClient_SetDataBatch)
+ */
+typedef struct {
+	uint32_t bt_size;            /*!< Max number of samples in a message (batch_size) */
+	uint32_t bt_messages;        /*!< Number of messages published */
+	uint32_t bt_samples;         /*!< Number of samples in these messages */
+	uint32_t bt_bytes;           /*!< Size (in bytes) of these messages */
+	uint32_t bt_by_linger;       /*!< Number of messages published because linger_ms elapsed */
+	uint32_t bt_by_room;         /*!< Number of messages published because the next sample did not fit */
+	uint32_t bt_dropped;         /*!< Number of samples lost */
+	uint32_t bt_fill_pct;        /*!< Average fill ratio of the messages (in percent of batch_size) */
+	uint32_t bt_bytes_per_sample; /*!< Average size (in bytes) of a sample in the messages, envelope included */
+} LiveObjectsD_BatchStats_t;
+
+/**
+ * @brief  Statistics of the TLS handshakes of a client: full handshakes, and abbreviated ones
+ *         (session resumed, with a session id or a session ticket)
+ */
+typedef struct {
+	uint32_t tls_full;            /*!< Number of full handshakes */
+	uint32_t tls_full_ms;         /*!< Total duration (in milliseconds) of the full handshakes */
+	uint32_t tls_full_last_ms;    /*!< Duration (in milliseconds) of the last full handshake */
+	uint32_t tls_resumed;         /*!< Number of handshakes resuming the previous session */
+	uint32_t tls_resumed_ms;      /*!< Total duration (in milliseconds) of these handshakes */
+	uint32_t tls_resumed_last_ms; /*!< Duration (in milliseconds) of the last one */
+	uint32_t tls_failed;          /*!< Number of failed handshakes */
+	uint32_t tls_ktls;            /*!< Number of connections where the kernel encrypts the records (kTLS) */
+} LiveObjectsD_TlsStats_t;
+
+/** Number of buckets of the histogram of the times to reconnect */
+#define LOD_RECONNECT_HIST_NB   12
+
+/**
+ * @brief  Statistics of the connection attempts of a client
+ */
+typedef struct {
+	uint32_t rc_attempts;        /*!< Number of connection attempts */
+	uint32_t rc_failures;        /*!< Number of failed attempts */
+	uint32_t rc_reconnects;      /*!< Number of connections after a disconnection */
+	uint32_t rc_last_ms;         /*!< Time (in milliseconds) from the last disconnection to the connection */
+	uint32_t rc_max_ms;          /*!< Longest time (in milliseconds) to reconnect */
+	uint32_t rc_next_ms;         /*!< Delay (in milliseconds) before the next attempt, 0 if connected */
+	uint32_t rc_hist[LOD_RECONNECT_HIST_NB]; /*!< Times to reconnect: rc_hist[0] counts those shorter than 125 ms,
+	                                              rc_hist[i] those from (125 << (i-1)) to (125 << i) ms,
+	                                              and the last bucket the longer ones */
+	uint32_t rc_dns_ms;          /*!< Duration (in milliseconds) of the DNS resolution in the last attempt */
+	uint32_t rc_tcp_ms;          /*!< Duration (in milliseconds) of the TCP connection in the last attempt */
+	uint32_t rc_tls_ms;          /*!< Duration (in milliseconds) of the TLS handshake in the last attempt */
+	uint32_t rc_mqtt_ms;         /*!< Duration (in milliseconds) of the MQTT CONNECT in the last attempt */
+} LiveObjectsD_ReconnectStats_t;
+
+/**
+ * @brief  Number of block size classes in the pool of messages
+ */
+#define LOD_POOL_CLASS_NB         3
+
+/**
+ * @brief  Statistics of one class of blocks in the pool of messages
+ */
+typedef struct {
+	uint32_t blk_sz;          /*!< Size (in bytes) of a block */
+	uint32_t blk_nb;          /*!< Number of blocks */
+	uint32_t blk_in_use;      /*!< Current number of allocated blocks */
+	uint32_t blk_peak;        /*!< Highest number of allocated blocks */
+	uint32_t blk_alloc;       /*!< Number of allocations served by this class */
+} LiveObjectsD_PoolClassStats_t;
+
+/**
+ * @brief  Statistics of the pool of messages
+ */
+typedef struct {
+	LiveObjectsD_PoolClassStats_t pool_class[LOD_POOL_CLASS_NB]; /*!< Statistics of each class, from the smallest */
+	uint32_t pool_heap_alloc;   /*!< Number of messages allocated from the heap (pool exhausted or message too large) */
+	uint32_t pool_heap_in_use;  /*!< Current number of messages allocated from the heap */
+	uint32_t pool_failures;     /*!< Number of allocation failures */
+} LiveObjectsD_PoolStats_t;
+
+/**
+ * @brief  Statistics of a gateway, summed over all its worker threads
+ */
+typedef struct {
+	uint32_t gw_workers;        /*!< Number of worker threads */
+	uint32_t gw_sessions;       /*!< Number of attached LiveObjects Client instances */
+	uint32_t gw_connected;      /*!< Number of instances connected to the LiveObjects server */
+	uint32_t gw_elapsed_ms;     /*!< Time elapsed since the gateway is started, in milliseconds */
+	uint32_t gw_published;      /*!< Number of MQTT messages published */
+	uint32_t gw_received;       /*!< Number of MQTT messages received */
+	uint32_t gw_steps;          /*!< Number of steps (processing of one instance after an event) */
+	uint32_t gw_step_avg_us;    /*!< Average duration of a step, in microseconds */
+	uint32_t gw_step_max_us;    /*!< Longest step (connection included), in microseconds */
+} LiveObjectsD_GatewayStats_t;
+
 /**
  * @brief  Prototype of a user callback function called to notify the LiveObjects Client state changes.
  *
@@ -149,6 +306,29 @@ typedef enum {
  */
 typedef void (*LiveObjectsD_CallbackState_t)(LiveObjectsD_State_t state);
 
+/**
+ * @brief  Prototype of a user callback function called when a message published with QoS 1 is completed.
+ *         It is called by the LiveObjects Client thread.
+ *
+ * @param msg_ctx   User context given with the message.
+ * @param result    0: acknowledged by the LiveObjects server (PUBACK),
+ *                  otherwise a negative value: released without acknowledgement (queue full, instance destroyed).
+ */
+typedef void (*LiveObjectsD_CallbackPubAck_t)(void* msg_ctx, int result);
+
+/**
+ * @brief  Prototype of a user function encoding the values of a set of 'collected data'
+ *         (i.e. generated for the typed data sets of liveobjects_iotsoftbox_data.hpp).
+ *         It is called each time the data set is encoded in JSON.
+ *
+ * @param ctx   User context given with the function.
+ * @param buf   Output buffer: JSON object of the "v" section, {"name":value,...}, null-terminated.
+ * @param sz    Size of the output buffer.
+ *
+ * @return the length of the JSON object, or a negative value if it does not fit in the buffer.
+ */
+typedef int (*LiveObjectsD_DataEncoder_t)(void* ctx, char* buf, uint32_t sz);
+
 /**
  * @brief  Type of a user callback function linked to a set of configuration parameters.
  *         This function will be called when user configuration parameter must be
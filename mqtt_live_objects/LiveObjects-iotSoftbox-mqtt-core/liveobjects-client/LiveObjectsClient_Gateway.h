@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file  LiveObjectsClient_Gateway.h
+ * @brief Live Objects Client Interface to run many client instances (devices) in one process
+ *
+ * A gateway runs a fixed pool of worker threads (by default, one per CPU core). Each worker
+ * waits for the events of a shard of instances (data received, message pushed, timers) and
+ * processes the instances which are ready, one after the other.
+ * The instances with the same security parameters share one TLS configuration (parsed
+ * certificates).
+ *
+ * The instances are created and initialized with the LiveObjectsInstance_xxx() functions
+ * (see LiveObjectsClient_Instance.h), then attached to the gateway instead of being started
+ * with LiveObjectsInstance_ThreadStart().
+ * An instance is stopped with LiveObjectsInstance_Stop(), and can be destroyed when
+ * LiveObjectsInstance_ThreadState() returns -2.
+ *
+ * Limitation: a worker connects its instances synchronously. While it establishes the TCP
+ * connection (up to LOC_SERV_TIMEOUT), runs the TLS handshake and waits for the MQTT CONNACK
+ * (up to LOC_MQTT_DEF_COMMAND_TIMEOUT), the other instances of its shard are not processed.
+ * When many instances (re)connect at the same time, e.g. after a network outage, use more
+ * workers than CPU cores, or a shorter LOC_SERV_TIMEOUT.
+ */
+
+#ifndef __LiveObjectsClient_Gateway_H_
+#define __LiveObjectsClient_Gateway_H_
+
+#include <stdint.h>
+
+#include "liveobjects-client/LiveObjectsClient_Defs.h"
+#include "liveobjects-client/LiveObjectsClient_Instance.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/** Opaque handle of a gateway */
+typedef struct LiveObjectsGateway LiveObjectsGateway_t;
+
+/* ================================================================== */
+/**
+ * * \addtogroup Gateway  Gateway of Client Instances
+ *
+ * This section describes functions to run many LiveObjects Client instances with a pool of threads.
+ * @{
+ */
+
+/**
+ * @brief Create a gateway.
+ *
+ * @param worker_nb    Number of worker threads, 0 for one thread per CPU core
+ *                     (limited to LOC_GATEWAY_WORKER_MAX).
+ *
+ * @return the new gateway, or NULL when occur occurs.
+ */
+LiveObjectsGateway_t* LiveObjectsGateway_Create(uint32_t worker_nb);
+
+/**
+ * @brief Start the worker threads of the gateway.
+ *
+ * @param gw           Gateway.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsGateway_Start(LiveObjectsGateway_t* gw);
+
+/**
+ * @brief Attach an initialized LiveObjects Client instance to the least loaded worker.
+ *        The worker connects the instance and keeps it connected until it is stopped.
+ *
+ * @param gw           Gateway.
+ * @param loc          LiveObjects Client instance, initialized by LiveObjectsInstance_Init() and not running.
+ * @param callback     User callback function, called when the state of the instance changes (or NULL).
+ *
+ * @return the index of the worker (>= 0) if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsGateway_Attach(LiveObjectsGateway_t* gw, LiveObjectsClient_t* loc,
+		LiveObjectsD_CallbackState_t callback);
+
+/**
+ * @brief Request to stop all the attached instances and the worker threads.
+ *
+ * @param gw           Gateway.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsGateway_Stop(LiveObjectsGateway_t* gw);
+
+/**
+ * @brief Wait for the end of the worker threads (after LiveObjectsGateway_Stop) and release the gateway.
+ *
+ * @param gw           Gateway.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsGateway_Destroy(LiveObjectsGateway_t* gw);
+
+/**
+ * @brief Get the statistics of the gateway (summed over all its worker threads).
+ *
+ * @param gw           Gateway.
+ * @param stats        Pointer to the structure to be filled.
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsGateway_GetStats(LiveObjectsGateway_t* gw, LiveObjectsD_GatewayStats_t* stats);
+
+/* @} group end : Gateway */
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __LiveObjectsClient_Gateway_H_ */
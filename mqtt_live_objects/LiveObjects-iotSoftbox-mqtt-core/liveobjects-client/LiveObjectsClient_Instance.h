@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file  LiveObjectsClient_Instance.h
+ * @brief Live Objects Client Interface with several client instances in the same process
+ *
+ * Each instance owns its device identifier, its sets of data, its MQTT/TLS session,
+ * its queue of messages and its thread. The LiveObjectsClient_xxx() functions of
+ * LiveObjectsClient_Core.h operate on the default instance (see LiveObjectsInstance_Default()).
+ *
+ * The following functions are shared by all instances: LiveObjectsClient_CheckApiKey,
+ * LiveObjectsClient_InitDbgTrace, LiveObjectsClient_SetDbgLevel, LiveObjectsClient_SetDbgMsgDump,
+ * LiveObjectsClient_DnsResolve, LiveObjectsClient_DnsSetFQDN and LiveObjectsClient_GetPoolStats.
+ */
+
+#ifndef __LiveObjectsClient_Instance_H_
+#define __LiveObjectsClient_Instance_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "liveobjects-client/LiveObjectsClient_Defs.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/** Opaque handle of a LiveObjects Client instance */
+typedef struct LiveObjectsClient LiveObjectsClient_t;
+
+/* ================================================================== */
+/**
+ * * \addtogroup Instance  Client Instances
+ *
+ * This section describes functions to create and release a LiveObjects Client instance.
+ * @{
+ */
+
+/**
+ * @brief Create a new LiveObjects Client instance, with the default parameters.
+ *        LiveObjectsInstance_Init() has to be called before using it.
+ *
+ * @return the new instance, or NULL when occur occurs.
+ */
+LiveObjectsClient_t* LiveObjectsInstance_Create(void);
+
+/**
+ * @brief Disconnect and release a LiveObjects Client instance.
+ *        The default instance is only reset to the default parameters.
+ *
+ * @param loc          LiveObjects Client instance (its thread must be stopped).
+ *
+ * @return 0 if successful, otherwise a negative value when occur occurs.
+ */
+int LiveObjectsInstance_Destroy(LiveObjectsClient_t* loc);
+
+/**
+ * @brief Return the default instance, used by the LiveObjectsClient_xxx() functions.
+ */
+LiveObjectsClient_t* LiveObjectsInstance_Default(void);
+
+/* @} group end : Instance */
+
+/* ================================================================== */
+/**
+ * * \addtogroup InstanceApi  Operations on a Client Instance
+ *
+ * Same behavior as the LiveObjectsClient_xxx() function with the same name,
+ * applied to the given instance.
+ * @{
+ */
+
+int LiveObjectsInstance_Init(LiveObjectsClient_t* loc, void* network_itf_handle,
+		unsigned long long apikey_p1, unsigned long long apikey_p2);
+
+int LiveObjectsInstance_SetDevId(LiveObjectsClient_t* loc, const char* dev_id);
+
+int LiveObjectsInstance_SetNameSpace(LiveObjectsClient_t* loc, const char* name_space);
+
+int LiveObjectsInstance_SetQueueParams(LiveObjectsClient_t* loc, uint32_t capacity,
+		LiveObjectsD_MqPolicy_t policy, uint32_t timeout_ms);
+
+int LiveObjectsInstance_SetRetryParams(LiveObjectsClient_t* loc, uint32_t delay_ms, uint32_t max_delay_ms);
+
+int LiveObjectsInstance_NetworkChanged(LiveObjectsClient_t* loc);
+
+int LiveObjectsInstance_SetStore(LiveObjectsClient_t* loc, const char* dir, uint32_t max_bytes);
+
+int LiveObjectsInstance_SetTlsSessionFile(LiveObjectsClient_t* loc, const char* path);
+
+int LiveObjectsInstance_AttachCfgParams(LiveObjectsClient_t* loc, const LiveObjectsD_Param_t* param_ptr,
+		int32_t param_nb, LiveObjectsD_CallbackParams_t callback);
+
+int LiveObjectsInstance_AttachStatus(LiveObjectsClient_t* loc, const LiveObjectsD_Data_t* status_ptr,
+		int32_t status_nb);
+
+int LiveObjectsInstance_AttachData(LiveObjectsClient_t* loc, uint8_t prefix, const char* stream_id,
+		const char* model, const char* tags, const LiveObjectsD_GpsFix_t* gps_ptr,
+		const LiveObjectsD_Data_t* data_ptr, int32_t data_nb);
+
+int LiveObjectsInstance_AttachCommands(LiveObjectsClient_t* loc, const LiveObjectsD_Command_t* cmd_ptr,
+		int32_t cmd_nb, LiveObjectsD_CallbackCommand_t callback);
+
+int LiveObjectsInstance_AttachResources(LiveObjectsClient_t* loc, const LiveObjectsD_Resource_t* rsc_ptr,
+		int32_t rsc_nb, LiveObjectsD_CallbackResourceNotify_t ntfyCB, LiveObjectsD_CallbackResourceData_t dataCB);
+
+int LiveObjectsInstance_ControlCommands(LiveObjectsClient_t* loc, bool enable);
+
+int LiveObjectsInstance_ControlResources(LiveObjectsClient_t* loc, bool enable);
+
+int LiveObjectsInstance_RemoveData(LiveObjectsClient_t* loc, int handle);
+
+int LiveObjectsInstance_ChangeDataStreamId(LiveObjectsClient_t* loc, uint8_t prefix, int handle,
+		const char* stream_id);
+
+int LiveObjectsInstance_RemoveCommands(LiveObjectsClient_t* loc);
+
+int LiveObjectsInstance_RemoveResources(LiveObjectsClient_t* loc);
+
+int LiveObjectsInstance_ThreadStart(LiveObjectsClient_t* loc, LiveObjectsD_CallbackState_t callback);
+
+int8_t LiveObjectsInstance_ThreadState(LiveObjectsClient_t* loc);
+
+void LiveObjectsInstance_Run(LiveObjectsClient_t* loc, LiveObjectsD_CallbackState_t callback);
+
+int LiveObjectsInstance_Stop(LiveObjectsClient_t* loc);
+
+int LiveObjectsInstance_Connect(LiveObjectsClient_t* loc);
+
+int LiveObjectsInstance_Disconnect(LiveObjectsClient_t* loc);
+
+int LiveObjectsInstance_Yield(LiveObjectsClient_t* loc, int timeout_ms);
+
+int LiveObjectsInstance_Cycle(LiveObjectsClient_t* loc, int timeout_ms);
+
+int LiveObjectsInstance_PushStatus(LiveObjectsClient_t* loc, int handle);
+
+int LiveObjectsInstance_PushData(LiveObjectsClient_t* loc, int handle);
+
+int LiveObjectsInstance_SetDataBatch(LiveObjectsClient_t* loc, int handle, uint32_t batch_size, uint32_t linger_ms);
+
+int LiveObjectsInstance_SetDataEncoding(LiveObjectsClient_t* loc, int handle, LiveObjectsD_Encoding_t encoding);
+
+int LiveObjectsInstance_SetStatusEncoding(LiveObjectsClient_t* loc, int handle, LiveObjectsD_Encoding_t encoding);
+
+int LiveObjectsInstance_SetStatusDelta(LiveObjectsClient_t* loc, int handle, uint32_t resync_ms);
+
+int LiveObjectsInstance_PushDataQos1(LiveObjectsClient_t* loc, int handle,
+		LiveObjectsD_CallbackPubAck_t callback, void* msg_ctx);
+
+int LiveObjectsInstance_PushCfgParams(LiveObjectsClient_t* loc);
+
+int LiveObjectsInstance_PushResources(LiveObjectsClient_t* loc);
+
+int LiveObjectsInstance_RscGetChunck(LiveObjectsClient_t* loc, const LiveObjectsD_Resource_t* rsc_ptr,
+		char* data_ptr, int data_len);
+
+int LiveObjectsInstance_CommandResponse(LiveObjectsClient_t* loc, int32_t cid,
+		const LiveObjectsD_Data_t* data_ptr, int data_nb);
+
+int LiveObjectsInstance_Publish(LiveObjectsClient_t* loc, const char* topic_name, const char* payload_data);
+
+int LiveObjectsInstance_PublishQos1(LiveObjectsClient_t* loc, const char* topic_name, const char* payload_data,
+		LiveObjectsD_CallbackPubAck_t callback, void* msg_ctx);
+
+int LiveObjectsInstance_GetQueueStats(LiveObjectsClient_t* loc, LiveObjectsD_MqStats_t* stats);
+
+int LiveObjectsInstance_GetInflightStats(LiveObjectsClient_t* loc, LiveObjectsD_InflightStats_t* stats);
+
+int LiveObjectsInstance_GetStoreStats(LiveObjectsClient_t* loc, LiveObjectsD_StoreStats_t* stats);
+
+int LiveObjectsInstance_GetDataBatchStats(LiveObjectsClient_t* loc, int handle, LiveObjectsD_BatchStats_t* stats);
+
+int LiveObjectsInstance_GetReconnectStats(LiveObjectsClient_t* loc, LiveObjectsD_ReconnectStats_t* stats);
+
+int LiveObjectsInstance_GetTlsStats(LiveObjectsClient_t* loc, LiveObjectsD_TlsStats_t* stats);
+
+/* @} group end : InstanceApi */
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* __LiveObjectsClient_Instance_H_ */
@@ -16,10 +16,14 @@
 
 /**
  * @brief Define a Security Record: type and location
+ *
+ * DER data in memory is parsed without any PEM/base64 decoding: the root record may hold
+ * several certificates (a CA chain), one after the other.
  */
 typedef struct {
-	unsigned char type;  /*!< location type: 0= memory 1= file */
+	unsigned char type;  /*!< location type: 0= memory (PEM, null-terminated) 1= file (PEM or DER) 2= memory (DER) */
 	const char* pLoc;    /*!< Location: memory address or file path */
+	unsigned int len;    /*!< Length in bytes of the DER data in memory (type 2) */
 } LiveObjectsSecurityRecord_t;
 
 /**
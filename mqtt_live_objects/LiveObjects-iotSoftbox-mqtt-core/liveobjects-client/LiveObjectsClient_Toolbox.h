@@ -34,6 +34,41 @@ void LiveObjectsClient_ToolboxInit(void);
  */
 int32_t tbx_GetDateTimeStr(char* str, uint32_t sz);
 
+/*
+ * Numeric formatting, as in the JSON messages: integers, and floating-point values with the
+ * shortest representation that reads back to the same value.
+ * All functions write the text of the number at 'p' (not null-terminated)
+ * and return the number of characters written.
+ * The output buffer must have at least LO_FMT_NUM_SZ bytes.
+ */
+
+/** Size of the buffer required to format any number */
+#define LO_FMT_NUM_SZ      32
+
+int LO_fmt_u32(char* p, uint32_t value);
+
+int LO_fmt_i32(char* p, int32_t value);
+
+int LO_fmt_u64(char* p, uint64_t value);
+
+/**
+ * Format a double value.
+ * prec = 0: shortest representation that reads back to the same double value.
+ * prec > 0: rounded to (at most) 'prec' decimal places, trailing zeros removed.
+ * The text always reads as a floating-point number: a value without
+ * fractional part is formatted with ".0" (e.g. "12.0"), or in exponent
+ * notation from 1e21 (e.g. "1e21", "1.5e22").
+ * NaN and infinity are formatted as null (no JSON representation).
+ */
+int LO_fmt_double(char* p, double value, int8_t prec);
+
+/**
+ * Format a float value.
+ * Same as LO_fmt_double(), but with prec = 0 the shortest representation
+ * is the one that reads back to the same float value.
+ */
+int LO_fmt_float(char* p, float value, int8_t prec);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -19,19 +19,23 @@
  *   - Disable Timer to send MQTT Packet
  *   - Add a few traces
  *   - Patch in MQTTSubscribe function to define qos as integer
+ *   - Add MQTTPublishInPlace function to send a payload without copy
  * Note: keep the source code as it (dont't suppress /replace tab, end space, ..)
  */
 
 #include "paho-mqttclient-embedded-c/MQTTClient.h"
 
+#include <string.h>
+
 // LiveObjects Client: Add some logs  (search pattern LOTRACE_ ) ...
 #include "liveobjects-sys/loc_trace.h"
 
 
 
-static void NewMessageData(MessageData* md, MQTTString* aTopicName, MQTTMessage* aMessage) {
+static void NewMessageData(MessageData* md, MQTTString* aTopicName, MQTTMessage* aMessage, void* aContext) {
     md->topicName = aTopicName;
     md->message = aMessage;
+    md->context = aContext;
 }
 
 
@@ -40,14 +44,20 @@ static int getNextPacketId(MQTTClient *c) {
 }
 
 
-static int sendPacket(MQTTClient* c, int length, Timer* timer)
+unsigned short MQTTNextPacketId(MQTTClient* c)
+{
+    return (unsigned short)getNextPacketId(c);
+}
+
+
+static int sendBuffer(MQTTClient* c, unsigned char* buf, int length, Timer* timer)
 {
     int rc = FAILURE, 
         sent = 0;
     
     while (sent < length ) // && !TimerIsExpired(timer)) //OAB: Disable timer to send a packet.
     {
-        rc = c->ipstack->mqttwrite(c->ipstack, &c->buf[sent], length, TimerLeftMS(timer));
+        rc = c->ipstack->mqttwrite(c->ipstack, &buf[sent], length - sent, TimerLeftMS(timer));
         if (rc < 0)  // there was an error writing the data
             break;
         sent += rc;
@@ -63,6 +73,12 @@ static int sendPacket(MQTTClient* c, int length, Timer* timer)
 }
 
 
+static int sendPacket(MQTTClient* c, int length, Timer* timer)
+{
+    return sendBuffer(c, c->buf, length, timer);
+}
+
+
 void MQTTClientInit(MQTTClient* c, Network* network, unsigned int command_timeout_ms,
 		unsigned char* sendbuf, size_t sendbuf_size, unsigned char* readbuf, size_t readbuf_size)
 {
@@ -79,6 +95,8 @@ void MQTTClientInit(MQTTClient* c, Network* network, unsigned int command_timeou
     c->isconnected = 0;
     c->ping_outstanding = 0;
     c->defaultMessageHandler = NULL;
+    c->pubAckHandler = NULL;
+    c->context = NULL;
 	c->next_packetid = 1;
     TimerInit(&c->ping_timer);
 #if defined(MQTT_TASK)
@@ -189,7 +207,7 @@ int deliverMessage(MQTTClient* c, MQTTString* topicName, MQTTMessage* message)
             if (c->messageHandlers[i].fp != NULL)
             {
                 MessageData md;
-                NewMessageData(&md, topicName, message);
+                NewMessageData(&md, topicName, message, c->context);
                 c->messageHandlers[i].fp(&md);
                 rc = SUCCESS;
             }
@@ -199,7 +217,7 @@ int deliverMessage(MQTTClient* c, MQTTString* topicName, MQTTMessage* message)
     if (rc == FAILURE && c->defaultMessageHandler != NULL) 
     {
         MessageData md;
-        NewMessageData(&md, topicName, message);
+        NewMessageData(&md, topicName, message, c->context);
         c->defaultMessageHandler(&md);
         rc = SUCCESS;
     }   
@@ -210,17 +228,16 @@ int deliverMessage(MQTTClient* c, MQTTString* topicName, MQTTMessage* message)
 
 int keepalive(MQTTClient* c)
 {
-    int rc = FAILURE;
+    int rc = SUCCESS;
 
     if (c->keepAliveInterval == 0)
-    {
-        rc = SUCCESS;
         goto exit;
-    }
 
     if (TimerIsExpired(&c->ping_timer))
     {
-        if (!c->ping_outstanding)
+        if (c->ping_outstanding)
+            rc = FAILURE; // PINGRESP not received within the keepalive interval: connection lost
+        else
         {
             int len;
             Timer timer;
@@ -249,8 +266,17 @@ int cycle(MQTTClient* c, Timer* timer)
 
     switch (packet_type)
     {
-        case CONNACK:
         case PUBACK:
+            if (c->pubAckHandler != NULL)
+            {
+                unsigned short mypacketid;
+                unsigned char dup, type;
+                if (MQTTDeserialize_ack(&type, &dup, &mypacketid, c->readbuf, c->readbuf_size) == 1)
+                    c->pubAckHandler(c->context, mypacketid);
+            }
+            LOTRACE_DBG1("cycle: PUBACK packet_type=%d x%x", packet_type, packet_type);
+            break;
+        case CONNACK:
         case SUBACK:
             LOTRACE_DBG1("cycle: xxxACK packet_type=%d x%x", packet_type, packet_type);
             break;
@@ -300,7 +326,8 @@ int cycle(MQTTClient* c, Timer* timer)
             LOTRACE_DBG1("cycle: PINGRESP packet_type=%d x%x", packet_type, packet_type);
             break;
     }
-    keepalive(c);
+    if (keepalive(c) != SUCCESS)
+        rc = FAILURE;
 exit:
     LOTRACE_DBG_VERBOSE("cycle: rc=%d packet_type=%d x%x", rc, packet_type, packet_type);
     if (rc == SUCCESS)
@@ -394,6 +421,7 @@ int MQTTConnect(MQTTClient* c, MQTTPacket_connectData* options)
         options = &default_options; /* set default options if none were supplied */
     
     c->keepAliveInterval = options->keepAliveInterval;
+    c->ping_outstanding = 0;
     TimerCountdown(&c->ping_timer, c->keepAliveInterval);
     if ((len = MQTTSerialize_connect(c->buf, c->buf_size, options)) <= 0)
         goto exit;
@@ -580,6 +608,63 @@ exit:
 }
 
 
+int MQTTPublishInPlace(MQTTClient* c, const char* topicName, int topicLen, MQTTMessage* message, int headroom)
+{
+    int rc = FAILURE;
+    int len, rem_len, tlen;
+    unsigned char *buf, *ptr;
+    Timer timer;
+    MQTTHeader header = {0};
+
+#if defined(MQTT_TASK)
+	MutexLock(&c->mutex);
+#endif
+	if (!c->isconnected)
+		goto exit;
+
+    if (message->qos == QOS2) // the ack of QoS1 is given to the pubAckHandler, no support of the QoS2 flow
+        goto exit;
+
+    if (message->qos == QOS1 && message->id == 0)
+        message->id = getNextPacketId(c);
+
+    tlen = topicLen;
+    rem_len = 2 + tlen + ((message->qos == QOS1) ? 2 : 0) + message->payloadlen;
+    len = MQTTPacket_len(rem_len);
+    if (len - (int)message->payloadlen > headroom)
+    {
+        rc = BUFFER_OVERFLOW;
+        goto exit;
+    }
+
+    // Serialize the fixed header and the topic just before the payload
+    buf = (unsigned char*)message->payload - (len - message->payloadlen);
+    ptr = buf;
+    header.bits.type = PUBLISH;
+    header.bits.dup = message->dup;
+    header.bits.qos = message->qos;
+    header.bits.retain = message->retained;
+    writeChar(&ptr, header.byte);
+    ptr += MQTTPacket_encode(ptr, rem_len);
+    writeInt(&ptr, tlen);
+    if (ptr != (unsigned char*)topicName)
+        memmove(ptr, topicName, tlen);
+    ptr += tlen;
+    if (message->qos == QOS1)
+        writeInt(&ptr, message->id);
+
+    TimerInit(&timer);
+    TimerCountdownMS(&timer, c->command_timeout_ms);
+    rc = sendBuffer(c, buf, len, &timer);
+
+exit:
+#if defined(MQTT_TASK)
+	MutexUnlock(&c->mutex);
+#endif
+    return rc;
+}
+
+
 int MQTTDisconnect(MQTTClient* c)
 {  
     int rc = FAILURE;
@@ -98,10 +98,13 @@ typedef struct MessageData
 {
     MQTTMessage* message;
     MQTTString* topicName;
+    void* context;          /* Context of the client which received the message */
 } MessageData;
 
 typedef void (*messageHandler)(MessageData*);
 
+typedef void (*pubAckHandler)(void* context, unsigned short packetid);
+
 typedef struct MQTTClient
 {
     unsigned int next_packetid,
@@ -121,9 +124,11 @@ typedef struct MQTTClient
     } messageHandlers[MAX_MESSAGE_HANDLERS];      /* Message handlers are indexed by subscription topic */
 
     void (*defaultMessageHandler) (MessageData*);
+    pubAckHandler pubAckHandler;   /* Called by the cycle for each PUBACK received (asynchronous QoS1 publish) */
 
     Network* ipstack;
     Timer ping_timer;
+    void* context;          /* User context, given to the message handlers */
 #if defined(MQTT_TASK)
 	Mutex mutex;
 	Thread thread;
@@ -158,6 +163,25 @@ DLLExport int MQTTConnect(MQTTClient* client, MQTTPacket_connectData* options);
  */
 DLLExport int MQTTPublish(MQTTClient* client, const char*, MQTTMessage*);
 
+/** MQTT Publish without copy - send an MQTT publish packet (QoS0 or QoS1) serialized in place:
+ *  the fixed header, the topic and the packet id (QoS1) are written in the free space just before the payload.
+ *  It does not wait for the PUBACK of a QoS1 message, given to the pubAckHandler of the client.
+ *  @param client - the client object to use
+ *  @param topic - the topic to publish to (it can be already stored just before the payload,
+ *                 or just before the packet id for QoS1)
+ *  @param topicLen - length of the topic (not necessarily terminated by a NUL character)
+ *  @param message - the message to send (QoS1: a new packet id is set if message->id is 0)
+ *  @param headroom - size of the free space before the payload
+ *  @return success code
+ */
+DLLExport int MQTTPublishInPlace(MQTTClient* client, const char*, int topicLen, MQTTMessage*, int headroom);
+
+/** MQTT Next Packet Id - reserve a packet id (for a message given later to MQTTPublishInPlace)
+ *  @param client - the client object to use
+ *  @return the packet id
+ */
+DLLExport unsigned short MQTTNextPacketId(MQTTClient* client);
+
 /** MQTT Subscribe - send an MQTT subscribe packet and wait for suback before returning.
  *  @param client - the client object to use
  *  @param topicFilter - the topic filter to subscribe to
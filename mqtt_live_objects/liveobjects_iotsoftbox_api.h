@@ -26,7 +26,10 @@
 #include "LiveObjects-iotSoftbox-mqtt-core/liveobjects-client/LiveObjectsClient_Config.h"
 #include "LiveObjects-iotSoftbox-mqtt-core/liveobjects-client/LiveObjectsClient_Defs.h"
 #include "LiveObjects-iotSoftbox-mqtt-core/liveobjects-client/LiveObjectsClient_Core.h"
+#include "LiveObjects-iotSoftbox-mqtt-core/liveobjects-client/LiveObjectsClient_Instance.h"
+#include "LiveObjects-iotSoftbox-mqtt-core/liveobjects-client/LiveObjectsClient_Gateway.h"
 #include "LiveObjects-iotSoftbox-mqtt-core/liveobjects-client/LiveObjectsClient_Security.h"
+#include "LiveObjects-iotSoftbox-mqtt-core/liveobjects-client/LiveObjectsClient_Toolbox.h"
 
 /* Definitions set for this board or os.*/
 #include "platforms/linux/liveobjects-sys/LiveObjectsClient_Platform.h"
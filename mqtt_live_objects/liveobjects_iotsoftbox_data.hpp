@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ *
+ * This file is a part of LiveObjects iotsoftbox-mqtt library.
+ */
+
+/**
+ * @file  liveobjects_iotsoftbox_data.hpp
+ *
+ * @brief Typed data sets for C++ (17) applications
+ *
+ * A set of data is declared from the fields of a user structure: the LOD_TYPE_* tag
+ * and the dimension of each element are deduced at compile time from the type of
+ * the field, so that a wrong tag can not be written by hand.
+ *
+ * @code
+ * struct Measures {
+ *     uint32_t counter;
+ *     double   volt;
+ *     int16_t  accel[3];
+ *     char     message[32];
+ * } measures;
+ *
+ * constexpr auto measures_schema = LiveObjects::schema(
+ *     LiveObjects::field<&Measures::counter>("counter"),
+ *     LiveObjects::field<&Measures::volt>("volt", 2),
+ *     LiveObjects::field<&Measures::accel>("accel"),
+ *     LiveObjects::field<&Measures::message>("message"));
+ *
+ * LiveObjects::DataSet measures_set(measures_schema, measures);
+ *
+ * measures_set.attach(0, "measures", "v1", NULL, NULL);   // LiveObjectsClient_AttachData
+ * measures.counter++;
+ * measures_set.push();                                    // LiveObjectsClient_PushData
+ * @endcode
+ *
+ * Once attached, the values of the JSON messages of the data set are written by
+ * DataSet::encode() (see LiveObjectsClient_SetDataEncoder).
+ * The DataSet object also provides the LiveObjectsD_Data_t table used by the C API
+ * (data(), size()), so it can be attached as a status set, or to an instance.
+ */
+
+#ifndef __liveobjects_iotsoftbox_data_HPP__
+#define __liveobjects_iotsoftbox_data_HPP__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "liveobjects_iotsoftbox_api.h"
+
+namespace LiveObjects {
+
+/* --------------------------------------------------------------------------------- */
+/* LOD_TYPE_* tag of a C++ type */
+template <typename T> struct DataTypeOf {
+	static_assert(sizeof(T) == 0, "Type not supported in a LiveObjects data set");
+	static constexpr LiveObjectsD_Type_t type = LOD_TYPE_UNKNOWN;
+};
+
+template <> struct DataTypeOf<int32_t>  { static constexpr LiveObjectsD_Type_t type = LOD_TYPE_INT32; };
+template <> struct DataTypeOf<int16_t>  { static constexpr LiveObjectsD_Type_t type = LOD_TYPE_INT16; };
+template <> struct DataTypeOf<int8_t>   { static constexpr LiveObjectsD_Type_t type = LOD_TYPE_INT8; };
+template <> struct DataTypeOf<uint32_t> { static constexpr LiveObjectsD_Type_t type = LOD_TYPE_UINT32; };
+template <> struct DataTypeOf<uint16_t> { static constexpr LiveObjectsD_Type_t type = LOD_TYPE_UINT16; };
+template <> struct DataTypeOf<uint8_t>  { static constexpr LiveObjectsD_Type_t type = LOD_TYPE_UINT8; };
+template <> struct DataTypeOf<float>    { static constexpr LiveObjectsD_Type_t type = LOD_TYPE_FLOAT; };
+template <> struct DataTypeOf<double>   { static constexpr LiveObjectsD_Type_t type = LOD_TYPE_DOUBLE; };
+template <> struct DataTypeOf<bool>     {
+	static_assert(sizeof(bool) == sizeof(uint8_t), "LOD_TYPE_BOOL is a 8-bit value");
+	static constexpr LiveObjectsD_Type_t type = LOD_TYPE_BOOL;
+};
+
+/* Type and dimension of a field: single value, array of values, or c-string (char array) */
+template <typename T> struct DataTraits {
+	using Item = T;
+	static constexpr LiveObjectsD_Type_t type = DataTypeOf<T>::type;
+	static constexpr int8_t dim = 1;
+};
+
+template <typename T, std::size_t N> struct DataTraits<T[N]> {
+	static_assert((N > 0) && (N <= 127), "Array of 1 to 127 values");
+	using Item = T;
+	static constexpr LiveObjectsD_Type_t type = DataTypeOf<T>::type;
+	static constexpr int8_t dim = static_cast<int8_t>(N);
+};
+
+template <std::size_t N> struct DataTraits<char[N]> {
+	using Item = char;
+	static constexpr LiveObjectsD_Type_t type = LOD_TYPE_STRING_C;
+	static constexpr int8_t dim = 1;
+};
+
+template <auto First, auto... Others> struct FirstOf {
+	static constexpr auto value = First;
+};
+
+template <typename M> struct MemberOf;
+
+template <typename C, typename T> struct MemberOf<T C::*> {
+	using Class = C;
+	using Value = T;
+};
+
+/* --------------------------------------------------------------------------------- */
+/**
+ * @brief Field of a user structure, published as a data element
+ */
+template <auto Member>
+struct Field {
+	using Class = typename MemberOf<decltype(Member)>::Class;
+	using Value = typename MemberOf<decltype(Member)>::Value;
+
+	static constexpr LiveObjectsD_Type_t type = DataTraits<Value>::type;
+	static constexpr int8_t dim = DataTraits<Value>::dim;
+
+	const char* name;  /*!< JSON name */
+	int8_t prec;       /*!< Precision of a floating-point value: LOD_PREC_SHORTEST or number of decimal places */
+};
+
+template <auto Member>
+constexpr Field<Member> field(const char* name, int8_t prec = LOD_PREC_SHORTEST) {
+	return Field<Member> { name, prec };
+}
+
+/**
+ * @brief Entry of the key table of a schema
+ */
+struct Key {
+	const char* name;          /*!< JSON name */
+	uint32_t name_len;         /*!< Length of name */
+	LiveObjectsD_Type_t type;  /*!< Type deduced from the field */
+	int8_t dim;                /*!< Number of values */
+	int8_t prec;               /*!< Precision of a floating-point value */
+};
+
+/* --------------------------------------------------------------------------------- */
+/**
+ * @brief Schema of a data set: constexpr key table of the fields of a structure
+ */
+template <auto... Members>
+struct Schema {
+	static_assert(sizeof...(Members) > 0, "Empty schema");
+	using Class = typename Field<FirstOf<Members...>::value>::Class;
+	static_assert((std::is_same_v<Class, typename Field<Members>::Class> && ...),
+			"All the fields of a schema must be members of the same structure");
+
+	static constexpr std::size_t size = sizeof...(Members);
+
+	std::array<Key, sizeof...(Members)> keys;
+};
+
+template <auto... Members>
+constexpr Schema<Members...> schema(Field<Members>... fields) {
+	return Schema<Members...> { { {
+		Key { fields.name, static_cast<uint32_t>(std::char_traits<char>::length(fields.name)),
+				Field<Members>::type, Field<Members>::dim, fields.prec }... } } };
+}
+
+/* --------------------------------------------------------------------------------- */
+/**
+ * @brief Data set bound to an instance of the structure of its schema
+ *
+ * The LiveObjectsD_Data_t table refers to this object: it must outlive the attachment,
+ * and it can not be copied.
+ */
+template <auto... Members>
+class DataSet {
+public:
+	using Class = typename Schema<Members...>::Class;
+
+	DataSet(const Schema<Members...>& schema, Class& values)
+			: _values(values), _keys(schema.keys),
+			  _data(table(schema.keys, values, std::index_sequence_for<decltype(Members)...>())) {
+	}
+
+	DataSet(const DataSet&) = delete;
+	DataSet& operator=(const DataSet&) = delete;
+
+	/** Table of data elements, to be used with the C API */
+	const LiveObjectsD_Data_t* data() const {
+		return _data.data();
+	}
+
+	static constexpr std::size_t size() {
+		return sizeof...(Members);
+	}
+
+	Class& values() {
+		return _values;
+	}
+
+	const std::array<Key, sizeof...(Members)>& keys() const {
+		return _keys;
+	}
+
+	/** LiveObjectsClient_AttachData, with encode() as the encoder of the values.
+	 *  Returns the handle of the data set (or -1) */
+	int attach(uint8_t prefix, const char* stream_id, const char* model, const char* tags,
+			const LiveObjectsD_GpsFix_t* gps_ptr) {
+		_handle = LiveObjectsClient_AttachData(prefix, stream_id, model, tags, gps_ptr, _data.data(),
+				static_cast<int32_t>(size()));
+		if ((_handle >= 0) && (LiveObjectsClient_SetDataEncoder(_handle, &DataSet::encoder, this))) {
+			LiveObjectsClient_RemoveData(_handle);
+			_handle = -1;
+		}
+		return _handle;
+	}
+
+	/** LiveObjectsClient_PushData: message encoded with encode() */
+	int push() const {
+		return LiveObjectsClient_PushData(_handle);
+	}
+
+	int handle() const {
+		return _handle;
+	}
+
+	/**
+	 * Encode the current values in the JSON object of the "v" section of the data messages:
+	 *   {"name":value,...}
+	 * Each field is written by the function of its type, selected at compile time.
+	 * Return the length of the text (null-terminated), or -1 if the buffer is too small.
+	 */
+	int encode(char* buf, uint32_t sz) const {
+		Writer w { buf, sz, 0, false };
+		std::size_t i = 0;
+		w.put("{", 1);
+		(putField<Members>(w, _keys[i++]), ...);
+		if (w.len > 1) {
+			w.len--;  /* last comma */
+		}
+		w.put("}", 1);
+		if ((w.err) || (w.len >= sz)) {
+			return -1;
+		}
+		buf[w.len] = 0;
+		return static_cast<int>(w.len);
+	}
+
+private:
+	static int encoder(void* ctx, char* buf, uint32_t sz) {
+		return static_cast<const DataSet*>(ctx)->encode(buf, sz);
+	}
+
+	struct Writer {
+		char* buf;
+		uint32_t sz;
+		uint32_t len;
+		bool err;
+
+		void put(const char* p, uint32_t n) {
+			if ((err) || (len + n >= sz)) {
+				err = true;
+				return;
+			}
+			for (uint32_t k = 0; k < n; k++) {
+				buf[len + k] = p[k];
+			}
+			len += n;
+		}
+	};
+
+	template <std::size_t... I>
+	static std::array<LiveObjectsD_Data_t, sizeof...(Members)> table(const std::array<Key, sizeof...(Members)>& keys,
+			Class& values, std::index_sequence<I...>) {
+		return { { LiveObjectsD_Data_t { keys[I].type, keys[I].name, static_cast<void*>(&(values.*Members)),
+				keys[I].dim, keys[I].prec }... } };
+	}
+
+	template <typename T>
+	static void putValue(Writer& w, const T& v, int8_t prec) {
+		char num[LO_FMT_NUM_SZ];
+		if constexpr (std::is_same_v<T, bool>) {
+			w.put(v ? "true" : "false", v ? 4 : 5);
+		}
+		else if constexpr (std::is_same_v<T, float>) {
+			w.put(num, LO_fmt_float(num, v, prec));
+		}
+		else if constexpr (std::is_same_v<T, double>) {
+			w.put(num, LO_fmt_double(num, v, prec));
+		}
+		else if constexpr (std::is_signed_v<T>) {
+			w.put(num, LO_fmt_i32(num, v));
+		}
+		else {
+			w.put(num, LO_fmt_u32(num, v));
+		}
+	}
+
+	template <auto Member>
+	void putField(Writer& w, const Key& key) const {
+		using Value = typename Field<Member>::Value;
+		const Value& v = _values.*Member;
+
+		w.put("\"", 1);
+		w.put(key.name, key.name_len);
+		w.put("\":", 2);
+		if constexpr (Field<Member>::type == LOD_TYPE_STRING_C) {
+			w.put("\"", 1);
+			w.put(v, static_cast<uint32_t>(std::char_traits<char>::length(v)));
+			w.put("\"", 1);
+		}
+		else if constexpr (std::is_array_v<Value>) {
+			w.put("[", 1);
+			for (std::size_t k = 0; k < std::extent_v<Value>; k++) {
+				if (k) {
+					w.put(",", 1);
+				}
+				putValue(w, v[k], key.prec);
+			}
+			w.put("]", 1);
+		}
+		else {
+			putValue(w, v, key.prec);
+		}
+		w.put(",", 1);
+	}
+
+	Class& _values;
+	const std::array<Key, sizeof...(Members)> _keys;
+	const std::array<LiveObjectsD_Data_t, sizeof...(Members)> _data;
+	int _handle = -1;
+};
+
+template <auto... Members>
+DataSet(const Schema<Members...>&, typename Schema<Members...>::Class&) -> DataSet<Members...>;
+
+} /* namespace LiveObjects */
+
+#endif /* __liveobjects_iotsoftbox_data_HPP__ */
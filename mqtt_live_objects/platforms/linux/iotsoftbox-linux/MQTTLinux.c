@@ -92,6 +92,7 @@ void NetworkInit(Network *n) {
 	n->my_socket = 0;
 	n->mqttread = linux_read;
 	n->mqttwrite = linux_write;
+	n->netw_ctx = NULL;
 }
 
 int NetworkConnect(Network *n, char *addr, int port) {
@@ -22,6 +22,9 @@
 #include <errno.h>
 #include <netdb.h>
 #include <netinet/in.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/socket.h>
@@ -29,10 +32,33 @@
 #include <time.h>
 #include <unistd.h>
 
+#include "iotsoftbox-core/loc_sys.h"
+#include "liveobjects-client/LiveObjectsClient_Config.h"
 #include "liveobjects-sys/LiveObjectsClient_Platform.h"
 #include "liveobjects-sys/loc_trace.h"
 #include "liveobjects-sys/socket_defs.h"
 
+/* Address of a server (IPv4 or IPv6) */
+typedef union {
+	struct sockaddr sa;
+	struct sockaddr_in in4;
+	struct sockaddr_in6 in6;
+} sock_addr_t;
+
+#if LOC_DNS_CACHE_NB > 0
+/* Entry of the resolver cache: addresses of a name (in the order of the connection attempts),
+ * none if the name does not exist (negative entry) */
+typedef struct {
+	char name[LOC_DNS_NAME_SZ];
+	uint8_t fixed;           /* Set by LO_sock_dnsSetFQDN(name, ip_address): no expiry */
+	uint8_t addr_nb;
+	uint64_t expire_us;
+	sock_addr_t addr[LOC_SERV_ADDR_MAX];
+} sock_dns_t;
+
+static sock_dns_t _sock_dns[LOC_DNS_CACHE_NB];
+#endif
+
 /*---------------------------------------------------------------------------------*/
 
 void LO_sock_disconnect(socketHandle_t *pHdl) {
@@ -43,84 +69,341 @@ void LO_sock_disconnect(socketHandle_t *pHdl) {
 	}
 }
 
+/*---------------------------------------------------------------------------------*/
+
+/* Copy the addresses given by getaddrinfo() in the order of the connection attempts (RFC 8305 section 4):
+ * the order given by the resolver, alternating the address families from the family of the first one */
+static int sock_addrSort(const struct addrinfo* res, sock_addr_t* addr, int addr_max) {
+	const struct addrinfo* ai;
+	const struct addrinfo* other;
+	int nb = 0;
+	int family = (res) ? res->ai_family : AF_UNSPEC;
+
+	ai = res;
+	other = res;
+	while ((nb < addr_max) && ((ai) || (other))) {
+		while ((ai) && (ai->ai_family != family)) {
+			ai = ai->ai_next;
+		}
+		while ((other) && ((other->ai_family == family) || (other->ai_addrlen > sizeof(sock_addr_t)))) {
+			other = other->ai_next;
+		}
+		if ((ai) && (ai->ai_addrlen <= sizeof(sock_addr_t))) {
+			memcpy(&addr[nb++], ai->ai_addr, ai->ai_addrlen);
+		}
+		if (ai) {
+			ai = ai->ai_next;
+		}
+		if ((other) && (nb < addr_max)) {
+			memcpy(&addr[nb++], other->ai_addr, other->ai_addrlen);
+			other = other->ai_next;
+		}
+	}
+	return nb;
+}
+
+#if LOC_DNS_CACHE_NB > 0
+/* Entry of this name (or NULL), to be called with the DNS mutex locked */
+static sock_dns_t* sock_dnsFind(const char* name) {
+	int i;
+	for (i = 0; i < LOC_DNS_CACHE_NB; i++) {
+		if ((_sock_dns[i].name[0]) && (strcmp(_sock_dns[i].name, name) == 0)) {
+			return &_sock_dns[i];
+		}
+	}
+	return NULL;
+}
+
+/* Store the addresses of a name (none: negative entry), replacing the entry of this name or the entry
+ * expiring first (the fixed entries are kept) */
+static void sock_dnsStore(const char* name, const sock_addr_t* addr, int addr_nb, uint8_t fixed, uint32_t ttl_s) {
+	sock_dns_t* entry;
+	int i;
+
+	if (strlen(name) >= LOC_DNS_NAME_SZ) {
+		LOTRACE_WARN("Name too long to be cached: %s", name);
+		return;
+	}
+	DNS_MUTEX_LOCK();
+	entry = sock_dnsFind(name);
+	for (i = 0; (entry == NULL) && (i < LOC_DNS_CACHE_NB); i++) {
+		if (_sock_dns[i].name[0] == 0) {
+			entry = &_sock_dns[i];
+		}
+	}
+	for (i = 0; (entry == NULL) && (i < LOC_DNS_CACHE_NB); i++) {
+		if ((!_sock_dns[i].fixed) && ((entry == NULL) || (_sock_dns[i].expire_us < entry->expire_us))) {
+			entry = &_sock_dns[i];
+		}
+	}
+	if (entry) {
+		strcpy(entry->name, name);
+		entry->fixed = fixed;
+		entry->addr_nb = (uint8_t) addr_nb;
+		entry->expire_us = LO_sys_timeUs() + (uint64_t) ttl_s * 1000000;
+		memcpy(entry->addr, addr, addr_nb * sizeof(sock_addr_t));
+	}
+	else {
+		LOTRACE_WARN("Cache full of fixed entries, %s not cached", name);
+	}
+	DNS_MUTEX_UNLOCK();
+}
+
+/* Remove the entry of a name, unless it is fixed and 'all' is not set */
+static void sock_dnsDrop(const char* name, uint8_t all) {
+	sock_dns_t* entry;
+	DNS_MUTEX_LOCK();
+	entry = sock_dnsFind(name);
+	if ((entry) && ((all) || (!entry->fixed))) {
+		entry->name[0] = 0;
+		entry->fixed = 0;
+	}
+	DNS_MUTEX_UNLOCK();
+}
+
+/* Addresses of a name still valid in the cache: return their number, 0 for a negative entry, or -1 if none */
+static int sock_dnsLookup(const char* name, sock_addr_t* addr, int addr_max) {
+	sock_dns_t* entry;
+	int nb = -1;
+	DNS_MUTEX_LOCK();
+	entry = sock_dnsFind(name);
+	if ((entry) && ((entry->fixed) || (LO_sys_timeUs() < entry->expire_us))) {
+		nb = (entry->addr_nb < addr_max) ? entry->addr_nb : addr_max;
+		memcpy(addr, entry->addr, nb * sizeof(sock_addr_t));
+	}
+	DNS_MUTEX_UNLOCK();
+	return nb;
+}
+#endif
+
+/* Addresses of a host (name or numeric address): return their number, or -1 */
+static int sock_resolve(const char* host, sock_addr_t* addr, int addr_max, uint8_t use_cache) {
+	struct addrinfo hints, *res;
+	int errcode;
+	int nb;
+
+	/* Numeric address: no DNS query */
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = PF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags = AI_NUMERICHOST;
+	if (getaddrinfo(host, NULL, &hints, &res) == 0) {
+		nb = sock_addrSort(res, addr, addr_max);
+		freeaddrinfo(res);
+		return nb;
+	}
+
+#if LOC_DNS_CACHE_NB > 0
+	if ((use_cache) && ((nb = sock_dnsLookup(host, addr, addr_max)) >= 0)) {
+		if (nb == 0) {
+			LOTRACE_ERR("   DNS failed (cached) -> Check the server name. Address used : %s", host);
+			return -1;
+		}
+		LOTRACE_INF("   DNS Ok (cached) !! => %d address(es) for %s", nb, host);
+		return nb;
+	}
+#else
+	(void) use_cache;
+#endif
+
+	hints.ai_flags = AI_ADDRCONFIG;
+	errcode = getaddrinfo(host, NULL, &hints, &res);
+	if (errcode) {
+		LOTRACE_ERR("   DNS failed (%s) -> Check the server name. Address used : %s", gai_strerror(errcode), host);
+#if LOC_DNS_CACHE_NB > 0
+		/* Only a name which does not exist is cached, not a temporary failure (network down...) */
+		if ((errcode == EAI_NONAME)
+#ifdef EAI_NODATA
+				|| (errcode == EAI_NODATA)
+#endif
+				) {
+			sock_dnsStore(host, NULL, 0, 0, LOC_DNS_NEGATIVE_TTL_S);
+		}
+#endif
+		return -1;
+	}
+	nb = sock_addrSort(res, addr, addr_max);
+	freeaddrinfo(res);
+	LOTRACE_INF("   DNS Ok !! => %d address(es) for %s", nb, host);
+#if LOC_DNS_CACHE_NB > 0
+	if (nb > 0) {
+		sock_dnsStore(host, addr, nb, 0, LOC_DNS_CACHE_TTL_S);
+	}
+#endif
+	return (nb > 0) ? nb : -1;
+}
+
+/*---------------------------------------------------------------------------------*/
+
 int LO_sock_dnsSetFQDN(const char* domain_name, const char* ip_address) {
+#if LOC_DNS_CACHE_NB > 0
+	sock_addr_t addr[LOC_SERV_ADDR_MAX];
+	int nb;
+
+	if (ip_address == NULL) {
+		/* Resolve the name now (its fixed address, if any, is removed) */
+		sock_dnsDrop(domain_name, 1);
+		return (sock_resolve(domain_name, addr, LOC_SERV_ADDR_MAX, 0) > 0) ? 0 : -1;
+	}
+	/* Fixed address, used instead of a DNS query */
+	if (((nb = sock_resolve(ip_address, addr, LOC_SERV_ADDR_MAX, 0)) <= 0) || (strcmp(ip_address, domain_name) == 0)) {
+		LOTRACE_ERR("Invalid address %s for %s", ip_address, domain_name);
+		return -1;
+	}
+	LOTRACE_INF("%s => %s", domain_name, ip_address);
+	sock_dnsStore(domain_name, addr, nb, 1, 0);
+	return 0;
+#else
+	(void) domain_name;
+	(void) ip_address;
 	return -1;
+#endif
+}
+
+/*---------------------------------------------------------------------------------*/
+
+/* Start a non-blocking connection to one address: return the socket (connection in progress), or -1 */
+static int sock_connectStart(const sock_addr_t* addr) {
+	int sock_fd = socket(addr->sa.sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (sock_fd < 0) {
+		LOTRACE_WARN("Could not create socket (family=%d), errno=%d", addr->sa.sa_family, errno);
+		return -1;
+	}
+	if ((connect(sock_fd, &addr->sa, (addr->sa.sa_family == AF_INET6) ? sizeof(addr->in6) : sizeof(addr->in4)) < 0)
+			&& (errno != EINPROGRESS)) {
+		LOTRACE_WARN("connect(family=%d) failed, errno=%d", addr->sa.sa_family, errno);
+		close(sock_fd);
+		return -1;
+	}
+	return sock_fd;
 }
 
 /*---------------------------------------------------------------------------------*/
 
 int LO_sock_connect(short retry, const char *remoteHostAddress,
 		uint16_t remoteHostPort, socketHandle_t *pHdl) {
-	int sock_fd;
-	struct sockaddr_in t_addr_in;
-	const char* remote_host;
+	LOTRACE_INF("Connecting to server %s:%d (retry=%d) ...", remoteHostAddress, remoteHostPort, retry);
+	return LO_sock_connectTmo(remoteHostAddress, remoteHostPort, LOC_SERV_TIMEOUT, pHdl, NULL);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+int LO_sock_connectTmo(const char *remoteHostAddress, uint16_t remoteHostPort, uint32_t tmo_ms,
+		socketHandle_t *pHdl, uint32_t* p_dns_ms) {
+	sock_addr_t addr[LOC_SERV_ADDR_MAX];
+	struct pollfd pfd[LOC_SERV_ADDR_MAX];
+	sock_addr_t peer;
+	socklen_t peer_len;
+	char addrstr[INET6_ADDRSTRLEN];
+	uint64_t start_us, deadline_us, next_us, now_us;
+	int addr_nb, next, pending, i;
+	int sock_fd = -1;
 
 	if (pHdl) {
 		*pHdl = -1;
 	}
-	LOTRACE_INF("Connecting to server %s:%d (retry=%d) ...", remoteHostAddress,
-			remoteHostPort, retry);
-
-	if ((*remoteHostAddress >= '0') && (*remoteHostAddress <= '9')) {
-		remote_host = remoteHostAddress;
-	} else {
-		struct addrinfo hints, *res;
-		int errcode;
-		char addrstr[100];
-		void *ptr;
-
-		memset (&hints, 0, sizeof (hints));
-		hints.ai_family = PF_UNSPEC;
-		hints.ai_socktype = SOCK_STREAM;
-		hints.ai_flags |= AI_CANONNAME;
-
-		errcode = getaddrinfo (remoteHostAddress, NULL, &hints, &res);
-		if (errcode == 0) {
-			inet_ntop (res->ai_family, res->ai_addr->sa_data, addrstr, 100);
-
-			switch (res->ai_family)
-			{
-			case AF_INET:
-				ptr = &((struct sockaddr_in *) res->ai_addr)->sin_addr;
+
+	start_us = LO_sys_timeUs();
+	addr_nb = sock_resolve(remoteHostAddress, addr, LOC_SERV_ADDR_MAX, 1);
+	if (p_dns_ms) {
+		*p_dns_ms = (uint32_t) ((LO_sys_timeUs() - start_us) / 1000);
+	}
+	if (addr_nb <= 0) {
+		return -1;
+	}
+	for (i = 0; i < addr_nb; i++) {
+		if (addr[i].sa.sa_family == AF_INET6) {
+			addr[i].in6.sin6_port = htons(remoteHostPort);
+		}
+		else {
+			addr[i].in4.sin_port = htons(remoteHostPort);
+		}
+	}
+
+	/* Happy Eyeballs: a new attempt is started every LOC_SERV_ATTEMPT_DELAY_MS (or as soon as the previous
+	 * ones have failed) while the previous ones are still running, the first connected socket is kept */
+	now_us = LO_sys_timeUs();
+	deadline_us = (tmo_ms) ? now_us + (uint64_t) tmo_ms * 1000 : 0;
+	next = 0;
+	next_us = now_us;
+	pending = 0;
+	while (sock_fd < 0) {
+		int wait_ms = -1;
+
+		if ((next < addr_nb) && ((pending == 0) || (now_us >= next_us))) {
+			int fd = sock_connectStart(&addr[next]);
+			next++;
+			next_us = now_us + LOC_SERV_ATTEMPT_DELAY_MS * 1000;
+			if (fd >= 0) {
+				pfd[pending].fd = fd;
+				pfd[pending].events = POLLOUT;
+				pfd[pending].revents = 0;
+				pending++;
+			}
+			continue;
+		}
+		if (pending == 0) {
+			LOTRACE_ERR("Failed to connect to %s:%d (%d address(es))", remoteHostAddress, remoteHostPort, addr_nb);
+			break;
+		}
+		if (next < addr_nb) {
+			wait_ms = (int) ((next_us - now_us + 999) / 1000);
+		}
+		if (deadline_us) {
+			if (now_us >= deadline_us) {
+				LOTRACE_ERR("Timeout (%"PRIu32" ms) to connect to %s:%d", tmo_ms, remoteHostAddress, remoteHostPort);
 				break;
-			case AF_INET6:
-				ptr = &((struct sockaddr_in6 *) res->ai_addr)->sin6_addr;
+			}
+			if ((wait_ms < 0) || ((uint64_t) wait_ms * 1000 > deadline_us - now_us)) {
+				wait_ms = (int) ((deadline_us - now_us + 999) / 1000);
+			}
+		}
+
+		if ((poll(pfd, pending, wait_ms) < 0) && (errno != EINTR)) {
+			LOTRACE_ERR("poll failed, errno=%d", errno);
+			break;
+		}
+		for (i = 0; i < pending; i++) {
+			int err = 0;
+			socklen_t err_len = sizeof(err);
+			if (pfd[i].revents == 0) {
+				continue;
+			}
+			if ((getsockopt(pfd[i].fd, SOL_SOCKET, SO_ERROR, &err, &err_len) == 0) && (err == 0)) {
+				sock_fd = pfd[i].fd;
 				break;
 			}
-			inet_ntop (res->ai_family, ptr, addrstr, 100);
-			remote_host = addrstr;
-			LOTRACE_INF("   DNS Ok !! => IP address used = %s  ...", remote_host);
-		} else {
-			LOTRACE_ERR("   DNS failed -> Check the server name. Address used : %s", remoteHostAddress);
-			return -1;
+			LOTRACE_WARN("Connection attempt failed, error=%d", err);
+			close(pfd[i].fd);
+			pfd[i--] = pfd[--pending];
 		}
+		now_us = LO_sys_timeUs();
 	}
 
-	sock_fd = socket(PF_INET, SOCK_STREAM, 0);
-	if (sock_fd < 0) {
-		LOTRACE_ERR("Could not create socket value : %d", sock_fd);
-		return sock_fd;
+	/* Cancel the other attempts */
+	for (i = 0; i < pending; i++) {
+		if (pfd[i].fd != sock_fd) {
+			close(pfd[i].fd);
+		}
 	}
 
-	memset(&t_addr_in, '0', sizeof(t_addr_in));
-
-	t_addr_in.sin_family = PF_INET;
-	t_addr_in.sin_port = htons(remoteHostPort);
-
-	/* convert IPv4 addresses from text to binary form*/
-	if (inet_pton(PF_INET, remote_host, &t_addr_in.sin_addr) <= 0) {
-		LOTRACE_INF("\n inet_pton error occured\n");
+	if (sock_fd < 0) {
+#if LOC_DNS_CACHE_NB > 0
+		/* The addresses may be out of date: resolve the name again at the next attempt */
+		sock_dnsDrop(remoteHostAddress, 0);
+#endif
 		return -1;
 	}
 
-	int ret = connect(sock_fd, (struct sockaddr *) &t_addr_in,
-			sizeof(t_addr_in));
-	if (ret < 0) {
-		LOTRACE_INF("Socket error and ret value is %d", ret);
-		return ret;
+	/* The socket is used in blocking mode */
+	fcntl(sock_fd, F_SETFL, fcntl(sock_fd, F_GETFL) & ~O_NONBLOCK);
+	peer_len = sizeof(peer);
+	if ((getpeername(sock_fd, &peer.sa, &peer_len) != 0)
+			|| (getnameinfo(&peer.sa, peer_len, addrstr, sizeof(addrstr), NULL, 0, NI_NUMERICHOST) != 0)) {
+		strcpy(addrstr, "?");
 	}
-
-	LOTRACE_INF("Connected to server %s:%d", remoteHostAddress, remoteHostPort);
+	LOTRACE_INF("Connected to server %s:%d (%s) in %"PRIu32" ms", remoteHostAddress, remoteHostPort, addrstr,
+			(uint32_t) ((LO_sys_timeUs() - start_us) / 1000));
 	if (pHdl) {
 		*pHdl = sock_fd;
 	}
@@ -142,7 +425,7 @@ int LO_sock_send(socketHandle_t hdl, const char *buf_ptr) {
 	LOTRACE_DBG1("send_data: len=%d\r\n%s", len, buf_ptr);
 
 	while (len > 0) {
-		int ret = (int) send(hdl, pc, len, 0);
+		int ret = (int) send(hdl, pc, len, MSG_NOSIGNAL);
 		if (ret < 0) {
 			if (errno == EINTR) {
 				LOTRACE_WARN("send_data: INTERRUPT !!");
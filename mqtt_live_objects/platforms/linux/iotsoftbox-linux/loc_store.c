@@ -0,0 +1,539 @@
+/*
+ * Copyright (C) 2016 Orange
+ *
+ * This software is distributed under the terms and conditions of the
+ * 'BSD-3-Clause'
+ * license which can be found in the file 'LICENSE.txt' in this package
+ * distribution
+ * or at 'https://opensource.org/licenses/BSD-3-Clause'.
+ */
+
+/**
+ * @file  loc_store.c
+ * @brief Store and forward: log of memory-mapped segment files
+ */
+
+#include "iotsoftbox-core/loc_store.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "iotsoftbox-core/loc_sys.h"
+#include "liveobjects-client/LiveObjectsClient_Config.h"
+#include "liveobjects-sys/LiveObjectsClient_Platform.h"
+#include "liveobjects-sys/loc_trace.h"
+
+#define LO_STORE_MAGIC          0x4C4F5331      /* "LOS1" */
+#define LO_STORE_PATH_SZ        256
+#define LO_STORE_ALIGN(n)       (((n) + 7) & ~7U)
+
+/* Header of a segment file */
+typedef struct {
+	uint32_t magic;
+	uint32_t seq;
+	uint32_t read_off;      /* Offset of the next record to read (used in the oldest segment) */
+	uint32_t reserved;
+} LOStoreSegHdr_t;
+
+/* Header of a record, followed by the data and a NUL character */
+typedef struct {
+	uint32_t len;           /* Written last: 0 means no more record in this segment */
+	uint32_t sum;           /* Checksum of the type and the data */
+	uint8_t  type;
+	uint8_t  pad[7];
+} LOStoreRecHdr_t;
+
+#define LO_STORE_REC_SZ(len)    LO_STORE_ALIGN(sizeof(LOStoreRecHdr_t) + (len) + 1)
+
+typedef struct {
+	uint32_t seq;
+	char*    base;
+	uint32_t rec_nb;        /* Number of records not yet consumed in this segment */
+	uint32_t rec_bytes;     /* and their size */
+} LOStoreSeg_t;
+
+struct LOStore_s {
+	pthread_mutex_t mutex;
+	char            dir[LO_STORE_PATH_SZ - 16];   /* Room for "/lo-%08x.seg" */
+	LOStoreSeg_t*   segs;           /* Ring of the mapped segments, from the oldest one */
+	uint32_t        seg_max;
+	uint32_t        seg_first;
+	uint32_t        seg_nb;
+	uint32_t        seq_next;
+	uint32_t        write_off;      /* Offset of the next record in the last segment */
+
+	uint32_t        backlog;
+	uint32_t        backlog_bytes;
+	uint32_t        cnt_stored;
+	uint32_t        cnt_replayed;
+	uint32_t        cnt_dropped;
+	uint32_t        cnt_corrupt;
+
+	uint64_t        rate_start_us;
+	uint32_t        rate_cnt;
+	uint32_t        drain_rate;
+};
+
+#define LO_STORE_SEG(st, i)     (&(st)->segs[((st)->seg_first + (i)) % (st)->seg_max])
+#define LO_STORE_HDR(seg)       ((LOStoreSegHdr_t*) (seg)->base)
+#define LO_STORE_REC(seg, off)  ((LOStoreRecHdr_t*) ((seg)->base + (off)))
+
+/*=================================================================================*/
+/* Private Functions*/
+/*---------------------------------------------------------------------------------*/
+
+static uint32_t _LO_store_sum(uint8_t type, const char* data, uint32_t len) {
+	/* FNV-1a */
+	uint32_t h = 2166136261U ^ type;
+	uint32_t i;
+	h *= 16777619U;
+	for (i = 0; i < len; i++) {
+		h ^= (uint8_t) data[i];
+		h *= 16777619U;
+	}
+	return h;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+static void _LO_store_path(const LOStore_t* st, uint32_t seq, char* path) {
+	snprintf(path, LO_STORE_PATH_SZ, "%s/lo-%08x.seg", st->dir, seq);
+}
+
+/*---------------------------------------------------------------------------------*/
+/* Record at the offset off of a segment, NULL if there is no valid record
+ * (end of the segment, or record not completely written before a crash) */
+static LOStoreRecHdr_t* _LO_store_rec(const LOStoreSeg_t* seg, uint32_t off) {
+	LOStoreRecHdr_t* rec;
+	uint32_t len;
+	if ((off + sizeof(LOStoreRecHdr_t)) > LOC_STORE_SEGMENT_SZ) {
+		return NULL;
+	}
+	rec = LO_STORE_REC(seg, off);
+	len = __atomic_load_n(&rec->len, __ATOMIC_ACQUIRE);
+	if ((len == 0) || (len > LOC_STORE_SEGMENT_SZ) || ((off + LO_STORE_REC_SZ(len)) > LOC_STORE_SEGMENT_SZ)) {
+		return NULL;
+	}
+	if (rec->sum != _LO_store_sum(rec->type, (const char*) (rec + 1), len)) {
+		LOTRACE_WARN("segment %08x: bad record at %u", seg->seq, off);
+		return NULL;
+	}
+	return rec;
+}
+
+/*---------------------------------------------------------------------------------*/
+/* Map a segment file, created if create is set */
+static char* _LO_store_map(const LOStore_t* st, uint32_t seq, uint8_t create) {
+	char path[LO_STORE_PATH_SZ];
+	char* base;
+	int fd;
+
+	_LO_store_path(st, seq, path);
+	fd = open(path, (create) ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDWR, 0600);
+	if (fd < 0) {
+		LOTRACE_ERR("open(%s) ERROR errno=%d", path, errno);
+		return NULL;
+	}
+	if ((create) && (ftruncate(fd, LOC_STORE_SEGMENT_SZ))) {
+		LOTRACE_ERR("ftruncate(%s) ERROR errno=%d", path, errno);
+		close(fd);
+		unlink(path);
+		return NULL;
+	}
+	base = (char*) mmap(NULL, LOC_STORE_SEGMENT_SZ, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		LOTRACE_ERR("mmap(%s) ERROR errno=%d", path, errno);
+		if (create) {
+			unlink(path);
+		}
+		return NULL;
+	}
+	if (create) {
+		LOStoreSegHdr_t* hdr = (LOStoreSegHdr_t*) base;
+		hdr->magic = LO_STORE_MAGIC;
+		hdr->seq = seq;
+		hdr->read_off = sizeof(LOStoreSegHdr_t);
+	}
+	return base;
+}
+
+/*---------------------------------------------------------------------------------*/
+/* Unmap and remove the oldest segment, its records not yet read are lost */
+static void _LO_store_segRelease(LOStore_t* st) {
+	LOStoreSeg_t* seg = LO_STORE_SEG(st, 0);
+	char path[LO_STORE_PATH_SZ];
+
+	st->backlog -= seg->rec_nb;
+	st->backlog_bytes -= seg->rec_bytes;
+	st->cnt_dropped += seg->rec_nb;
+	munmap(seg->base, LOC_STORE_SEGMENT_SZ);
+	_LO_store_path(st, seg->seq, path);
+	unlink(path);
+	LOTRACE_DBG1("segment %08x released", seg->seq);
+
+	seg->base = NULL;
+	st->seg_first = (st->seg_first + 1) % st->seg_max;
+	st->seg_nb--;
+	if (st->seg_nb == 0) {
+		st->write_off = 0;
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+/* Add a new segment at the end of the log (the oldest one is released if the log is full) */
+static int _LO_store_segAdd(LOStore_t* st) {
+	LOStoreSeg_t* seg;
+	char* base;
+
+	if (st->seg_nb >= st->seg_max) {
+		LOTRACE_WARN("Max disk usage reached, release the oldest segment");
+		_LO_store_segRelease(st);
+	}
+	base = _LO_store_map(st, st->seq_next, 1);
+	if (base == NULL) {
+		return -1;
+	}
+	seg = LO_STORE_SEG(st, st->seg_nb);
+	seg->seq = st->seq_next++;
+	seg->base = base;
+	seg->rec_nb = 0;
+	seg->rec_bytes = 0;
+	st->seg_nb++;
+	st->write_off = sizeof(LOStoreSegHdr_t);
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------*/
+/* Count the records of a segment from off, and return the end of the last valid one */
+static uint32_t _LO_store_segScan(LOStore_t* st, LOStoreSeg_t* seg, uint32_t off) {
+	LOStoreRecHdr_t* rec;
+	while ((rec = _LO_store_rec(seg, off)) != NULL) {
+		seg->rec_nb++;
+		seg->rec_bytes += rec->len;
+		off += LO_STORE_REC_SZ(rec->len);
+	}
+	st->backlog += seg->rec_nb;
+	st->backlog_bytes += seg->rec_bytes;
+	return off;
+}
+
+/*---------------------------------------------------------------------------------*/
+/* No valid record at the read position of the oldest segment, which still has records to read:
+ * the records from this position are lost (the length of the bad one cannot be trusted) */
+static void _LO_store_segCorrupt(LOStore_t* st) {
+	LOStoreSeg_t* seg = LO_STORE_SEG(st, 0);
+
+	LOTRACE_ERR("segment %08x: corrupted at %u, %u records lost", seg->seq, LO_STORE_HDR(seg)->read_off,
+			seg->rec_nb);
+	st->backlog -= seg->rec_nb;
+	st->backlog_bytes -= seg->rec_bytes;
+	st->cnt_corrupt += seg->rec_nb;
+	seg->rec_nb = 0;
+	seg->rec_bytes = 0;
+	if (st->seg_nb > 1) {
+		_LO_store_segRelease(st);
+	}
+	else {
+		/* Truncated: the next records are appended after the bad one */
+		LO_STORE_HDR(seg)->read_off = st->write_off;
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+
+static int _LO_store_cmpSeq(const void* a, const void* b) {
+	uint32_t sa = *(const uint32_t*) a;
+	uint32_t sb = *(const uint32_t*) b;
+	return (sa < sb) ? -1 : (sa > sb);
+}
+
+/*---------------------------------------------------------------------------------*/
+/* Map the segment files found in the directory, and find the records not yet read */
+static int _LO_store_recover(LOStore_t* st) {
+	uint32_t* seqs;
+	uint32_t nb = 0;
+	uint32_t i;
+	char path[LO_STORE_PATH_SZ];
+	struct dirent* de;
+	DIR* d = opendir(st->dir);
+
+	if (d == NULL) {
+		LOTRACE_ERR("opendir(%s) ERROR errno=%d", st->dir, errno);
+		return -1;
+	}
+	seqs = (uint32_t*) MEM_ALLOC(st->seg_max * sizeof(uint32_t));
+	if (seqs == NULL) {
+		closedir(d);
+		return -1;
+	}
+	while ((de = readdir(d)) != NULL) {
+		unsigned int seq;
+		char c;
+		if ((sscanf(de->d_name, "lo-%8x.se%c", &seq, &c) != 2) || (c != 'g')) {
+			continue;
+		}
+		if (nb < st->seg_max) {
+			seqs[nb++] = seq;
+		}
+		else {
+			/* Keep the most recent ones */
+			uint32_t imin = 0;
+			for (i = 1; i < nb; i++) {
+				if (seqs[i] < seqs[imin]) {
+					imin = i;
+				}
+			}
+			if (seq > seqs[imin]) {
+				uint32_t old = seqs[imin];
+				seqs[imin] = seq;
+				seq = old;
+			}
+			LOTRACE_WARN("Too many segments, remove %08x", seq);
+			_LO_store_path(st, seq, path);
+			unlink(path);
+		}
+	}
+	closedir(d);
+	qsort(seqs, nb, sizeof(uint32_t), _LO_store_cmpSeq);
+
+	for (i = 0; i < nb; i++) {
+		char* base = _LO_store_map(st, seqs[i], 0);
+		LOStoreSegHdr_t* hdr = (LOStoreSegHdr_t*) base;
+		LOStoreSeg_t* seg;
+		if ((base) && ((hdr->magic != LO_STORE_MAGIC) || (hdr->seq != seqs[i])
+				|| (hdr->read_off < sizeof(LOStoreSegHdr_t)) || (hdr->read_off > LOC_STORE_SEGMENT_SZ))) {
+			munmap(base, LOC_STORE_SEGMENT_SZ);
+			base = NULL;
+		}
+		if (base == NULL) {
+			LOTRACE_WARN("Invalid segment %08x, removed", seqs[i]);
+			_LO_store_path(st, seqs[i], path);
+			unlink(path);
+			continue;
+		}
+		seg = LO_STORE_SEG(st, st->seg_nb);
+		seg->seq = seqs[i];
+		seg->base = base;
+		seg->rec_nb = 0;
+		seg->rec_bytes = 0;
+		st->seg_nb++;
+		st->seq_next = seqs[i] + 1;
+		/* Only the records after the read position of the oldest segment */
+		st->write_off = _LO_store_segScan(st, seg, (st->seg_nb == 1) ? hdr->read_off : sizeof(LOStoreSegHdr_t));
+	}
+	MEM_FREE(seqs);
+
+	if (st->seg_nb) {
+		/* Clear what follows the last record (interrupted write) */
+		LOStoreSeg_t* seg = LO_STORE_SEG(st, st->seg_nb - 1);
+		memset(seg->base + st->write_off, 0, LOC_STORE_SEGMENT_SZ - st->write_off);
+	}
+	return 0;
+}
+
+/*=================================================================================*/
+/* Public Functions*/
+/*---------------------------------------------------------------------------------*/
+
+LOStore_t* LO_store_open(const char* dir, uint32_t max_bytes) {
+	LOStore_t* st;
+
+	if ((dir == NULL) || (*dir == 0) || (strlen(dir) >= sizeof(st->dir))) {
+		LOTRACE_ERR("Invalid directory");
+		return NULL;
+	}
+	if ((mkdir(dir, 0700)) && (errno != EEXIST)) {
+		LOTRACE_ERR("mkdir(%s) ERROR errno=%d", dir, errno);
+		return NULL;
+	}
+
+	st = (LOStore_t*) MEM_ALLOC(sizeof(LOStore_t));
+	if (st == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (size=%u)", (unsigned) sizeof(LOStore_t));
+		return NULL;
+	}
+	memset(st, 0, sizeof(LOStore_t));
+	strcpy(st->dir, dir);
+	st->seg_max = max_bytes / LOC_STORE_SEGMENT_SZ;
+	if (st->seg_max < 2) {
+		st->seg_max = 2;
+	}
+	st->segs = (LOStoreSeg_t*) MEM_ALLOC(st->seg_max * sizeof(LOStoreSeg_t));
+	if (st->segs == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (%u segments)", st->seg_max);
+		MEM_FREE(st);
+		return NULL;
+	}
+	memset(st->segs, 0, st->seg_max * sizeof(LOStoreSeg_t));
+	pthread_mutex_init(&st->mutex, NULL);
+
+	if (_LO_store_recover(st)) {
+		LO_store_close(st);
+		return NULL;
+	}
+	LOTRACE_INF("Store %s: %u segments, %u messages to publish", dir, st->seg_nb, st->backlog);
+	return st;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_store_close(LOStore_t* st) {
+	uint32_t i;
+	if (st == NULL) {
+		return;
+	}
+	for (i = 0; i < st->seg_nb; i++) {
+		LOStoreSeg_t* seg = LO_STORE_SEG(st, i);
+		msync(seg->base, LOC_STORE_SEGMENT_SZ, MS_SYNC);
+		munmap(seg->base, LOC_STORE_SEGMENT_SZ);
+	}
+	pthread_mutex_destroy(&st->mutex);
+	MEM_FREE(st->segs);
+	MEM_FREE(st);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+int LO_store_append(LOStore_t* st, uint8_t type, const char* data, uint32_t len) {
+	LOStoreSeg_t* seg;
+	LOStoreRecHdr_t* rec;
+	uint32_t sz = LO_STORE_REC_SZ(len);
+
+	if ((len == 0) || (sz > (LOC_STORE_SEGMENT_SZ - sizeof(LOStoreSegHdr_t)))) {
+		LOTRACE_ERR("Invalid length %u", len);
+		return -1;
+	}
+
+	pthread_mutex_lock(&st->mutex);
+	if (((st->seg_nb == 0) || ((st->write_off + sz) > LOC_STORE_SEGMENT_SZ)) && (_LO_store_segAdd(st))) {
+		pthread_mutex_unlock(&st->mutex);
+		return -1;
+	}
+	seg = LO_STORE_SEG(st, st->seg_nb - 1);
+	rec = LO_STORE_REC(seg, st->write_off);
+	memcpy(rec + 1, data, len);
+	((char*) (rec + 1))[len] = 0;
+	rec->type = type;
+	rec->sum = _LO_store_sum(type, data, len);
+	/* The record exists when its length is written */
+	__atomic_store_n(&rec->len, len, __ATOMIC_RELEASE);
+
+	st->write_off += sz;
+	seg->rec_nb++;
+	seg->rec_bytes += len;
+	st->backlog++;
+	st->backlog_bytes += len;
+	st->cnt_stored++;
+	pthread_mutex_unlock(&st->mutex);
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+int LO_store_read(LOStore_t* st, uint8_t* type, char* buf, uint32_t buf_sz) {
+	LOStoreRecHdr_t* rec = NULL;
+	int ret = 0;
+
+	pthread_mutex_lock(&st->mutex);
+	while ((st->backlog) && (st->seg_nb)) {
+		LOStoreSeg_t* seg = LO_STORE_SEG(st, 0);
+		if (seg->rec_nb == 0) {
+			if (st->seg_nb == 1) {
+				break;
+			}
+			/* End of this segment, go to the next one */
+			_LO_store_segRelease(st);
+			continue;
+		}
+		rec = _LO_store_rec(seg, LO_STORE_HDR(seg)->read_off);
+		if (rec) {
+			break;
+		}
+		_LO_store_segCorrupt(st);
+	}
+	if (rec) {
+		if ((rec->len + 1) > buf_sz) {
+			LOTRACE_ERR("Record too long (%u bytes)", rec->len);
+			ret = -1;
+		}
+		else {
+			memcpy(buf, rec + 1, rec->len + 1);
+			*type = rec->type;
+			ret = (int) rec->len;
+		}
+	}
+	pthread_mutex_unlock(&st->mutex);
+	return ret;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_store_consume(LOStore_t* st) {
+	LOStoreSeg_t* seg;
+	LOStoreRecHdr_t* rec;
+	uint64_t now_us;
+
+	pthread_mutex_lock(&st->mutex);
+	if ((st->backlog == 0) || (st->seg_nb == 0)) {
+		pthread_mutex_unlock(&st->mutex);
+		return;
+	}
+	seg = LO_STORE_SEG(st, 0);
+	rec = (seg->rec_nb) ? _LO_store_rec(seg, LO_STORE_HDR(seg)->read_off) : NULL;
+	if (rec) {
+		LO_STORE_HDR(seg)->read_off += LO_STORE_REC_SZ(rec->len);
+		seg->rec_nb--;
+		seg->rec_bytes -= rec->len;
+		st->backlog--;
+		st->backlog_bytes -= rec->len;
+		st->cnt_replayed++;
+
+		now_us = LO_sys_timeUs();
+		if ((now_us - st->rate_start_us) >= 1000000) {
+			st->drain_rate = ((now_us - st->rate_start_us) < 2000000) ? st->rate_cnt : 0;
+			st->rate_start_us = now_us;
+			st->rate_cnt = 0;
+		}
+		st->rate_cnt++;
+
+		if ((st->seg_nb > 1) && (seg->rec_nb == 0)) {
+			_LO_store_segRelease(st);
+		}
+	}
+	pthread_mutex_unlock(&st->mutex);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+uint32_t LO_store_backlog(LOStore_t* st) {
+	return __atomic_load_n(&st->backlog, __ATOMIC_ACQUIRE);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_store_getStats(LOStore_t* st, LiveObjectsD_StoreStats_t* stats) {
+	uint64_t now_us = LO_sys_timeUs();
+	pthread_mutex_lock(&st->mutex);
+	stats->st_disk_max = st->seg_max * LOC_STORE_SEGMENT_SZ;
+	stats->st_disk_used = st->seg_nb * LOC_STORE_SEGMENT_SZ;
+	stats->st_segments = st->seg_nb;
+	stats->st_backlog = st->backlog;
+	stats->st_backlog_bytes = st->backlog_bytes;
+	stats->st_stored = st->cnt_stored;
+	stats->st_replayed = st->cnt_replayed;
+	stats->st_dropped = st->cnt_dropped;
+	stats->st_corrupt = st->cnt_corrupt;
+	/* Rate of the last complete second, 0 when nothing was published since */
+	stats->st_drain_rate = ((now_us - st->rate_start_us) < 2000000) ? st->drain_rate : 0;
+	pthread_mutex_unlock(&st->mutex);
+}
@@ -10,38 +10,74 @@
 
 /**
  * @file  loc_sys.c
- * @brief System Interface : Mutex , Thread, ..
+ * @brief System Interface : Mutex , Thread, Events, ..
  */
 
 #include "iotsoftbox-core/loc_sys.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
 #include <pthread.h>
+#include <stdio.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "liveobjects-client/LiveObjectsClient_Config.h"
-#include "liveobjects-client/LiveObjectsClient_Core.h"
+#include "liveobjects-sys/LiveObjectsClient_Platform.h"
 #include "liveobjects-sys/loc_trace.h"
 #include "liveobjects-sys/socket_defs.h"
 
-static pthread_t _lo_sys_thread_id = 0;
-static pthread_t _lo_sys_thread_def;
-static uint32_t _lo_sys_thread_max = 0;
+static uint8_t _lo_sys_ready = 0;
 
 static struct {
 	pthread_mutex_t mutex;
 	pthread_t mutex_id;
 } _lo_sys_mutex[LO_SYS_MUTEX_NB];
 
+struct LOSysMutex_s {
+	pthread_mutex_t mutex;
+};
+
+struct LOSysEvent_s {
+	int epoll_fd;
+	int event_fd;
+	int timer_fd;
+	int sock_fd;
+	int netw_fd;      /* Netlink socket, notified of the changes of the network interfaces (or -1) */
+};
+
+struct LOSysEventGroup_s {
+	int epoll_fd;
+	int event_fd;
+};
+
+typedef struct {
+	LO_sys_threadFunc_t func;
+	void* argument;
+} LOSysThreadArg_t;
+
 /*=================================================================================*/
 /* Private Functions*/
 /*---------------------------------------------------------------------------------*/
 
 static void * _LO_sys_threadExec(void *argument) {
-	LOTRACE_DBG1(" _LO_sys_threadExec: go %p...", argument);
+	LOSysThreadArg_t thr = *(LOSysThreadArg_t*) argument;
+	MEM_FREE(argument);
+
+	LOTRACE_DBG1(" _LO_sys_threadExec: go %p...", thr.argument);
 
-	LiveObjectsClient_Run((LiveObjectsD_CallbackState_t) argument);
+	thr.func(thr.argument);
 
 	LOTRACE_WARN(" _LO_sys_threadExec: EXIT");
+	return NULL;
 }
 
 /*=================================================================================*/
@@ -50,8 +86,10 @@ static void * _LO_sys_threadExec(void *argument) {
 /* Initialization*/
 void LO_sys_init(void) {
 	int i;
-	_lo_sys_thread_id = 0;
-	_lo_sys_thread_max = 0;
+	if (_lo_sys_ready) {
+		/* Already done by another LiveObjects Client instance */
+		return;
+	}
 
 	memset(_lo_sys_mutex, 0, sizeof(_lo_sys_mutex));
 
@@ -59,6 +97,7 @@ void LO_sys_init(void) {
 		pthread_mutex_init(&_lo_sys_mutex[i].mutex, NULL);
 		/* TODO Think to do something if the initialization goes wrong*/
 	}
+	_lo_sys_ready = 1;
 }
 /*=================================================================================*/
 /* MUTEX*/
@@ -84,42 +123,75 @@ void LO_sys_mutex_unlock(uint8_t idx) {
 		pthread_mutex_unlock(&_lo_sys_mutex[idx].mutex);
 }
 
-/*=================================================================================*/
-/* THREAD*/
 /*---------------------------------------------------------------------------------*/
 
-void LO_sys_threadRun(void) {
-	pthread_t id = pthread_self();
-	if ((_lo_sys_thread_id) && (_lo_sys_thread_id != id)) {
-		LOTRACE_WARN(" LO_sys_threadRun: %lu %lu", _lo_sys_thread_id, id);
-	} else {
-		LOTRACE_WARN("LiveObjectsClient: thread_id= x%lu (x%lu)", id,
-				_lo_sys_thread_id);
+LOSysMutex_t* LO_sys_mutexCreate(void) {
+	LOSysMutex_t* mtx = (LOSysMutex_t*) MEM_ALLOC(sizeof(LOSysMutex_t));
+	if (mtx == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR");
+		return NULL;
+	}
+	if (pthread_mutex_init(&mtx->mutex, NULL)) {
+		LOTRACE_ERR("Error to initialize the mutex");
+		MEM_FREE(mtx);
+		return NULL;
+	}
+	return mtx;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_mutexDelete(LOSysMutex_t* mtx) {
+	if (mtx) {
+		pthread_mutex_destroy(&mtx->mutex);
+		MEM_FREE(mtx);
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_mutexLock(LOSysMutex_t* mtx) {
+	int ret = pthread_mutex_lock(&mtx->mutex);
+	if (ret != 0) {
+		LOTRACE_ERR(" !!!! LO_sys_mutexLock(%p): ERROR %x", mtx, ret);
 	}
-	_lo_sys_thread_id = id;
 }
 
 /*---------------------------------------------------------------------------------*/
 
-uint8_t LO_sys_threadIsLiveObjectsClient(void) {
-	pthread_t id = pthread_self();
-	return (_lo_sys_thread_id == id) ? 1 : 0;
+void LO_sys_mutexUnlock(LOSysMutex_t* mtx) {
+	pthread_mutex_unlock(&mtx->mutex);
+}
+
+/*=================================================================================*/
+/* THREAD*/
+/*---------------------------------------------------------------------------------*/
+
+uintptr_t LO_sys_threadSelf(void) {
+	return (uintptr_t) pthread_self();
 }
 
 /*---------------------------------------------------------------------------------*/
 
-int LO_sys_threadStart(const void *argument) {
-	memset(&_lo_sys_thread_def, 0, sizeof(_lo_sys_thread_def));
+int LO_sys_threadStart(LO_sys_threadFunc_t func, void* argument) {
+	pthread_t thread_id;
+	LOSysThreadArg_t* thr = (LOSysThreadArg_t*) MEM_ALLOC(sizeof(LOSysThreadArg_t));
+	if (thr == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR");
+		return -1;
+	}
+	thr->func = func;
+	thr->argument = argument;
 
-	int ret = pthread_create(&_lo_sys_thread_def, NULL, _LO_sys_threadExec,
-			(void *) argument);
+	int ret = pthread_create(&thread_id, NULL, _LO_sys_threadExec, thr);
 	if (ret != 0) {
 		LOTRACE_ERR("Error while creating LiveObjects Client Thread ..");
+		MEM_FREE(thr);
 		return -1;
 	}
+	pthread_detach(thread_id);
 
-	LOTRACE_WARN("LiveObjects Client Thread x%lu is running !!!",
-			_lo_sys_thread_id);
+	LOTRACE_WARN("LiveObjects Client Thread x%lu is running !!!", thread_id);
 	return 0;
 }
 
@@ -128,3 +200,425 @@ int LO_sys_threadStart(const void *argument) {
 void LO_sys_threadCheck(void) {
 	/* TODO add some stuff or remove the function*/
 }
+
+/*---------------------------------------------------------------------------------*/
+
+uint32_t LO_sys_cpuCount(void) {
+	long nb = sysconf(_SC_NPROCESSORS_ONLN);
+	return (nb > 0) ? (uint32_t) nb : 1;
+}
+
+/*=================================================================================*/
+/* TIME*/
+/*---------------------------------------------------------------------------------*/
+
+uint64_t LO_sys_timeUs(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ((uint64_t) ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+int LO_sys_dateStr(char* buf, uint32_t sz) {
+	struct timespec ts;
+	struct tm tm;
+	int len;
+	if ((clock_gettime(CLOCK_REALTIME, &ts)) || (gmtime_r(&ts.tv_sec, &tm) == NULL)) {
+		return 0;
+	}
+	len = snprintf(buf, sz, "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", tm.tm_year + 1900, tm.tm_mon + 1,
+			tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, (int) (ts.tv_nsec / 1000000));
+	return ((len > 0) && ((uint32_t) len < sz)) ? len : 0;
+}
+
+/*=================================================================================*/
+/* FILES*/
+/*---------------------------------------------------------------------------------*/
+
+int LO_sys_fileSave(const char* path, const void* data, uint32_t len) {
+	char tmp[256];
+	int fd;
+	ssize_t n;
+
+	if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int) sizeof(tmp)) {
+		LOTRACE_ERR("Path too long: %s", path);
+		return -1;
+	}
+	fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+	if (fd < 0) {
+		LOTRACE_ERR("open(%s) ERROR errno=%d", tmp, errno);
+		return -1;
+	}
+	n = write(fd, data, len);
+	if ((n != (ssize_t) len) || (fsync(fd))) {
+		LOTRACE_ERR("write(%s) ERROR errno=%d", tmp, errno);
+		close(fd);
+		unlink(tmp);
+		return -1;
+	}
+	close(fd);
+	if (rename(tmp, path)) {
+		LOTRACE_ERR("rename(%s) ERROR errno=%d", path, errno);
+		unlink(tmp);
+		return -1;
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+char* LO_sys_fileLoad(const char* path, uint32_t max_len, uint32_t* p_len) {
+	struct stat sb;
+	char* data;
+	int fd;
+
+	fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		if (errno != ENOENT) {
+			LOTRACE_ERR("open(%s) ERROR errno=%d", path, errno);
+		}
+		return NULL;
+	}
+	if ((fstat(fd, &sb)) || (sb.st_size <= 0) || (sb.st_size > max_len)) {
+		LOTRACE_ERR("%s: bad size", path);
+		close(fd);
+		return NULL;
+	}
+	data = (char*) MEM_ALLOC(sb.st_size);
+	if (data == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR (size=%u)", (unsigned) sb.st_size);
+		close(fd);
+		return NULL;
+	}
+	if (read(fd, data, sb.st_size) != sb.st_size) {
+		LOTRACE_ERR("read(%s) ERROR errno=%d", path, errno);
+		MEM_FREE(data);
+		close(fd);
+		return NULL;
+	}
+	close(fd);
+	*p_len = (uint32_t) sb.st_size;
+	return data;
+}
+
+/*=================================================================================*/
+/* EVENTS*/
+/*---------------------------------------------------------------------------------*/
+
+static int _LO_sys_eventAdd(LOSysEvent_t* ev, int fd, uint32_t event) {
+	struct epoll_event epev;
+	memset(&epev, 0, sizeof(epev));
+	epev.events = EPOLLIN;
+	epev.data.u32 = event;
+	return epoll_ctl(ev->epoll_fd, EPOLL_CTL_ADD, fd, &epev);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+static void _LO_sys_eventDrain(int fd) {
+	uint64_t cnt;
+	/* Reset the counter of the eventfd/timerfd */
+	if (read(fd, &cnt, sizeof(cnt)) < 0) {
+		LOTRACE_DBG1("fd %d: nothing to read, errno=%d", fd, errno);
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+
+static void _LO_sys_eventArm(LOSysEvent_t* ev, int32_t timeout_ms) {
+	struct itimerspec its;
+	memset(&its, 0, sizeof(its));
+	if (timeout_ms > 0) {
+		its.it_value.tv_sec = timeout_ms / 1000;
+		its.it_value.tv_nsec = (timeout_ms % 1000) * 1000000L;
+	}
+	/* A zero value disarms the timer */
+	timerfd_settime(ev->timer_fd, 0, &its, NULL);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+static int _LO_sys_eventCollect(LOSysEvent_t* ev, const struct epoll_event* evs, int n) {
+	int mask = 0;
+	int i;
+	for (i = 0; i < n; i++) {
+		mask |= evs[i].data.u32;
+	}
+	if (mask & LO_SYS_EVENT_USER) {
+		_LO_sys_eventDrain(ev->event_fd);
+	}
+	if (mask & LO_SYS_EVENT_TIMER) {
+		_LO_sys_eventDrain(ev->timer_fd);
+	}
+	if (mask & LO_SYS_EVENT_NETW) {
+		/* Only the notification matters, not its content */
+		char buf[4096];
+		while (recv(ev->netw_fd, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+		}
+	}
+	return mask;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+LOSysEvent_t* LO_sys_eventCreate(void) {
+	LOSysEvent_t* ev = (LOSysEvent_t*) MEM_ALLOC(sizeof(LOSysEvent_t));
+	if (ev == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR");
+		return NULL;
+	}
+	ev->sock_fd = -1;
+	ev->netw_fd = -1;
+	ev->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	ev->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	ev->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if ((ev->epoll_fd < 0) || (ev->event_fd < 0) || (ev->timer_fd < 0)
+			|| _LO_sys_eventAdd(ev, ev->event_fd, LO_SYS_EVENT_USER)
+			|| _LO_sys_eventAdd(ev, ev->timer_fd, LO_SYS_EVENT_TIMER)) {
+		LOTRACE_ERR("Error to create the event fds, errno=%d", errno);
+		LO_sys_eventDelete(ev);
+		return NULL;
+	}
+	return ev;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_eventDelete(LOSysEvent_t* ev) {
+	if (ev == NULL) {
+		return;
+	}
+	if (ev->epoll_fd >= 0)
+		close(ev->epoll_fd);
+	if (ev->event_fd >= 0)
+		close(ev->event_fd);
+	if (ev->timer_fd >= 0)
+		close(ev->timer_fd);
+	if (ev->netw_fd >= 0)
+		close(ev->netw_fd);
+	MEM_FREE(ev);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_eventSocket(LOSysEvent_t* ev, int sock_fd) {
+	if ((ev == NULL) || (sock_fd == ev->sock_fd)) {
+		return;
+	}
+	if (ev->sock_fd >= 0) {
+		/* Fails when the socket is already closed (then removed from the epoll set) */
+		epoll_ctl(ev->epoll_fd, EPOLL_CTL_DEL, ev->sock_fd, NULL);
+	}
+	ev->sock_fd = -1;
+	if (sock_fd >= 0) {
+		if (_LO_sys_eventAdd(ev, sock_fd, LO_SYS_EVENT_SOCK)) {
+			LOTRACE_ERR("Error to add socket %d, errno=%d", sock_fd, errno);
+			return;
+		}
+		ev->sock_fd = sock_fd;
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_eventSignal(LOSysEvent_t* ev) {
+	uint64_t one = 1;
+	if ((ev) && (write(ev->event_fd, &one, sizeof(one)) < 0)) {
+		/* EAGAIN: counter overflow, the event is already signaled */
+		LOTRACE_DBG1("eventfd write error, errno=%d", errno);
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+
+int LO_sys_eventWait(LOSysEvent_t* ev, int32_t timeout_ms) {
+	struct epoll_event evs[4];
+	int n;
+
+	if (ev == NULL) {
+		/* No event support: wait as before */
+		if (timeout_ms > 0)
+			WAIT_MS(timeout_ms);
+		return LO_SYS_EVENT_TIMER;
+	}
+
+	_LO_sys_eventArm(ev, timeout_ms);
+
+	n = epoll_wait(ev->epoll_fd, evs, 4, (timeout_ms == 0) ? 0 : -1);
+	if (n < 0) {
+		if (errno != EINTR) {
+			LOTRACE_ERR("epoll_wait error, errno=%d", errno);
+			return -1;
+		}
+		return 0;
+	}
+	if (n == 0) {
+		return LO_SYS_EVENT_TIMER;
+	}
+	return _LO_sys_eventCollect(ev, evs, n);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+int LO_sys_eventPoll(LOSysEvent_t* ev) {
+	struct epoll_event evs[4];
+	int n;
+
+	if (ev == NULL) {
+		return -1;
+	}
+	n = epoll_wait(ev->epoll_fd, evs, 4, 0);
+	if (n <= 0) {
+		return 0;
+	}
+	return _LO_sys_eventCollect(ev, evs, n);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_eventTimer(LOSysEvent_t* ev, int32_t timeout_ms) {
+	if (ev == NULL) {
+		return;
+	}
+	if (timeout_ms == 0) {
+		/* Expired at once */
+		struct itimerspec its;
+		memset(&its, 0, sizeof(its));
+		its.it_value.tv_nsec = 1;
+		timerfd_settime(ev->timer_fd, 0, &its, NULL);
+	}
+	else {
+		_LO_sys_eventArm(ev, timeout_ms);
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_eventNetwork(LOSysEvent_t* ev, uint8_t enable) {
+	struct sockaddr_nl addr;
+
+	if ((ev == NULL) || ((ev->netw_fd >= 0) == (enable != 0))) {
+		return;
+	}
+	if (!enable) {
+		/* Also removed from the epoll set */
+		close(ev->netw_fd);
+		ev->netw_fd = -1;
+		return;
+	}
+	ev->netw_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+	if (ev->netw_fd < 0) {
+		LOTRACE_ERR("Error to create the netlink socket, errno=%d", errno);
+		return;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK;
+	addr.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR | RTMGRP_IPV4_ROUTE;
+	if ((bind(ev->netw_fd, (struct sockaddr*) &addr, sizeof(addr)))
+			|| (_LO_sys_eventAdd(ev, ev->netw_fd, LO_SYS_EVENT_NETW))) {
+		LOTRACE_ERR("Error to bind the netlink socket, errno=%d", errno);
+		close(ev->netw_fd);
+		ev->netw_fd = -1;
+	}
+}
+
+/*=================================================================================*/
+/* GROUPS OF EVENTS*/
+/*---------------------------------------------------------------------------------*/
+
+LOSysEventGroup_t* LO_sys_groupCreate(void) {
+	struct epoll_event epev;
+	LOSysEventGroup_t* grp = (LOSysEventGroup_t*) MEM_ALLOC(sizeof(LOSysEventGroup_t));
+	if (grp == NULL) {
+		LOTRACE_ERR("MEM_ALLOC ERROR");
+		return NULL;
+	}
+	grp->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	grp->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	memset(&epev, 0, sizeof(epev));
+	epev.events = EPOLLIN;
+	/* The group itself is identified by a NULL context */
+	epev.data.ptr = NULL;
+	if ((grp->epoll_fd < 0) || (grp->event_fd < 0)
+			|| epoll_ctl(grp->epoll_fd, EPOLL_CTL_ADD, grp->event_fd, &epev)) {
+		LOTRACE_ERR("Error to create the group fds, errno=%d", errno);
+		LO_sys_groupDelete(grp);
+		return NULL;
+	}
+	return grp;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_groupDelete(LOSysEventGroup_t* grp) {
+	if (grp == NULL) {
+		return;
+	}
+	if (grp->epoll_fd >= 0)
+		close(grp->epoll_fd);
+	if (grp->event_fd >= 0)
+		close(grp->event_fd);
+	MEM_FREE(grp);
+}
+
+/*---------------------------------------------------------------------------------*/
+
+int LO_sys_groupAdd(LOSysEventGroup_t* grp, LOSysEvent_t* ev, void* ctx) {
+	struct epoll_event epev;
+	if ((grp == NULL) || (ev == NULL) || (ctx == NULL)) {
+		return -1;
+	}
+	/* An epoll fd is readable when one of its fds is ready */
+	memset(&epev, 0, sizeof(epev));
+	epev.events = EPOLLIN;
+	epev.data.ptr = ctx;
+	if (epoll_ctl(grp->epoll_fd, EPOLL_CTL_ADD, ev->epoll_fd, &epev)) {
+		LOTRACE_ERR("Error to add the event set %p, errno=%d", ev, errno);
+		return -1;
+	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_groupRemove(LOSysEventGroup_t* grp, LOSysEvent_t* ev) {
+	if ((grp) && (ev)) {
+		epoll_ctl(grp->epoll_fd, EPOLL_CTL_DEL, ev->epoll_fd, NULL);
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+
+void LO_sys_groupSignal(LOSysEventGroup_t* grp) {
+	uint64_t one = 1;
+	if ((grp) && (write(grp->event_fd, &one, sizeof(one)) < 0)) {
+		LOTRACE_DBG1("eventfd write error, errno=%d", errno);
+	}
+}
+
+/*---------------------------------------------------------------------------------*/
+
+int LO_sys_groupWait(LOSysEventGroup_t* grp, int32_t timeout_ms, void** ctx_list, int ctx_max) {
+	struct epoll_event evs[64];
+	int i, n, cnt = 0;
+
+	if (ctx_max > (int) (sizeof(evs) / sizeof(evs[0]))) {
+		ctx_max = (int) (sizeof(evs) / sizeof(evs[0]));
+	}
+	n = epoll_wait(grp->epoll_fd, evs, ctx_max, (timeout_ms < 0) ? -1 : timeout_ms);
+	if (n < 0) {
+		if (errno != EINTR) {
+			LOTRACE_ERR("epoll_wait error, errno=%d", errno);
+			return -1;
+		}
+		return 0;
+	}
+	for (i = 0; i < n; i++) {
+		if (evs[i].data.ptr) {
+			ctx_list[cnt++] = evs[i].data.ptr;
+		}
+		else {
+			_LO_sys_eventDrain(grp->event_fd);
+		}
+	}
+	return cnt;
+}
@@ -19,6 +19,8 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -28,6 +30,9 @@
 #include <sys/types.h>
 #include <time.h>
 #include <unistd.h>
+#if LOC_NETW_KTLS
+#include <linux/tls.h>
+#endif
 
 #include "iotsoftbox-core/loc_sock.h"
 #include "liveobjects-sys/LiveObjectsClient_Platform.h"
@@ -37,7 +42,8 @@
 #include "mbedtls/net_sockets.h"
 #include "mbedtls/ssl.h"
 
-static int _netw_socket;
+/* Socket of the network connection given to the mbedtls callbacks */
+#define NETW_SOCK(pNetwork)   (((Network*) (pNetwork))->my_socket)
 
 /*---------------------------------------------------------------------------------*/
 
@@ -47,51 +53,99 @@ int f_netw_sock_init(Network *pNetwork, void *net_iface_handler) {
 		pNetwork->mqttread = NULL;
 		pNetwork->mqttwrite = NULL;
 	}
-	_netw_socket = -1;
 	return 0;
 }
 
 uint8_t f_netw_sock_isOpen(Network *pNetwork) {
-	return (_netw_socket >= 0) ? 1 : 0;
+	return ((pNetwork) && (pNetwork->my_socket >= 0)) ? 1 : 0;
 }
 
+/* Lost if the TCP connection is no longer established: closed by the peer (FIN or RST received),
+ * or aborted by the kernel (keepalive probes or data not acknowledged in time) */
 uint8_t f_netw_sock_isLost(Network *pNetwork) {
+	struct tcp_info info;
+	socklen_t len = sizeof(info);
+	int err = 0;
+
+	if ((pNetwork == NULL) || (pNetwork->my_socket < 0)) {
+		return 0;
+	}
+	if (getsockopt(pNetwork->my_socket, IPPROTO_TCP, TCP_INFO, &info, &len) == 0) {
+		if (info.tcpi_state != TCP_ESTABLISHED) {
+			LOTRACE_WARN("Connection lost (sock=%d TCP state=%u)", pNetwork->my_socket, info.tcpi_state);
+			return 1;
+		}
+		return 0;
+	}
+	len = sizeof(err);
+	if ((getsockopt(pNetwork->my_socket, SOL_SOCKET, SO_ERROR, &err, &len) == 0) && (err)) {
+		LOTRACE_WARN("Connection lost (sock=%d error=%d)", pNetwork->my_socket, err);
+		return 1;
+	}
 	return 0;
 }
 
 int f_netw_sock_close(Network *pNetwork) {
-	LOTRACE_DBG1("f_netw_sock_close(%d %p)...", _netw_socket, pNetwork);
-	if (_netw_socket >= 0) {
-		close(_netw_socket);
-	}
-	_netw_socket = -1;
 	if (pNetwork) {
+		LOTRACE_DBG1("f_netw_sock_close(%d %p)...", pNetwork->my_socket, pNetwork);
+		if (pNetwork->my_socket >= 0) {
+			close(pNetwork->my_socket);
+		}
 		pNetwork->my_socket = -1;
 	}
 	return 0;
 }
 
+static void f_netw_sock_option(int sock, int level, int name, int value, const char* label) {
+	if (setsockopt(sock, level, name, &value, sizeof(value)) < 0) {
+		LOTRACE_WARN("setsockopt(%s=%d) failed, errno=%d", label, value, errno);
+	}
+}
+
+/* Socket options of the connection (see LOC_NETW_TCP_* and LOC_NETW_SOCK_* parameters) */
 int f_netw_sock_setup(Network *pNetwork) {
+	int sock;
+	if ((pNetwork == NULL) || (pNetwork->my_socket < 0)) {
+		return -1;
+	}
+	sock = pNetwork->my_socket;
+#if LOC_NETW_TCP_NODELAY
+	/* Small MQTT packets are sent at once (they are already gathered by netw_batchStart/netw_batchFlush) */
+	f_netw_sock_option(sock, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+#endif
+	/* Probes sent by the kernel on an idle connection: a dead peer is detected between two MQTT PINGREQ */
+	f_netw_sock_option(sock, SOL_SOCKET, SO_KEEPALIVE, (LOC_NETW_TCP_KEEPIDLE_S > 0), "SO_KEEPALIVE");
+#if LOC_NETW_TCP_KEEPIDLE_S > 0
+	f_netw_sock_option(sock, IPPROTO_TCP, TCP_KEEPIDLE, LOC_NETW_TCP_KEEPIDLE_S, "TCP_KEEPIDLE");
+	f_netw_sock_option(sock, IPPROTO_TCP, TCP_KEEPINTVL, LOC_NETW_TCP_KEEPINTVL_S, "TCP_KEEPINTVL");
+	f_netw_sock_option(sock, IPPROTO_TCP, TCP_KEEPCNT, LOC_NETW_TCP_KEEPCNT, "TCP_KEEPCNT");
+#endif
+#if LOC_NETW_TCP_USER_TIMEOUT_MS > 0
+	/* Connection aborted when the data sent are not acknowledged in time */
+	f_netw_sock_option(sock, IPPROTO_TCP, TCP_USER_TIMEOUT, LOC_NETW_TCP_USER_TIMEOUT_MS, "TCP_USER_TIMEOUT");
+#endif
+#if LOC_NETW_SOCK_SNDBUF > 0
+	f_netw_sock_option(sock, SOL_SOCKET, SO_SNDBUF, LOC_NETW_SOCK_SNDBUF, "SO_SNDBUF");
+#endif
+#if LOC_NETW_SOCK_RCVBUF > 0
+	f_netw_sock_option(sock, SOL_SOCKET, SO_RCVBUF, LOC_NETW_SOCK_RCVBUF, "SO_RCVBUF");
+#endif
 	return 0;
 }
 
 /*---------------------------------------------------------------------------------*/
 
 int f_netw_sock_connect(Network *pNetwork, const char *RemoteHostAddress,
-		uint16_t RemoteHostPort, uint32_t tmo_ms) {
+		uint16_t RemoteHostPort, uint32_t tmo_ms, uint32_t* p_dns_ms) {
 	int ret;
 	LOTRACE_DBG1(
-			"(RemoteHostAddress=%s RemoteHostPort=%u) (_netw_socket=%d) ...",
-			RemoteHostAddress, RemoteHostPort, _netw_socket);
-	if (_netw_socket >= 0) {
-		close(_netw_socket);
-	}
-	_netw_socket = -1;
-	ret = LO_sock_connect(1, RemoteHostAddress, RemoteHostPort, &_netw_socket);
-
-	if (pNetwork) {
-		pNetwork->my_socket = _netw_socket;
+			"(RemoteHostAddress=%s RemoteHostPort=%u) (my_socket=%d) ...",
+			RemoteHostAddress, RemoteHostPort, pNetwork->my_socket);
+	if (pNetwork->my_socket >= 0) {
+		close(pNetwork->my_socket);
 	}
+	pNetwork->my_socket = -1;
+	ret = LO_sock_connectTmo(RemoteHostAddress, RemoteHostPort, tmo_ms, &pNetwork->my_socket, p_dns_ms);
 	return ret;
 }
 
@@ -100,81 +154,87 @@ int f_netw_sock_connect(Network *pNetwork, const char *RemoteHostAddress,
 int f_netw_sock_recv(void *pNetwork, unsigned char *buf, size_t len) {
 	int ret;
 
-	if (_netw_socket < 0)
+	if (NETW_SOCK(pNetwork) < 0)
 		return (MBEDTLS_ERR_NET_INVALID_CONTEXT);
 
-	/* LOTRACE_DBG1("(pNetwork=%p _netw_socket=%d buf=%p len=%d) ...", pNetwork,*/
-	/* _netw_socket, buf, len);*/
-	ret = (int) recv(_netw_socket, buf, len, 0);
+	/* LOTRACE_DBG1("(pNetwork=%p sock=%d buf=%p len=%d) ...", pNetwork,*/
+	/* NETW_SOCK(pNetwork), buf, len);*/
+	ret = (int) recv(NETW_SOCK(pNetwork), buf, len, 0);
 	if (ret < 0) {
 		if (errno == EINTR) {
-			LOTRACE_INF("(pNetwork=%p _netw_socket=%d len=%x) ret=%d x%x",
-					pNetwork, _netw_socket, len, ret,
+			LOTRACE_INF("(pNetwork=%p sock=%d len=%x) ret=%d x%x",
+					pNetwork, NETW_SOCK(pNetwork), len, ret,
 					MBEDTLS_ERR_SSL_WANT_READ);
 			return (MBEDTLS_ERR_SSL_WANT_READ);
 		}
 
 		if (errno == EPIPE || errno == ECONNRESET) {
 			LOTRACE_ERR(
-					"(pNetwork=%p _netw_socket=%d len=%x) ret=%d errno=%d x%x",
-					pNetwork, _netw_socket, len, ret, errno,
+					"(pNetwork=%p sock=%d len=%x) ret=%d errno=%d x%x",
+					pNetwork, NETW_SOCK(pNetwork), len, ret, errno,
 					MBEDTLS_ERR_NET_CONN_RESET);
 			return (MBEDTLS_ERR_NET_CONN_RESET);
 		}
-		LOTRACE_ERR("(pNetwork=%p _netw_socket=%d len=%x) ret=%d errno=%d x%x",
-				pNetwork, _netw_socket, len, ret, errno,
+		LOTRACE_ERR("(pNetwork=%p sock=%d len=%x) ret=%d errno=%d x%x",
+				pNetwork, NETW_SOCK(pNetwork), len, ret, errno,
 				MBEDTLS_ERR_NET_RECV_FAILED);
 		return (MBEDTLS_ERR_NET_RECV_FAILED);
 	}
-	LOTRACE_DBG_VERBOSE("(pNetwork=%p _netw_socket=%d len=%d) ret=%d", pNetwork,
-			_netw_socket, len, ret);
+	LOTRACE_DBG_VERBOSE("(pNetwork=%p sock=%d len=%d) ret=%d", pNetwork,
+			NETW_SOCK(pNetwork), len, ret);
 	return (ret);
 }
 
 /*---------------------------------------------------------------------------------*/
 
-int f_netw_sock_recv_timeout(void *pNetwork, unsigned char *buf, size_t len,
-		uint32_t timeout) {
+/* Wait for received data: 0 when the socket is readable, or an error (timeout) */
+static int f_netw_sock_wait(void *pNetwork, size_t len, uint32_t timeout) {
 	int ret;
-	struct timeval tv;
-	fd_set read_fds;
+	struct pollfd pfd;
+	(void) len; /* only traced */
 
-	LOTRACE_DBG_VERBOSE("(pNetwork=%p _netw_socket=%d buf=%p len=%d tmo=%u)...",
-			pNetwork, _netw_socket, buf, len, timeout);
+	LOTRACE_DBG_VERBOSE("(pNetwork=%p sock=%d len=%d tmo=%u)...",
+			pNetwork, NETW_SOCK(pNetwork), len, timeout);
 
-	if (_netw_socket < 0) {
-		LOTRACE_ERR("Invalid context %d", _netw_socket);
+	if (NETW_SOCK(pNetwork) < 0) {
+		LOTRACE_ERR("Invalid context %d", NETW_SOCK(pNetwork));
 		return (MBEDTLS_ERR_NET_INVALID_CONTEXT);
 	}
 
-	FD_ZERO(&read_fds);
-	FD_SET(_netw_socket, &read_fds);
-
-	tv.tv_sec = timeout / 1000;
-	tv.tv_usec = (timeout % 1000) * 1000;
+	/* poll() rather than select(): the socket may be above FD_SETSIZE (gateway) */
+	pfd.fd = NETW_SOCK(pNetwork);
+	pfd.events = POLLIN;
+	pfd.revents = 0;
 
-	struct timeval tv_const = tv;
-
-	ret = select(_netw_socket + 1, &read_fds, NULL, NULL,
-			timeout == ((uint32_t) -1) ? NULL : &tv_const);
+	ret = poll(&pfd, 1, timeout == ((uint32_t) -1) ? -1 : (int) timeout);
 	/* Zero fds ready means we timed out */
 	if (ret == 0) {
 		LOTRACE_DBG_VERBOSE("TIMEOUT (sock=%d len=%d tmo=%u) => x%x!",
-				_netw_socket, len, timeout, MBEDTLS_ERR_SSL_TIMEOUT);
+				NETW_SOCK(pNetwork), len, timeout, MBEDTLS_ERR_SSL_TIMEOUT);
 		return (MBEDTLS_ERR_SSL_TIMEOUT);
 	}
 
 	if (ret < 0) {
 		if (errno == EINTR) {
-			LOTRACE_WARN("SELECT INTERRUPT (sock=%d tmo=%u) %d !", _netw_socket,
+			LOTRACE_WARN("POLL INTERRUPT (sock=%d tmo=%u) %d !", NETW_SOCK(pNetwork),
 					timeout, ret);
 			return (MBEDTLS_ERR_SSL_WANT_READ);
 		}
-		LOTRACE_WARN("SELECT ERR (sock=%d tmo=%u) %d !", _netw_socket, timeout,
+		LOTRACE_WARN("POLL ERR (sock=%d tmo=%u) %d !", NETW_SOCK(pNetwork), timeout,
 				ret);
 		return (MBEDTLS_ERR_NET_RECV_FAILED);
 	}
+	return 0;
+}
+
+/*---------------------------------------------------------------------------------*/
 
+int f_netw_sock_recv_timeout(void *pNetwork, unsigned char *buf, size_t len,
+		uint32_t timeout) {
+	int ret = f_netw_sock_wait(pNetwork, len, timeout);
+	if (ret) {
+		return ret;
+	}
 	/* This call will not block */
 	return (f_netw_sock_recv(pNetwork, buf, len));
 }
@@ -184,15 +244,15 @@ int f_netw_sock_recv_timeout(void *pNetwork, unsigned char *buf, size_t len,
 int f_netw_sock_send(void *pNetwork, const unsigned char *buf, size_t len) {
 	int ret;
 
-	LOTRACE_DBG_VERBOSE("(pNetwork=%p _netw_socket=%d buf=%p len=%d)...",
-			pNetwork, _netw_socket, buf, len);
+	LOTRACE_DBG_VERBOSE("(pNetwork=%p sock=%d buf=%p len=%d)...",
+			pNetwork, NETW_SOCK(pNetwork), buf, len);
 
-	if (_netw_socket < 0) {
-		LOTRACE_ERR("Invalid context %d", _netw_socket);
+	if (NETW_SOCK(pNetwork) < 0) {
+		LOTRACE_ERR("Invalid context %d", NETW_SOCK(pNetwork));
 		return (MBEDTLS_ERR_NET_INVALID_CONTEXT);
 	}
 
-	ret = (int) send(_netw_socket, buf, len, 0);
+	ret = (int) send(NETW_SOCK(pNetwork), buf, len, MSG_NOSIGNAL);
 	if (ret < 0) {
 		if (errno == EINTR) {
 			return (MBEDTLS_ERR_SSL_WANT_WRITE);
@@ -207,7 +267,198 @@ int f_netw_sock_send(void *pNetwork, const unsigned char *buf, size_t len) {
 		return (MBEDTLS_ERR_NET_SEND_FAILED);
 	}
 
-	LOTRACE_DBG_VERBOSE("(_netw_socket=%d len=%d) ret= %d", _netw_socket, len,
+	LOTRACE_DBG_VERBOSE("(sock=%d len=%d) ret= %d", NETW_SOCK(pNetwork), len,
 			ret);
 	return (ret);
 }
+
+/*---------------------------------------------------------------------------------*/
+
+#if LOC_NETW_KTLS
+#ifndef TCP_ULP
+#define TCP_ULP   31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS   282
+#endif
+
+/* TLS record content types */
+#define NETW_TLS_ALERT           21
+#define NETW_TLS_APPLICATION     23
+
+/* Keys of one direction given to the kernel (TLS_TX or TLS_RX) */
+static int f_netw_sock_ktls_set(int sock, int dir, const netw_ktls_crypto_t* crypto, const char* label) {
+	union {
+		struct tls12_crypto_info_aes_gcm_128 gcm128;
+		struct tls12_crypto_info_aes_gcm_256 gcm256;
+	} info;
+	volatile unsigned char* p;
+	socklen_t len;
+	size_t i;
+	int ret;
+
+	memset(&info, 0, sizeof(info));
+	if (crypto->key_len == TLS_CIPHER_AES_GCM_128_KEY_SIZE) {
+		info.gcm128.info.version = TLS_1_2_VERSION;
+		info.gcm128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+		memcpy(info.gcm128.key, crypto->key, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+		memcpy(info.gcm128.salt, crypto->salt, TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+		/* Explicit part of the nonce: the sequence number, as mbedtls does */
+		memcpy(info.gcm128.iv, crypto->seq, TLS_CIPHER_AES_GCM_128_IV_SIZE);
+		memcpy(info.gcm128.rec_seq, crypto->seq, TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE);
+		len = sizeof(info.gcm128);
+	}
+	else if (crypto->key_len == TLS_CIPHER_AES_GCM_256_KEY_SIZE) {
+		info.gcm256.info.version = TLS_1_2_VERSION;
+		info.gcm256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+		memcpy(info.gcm256.key, crypto->key, TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+		memcpy(info.gcm256.salt, crypto->salt, TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+		memcpy(info.gcm256.iv, crypto->seq, TLS_CIPHER_AES_GCM_256_IV_SIZE);
+		memcpy(info.gcm256.rec_seq, crypto->seq, TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE);
+		len = sizeof(info.gcm256);
+	}
+	else {
+		LOTRACE_WARN("%s: unsupported key length %u", label, crypto->key_len);
+		return -1;
+	}
+	ret = setsockopt(sock, SOL_TLS, dir, &info, len);
+	if (ret < 0) {
+		LOTRACE_WARN("setsockopt(SOL_TLS, %s) failed, errno=%d", label, errno);
+	}
+	/* Erase the keys */
+	for (p = (volatile unsigned char*) &info, i = 0; i < sizeof(info); i++) {
+		p[i] = 0;
+	}
+	return ret;
+}
+#endif
+
+/* The "tls" upper layer protocol is attached to the TCP socket, then the keys of each direction are set:
+ * the socket then sends and receives the payload of the application records */
+uint8_t f_netw_sock_ktls_start(Network *pNetwork, const netw_ktls_crypto_t* tx, const netw_ktls_crypto_t* rx) {
+#if LOC_NETW_KTLS
+	uint8_t done = 0;
+	if ((pNetwork == NULL) || (pNetwork->my_socket < 0)) {
+		return 0;
+	}
+	if (setsockopt(pNetwork->my_socket, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")) < 0) {
+		LOTRACE_INF("Kernel TLS not available (errno=%d): records encrypted by mbedtls", errno);
+		return 0;
+	}
+	/* Without keys, the "tls" layer lets the data through: each direction is independent */
+	if ((tx) && (f_netw_sock_ktls_set(pNetwork->my_socket, TLS_TX, tx, "TLS_TX") == 0)) {
+		done |= NETW_KTLS_TX;
+	}
+	if ((rx) && (f_netw_sock_ktls_set(pNetwork->my_socket, TLS_RX, rx, "TLS_RX") == 0)) {
+		done |= NETW_KTLS_RX;
+	}
+	LOTRACE_INF("Kernel TLS (sock=%d): TX %s, RX %s", pNetwork->my_socket, (done & NETW_KTLS_TX) ? "on" : "off",
+			(done & NETW_KTLS_RX) ? "on" : "off");
+	return done;
+#else
+	(void) pNetwork;
+	(void) tx;
+	(void) rx;
+	return 0;
+#endif
+}
+
+/*---------------------------------------------------------------------------------*/
+
+/* The record type comes as a control message: an alert (or a handshake message, not supported
+ * after the handshake) ends the connection */
+int f_netw_sock_ktls_recv_timeout(void *pNetwork, unsigned char *buf, size_t len, uint32_t timeout) {
+#if LOC_NETW_KTLS
+	char cbuf[CMSG_SPACE(sizeof(unsigned char))];
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	int ret;
+
+	ret = f_netw_sock_wait(pNetwork, len, timeout);
+	if (ret) {
+		return ret;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+	iov.iov_base = buf;
+	iov.iov_len = len;
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbuf;
+	msg.msg_controllen = sizeof(cbuf);
+
+	ret = (int) recvmsg(NETW_SOCK(pNetwork), &msg, 0);
+	if (ret < 0) {
+		if ((errno == EINTR) || (errno == EAGAIN)) {
+			return (MBEDTLS_ERR_SSL_WANT_READ);
+		}
+		/* EBADMSG: record not authenticated */
+		LOTRACE_ERR("(sock=%d len=%d) recvmsg ret=%d errno=%d", NETW_SOCK(pNetwork), len, ret, errno);
+		if (errno == EPIPE || errno == ECONNRESET) {
+			return (MBEDTLS_ERR_NET_CONN_RESET);
+		}
+		return (MBEDTLS_ERR_NET_RECV_FAILED);
+	}
+
+	cmsg = CMSG_FIRSTHDR(&msg);
+	if ((cmsg) && (cmsg->cmsg_level == SOL_TLS) && (cmsg->cmsg_type == TLS_GET_RECORD_TYPE)) {
+		unsigned char type = *((unsigned char*) CMSG_DATA(cmsg));
+		if (type != NETW_TLS_APPLICATION) {
+			if ((type == NETW_TLS_ALERT) && (ret >= 2)) {
+				LOTRACE_WARN("(sock=%d) TLS alert received: level=%u description=%u", NETW_SOCK(pNetwork), buf[0],
+						buf[1]);
+				return (MBEDTLS_ERR_NET_CONN_RESET);
+			}
+			LOTRACE_ERR("(sock=%d) Unexpected TLS record: type=%u len=%d", NETW_SOCK(pNetwork), type, ret);
+			return (MBEDTLS_ERR_NET_RECV_FAILED);
+		}
+	}
+	LOTRACE_DBG_VERBOSE("(pNetwork=%p sock=%d len=%d) ret=%d", pNetwork, NETW_SOCK(pNetwork), len, ret);
+	return (ret);
+#else
+	(void) pNetwork;
+	(void) buf;
+	(void) len;
+	(void) timeout;
+	return (MBEDTLS_ERR_NET_RECV_FAILED);
+#endif
+}
+
+/*---------------------------------------------------------------------------------*/
+
+int f_netw_sock_ktls_close_notify(Network *pNetwork) {
+#if LOC_NETW_KTLS
+	unsigned char alert[2] = { 1, 0 }; /* warning, close_notify */
+	char cbuf[CMSG_SPACE(sizeof(unsigned char))];
+	struct msghdr msg;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+
+	if (NETW_SOCK(pNetwork) < 0) {
+		return (MBEDTLS_ERR_NET_INVALID_CONTEXT);
+	}
+	memset(&msg, 0, sizeof(msg));
+	memset(cbuf, 0, sizeof(cbuf));
+	iov.iov_base = alert;
+	iov.iov_len = sizeof(alert);
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = cbuf;
+	msg.msg_controllen = sizeof(cbuf);
+	cmsg = CMSG_FIRSTHDR(&msg);
+	cmsg->cmsg_level = SOL_TLS;
+	cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+	cmsg->cmsg_len = CMSG_LEN(sizeof(unsigned char));
+	*((unsigned char*) CMSG_DATA(cmsg)) = NETW_TLS_ALERT;
+
+	if (sendmsg(NETW_SOCK(pNetwork), &msg, MSG_NOSIGNAL) < 0) {
+		LOTRACE_WARN("(sock=%d) close_notify not sent, errno=%d", NETW_SOCK(pNetwork), errno);
+		return (MBEDTLS_ERR_NET_SEND_FAILED);
+	}
+	return 0;
+#else
+	(void) pNetwork;
+	return (MBEDTLS_ERR_NET_SEND_FAILED);
+#endif
+}
@@ -35,10 +35,25 @@
 
 #define MEM_ALLOC(len)        ((char*) malloc(len))
 
+/* 'len' must be a multiple of 'align' (memory released with MEM_FREE) */
+#define MEM_ALLOC_ALIGNED(align, len) ((char*) aligned_alloc((align), (len)))
+
 #define MEM_FREE(p)            free((void*)(p))
 
 #define WAIT_MS(dt_ms)         delay(dt_ms)
 
+/* Atomic operations (GCC built-in functions) */
+#define LO_ATOMIC_LOAD(p)               __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define LO_ATOMIC_STORE(p, v)           __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define LO_ATOMIC_CAS(p, p_expected, v) __atomic_compare_exchange_n((p), (p_expected), (v), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define LO_ATOMIC_ADD(p, v)             __atomic_add_fetch((p), (v), __ATOMIC_RELAXED)
+
+/* Alignment of a type or of a structure member (GCC) */
+#define LO_ALIGNED(n)                   __attribute__((aligned(n)))
+
+/* Thread-local storage (GCC), one copy of the variable per LiveObjects Client thread */
+#define LO_THREAD_LOCAL                 __thread
+
 void WAIT_MS(uint32_t dt_ms);
 
 #endif /* __LiveObjectsClient_Platform_H_ */
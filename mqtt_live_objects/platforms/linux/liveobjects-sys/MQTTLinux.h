@@ -60,6 +60,7 @@ typedef struct Network {
 	int my_socket;
 	int (*mqttread)(struct Network*, unsigned char*, int, int);
 	int (*mqttwrite)(struct Network*, unsigned char*, int, int);
+	void* netw_ctx;   /* Context of the network wrapper (TLS session, ...) */
 } Network;
 
 int linux_read(Network*, unsigned char*, int, int);